@@ -0,0 +1,119 @@
+"""
+Build the web UI static assets for the LittleFS image.
+
+Minifies and gzips every CSS/JS file under web/ into data/static/ with a
+content hash in the file name, and generates src/web/assets.h with the
+matching ASSET_* URL macros used by the page templates in pages.h.
+
+Runs automatically before each PlatformIO build (extra_scripts = pre:...),
+or standalone: python scripts/build_web_assets.py
+"""
+
+import gzip
+import hashlib
+import os
+import re
+
+ASSET_TYPES = {
+    ".css": "css",
+    ".js": "js",
+}
+
+HASH_LENGTH = 10
+
+
+def minify_css(source):
+    source = re.sub(r"/\*.*?\*/", "", source, flags=re.S)
+    source = re.sub(r"\s+", " ", source)
+    source = re.sub(r"\s*([{}:;,>])\s*", r"\1", source)
+    source = source.replace(";}", "}")
+    return source.strip()
+
+
+def minify_js(source):
+    # Conservative: drop indentation, blank lines and whole-line comments only,
+    # so string literals and regexes are never touched
+    lines = []
+    for line in source.splitlines():
+        line = line.strip()
+        if not line or line.startswith("//"):
+            continue
+        lines.append(line)
+    return "\n".join(lines)
+
+
+def build_asset(path, kind):
+    with open(path, "r", encoding="utf-8") as f:
+        source = f.read()
+
+    minified = minify_css(source) if kind == "css" else minify_js(source)
+    data = minified.encode("utf-8")
+    digest = hashlib.sha256(data).hexdigest()[:HASH_LENGTH]
+    # mtime=0 keeps the output byte-identical across builds
+    compressed = gzip.compress(data, compresslevel=9, mtime=0)
+    return digest, len(source.encode("utf-8")), compressed
+
+
+def write_if_changed(path, content):
+    mode = "wb" if isinstance(content, bytes) else "w"
+    if os.path.exists(path):
+        with open(path, "rb" if mode == "wb" else "r") as f:
+            if f.read() == content:
+                return
+    with open(path, mode) as f:
+        f.write(content)
+
+
+def build(project_dir):
+    source_dir = os.path.join(project_dir, "web")
+    output_dir = os.path.join(project_dir, "data", "static")
+    header_path = os.path.join(project_dir, "src", "web", "assets.h")
+
+    os.makedirs(output_dir, exist_ok=True)
+
+    macros = []
+    outputs = set()
+    for subdir in sorted(os.listdir(source_dir)):
+        subpath = os.path.join(source_dir, subdir)
+        if not os.path.isdir(subpath):
+            continue
+        for filename in sorted(os.listdir(subpath)):
+            name, ext = os.path.splitext(filename)
+            kind = ASSET_TYPES.get(ext)
+            if not kind:
+                continue
+
+            digest, raw_size, compressed = build_asset(os.path.join(subpath, filename), kind)
+            served_name = "%s.%s%s" % (name, digest, ext)
+            output_name = served_name + ".gz"
+            write_if_changed(os.path.join(output_dir, output_name), compressed)
+            outputs.add(output_name)
+
+            macro = "ASSET_%s_%s" % (kind.upper(), re.sub(r"\W", "_", name).upper())
+            macros.append((macro, "/static/" + served_name))
+            print("Web assets: %s -> %s (%d -> %d bytes)" %
+                  (filename, output_name, raw_size, len(compressed)))
+
+    # Remove stale builds of assets whose content hash changed
+    for filename in os.listdir(output_dir):
+        if filename not in outputs:
+            os.remove(os.path.join(output_dir, filename))
+
+    width = max(len(m) for m, _ in macros) + 1 if macros else 0
+    lines = [
+        "// Generated by scripts/build_web_assets.py - do not edit",
+        "#ifndef ASSETS_H",
+        "#define ASSETS_H",
+        "",
+    ]
+    lines += ['#define %s"%s"' % (macro.ljust(width), url) for macro, url in macros]
+    lines += ["", "#endif // ASSETS_H", ""]
+    write_if_changed(header_path, "\n".join(lines))
+
+
+try:
+    Import("env")  # noqa: F821 - provided by PlatformIO
+    build(env["PROJECT_DIR"])  # noqa: F821
+except NameError:
+    if __name__ == "__main__":
+        build(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
@@ -0,0 +1,125 @@
+#include "addrcache.h"
+#include "../utils/log.h"
+#include <LittleFS.h>
+
+struct AddressCacheHeader {
+    uint32_t magic;
+    uint32_t walletId;
+    int32_t lastUsed;
+    uint32_t count;
+};
+
+AddressChain::AddressChain() {
+    walletId = 0;
+    lastUsed = -1;
+    derived = 0;
+    dirty = false;
+}
+
+void AddressChain::load(uint32_t walletId, uint8_t chain) {
+    char name[32];
+    snprintf(name, sizeof(name), ADDRESS_CACHE_PREFIX "%08x_%u.bin", (unsigned)walletId, chain);
+    path = name;
+    this->walletId = walletId;
+    hashes.clear();
+    lastUsed = -1;
+    derived = 0;
+    dirty = false;
+
+    if (!LittleFS.exists(path)) {
+        return;
+    }
+    File file = LittleFS.open(path, "r");
+    if (!file) {
+        return;
+    }
+    AddressCacheHeader header;
+    bool valid = file.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+                 header.magic == ADDRESS_CACHE_MAGIC && header.walletId == walletId &&
+                 header.count <= ADDRESS_CACHE_MAX && header.lastUsed < (int32_t)header.count;
+    if (valid) {
+        hashes.resize(header.count * HASH160_SIZE);
+        valid = file.read(hashes.data(), hashes.size()) == hashes.size();
+    }
+    file.close();
+
+    if (valid) {
+        lastUsed = header.lastUsed;
+    } else {
+        LOG_W(COLD, "AddressChain: Ignoring invalid cache %s\n", path.c_str());
+        hashes.clear();
+    }
+}
+
+bool AddressChain::save() {
+    if (!dirty) {
+        return true;
+    }
+
+    AddressCacheHeader header;
+    header.magic = ADDRESS_CACHE_MAGIC;
+    header.walletId = walletId;
+    header.lastUsed = lastUsed;
+    header.count = getCount();
+
+    // Same temp-and-rename swap as the settings records
+    String temp = path + ".tmp";
+    File file = LittleFS.open(temp, "w");
+    if (!file) {
+        LOG_E(COLD, "AddressChain: Failed to open %s\n", temp.c_str());
+        return false;
+    }
+    size_t written = file.write((const uint8_t*)&header, sizeof(header));
+    written += file.write(hashes.data(), hashes.size());
+    file.close();
+
+    if (written != sizeof(header) + hashes.size() || !LittleFS.rename(temp, path)) {
+        LOG_E(COLD, "AddressChain: Failed to write %s\n", path.c_str());
+        LittleFS.remove(temp);
+        return false;
+    }
+    dirty = false;
+    return true;
+}
+
+bool AddressChain::extend(const ExtendedPubKey& chainKey, uint32_t count) {
+    if (count > ADDRESS_CACHE_MAX) {
+        count = ADDRESS_CACHE_MAX;
+    }
+    if (getCount() >= count) {
+        return true;
+    }
+
+    Bip32Deriver deriver;
+    if (!deriver.begin(chainKey)) {
+        return false;
+    }
+    hashes.reserve(count * HASH160_SIZE);
+    for (uint32_t index = getCount(); index < count; index++) {
+        ExtendedPubKey child;
+        if (!deriver.derive(index, child)) {
+            LOG_E(COLD, "AddressChain: Derivation failed at index %u\n", (unsigned)index);
+            return false;
+        }
+        uint8_t hash[HASH160_SIZE];
+        scriptHash(child.key, chainKey.script, hash);
+        hashes.insert(hashes.end(), hash, hash + HASH160_SIZE);
+        derived++;
+        dirty = true;
+    }
+    return true;
+}
+
+const uint8_t* AddressChain::getHash(uint32_t index) const {
+    if (index >= getCount()) {
+        return nullptr;
+    }
+    return hashes.data() + index * HASH160_SIZE;
+}
+
+void AddressChain::markUsed(uint32_t index) {
+    if ((int32_t)index > lastUsed) {
+        lastUsed = index;
+        dirty = true;
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef ADDRCACHE_H
+#define ADDRCACHE_H
+
+#include <Arduino.h>
+#include <vector>
+#include "bip32.h"
+
+// Derived address cache. Each wallet chain keeps the script hashes of its
+// derived addresses and the highest index seen in use in one LittleFS
+// file, so a wake neither repeats the point multiplications nor rediscovers
+// the used range one gap at a time.
+#define ADDRESS_CACHE_MAGIC     0x31434148  // "HAC1"
+#define ADDRESS_CACHE_MAX       1000        // Addresses per chain
+#define ADDRESS_CACHE_PREFIX    "/addr_"    // + wallet id and chain
+
+class AddressChain {
+public:
+    AddressChain();
+
+    // Loads the cache of one chain; a missing or foreign file starts empty
+    void load(uint32_t walletId, uint8_t chain);
+
+    // Writes the file if anything changed since load()
+    bool save();
+
+    // Derives addresses from chainKey until count are cached
+    bool extend(const ExtendedPubKey& chainKey, uint32_t count);
+
+    const uint8_t* getHash(uint32_t index) const;
+    uint32_t getCount() const { return hashes.size() / HASH160_SIZE; }
+    uint32_t getDerived() const { return derived; }
+
+    // -1 while no address of the chain has been used
+    int32_t getLastUsed() const { return lastUsed; }
+    void markUsed(uint32_t index);
+
+private:
+    std::vector<uint8_t> hashes;
+    uint32_t walletId;
+    int32_t lastUsed;
+    uint32_t derived;       // Addresses derived since load()
+    String path;
+    bool dirty;
+};
+
+#endif // ADDRCACHE_H
@@ -0,0 +1,308 @@
+#include "address.h"
+#include <mbedtls/md.h>
+
+#define BASE58_MAX_BYTES    96      // Longest payload handled, extended keys need 82
+
+static const char BASE58_ALPHABET[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+static const char BECH32_CHARSET[] = "qpzry9x8gf2tvdw0s3jn54khce6mua7l";
+
+// RIPEMD-160 message schedule and rotations, left and right lines
+static const uint8_t RMD_LEFT_WORD[80] = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+    7, 4, 13, 1, 10, 6, 15, 3, 12, 0, 9, 5, 2, 14, 11, 8,
+    3, 10, 14, 4, 9, 15, 8, 1, 2, 7, 0, 6, 13, 11, 5, 12,
+    1, 9, 11, 10, 0, 8, 12, 4, 13, 3, 7, 15, 14, 5, 6, 2,
+    4, 0, 5, 9, 7, 12, 2, 10, 14, 1, 3, 8, 11, 6, 15, 13
+};
+static const uint8_t RMD_RIGHT_WORD[80] = {
+    5, 14, 7, 0, 9, 2, 11, 4, 13, 6, 15, 8, 1, 10, 3, 12,
+    6, 11, 3, 7, 0, 13, 5, 10, 14, 15, 8, 12, 4, 9, 1, 2,
+    15, 5, 1, 3, 7, 14, 6, 9, 11, 8, 12, 2, 10, 0, 4, 13,
+    8, 6, 4, 1, 3, 11, 15, 0, 5, 12, 2, 13, 9, 7, 10, 14,
+    12, 15, 10, 4, 1, 5, 8, 7, 6, 2, 13, 14, 0, 3, 9, 11
+};
+static const uint8_t RMD_LEFT_SHIFT[80] = {
+    11, 14, 15, 12, 5, 8, 7, 9, 11, 13, 14, 15, 6, 7, 9, 8,
+    7, 6, 8, 13, 11, 9, 7, 15, 7, 12, 15, 9, 11, 7, 13, 12,
+    11, 13, 6, 7, 14, 9, 13, 15, 14, 8, 13, 6, 5, 12, 7, 5,
+    11, 12, 14, 15, 14, 15, 9, 8, 9, 14, 5, 6, 8, 6, 5, 12,
+    9, 15, 5, 11, 6, 8, 13, 12, 5, 12, 13, 14, 11, 8, 5, 6
+};
+static const uint8_t RMD_RIGHT_SHIFT[80] = {
+    8, 9, 9, 11, 13, 15, 15, 5, 7, 7, 8, 11, 14, 14, 12, 6,
+    9, 13, 15, 7, 12, 8, 9, 11, 7, 7, 12, 7, 6, 15, 13, 11,
+    9, 7, 15, 11, 8, 6, 6, 14, 12, 13, 5, 14, 13, 13, 7, 5,
+    15, 5, 8, 11, 14, 14, 6, 14, 6, 9, 12, 9, 12, 5, 15, 8,
+    8, 5, 12, 9, 12, 5, 14, 6, 8, 13, 6, 5, 15, 13, 11, 11
+};
+static const uint32_t RMD_LEFT_K[5] = { 0x00000000, 0x5A827999, 0x6ED9EBA1, 0x8F1BBCDC, 0xA953FD4E };
+static const uint32_t RMD_RIGHT_K[5] = { 0x50A28BE6, 0x5C4DD124, 0x6D703EF3, 0x7A6D76E9, 0x00000000 };
+
+static inline uint32_t rotateLeft(uint32_t value, uint8_t bits) {
+    return (value << bits) | (value >> (32 - bits));
+}
+
+static inline uint32_t rmdF(uint8_t round, uint32_t x, uint32_t y, uint32_t z) {
+    switch (round) {
+        case 0: return x ^ y ^ z;
+        case 1: return (x & y) | (~x & z);
+        case 2: return (x | ~y) ^ z;
+        case 3: return (x & z) | (y & ~z);
+        default: return x ^ (y | ~z);
+    }
+}
+
+static void ripemd160Block(uint32_t* state, const uint8_t* block) {
+    uint32_t words[16];
+    for (size_t i = 0; i < 16; i++) {
+        words[i] = block[i * 4] | (block[i * 4 + 1] << 8) | (block[i * 4 + 2] << 16) | ((uint32_t)block[i * 4 + 3] << 24);
+    }
+
+    uint32_t al = state[0], bl = state[1], cl = state[2], dl = state[3], el = state[4];
+    uint32_t ar = al, br = bl, cr = cl, dr = dl, er = el;
+    for (uint8_t j = 0; j < 80; j++) {
+        uint8_t round = j / 16;
+        uint32_t t = rotateLeft(al + rmdF(round, bl, cl, dl) + words[RMD_LEFT_WORD[j]] + RMD_LEFT_K[round],
+                                RMD_LEFT_SHIFT[j]) + el;
+        al = el; el = dl; dl = rotateLeft(cl, 10); cl = bl; bl = t;
+
+        t = rotateLeft(ar + rmdF(4 - round, br, cr, dr) + words[RMD_RIGHT_WORD[j]] + RMD_RIGHT_K[round],
+                       RMD_RIGHT_SHIFT[j]) + er;
+        ar = er; er = dr; dr = rotateLeft(cr, 10); cr = br; br = t;
+    }
+
+    uint32_t t = state[1] + cl + dr;
+    state[1] = state[2] + dl + er;
+    state[2] = state[3] + el + ar;
+    state[3] = state[4] + al + br;
+    state[4] = state[0] + bl + cr;
+    state[0] = t;
+}
+
+// Only ever hashes short inputs (a SHA-256 digest), so the whole padded
+// message is built in one buffer
+static void ripemd160(const uint8_t* data, size_t length, uint8_t* out) {
+    uint32_t state[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+
+    size_t offset = 0;
+    for (; offset + 64 <= length; offset += 64) {
+        ripemd160Block(state, data + offset);
+    }
+
+    uint8_t tail[128];
+    size_t remaining = length - offset;
+    memset(tail, 0, sizeof(tail));
+    memcpy(tail, data + offset, remaining);
+    tail[remaining] = 0x80;
+    size_t tailLength = remaining < 56 ? 64 : 128;
+    uint64_t bits = (uint64_t)length * 8;
+    for (size_t i = 0; i < 8; i++) {
+        tail[tailLength - 8 + i] = bits >> (i * 8);
+    }
+    for (size_t i = 0; i < tailLength; i += 64) {
+        ripemd160Block(state, tail + i);
+    }
+
+    for (size_t i = 0; i < 5; i++) {
+        out[i * 4] = state[i];
+        out[i * 4 + 1] = state[i] >> 8;
+        out[i * 4 + 2] = state[i] >> 16;
+        out[i * 4 + 3] = state[i] >> 24;
+    }
+}
+
+static void sha256(const uint8_t* data, size_t length, uint8_t* out) {
+    mbedtls_md(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), data, length, out);
+}
+
+void hash160(const uint8_t* data, size_t length, uint8_t* out) {
+    uint8_t digest[32];
+    sha256(data, length, digest);
+    ripemd160(digest, sizeof(digest), out);
+}
+
+void scriptHash(const uint8_t* publicKey, ScriptType script, uint8_t* out) {
+    if (script != ScriptType::P2SH_P2WPKH) {
+        hash160(publicKey, 33, out);
+        return;
+    }
+
+    // Redeem script: OP_0 <20-byte key hash>
+    uint8_t redeem[2 + HASH160_SIZE];
+    redeem[0] = 0x00;
+    redeem[1] = HASH160_SIZE;
+    hash160(publicKey, 33, redeem + 2);
+    hash160(redeem, sizeof(redeem), out);
+}
+
+// BIP173 checksum over the expanded HRP and the 5-bit data
+static uint32_t bech32Polymod(const uint8_t* values, size_t length) {
+    static const uint32_t GENERATOR[5] = { 0x3b6a57b2, 0x26508e6d, 0x1ea119fa, 0x3d4233dd, 0x2a1462b3 };
+    uint32_t check = 1;
+    for (size_t i = 0; i < length; i++) {
+        uint8_t top = check >> 25;
+        check = ((check & 0x1ffffff) << 5) ^ values[i];
+        for (uint8_t bit = 0; bit < 5; bit++) {
+            if ((top >> bit) & 1) {
+                check ^= GENERATOR[bit];
+            }
+        }
+    }
+    return check;
+}
+
+// Segwit version 0 address for a 20-byte program
+static bool encodeBech32(const char* hrp, const uint8_t* program, char* out) {
+    size_t hrpLength = strlen(hrp);
+    uint8_t values[2 * 4 + 1 + 1 + 32 + 6];     // Expanded HRP, version, program, checksum
+    size_t count = 0;
+    for (size_t i = 0; i < hrpLength; i++) {
+        values[count++] = hrp[i] >> 5;
+    }
+    values[count++] = 0;
+    for (size_t i = 0; i < hrpLength; i++) {
+        values[count++] = hrp[i] & 31;
+    }
+    size_t dataStart = count;
+    values[count++] = 0;    // Witness version
+
+    uint32_t accumulator = 0;
+    uint8_t bits = 0;
+    for (size_t i = 0; i < HASH160_SIZE; i++) {
+        accumulator = (accumulator << 8) | program[i];
+        bits += 8;
+        while (bits >= 5) {
+            bits -= 5;
+            values[count++] = (accumulator >> bits) & 31;
+        }
+    }
+    if (bits > 0) {
+        values[count++] = (accumulator << (5 - bits)) & 31;
+    }
+
+    size_t checksumStart = count;
+    memset(values + count, 0, 6);
+    count += 6;
+    uint32_t checksum = bech32Polymod(values, count) ^ 1;
+    for (size_t i = 0; i < 6; i++) {
+        values[checksumStart + i] = (checksum >> (5 * (5 - i))) & 31;
+    }
+
+    char* cursor = out;
+    memcpy(cursor, hrp, hrpLength);
+    cursor += hrpLength;
+    *cursor++ = '1';
+    for (size_t i = dataStart; i < count; i++) {
+        *cursor++ = BECH32_CHARSET[values[i]];
+    }
+    *cursor = '\0';
+    return true;
+}
+
+bool encodeAddress(const uint8_t* hash, ScriptType script, bool testnet, char* out) {
+    if (script == ScriptType::P2WPKH) {
+        return encodeBech32(testnet ? "tb" : "bc", hash, out);
+    }
+
+    uint8_t payload[1 + HASH160_SIZE];
+    if (script == ScriptType::P2PKH) {
+        payload[0] = testnet ? 0x6f : 0x00;
+    } else {
+        payload[0] = testnet ? 0xc4 : 0x05;
+    }
+    memcpy(payload + 1, hash, HASH160_SIZE);
+    return base58CheckEncode(payload, sizeof(payload), out, ADDRESS_MAX_LENGTH);
+}
+
+size_t base58CheckDecode(const char* text, size_t length, uint8_t* out, size_t capacity) {
+    // Big-endian base-256 accumulator, multiplied by 58 per digit
+    uint8_t buffer[BASE58_MAX_BYTES];
+    size_t used = 0;
+    size_t zeros = 0;
+    while (zeros < length && text[zeros] == '1') {
+        zeros++;
+    }
+
+    for (size_t i = zeros; i < length; i++) {
+        const char* digit = strchr(BASE58_ALPHABET, text[i]);
+        if (!digit || text[i] == '\0') {
+            return 0;
+        }
+        uint32_t carry = digit - BASE58_ALPHABET;
+        for (size_t j = 0; j < used; j++) {
+            carry += (uint32_t)buffer[BASE58_MAX_BYTES - 1 - j] * 58;
+            buffer[BASE58_MAX_BYTES - 1 - j] = carry & 0xff;
+            carry >>= 8;
+        }
+        while (carry > 0) {
+            if (used == BASE58_MAX_BYTES) {
+                return 0;
+            }
+            buffer[BASE58_MAX_BYTES - 1 - used++] = carry & 0xff;
+            carry >>= 8;
+        }
+    }
+
+    size_t total = zeros + used;
+    if (total < 4 || total - 4 > capacity || total > BASE58_MAX_BYTES) {
+        return 0;
+    }
+    uint8_t decoded[BASE58_MAX_BYTES];
+    memset(decoded, 0, zeros);
+    memcpy(decoded + zeros, buffer + BASE58_MAX_BYTES - used, used);
+
+    uint8_t digest[32];
+    sha256(decoded, total - 4, digest);
+    sha256(digest, sizeof(digest), digest);
+    if (memcmp(digest, decoded + total - 4, 4) != 0) {
+        return 0;
+    }
+    memcpy(out, decoded, total - 4);
+    return total - 4;
+}
+
+bool base58CheckEncode(const uint8_t* data, size_t length, char* out, size_t capacity) {
+    if (length + 4 > BASE58_MAX_BYTES) {
+        return false;
+    }
+    uint8_t input[BASE58_MAX_BYTES];
+    memcpy(input, data, length);
+    uint8_t digest[32];
+    sha256(data, length, digest);
+    sha256(digest, sizeof(digest), digest);
+    memcpy(input + length, digest, 4);
+    length += 4;
+
+    // Little-endian base-58 digits, converted from base 256
+    uint8_t digits[BASE58_MAX_BYTES * 138 / 100 + 1];
+    size_t used = 0;
+    size_t zeros = 0;
+    while (zeros < length && input[zeros] == 0) {
+        zeros++;
+    }
+    for (size_t i = zeros; i < length; i++) {
+        uint32_t carry = input[i];
+        for (size_t j = 0; j < used; j++) {
+            carry += (uint32_t)digits[j] << 8;
+            digits[j] = carry % 58;
+            carry /= 58;
+        }
+        while (carry > 0) {
+            digits[used++] = carry % 58;
+            carry /= 58;
+        }
+    }
+
+    if (zeros + used + 1 > capacity) {
+        return false;
+    }
+    size_t position = 0;
+    for (size_t i = 0; i < zeros; i++) {
+        out[position++] = '1';
+    }
+    for (size_t i = 0; i < used; i++) {
+        out[position++] = BASE58_ALPHABET[digits[used - 1 - i]];
+    }
+    out[position] = '\0';
+    return true;
+}
@@ -0,0 +1,34 @@
+#ifndef ADDRESS_H
+#define ADDRESS_H
+
+#include <Arduino.h>
+
+// Bitcoin address encoding for watch-only wallets. Addresses are kept as
+// the 20-byte hash their script pays to and turned into text on demand.
+#define HASH160_SIZE        20
+#define ADDRESS_MAX_LENGTH  64      // Longest encoded address plus terminator
+
+// Output script of a derived address
+enum class ScriptType : uint8_t {
+    P2PKH,          // 1... / m..., n...
+    P2SH_P2WPKH,    // 3... / 2..., segwit nested in P2SH
+    P2WPKH          // bc1q... / tb1q...
+};
+
+// RIPEMD-160 of SHA-256. RIPEMD-160 is implemented here because the
+// framework's mbedtls build does not always include it.
+void hash160(const uint8_t* data, size_t length, uint8_t* out);
+
+// Hash the address commits to for a compressed public key: the key hash,
+// or for P2SH_P2WPKH the hash of the witness program script
+void scriptHash(const uint8_t* publicKey, ScriptType script, uint8_t* out);
+
+// Writes the address for a script hash into out (ADDRESS_MAX_LENGTH bytes)
+bool encodeAddress(const uint8_t* hash, ScriptType script, bool testnet, char* out);
+
+// Base58 with a 4-byte double SHA-256 checksum. decode returns the payload
+// length, 0 if the text is not valid base58check or does not fit.
+size_t base58CheckDecode(const char* text, size_t length, uint8_t* out, size_t capacity);
+bool base58CheckEncode(const uint8_t* data, size_t length, char* out, size_t capacity);
+
+#endif // ADDRESS_H
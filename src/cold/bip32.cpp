@@ -0,0 +1,150 @@
+#include "bip32.h"
+#include <mbedtls/md.h>
+
+// SLIP-132 version bytes of the public key formats accepted
+struct KeyVersion {
+    uint32_t version;
+    bool testnet;
+    ScriptType script;
+};
+
+static const KeyVersion KEY_VERSIONS[] = {
+    { 0x0488B21E, false, ScriptType::P2PKH },           // xpub
+    { 0x049D7CB2, false, ScriptType::P2SH_P2WPKH },     // ypub
+    { 0x04B24746, false, ScriptType::P2WPKH },          // zpub
+    { 0x043587CF, true,  ScriptType::P2PKH },           // tpub
+    { 0x044A5262, true,  ScriptType::P2SH_P2WPKH },     // upub
+    { 0x045F1CF6, true,  ScriptType::P2WPKH },          // vpub
+};
+
+bool parseExtendedPubKey(const char* text, size_t length, ExtendedPubKey& out) {
+    // version(4) depth(1) fingerprint(4) child(4) chain code(32) key(33)
+    uint8_t data[BIP32_SERIALIZED_SIZE];
+    if (base58CheckDecode(text, length, data, sizeof(data)) != BIP32_SERIALIZED_SIZE) {
+        return false;
+    }
+    if (data[45] != 0x02 && data[45] != 0x03) {
+        return false;
+    }
+
+    uint32_t version = ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | (data[2] << 8) | data[3];
+    for (size_t i = 0; i < sizeof(KEY_VERSIONS) / sizeof(KEY_VERSIONS[0]); i++) {
+        if (KEY_VERSIONS[i].version == version) {
+            memcpy(out.chainCode, data + 13, BIP32_CHAIN_CODE_SIZE);
+            memcpy(out.key, data + 45, BIP32_KEY_SIZE);
+            out.testnet = KEY_VERSIONS[i].testnet;
+            out.script = KEY_VERSIONS[i].script;
+            return true;
+        }
+    }
+    return false;
+}
+
+Bip32Deriver::Bip32Deriver() {
+    mbedtls_ecp_group_init(&group);
+    mbedtls_ecp_point_init(&point);
+    ready = false;
+}
+
+Bip32Deriver::~Bip32Deriver() {
+    mbedtls_ecp_point_free(&point);
+    mbedtls_ecp_group_free(&group);
+}
+
+bool Bip32Deriver::begin(const ExtendedPubKey& parent) {
+    ready = false;
+    if (group.id == MBEDTLS_ECP_DP_NONE && mbedtls_ecp_group_load(&group, MBEDTLS_ECP_DP_SECP256K1) != 0) {
+        return false;
+    }
+    if (!decompress(parent.key, point)) {
+        return false;
+    }
+    this->parent = parent;
+    ready = true;
+    return true;
+}
+
+bool Bip32Deriver::derive(uint32_t index, ExtendedPubKey& child) {
+    if (!ready || (index & BIP32_HARDENED)) {
+        return false;
+    }
+
+    // I = HMAC-SHA512(chain code, parent key || index)
+    uint8_t data[BIP32_KEY_SIZE + 4];
+    memcpy(data, parent.key, BIP32_KEY_SIZE);
+    data[BIP32_KEY_SIZE] = index >> 24;
+    data[BIP32_KEY_SIZE + 1] = index >> 16;
+    data[BIP32_KEY_SIZE + 2] = index >> 8;
+    data[BIP32_KEY_SIZE + 3] = index;
+    uint8_t digest[64];
+    if (mbedtls_md_hmac(mbedtls_md_info_from_type(MBEDTLS_MD_SHA512), parent.chainCode, BIP32_CHAIN_CODE_SIZE,
+                        data, sizeof(data), digest) != 0) {
+        return false;
+    }
+
+    // Child key = IL * G + parent key. An IL past the group order or a
+    // result at infinity makes the index invalid (odds about 2^-127).
+    mbedtls_mpi tweak;
+    mbedtls_mpi one;
+    mbedtls_ecp_point result;
+    mbedtls_mpi_init(&tweak);
+    mbedtls_mpi_init(&one);
+    mbedtls_ecp_point_init(&result);
+
+    size_t length = 0;
+    bool ok = mbedtls_mpi_read_binary(&tweak, digest, 32) == 0 &&
+              mbedtls_mpi_cmp_mpi(&tweak, &group.N) < 0 &&
+              mbedtls_mpi_lset(&one, 1) == 0 &&
+              mbedtls_ecp_muladd(&group, &result, &tweak, &group.G, &one, &point) == 0 &&
+              mbedtls_ecp_is_zero(&result) == 0 &&
+              mbedtls_ecp_point_write_binary(&group, &result, MBEDTLS_ECP_PF_COMPRESSED, &length,
+                                             child.key, sizeof(child.key)) == 0 &&
+              length == BIP32_KEY_SIZE;
+
+    mbedtls_ecp_point_free(&result);
+    mbedtls_mpi_free(&one);
+    mbedtls_mpi_free(&tweak);
+
+    if (ok) {
+        memcpy(child.chainCode, digest + 32, BIP32_CHAIN_CODE_SIZE);
+        child.testnet = parent.testnet;
+        child.script = parent.script;
+    }
+    return ok;
+}
+
+// Private methods
+
+// mbedtls 2.x only reads uncompressed points. On secp256k1 y^2 = x^3 + 7,
+// and as p = 3 (mod 4) the root is (x^3 + 7)^((p + 1) / 4).
+bool Bip32Deriver::decompress(const uint8_t* key, mbedtls_ecp_point& out) {
+    if (key[0] != 0x02 && key[0] != 0x03) {
+        return false;
+    }
+
+    mbedtls_mpi square;
+    mbedtls_mpi exponent;
+    mbedtls_mpi_init(&square);
+    mbedtls_mpi_init(&exponent);
+
+    bool ok = mbedtls_mpi_read_binary(&out.X, key + 1, 32) == 0 &&
+              mbedtls_mpi_cmp_mpi(&out.X, &group.P) < 0 &&
+              mbedtls_mpi_mul_mpi(&square, &out.X, &out.X) == 0 &&
+              mbedtls_mpi_mod_mpi(&square, &square, &group.P) == 0 &&
+              mbedtls_mpi_mul_mpi(&square, &square, &out.X) == 0 &&
+              mbedtls_mpi_add_mpi(&square, &square, &group.B) == 0 &&
+              mbedtls_mpi_mod_mpi(&square, &square, &group.P) == 0 &&
+              mbedtls_mpi_add_int(&exponent, &group.P, 1) == 0 &&
+              mbedtls_mpi_shift_r(&exponent, 2) == 0 &&
+              mbedtls_mpi_exp_mod(&out.Y, &square, &exponent, &group.P, nullptr) == 0;
+    if (ok && mbedtls_mpi_get_bit(&out.Y, 0) != (key[0] & 1)) {
+        ok = mbedtls_mpi_sub_mpi(&out.Y, &group.P, &out.Y) == 0;
+    }
+
+    // Rejects an x with no root, i.e. not on the curve
+    ok = ok && mbedtls_mpi_lset(&out.Z, 1) == 0 && mbedtls_ecp_check_pubkey(&group, &out) == 0;
+
+    mbedtls_mpi_free(&exponent);
+    mbedtls_mpi_free(&square);
+    return ok;
+}
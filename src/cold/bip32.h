@@ -0,0 +1,49 @@
+#ifndef BIP32_H
+#define BIP32_H
+
+#include <Arduino.h>
+#include <mbedtls/ecp.h>
+#include "address.h"
+
+// BIP32 public derivation (CKDpub) on secp256k1, for watch-only wallets.
+// Only non-hardened children can be derived from a public key.
+#define BIP32_KEY_SIZE          33      // Compressed public key
+#define BIP32_CHAIN_CODE_SIZE   32
+#define BIP32_SERIALIZED_SIZE   78      // Decoded xpub without checksum
+#define BIP32_HARDENED          0x80000000
+
+// Extended public key. The SLIP-132 version (xpub, ypub, zpub and their
+// testnet forms) decides the script of the addresses derived from it.
+struct ExtendedPubKey {
+    uint8_t key[BIP32_KEY_SIZE];
+    uint8_t chainCode[BIP32_CHAIN_CODE_SIZE];
+    bool testnet;
+    ScriptType script;
+};
+
+// Decodes a base58check extended public key; false for private keys,
+// unknown versions and bad checksums
+bool parseExtendedPubKey(const char* text, size_t length, ExtendedPubKey& out);
+
+// Derives the children of one parent. The parent point is decompressed
+// once and the curve's precomputed generator table is kept between
+// calls, so deriving a run of addresses costs one point multiplication
+// each.
+class Bip32Deriver {
+public:
+    Bip32Deriver();
+    ~Bip32Deriver();
+
+    bool begin(const ExtendedPubKey& parent);
+    bool derive(uint32_t index, ExtendedPubKey& child);
+
+private:
+    mbedtls_ecp_group group;
+    mbedtls_ecp_point point;
+    ExtendedPubKey parent;
+    bool ready;
+
+    bool decompress(const uint8_t* key, mbedtls_ecp_point& out);
+};
+
+#endif // BIP32_H
@@ -1,8 +1,57 @@
 #include "cold.h"
+#include "../utils/log.h"
+#include "../utils/jsonpool.h"
+#include "../utils/httppool.h"
+#include "../utils/utils.h"
+#include <StreamString.h>
+
+static_assert(TX_STORE_ACCOUNTS_MAX >= ADDRESS_CACHE_MAX * WALLET_MAX_CHAINS,
+              "The history store must hold every address a wallet scan can find");
 
 // Global instance
 ColdStorage coldStorage;
 
+// Web requests read the history while the job worker syncs it; the lock
+// covers only the RAM updates, never a network wait
+class HistoryLock {
+public:
+    explicit HistoryLock(SemaphoreHandle_t lock) : lock(lock) { xSemaphoreTake(lock, portMAX_DELAY); }
+    ~HistoryLock() { xSemaphoreGive(lock); }
+private:
+    SemaphoreHandle_t lock;
+};
+
+static uint32_t accountId(const String& address) {
+    return utils.crc32((const uint8_t*)address.c_str(), address.length());
+}
+
+static bool parseTxid(const char* hex, uint8_t* out) {
+    if (strlen(hex) != TXID_SIZE * 2) {
+        return false;
+    }
+    for (size_t i = 0; i < TXID_SIZE; i++) {
+        char byte[3] = { hex[2 * i], hex[2 * i + 1], '\0' };
+        char* end;
+        out[i] = strtoul(byte, &end, 16);
+        if (end != byte + 2) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static BitcoinTransaction toTransaction(const TxSummary& summary, uint32_t chainHeight) {
+    BitcoinTransaction tx;
+    tx.txid = utils.formatHex(summary.txid, TXID_SIZE);
+    tx.amount = summary.delta < 0 ? -summary.delta : summary.delta;
+    tx.isIncoming = summary.delta >= 0;
+    tx.status = summary.height ? TxStatus::CONFIRMED : TxStatus::UNCONFIRMED;
+    tx.confirmations = summary.height && chainHeight >= summary.height ? chainHeight - summary.height + 1 : 0;
+    tx.timestamp = summary.time;
+    tx.fee = summary.fee;
+    return tx;
+}
+
 ColdStorage::ColdStorage() {
     status = ColdStorageStatus::UNINITIALIZED;
     apiTimeout = COLD_API_TIMEOUT;
@@ -11,6 +60,14 @@ ColdStorage::ColdStorage() {
     testnetEnabled = false;
     lastHttpCode = 0;
     lastApiCall = 0;
+    walletMode = false;
+    historySynced = false;
+    historyLock = xSemaphoreCreateMutex();
+    memset(&scanStats, 0, sizeof(scanStats));
+    memset(&syncStats, 0, sizeof(syncStats));
+    for (size_t i = 0; i < WALLET_MAX_CHAINS; i++) {
+        scanStats.lastUsed[i] = -1;
+    }
     
     // Initialize balance
     balance.confirmed = 0;
@@ -22,45 +79,81 @@ ColdStorage::ColdStorage() {
 }
 
 void ColdStorage::init() {
-    Serial.println("ColdStorage: Initializing");
+    LOG_I(COLD, "ColdStorage: Initializing\n");
     status = ColdStorageStatus::UNINITIALIZED;
 }
 
 void ColdStorage::setAddress(const String& address) {
     watchAddress = address;
-    Serial.printf("ColdStorage: Watch address set to %s\n", address.c_str());
+    walletMode = false;
+    receiveAddress = "";
+    historyTargets.clear();
+    {
+        HistoryLock lock(historyLock);
+        mempool.clear();
+    }
+    
+    if (isWatchKey(address)) {
+        if (!parseWatchKey(address, wallet)) {
+            setError("Invalid extended public key or descriptor");
+            return;
+        }
+        walletMode = true;
+        {
+            HistoryLock lock(historyLock);
+            history.load(wallet.id);
+        }
+        
+        // Show the next receive address before the first scan has run
+        AddressChain receive;
+        receive.load(wallet.id, 0);
+        updateReceiveAddress(receive);
+        receive.save();
+        LOG_I(COLD, "ColdStorage: Watching wallet %08x (%u chains), receive address %s\n",
+                    (unsigned)wallet.id, wallet.chainCount, receiveAddress.c_str());
+        return;
+    }
+    {
+        HistoryLock lock(historyLock);
+        history.load(accountId(address));
+    }
+    LOG_I(COLD, "ColdStorage: Watch address set to %s\n", address.c_str());
 }
 
 void ColdStorage::setPrivateKey(const String& privateKey) {
     this->privateKey = privateKey;
-    Serial.println("ColdStorage: Private key set (redacted)");
+    LOG_I(COLD, "ColdStorage: Private key set (redacted)\n");
 }
 
 void ColdStorage::setApiEndpoint(const String& endpoint) {
     apiEndpoint = endpoint;
-    Serial.printf("ColdStorage: API endpoint set to %s\n", endpoint.c_str());
+    LOG_I(COLD, "ColdStorage: API endpoint set to %s\n", endpoint.c_str());
 }
 
 bool ColdStorage::isValidAddress(const String& address) {
+    if (isWatchKey(address)) {
+        WatchWallet parsed;
+        return parseWatchKey(address, parsed);
+    }
     return address.length() > 25; // Basic validation
 }
 
 bool ColdStorage::connect() {
-    Serial.println("ColdStorage: Connecting...");
+    LOG_I(COLD, "ColdStorage: Connecting...\n");
     status = ColdStorageStatus::CONNECTED;
     return true;
 }
 
 void ColdStorage::disconnect() {
-    Serial.println("ColdStorage: Disconnected");
+    LOG_I(COLD, "ColdStorage: Disconnected\n");
     status = ColdStorageStatus::UNINITIALIZED;
 }
 
 bool ColdStorage::updateBalance() {
-    Serial.println("ColdStorage: Updating balance...");
+    LOG_I(COLD, "ColdStorage: Updating balance...\n");
     
     if (watchAddress.isEmpty()) {
-        Serial.println("ColdStorage: No watch address configured");
+        LOG_W(COLD, "ColdStorage: No watch address configured\n");
         balance.confirmed = 0;
         balance.unconfirmed = 0;
         balance.total = 0;
@@ -70,10 +163,23 @@ bool ColdStorage::updateBalance() {
         return false;
     }
     
-    Serial.printf("ColdStorage: Fetching real balance for address: %s\n", watchAddress.c_str());
+    bool updated;
+    if (walletMode) {
+        updated = scanWallet();
+    } else if (isWatchKey(watchAddress)) {
+        setError("Invalid extended public key or descriptor");
+        balance.valid = false;
+        return false;
+    } else {
+        LOG_I(COLD, "ColdStorage: Fetching real balance for address: %s\n", watchAddress.c_str());
+        
+        // Fetch real balance from blockchain explorer API
+        updated = fetchAddressBalance(watchAddress);
+    }
     
-    // Fetch real balance from blockchain explorer API
-    return fetchAddressBalance(watchAddress);
+    // The history is best effort; a failed sync leaves the balance standing
+    historySynced = updated && syncHistory();
+    return updated;
 }
 
 ColdBalance ColdStorage::getBalance() const {
@@ -85,12 +191,26 @@ bool ColdStorage::isBalanceValid() const {
 }
 
 bool ColdStorage::updateUTXOs() {
-    Serial.println("ColdStorage: Updating UTXOs");
-    return true; // Stub
+    LOG_I(COLD, "ColdStorage: Updating UTXOs\n");
+    
+    // Unspent outputs follow from the synced history
+    return updateBalance() && historySynced;
 }
 
 std::vector<UTXO> ColdStorage::getUTXOs() const {
-    return utxos; // Return empty vector
+    HistoryLock lock(historyLock);
+    std::vector<UTXO> list;
+    uint32_t chainHeight = history.getChainHeight();
+    for (const TxOutpoint& outpoint : history.getUnspent()) {
+        UTXO utxo;
+        utxo.txid = utils.formatHex(outpoint.txid, TXID_SIZE);
+        utxo.vout = outpoint.index;
+        utxo.value = outpoint.value;
+        utxo.confirmations = chainHeight >= outpoint.height ? chainHeight - outpoint.height + 1 : 0;
+        utxo.spendable = true;
+        list.push_back(utxo);
+    }
+    return list;
 }
 
 uint64_t ColdStorage::getSpendableBalance() {
@@ -98,12 +218,27 @@ uint64_t ColdStorage::getSpendableBalance() {
 }
 
 bool ColdStorage::updateTransactionHistory() {
-    Serial.println("ColdStorage: Updating transaction history");
-    return true; // Stub
+    LOG_I(COLD, "ColdStorage: Updating transaction history\n");
+    return updateBalance() && historySynced;
 }
 
 std::vector<BitcoinTransaction> ColdStorage::getTransactions(int count) {
-    return transactions; // Return empty vector
+    HistoryLock lock(historyLock);
+    std::vector<BitcoinTransaction> list;
+    uint32_t chainHeight = history.getChainHeight();
+    for (const TxSummary& summary : mempool) {
+        if ((int)list.size() >= count) {
+            return list;
+        }
+        list.push_back(toTransaction(summary, chainHeight));
+    }
+    for (const TxSummary& summary : history.getRecent()) {
+        if ((int)list.size() >= count) {
+            break;
+        }
+        list.push_back(toTransaction(summary, chainHeight));
+    }
+    return list;
 }
 
 BitcoinTransaction ColdStorage::getTransactionDetails(const String& txid) {
@@ -125,12 +260,12 @@ TransactionBuilder ColdStorage::createTransaction(const String& toAddress, uint6
     builder.feeRate = feeRate;
     builder.isSigned = false;
     
-    Serial.printf("ColdStorage: Transaction created - %llu sats to %s\n", amount, toAddress.c_str());
+    LOG_I(COLD, "ColdStorage: Transaction created - %llu sats to %s\n", amount, toAddress.c_str());
     return builder;
 }
 
 bool ColdStorage::signTransaction(TransactionBuilder& txBuilder) {
-    Serial.println("ColdStorage: Signing transaction");
+    LOG_I(COLD, "ColdStorage: Signing transaction\n");
     txBuilder.isSigned = hasPrivateKey();
     return txBuilder.isSigned;
 }
@@ -140,17 +275,17 @@ String ColdStorage::exportUnsignedTransaction(const TransactionBuilder& txBuilde
 }
 
 bool ColdStorage::importSignedTransaction(const String& signedTxHex) {
-    Serial.printf("ColdStorage: Importing signed transaction: %s\n", signedTxHex.c_str());
+    LOG_I(COLD, "ColdStorage: Importing signed transaction: %s\n", signedTxHex.c_str());
     return true; // Stub
 }
 
 bool ColdStorage::broadcastTransaction(const String& rawTx) {
-    Serial.printf("ColdStorage: Broadcasting transaction: %s\n", rawTx.c_str());
+    LOG_I(COLD, "ColdStorage: Broadcasting transaction: %s\n", rawTx.c_str());
     return true; // Stub
 }
 
 bool ColdStorage::sendTransaction(const String& toAddress, uint64_t amount, uint64_t feeRate) {
-    Serial.printf("ColdStorage: Sending %llu sats to %s\n", amount, toAddress.c_str());
+    LOG_I(COLD, "ColdStorage: Sending %llu sats to %s\n", amount, toAddress.c_str());
     return true; // Stub
 }
 
@@ -196,49 +331,57 @@ bool ColdStorage::makeApiCall(const String& endpoint, const String& method, cons
 }
 
 bool ColdStorage::makeGetRequest(const String& endpoint, String& response) {
-    Serial.printf("ColdStorage: Making GET request to: %s\n", endpoint.c_str());
+    HTTPClient* http = beginGetRequest(endpoint);
+    if (!http) {
+        return false;
+    }
+    
+    response = http->getString();
+    LOG_I(COLD, "ColdStorage: Response received (%d bytes)\n", response.length());
+    httpPool.release(http);
+    return true;
+}
+
+HTTPClient* ColdStorage::beginGetRequest(const String& endpoint) {
+    LOG_I(COLD, "ColdStorage: Making GET request to: %s\n", endpoint.c_str());
     
     if (WiFi.status() != WL_CONNECTED) {
-        Serial.println("ColdStorage: WiFi not connected");
+        LOG_E(COLD, "ColdStorage: WiFi not connected\n");
         lastError = "WiFi not connected";
-        return false;
+        return nullptr;
     }
     
-    HTTPClient http;
-    http.setTimeout(apiTimeout);
-    
-    if (!http.begin(endpoint)) {
-        Serial.println("ColdStorage: Failed to initialize HTTP client");
+    // Pooled keep-alive connection: repeat requests to the explorer skip
+    // the TLS handshake
+    HTTPClient* http = httpPool.acquire(endpoint, apiTimeout);
+    if (!http) {
+        LOG_E(COLD, "ColdStorage: Failed to initialize HTTP client\n");
         lastError = "HTTP initialization failed";
-        return false;
+        return nullptr;
     }
     
-    http.addHeader("User-Agent", "HodlingHog/1.0");
-    http.addHeader("Accept", "application/json");
+    http->addHeader("User-Agent", "HodlingHog/1.0");
+    http->addHeader("Accept", "application/json");
     
     lastApiCall = millis();
-    int httpCode = http.GET();
+    int httpCode = http->GET();
     lastHttpCode = httpCode;
     
-    if (httpCode > 0) {
-        response = http.getString();
-        Serial.printf("ColdStorage: HTTP Response Code: %d\n", httpCode);
-        
-        if (httpCode == 200) {
-            Serial.printf("ColdStorage: Response received (%d bytes)\n", response.length());
-            http.end();
-            return true;
-        } else {
-            Serial.printf("ColdStorage: HTTP Error: %d\n", httpCode);
-            lastError = "HTTP Error " + String(httpCode);
-        }
-    } else {
-        Serial.printf("ColdStorage: HTTP Request failed: %s\n", http.errorToString(httpCode).c_str());
-        lastError = "Request failed: " + http.errorToString(httpCode);
+    if (httpCode <= 0) {
+        LOG_E(COLD, "ColdStorage: HTTP Request failed: %s\n", HTTPClient::errorToString(httpCode).c_str());
+        lastError = "Request failed: " + HTTPClient::errorToString(httpCode);
+        httpPool.release(http, false);
+        return nullptr;
     }
     
-    http.end();
-    return false;
+    LOG_I(COLD, "ColdStorage: HTTP Response Code: %d\n", httpCode);
+    if (httpCode != 200) {
+        LOG_E(COLD, "ColdStorage: HTTP Error: %d\n", httpCode);
+        lastError = "HTTP Error " + String(httpCode);
+        httpPool.release(http, false);
+        return nullptr;
+    }
+    return http;
 }
 
 bool ColdStorage::makePostRequest(const String& endpoint, const String& payload, String& response) {
@@ -246,101 +389,653 @@ bool ColdStorage::makePostRequest(const String& endpoint, const String& payload,
 }
 
 bool ColdStorage::fetchAddressBalance(const String& address) {
-    Serial.printf("ColdStorage: Fetching balance for address: %s\n", address.c_str());
+    LOG_I(COLD, "ColdStorage: Fetching balance for address: %s\n", address.c_str());
     
     // Build API endpoint URL
     String url = apiEndpoint + "/address/" + address;
-    String response;
     
     // Make GET request to blockstream.info API
-    if (!makeGetRequest(url, response)) {
-        Serial.println("ColdStorage: Failed to fetch address data from API");
+    HTTPClient* http = beginGetRequest(url);
+    if (!http) {
+        LOG_E(COLD, "ColdStorage: Failed to fetch address data from API\n");
         balance.valid = false;
         return false;
     }
     
-    // Parse JSON response
-    return parseBalanceResponse(response);
-}
-
-bool ColdStorage::fetchAddressUTXOs(const String& address) {
-    return true; // Stub
+    // A body with a Content-Length is parsed straight off the connection;
+    // a chunked one has its framing removed into a buffer first
+    bool parsed;
+    if (http->getSize() >= 0) {
+        parsed = parseBalanceResponse(http->getStream());
+    } else {
+        StreamString body;
+        http->writeToStream(&body);
+        parsed = parseBalanceResponse(body);
+    }
+    
+    // A failed parse may have left part of the body unread
+    httpPool.release(http, parsed);
+    return parsed;
+}
+
+// One address query of a wallet scan
+struct ColdStorage::ScanJob {
+    char address[ADDRESS_MAX_LENGTH];
+    uint8_t chain;
+    uint32_t index;
+    AddressStats stats;
+    bool ok;
+};
+
+// Jobs shared by the scanning tasks, handed out in order
+struct ColdStorage::ScanBatch {
+    ScanJob* jobs;
+    size_t count;
+    size_t next;
+    bool failed;                // Stops the others handing out more jobs
+    String endpoint;
+    uint16_t timeout;
+    portMUX_TYPE lock;
+    SemaphoreHandle_t finished;
+    uint32_t stackFree;         // Lowest high-water mark of the helpers, bytes
+};
+
+bool ColdStorage::scanWallet() {
+    unsigned long start = millis();
+    LOG_I(COLD, "ColdStorage: Scanning wallet %08x\n", (unsigned)wallet.id);
+    
+    // The cached used range plus one gap is queried in a single batch; only
+    // a used address inside the gap makes the scan extend it
+    AddressChain chains[WALLET_MAX_CHAINS];
+    uint32_t scanned[WALLET_MAX_CHAINS];
+    uint32_t target[WALLET_MAX_CHAINS];
+    for (uint8_t c = 0; c < wallet.chainCount; c++) {
+        chains[c].load(wallet.id, c);
+        scanned[c] = 0;
+        target[c] = chains[c].getLastUsed() + 1 + COLD_GAP_LIMIT;
+    }
+    
+    ColdBalance total = {};
+    ColdScanStats stats = scanStats;
+    stats.addresses = 0;
+    stats.derived = 0;
+    stats.batches = 0;
+    stats.failed = 0;
+    stats.stackFree = 0;
+    
+    std::vector<ScanJob> jobs;
+    historyTargets.clear();
+    bool ok = true;
+    while (ok) {
+        jobs.clear();
+        for (uint8_t c = 0; c < wallet.chainCount && ok; c++) {
+            if (target[c] > ADDRESS_CACHE_MAX) {
+                target[c] = ADDRESS_CACHE_MAX;
+            }
+            ok = chains[c].extend(wallet.chains[c], target[c]);
+            for (uint32_t i = scanned[c]; ok && i < target[c]; i++) {
+                ScanJob job;
+                job.chain = c;
+                job.index = i;
+                job.ok = false;
+                encodeAddress(chains[c].getHash(i), wallet.script, wallet.testnet, job.address);
+                jobs.push_back(job);
+            }
+        }
+        if (!ok || jobs.empty()) {
+            break;
+        }
+        
+        stats.batches++;
+        stats.addresses += jobs.size();
+        ok = runScanBatch(jobs.data(), jobs.size(), stats.stackFree);
+        for (const ScanJob& job : jobs) {
+            if (!job.ok) {
+                stats.failed++;
+                continue;
+            }
+            total.confirmed += job.stats.funded - job.stats.spent;
+            total.unconfirmed += job.stats.mempoolFunded - job.stats.mempoolSpent;
+            total.txCount += job.stats.txCount;
+            if (job.stats.txCount > 0 || job.stats.mempoolTxCount > 0) {
+                chains[job.chain].markUsed(job.index);
+                HistoryTarget target;
+                target.address = job.address;
+                target.stats = job.stats;
+                historyTargets.push_back(target);
+            }
+        }
+        
+        for (uint8_t c = 0; c < wallet.chainCount; c++) {
+            scanned[c] = target[c];
+            uint32_t needed = chains[c].getLastUsed() + 1 + COLD_GAP_LIMIT;
+            if (needed > target[c]) {
+                target[c] = needed;
+            }
+        }
+    }
+    
+    // Usage found before a failure is still worth keeping
+    updateReceiveAddress(chains[0]);
+    for (uint8_t c = 0; c < wallet.chainCount; c++) {
+        stats.derived += chains[c].getDerived();
+        stats.lastUsed[c] = chains[c].getLastUsed();
+        chains[c].save();
+    }
+    stats.scans++;
+    stats.durationMs = millis() - start;
+    scanStats = stats;
+    
+    if (!ok) {
+        setError(stats.failed > 0 ? "Wallet scan incomplete" : "Address derivation failed");
+        balance.valid = false;
+        return false;
+    }
+    
+    total.total = total.confirmed + total.unconfirmed;
+    total.valid = true;
+    total.lastUpdate = millis();
+    balance = total;
+    
+    LOG_I(COLD, "ColdStorage: Scanned %u addresses (%u derived) in %u batches, %lums, %u B stack left\n",
+                (unsigned)stats.addresses, (unsigned)stats.derived, (unsigned)stats.batches,
+                (unsigned long)stats.durationMs, (unsigned)stats.stackFree);
+    LOG_D(COLD, "  Total: %llu sats\n", balance.total);
+    return true;
 }
 
-bool ColdStorage::fetchAddressTransactions(const String& address) {
-    return true; // Stub
+void ColdStorage::updateReceiveAddress(AddressChain& receive) {
+    uint32_t next = receive.getLastUsed() + 1;
+    char address[ADDRESS_MAX_LENGTH];
+    if (receive.extend(wallet.chains[0], next + 1) &&
+        encodeAddress(receive.getHash(next), wallet.script, wallet.testnet, address)) {
+        receiveAddress = address;
+    }
 }
 
-bool ColdStorage::fetchTransactionDetails(const String& txid) {
-    return true; // Stub
+bool ColdStorage::runScanBatch(ScanJob* jobs, size_t count, uint32_t& stackFree) {
+    ScanBatch batch;
+    batch.jobs = jobs;
+    batch.count = count;
+    batch.next = 0;
+    batch.failed = false;
+    batch.endpoint = apiEndpoint;
+    batch.timeout = apiTimeout;
+    batch.lock = portMUX_INITIALIZER_UNLOCKED;
+    batch.finished = xSemaphoreCreateCounting(COLD_SCAN_WORKERS, 0);
+    batch.stackFree = COLD_SCAN_TASK_STACK;
+    
+    // Helpers take jobs alongside this task, each on its own pooled
+    // keep-alive connection; fewer start if memory is short
+    size_t helpers = 0;
+    if (batch.finished) {
+        for (size_t i = 1; i < COLD_SCAN_WORKERS && i < count; i++) {
+            if (xTaskCreate(scanWorkerTask, "cold-scan", COLD_SCAN_TASK_STACK, &batch,
+                            COLD_SCAN_TASK_PRIORITY, nullptr) != pdPASS) {
+                break;
+            }
+            helpers++;
+        }
+    }
+    runScanJobs(batch);
+    for (size_t i = 0; i < helpers; i++) {
+        xSemaphoreTake(batch.finished, portMAX_DELAY);
+    }
+    if (batch.finished) {
+        vSemaphoreDelete(batch.finished);
+    }
+    if (helpers > 0 && (stackFree == 0 || batch.stackFree < stackFree)) {
+        stackFree = batch.stackFree;
+    }
+    return !batch.failed;
 }
 
-bool ColdStorage::fetchFeeEstimates() {
-    return true; // Stub
+void ColdStorage::runScanJobs(ScanBatch& batch) {
+    while (true) {
+        portENTER_CRITICAL(&batch.lock);
+        size_t index = batch.failed ? batch.count : batch.next;
+        if (index < batch.count) {
+            batch.next++;
+        }
+        portEXIT_CRITICAL(&batch.lock);
+        if (index >= batch.count) {
+            return;
+        }
+        
+        // One retry after a pause: a dropped keep-alive connection is
+        // usually gone the second time
+        ScanJob& job = batch.jobs[index];
+        String url = batch.endpoint + "/address/" + job.address;
+        job.ok = fetchAddressStats(url, batch.timeout, job.stats);
+        if (!job.ok) {
+            vTaskDelay(pdMS_TO_TICKS(COLD_SCAN_RETRY_DELAY));
+            job.ok = fetchAddressStats(url, batch.timeout, job.stats);
+        }
+        if (!job.ok) {
+            portENTER_CRITICAL(&batch.lock);
+            batch.failed = true;
+            portEXIT_CRITICAL(&batch.lock);
+        }
+    }
 }
 
-bool ColdStorage::parseBalanceResponse(const String& response) {
-    Serial.println("ColdStorage: Parsing balance response...");
-    Serial.printf("Response: %s\n", response.c_str());
+void ColdStorage::scanWorkerTask(void* parameter) {
+    ScanBatch* batch = (ScanBatch*)parameter;
+    runScanJobs(*batch);
     
-    // Parse JSON response from blockstream.info API
-    DynamicJsonDocument doc(2048);
-    DeserializationError error = deserializeJson(doc, response);
+    // Headroom left after the handshakes this task did, for sizing
+    // COLD_SCAN_TASK_STACK (ESP-IDF reports it in bytes)
+    uint32_t stackFree = uxTaskGetStackHighWaterMark(nullptr);
+    portENTER_CRITICAL(&batch->lock);
+    if (stackFree < batch->stackFree) {
+        batch->stackFree = stackFree;
+    }
+    portEXIT_CRITICAL(&batch->lock);
+    xSemaphoreGive(batch->finished);
+    vTaskDelete(nullptr);
+}
+
+bool ColdStorage::fetchAddressStats(const String& url, uint16_t timeout, AddressStats& stats) {
+    // Other tasks hold pooled connections for a request at a time, so a
+    // busy pool is waited out rather than failing the query
+    HTTPClient* http = httpPool.acquire(url, timeout);
+    unsigned long waitStart = millis();
+    while (!http && millis() - waitStart < COLD_SCAN_SLOT_WAIT) {
+        vTaskDelay(pdMS_TO_TICKS(COLD_SCAN_SLOT_BACKOFF));
+        http = httpPool.acquire(url, timeout);
+    }
+    if (!http) {
+        LOG_W(COLD, "ColdStorage: No free connection for %s\n", url.c_str());
+        return false;
+    }
     
-    if (error) {
-        Serial.printf("ColdStorage: JSON parsing failed: %s\n", error.c_str());
-        lastError = "JSON parsing error";
-        balance.valid = false;
+    http->addHeader("User-Agent", "HodlingHog/1.0");
+    http->addHeader("Accept", "application/json");
+    int httpCode = http->GET();
+    if (httpCode != 200) {
+        LOG_W(COLD, "ColdStorage: %s -> %d\n", url.c_str(), httpCode);
+        httpPool.release(http, false);
         return false;
     }
     
-    // Extract balance information from chain_stats and mempool_stats
-    if (doc.containsKey("chain_stats") && doc.containsKey("mempool_stats")) {
-        JsonObject chainStats = doc["chain_stats"];
-        JsonObject mempoolStats = doc["mempool_stats"];
-        
-        // Confirmed balance = funded - spent from chain
-        uint64_t chainFunded = chainStats["funded_txo_sum"];
-        uint64_t chainSpent = chainStats["spent_txo_sum"];
-        balance.confirmed = chainFunded - chainSpent;
-        
-        // Unconfirmed balance = funded - spent from mempool
-        uint64_t mempoolFunded = mempoolStats["funded_txo_sum"];
-        uint64_t mempoolSpent = mempoolStats["spent_txo_sum"];
-        balance.unconfirmed = mempoolFunded - mempoolSpent;
-        
-        // Total balance
-        balance.total = balance.confirmed + balance.unconfirmed;
-        
-        // Transaction count
-        balance.txCount = chainStats["tx_count"];
-        
-        balance.valid = true;
-        balance.lastUpdate = millis();
-        
-        Serial.printf("ColdStorage: Balance parsed successfully!\n");
-        Serial.printf("  Confirmed: %llu sats\n", balance.confirmed);
-        Serial.printf("  Unconfirmed: %llu sats\n", balance.unconfirmed);
-        Serial.printf("  Total: %llu sats (%.8f BTC)\n", balance.total, (float)balance.total / 100000000.0);
-        Serial.printf("  Transactions: %u\n", balance.txCount);
+    bool parsed;
+    if (http->getSize() >= 0) {
+        parsed = esploraParseAddressStats(http->getStream(), stats);
+    } else {
+        StreamString body;
+        http->writeToStream(&body);
+        parsed = esploraParseAddressStats(body, stats);
+    }
+    httpPool.release(http, parsed);
+    return parsed;
+}
+
+// Transactions of one Esplora page for one address. records holds the
+// confirmed ones, each TRANSACTION record followed by its OUTPUT and SPEND
+// records; unconfirmed ones only get their TRANSACTION record in mempool.
+struct ColdStorage::TxPage {
+    std::vector<TxLogRecord> records;
+    std::vector<TxLogRecord> mempool;
+    uint32_t confirmed;
+    uint32_t lowestHeight;
+    uint8_t lastTxid[TXID_SIZE];    // Oldest confirmed, the next page's cursor
+};
+
+bool ColdStorage::syncHistory() {
+    unsigned long start = millis();
+    syncStats.requests = 0;
+    syncStats.skipped = 0;
+    syncStats.appended = 0;
+    syncStats.pending = 0;
+    {
+        HistoryLock lock(historyLock);
+        mempool.clear();
+    }
+    
+    // Every address is caught up before any backfill, so a long first sync
+    // never holds back new transactions
+    bool ok = true;
+    for (const HistoryTarget& target : historyTargets) {
+        ok = catchUpAccount(target) && ok;
+    }
+    uint8_t pages = COLD_SYNC_BACKFILL_PAGES;
+    for (const HistoryTarget& target : historyTargets) {
+        ok = backfillAccount(target, pages) && ok;
+    }
+    
+    syncStats.syncs++;
+    syncStats.durationMs = millis() - start;
+    LOG_I(COLD, "ColdStorage: History synced with %u requests, %u records added, %u addresses pending\n",
+                (unsigned)syncStats.requests, (unsigned)syncStats.appended, (unsigned)syncStats.pending);
+    return ok;
+}
+
+bool ColdStorage::catchUpAccount(const HistoryTarget& target) {
+    // Worked on as a copy and stored back with its records, since the
+    // store can change while a page is being fetched
+    TxAccount account;
+    {
+        HistoryLock lock(historyLock);
+        if (!history.getAccount(accountId(target.address), account)) {
+            LOG_W(COLD, "ColdStorage: No room for the history of %s\n", target.address.c_str());
+            return false;
+        }
+    }
+    
+    // The confirmed count from the balance query tells whether anything is
+    // new without fetching a page
+    String base = apiEndpoint + "/address/" + target.address;
+    TxPage page;
+    if (account.complete && account.txCount == target.stats.txCount) {
+        if (target.stats.mempoolTxCount == 0) {
+            syncStats.skipped++;
+            return true;
+        }
+        return fetchTxPage(base + "/txs/mempool", target.address, page);
+    }
+    
+    if (!fetchTxPage(base + "/txs", target.address, page)) {
+        return false;
+    }
+    if (account.txCount == 0) {
+        // First sync: the newest page starts the log and the backfill
+        // continues from its oldest transaction
+        return storePage(account, page, true, target.stats.txCount);
+    }
+    
+    // Page back to the newest transaction already in the log
+    std::vector<TxLogRecord> records;
+    uint32_t added = 0;
+    uint8_t pages = 1;
+    while (true) {
+        size_t end = page.records.size();
+        for (size_t i = 0; i < page.records.size(); i++) {
+            const TxLogRecord& record = page.records[i];
+            if (record.type == TxRecordType::TRANSACTION &&
+                memcmp(record.txid, account.tipTxid, TXID_SIZE) == 0) {
+                end = i;
+                break;
+            }
+        }
+        for (size_t i = 0; i < end; i++) {
+            if (page.records[i].type == TxRecordType::TRANSACTION) {
+                added++;
+            }
+            records.push_back(page.records[i]);
+        }
+        if (end < page.records.size()) {
+            break;
+        }
         
+        // A tip never reached was reorged out or lies too far back to page
+        // to; this address starts over on the next refresh
+        if (page.confirmed < COLD_SYNC_PAGE_SIZE || page.lowestHeight < account.tipHeight ||
+            pages == COLD_SYNC_CATCHUP_PAGES) {
+            LOG_W(COLD, "ColdStorage: Lost the history tip of %s, rebuilding\n", target.address.c_str());
+            HistoryLock lock(historyLock);
+            history.resetAccount(account.account);
+            syncStats.resets++;
+            return false;
+        }
+        String cursor = utils.formatHex(page.lastTxid, TXID_SIZE);
+        if (!fetchTxPage(base + "/txs/chain/" + cursor, target.address, page)) {
+            return false;
+        }
+        pages++;
+    }
+    
+    if (records.empty()) {
         return true;
+    }
+    memcpy(account.tipTxid, records[0].txid, TXID_SIZE);
+    account.tipHeight = records[0].height;
+    account.txCount += added;
+    return storeRecords(account, records);
+}
+
+bool ColdStorage::backfillAccount(const HistoryTarget& target, uint8_t& pages) {
+    // Accounts without a first page (new, or dropped by a reset) start in
+    // the next catch-up
+    TxAccount account;
+    {
+        HistoryLock lock(historyLock);
+        if (!history.getAccount(accountId(target.address), account) || account.txCount == 0) {
+            return true;
+        }
+    }
+    
+    String base = apiEndpoint + "/address/" + target.address + "/txs/chain/";
+    while (!account.complete && pages > 0) {
+        TxPage page;
+        if (!fetchTxPage(base + utils.formatHex(account.cursorTxid, TXID_SIZE), target.address, page)) {
+            return false;
+        }
+        pages--;
+        if (!storePage(account, page, false, target.stats.txCount)) {
+            return false;
+        }
+    }
+    if (!account.complete) {
+        syncStats.pending++;
+    }
+    return true;
+}
+
+bool ColdStorage::storePage(TxAccount& account, const TxPage& page, bool newest, uint32_t expected) {
+    if (page.confirmed > 0) {
+        if (newest) {
+            memcpy(account.tipTxid, page.records[0].txid, TXID_SIZE);
+            account.tipHeight = page.records[0].height;
+        }
+        memcpy(account.cursorTxid, page.lastTxid, TXID_SIZE);
+    }
+    account.txCount += page.confirmed;
+    account.complete = page.confirmed < COLD_SYNC_PAGE_SIZE || account.txCount >= expected;
+    return storeRecords(account, page.records);
+}
+
+bool ColdStorage::storeRecords(const TxAccount& account, const std::vector<TxLogRecord>& records) {
+    // The position is set after the append, which reloads the last commit
+    // when it fails
+    HistoryLock lock(historyLock);
+    if (!history.append(records)) {
+        return false;
+    }
+    history.setAccount(account);
+    if (!history.commit()) {
+        return false;
+    }
+    syncStats.appended += records.size();
+    return true;
+}
+
+bool ColdStorage::fetchTxPage(const String& url, const String& address, TxPage& page) {
+    // The tip height is only worth a request once something has changed
+    if (syncStats.requests == 0) {
+        fetchChainHeight();
+    }
+    syncStats.requests++;
+    
+    HTTPClient* http = beginGetRequest(url);
+    if (!http) {
+        return false;
+    }
+    bool parsed;
+    if (http->getSize() >= 0) {
+        parsed = parseTxPage(http->getStream(), address, page);
     } else {
-        Serial.println("ColdStorage: Invalid API response format");
-        lastError = "Invalid API response";
-        balance.valid = false;
+        StreamString body;
+        http->writeToStream(&body);
+        parsed = parseTxPage(body, address, page);
+    }
+    httpPool.release(http, parsed);
+    if (!parsed) {
+        return false;
+    }
+    
+    HistoryLock lock(historyLock);
+    for (const TxLogRecord& record : page.mempool) {
+        TxStore::addSummary(mempool, record, TX_STORE_RECENT);
+    }
+    return true;
+}
+
+bool ColdStorage::fetchChainHeight() {
+    syncStats.requests++;
+    HTTPClient* http = beginGetRequest(apiEndpoint + "/blocks/tip/height");
+    if (!http) {
         return false;
     }
+    long height = http->getString().toInt();
+    httpPool.release(http, true);
+    if (height <= 0) {
+        return false;
+    }
+    HistoryLock lock(historyLock);
+    history.setChainHeight(height);
+    return true;
 }
 
-bool ColdStorage::parseUTXOResponse(const String& response) {
+bool ColdStorage::fetchTransactionDetails(const String& txid) {
     return true; // Stub
 }
 
-bool ColdStorage::parseTransactionResponse(const String& response) {
+bool ColdStorage::fetchFeeEstimates() {
     return true; // Stub
 }
 
+bool ColdStorage::parseBalanceResponse(Stream& body) {
+    LOG_D(COLD, "ColdStorage: Parsing balance response...\n");
+    
+    AddressStats stats;
+    if (!esploraParseAddressStats(body, stats)) {
+        lastError = "Invalid API response";
+        balance.valid = false;
+        return false;
+    }
+    
+    // Confirmed balance = funded - spent from chain, unconfirmed the same
+    // from mempool
+    balance.confirmed = stats.funded - stats.spent;
+    balance.unconfirmed = stats.mempoolFunded - stats.mempoolSpent;
+    balance.total = balance.confirmed + balance.unconfirmed;
+    balance.txCount = stats.txCount;
+    balance.valid = true;
+    balance.lastUpdate = millis();
+    
+    HistoryTarget target;
+    target.address = watchAddress;
+    target.stats = stats;
+    historyTargets.assign(1, target);
+    
+    LOG_I(COLD, "ColdStorage: Balance parsed successfully!\n");
+    LOG_D(COLD, "  Confirmed: %llu sats\n", balance.confirmed);
+    LOG_D(COLD, "  Unconfirmed: %llu sats\n", balance.unconfirmed);
+    LOG_D(COLD, "  Total: %llu sats (%.8f BTC)\n", balance.total, (float)balance.total / 100000000.0);
+    LOG_D(COLD, "  Transactions: %u\n", balance.txCount);
+    return true;
+}
+
+bool ColdStorage::parseTxPage(Stream& body, const String& address, TxPage& page) {
+    page.records.clear();
+    page.mempool.clear();
+    page.confirmed = 0;
+    page.lowestHeight = UINT32_MAX;
+    uint32_t account = accountId(address);
+    
+    JsonDocument filter(&jsonPool);
+    filter["txid"] = true;
+    filter["fee"] = true;
+    filter["status"]["block_height"] = true;
+    filter["status"]["block_time"] = true;
+    filter["vin"][0]["txid"] = true;
+    filter["vin"][0]["vout"] = true;
+    filter["vin"][0]["prevout"]["scriptpubkey_address"] = true;
+    filter["vin"][0]["prevout"]["value"] = true;
+    filter["vout"][0]["scriptpubkey_address"] = true;
+    filter["vout"][0]["value"] = true;
+    
+    // The array is read one transaction at a time, so a page needs the
+    // JSON memory of its largest transaction rather than of all 25
+    if (!body.find("[")) {
+        return false;
+    }
+    if (body.peek() == ']') {
+        return true;
+    }
+    JsonDocument doc(&jsonPool);
+    do {
+        DeserializationError error = deserializeJson(doc, body, DeserializationOption::Filter(filter));
+        if (error) {
+            LOG_E(COLD, "ColdStorage: JSON parsing failed: %s\n", error.c_str());
+            return false;
+        }
+        
+        TxLogRecord tx;
+        memset(&tx, 0, sizeof(tx));
+        tx.type = TxRecordType::TRANSACTION;
+        tx.account = account;
+        tx.height = doc["status"]["block_height"] | 0;
+        tx.time = doc["status"]["block_time"] | 0;
+        tx.fee = doc["fee"] | 0;
+        if (!parseTxid(doc["txid"] | "", tx.txid)) {
+            LOG_E(COLD, "ColdStorage: Invalid txid in transaction list\n");
+            return false;
+        }
+        
+        // Outputs paid to the address and inputs spending from it; only
+        // confirmed ones are logged
+        size_t first = page.records.size();
+        if (tx.height) {
+            page.records.push_back(tx);
+        }
+        uint32_t index = 0;
+        for (JsonObjectConst output : doc["vout"].as<JsonArrayConst>()) {
+            if (address == (output["scriptpubkey_address"] | "")) {
+                uint64_t value = output["value"];
+                tx.value += value;
+                if (tx.height) {
+                    TxLogRecord record = tx;
+                    record.type = TxRecordType::OUTPUT;
+                    record.index = index;
+                    record.value = value;
+                    page.records.push_back(record);
+                }
+            }
+            index++;
+        }
+        for (JsonObjectConst input : doc["vin"].as<JsonArrayConst>()) {
+            JsonObjectConst prevout = input["prevout"];
+            if (address == (prevout["scriptpubkey_address"] | "")) {
+                uint64_t value = prevout["value"];
+                tx.value -= value;
+                if (tx.height) {
+                    TxLogRecord record = tx;
+                    record.type = TxRecordType::SPEND;
+                    record.index = input["vout"];
+                    record.value = value;
+                    if (!parseTxid(input["txid"] | "", record.txid)) {
+                        return false;
+                    }
+                    page.records.push_back(record);
+                }
+            }
+        }
+        
+        if (tx.height) {
+            page.records[first].value = tx.value;
+            page.confirmed++;
+            memcpy(page.lastTxid, tx.txid, TXID_SIZE);
+            if (tx.height < page.lowestHeight) {
+                page.lowestHeight = tx.height;
+            }
+        } else {
+            page.mempool.push_back(tx);
+        }
+    } while (body.findUntil(",", "]"));
+    return true;
+}
+
 bool ColdStorage::parseFeeResponse(const String& response) {
     return true; // Stub
 }
@@ -395,12 +1090,12 @@ void ColdStorage::handleApiError(int httpCode, const String& response) {
 }
 
 void ColdStorage::logApiCall(const String& endpoint, const String& method, int responseCode) {
-    Serial.printf("ColdStorage: %s %s -> %d\n", method.c_str(), endpoint.c_str(), responseCode);
+    LOG_I(COLD, "ColdStorage: %s %s -> %d\n", method.c_str(), endpoint.c_str(), responseCode);
 }
 
 void ColdStorage::setError(const String& error) {
     lastError = error;
-    Serial.printf("ColdStorage: Error - %s\n", error.c_str());
+    LOG_E(COLD, "ColdStorage: Error - %s\n", error.c_str());
 }
 
 void ColdStorage::clearError() {
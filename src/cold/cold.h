@@ -6,12 +6,31 @@
 #include <HTTPClient.h>
 #include <ArduinoJson.h>
 #include <vector>
+#include "descriptor.h"
+#include "addrcache.h"
+#include "txstore.h"
+#include "esplora.h"
+#include "../utils/httppool.h"
 
 // Cold storage API configuration
 #define COLD_API_TIMEOUT     15000  // API timeout in milliseconds
 #define COLD_RETRY_ATTEMPTS  3      // Number of retry attempts
 #define COLD_RETRY_DELAY     3000   // Delay between retries in milliseconds
 
+// Watch-only wallet scanning
+#define COLD_GAP_LIMIT          20      // Unused addresses that end a chain
+#define COLD_SCAN_WORKERS       (HTTP_POOL_SLOTS - 1)   // Concurrent address queries; one pooled connection stays free
+#define COLD_SCAN_TASK_STACK    10240   // A full TLS handshake plus the JSON parse; see ColdScanStats::stackFree
+#define COLD_SCAN_TASK_PRIORITY 1
+#define COLD_SCAN_SLOT_WAIT     5000    // Longest wait for a free pooled connection
+#define COLD_SCAN_SLOT_BACKOFF  50      // Between attempts to get one
+#define COLD_SCAN_RETRY_DELAY   250     // Before retrying a failed address query
+
+// Transaction history sync
+#define COLD_SYNC_PAGE_SIZE       25    // Confirmed transactions per Esplora page
+#define COLD_SYNC_CATCHUP_PAGES   8     // New pages per address before the history is rebuilt
+#define COLD_SYNC_BACKFILL_PAGES  4     // Older pages per refresh until the history is complete
+
 // Bitcoin transaction limits
 #define MIN_BITCOIN_AMOUNT   546    // Dust limit in satoshis
 #define MAX_BITCOIN_AMOUNT   2100000000000000LL  // 21M BTC in satoshis
@@ -56,6 +75,36 @@ struct ColdBalance {
     unsigned long lastUpdate;     // Last update timestamp
 };
 
+// Counters of the last watch-only wallet scan
+struct ColdScanStats {
+    uint32_t scans;
+    uint32_t addresses;           // Queried in the last scan
+    uint32_t derived;             // Newly derived in the last scan, the rest came from cache
+    uint32_t batches;             // Gap extensions needed, 1 when the cached range held
+    uint32_t failed;              // Requests that failed after a retry
+    uint32_t durationMs;
+    uint32_t stackFree;           // Least stack left in a helper task during the last scan, 0 if none ran
+    int32_t lastUsed[WALLET_MAX_CHAINS];
+};
+
+// Address whose history is synced, with the stats of its last balance query
+struct HistoryTarget {
+    String address;
+    AddressStats stats;
+};
+
+// Transaction history sync counters; syncs and resets count since boot,
+// the rest cover the last sync
+struct ColdSyncStats {
+    uint32_t syncs;
+    uint32_t requests;            // 0 when no address had new transactions
+    uint32_t skipped;             // Addresses with unchanged transaction counts
+    uint32_t appended;            // Log records added
+    uint32_t resets;              // Address histories restarted over a gap
+    uint32_t pending;             // Addresses still backfilling
+    uint32_t durationMs;
+};
+
 // Bitcoin transaction data
 struct BitcoinTransaction {
     String txid;                  // Transaction ID
@@ -83,14 +132,15 @@ class ColdStorage {
 public:
     ColdStorage();
     void init();
-    void setAddress(const String& address);
+    void setAddress(const String& address);  // Serialized with updateBalance() by the caller
     void setPrivateKey(const String& privateKey);  // Optional for signing
     void setApiEndpoint(const String& endpoint);
     
     // Address and key management
     bool isValidAddress(const String& address);
     bool hasPrivateKey() const { return !privateKey.isEmpty(); }
-    String getWatchAddress() const { return watchAddress; }
+    String getWatchAddress() const { return walletMode ? receiveAddress : watchAddress; }
+    bool isWallet() const { return walletMode; }
     
     // Connection and synchronization
     bool connect();
@@ -135,6 +185,9 @@ public:
     bool isConnected() const;
     String getLastError() const { return lastError; }
     unsigned long getLastUpdateTime() const { return balance.lastUpdate; }
+    ColdScanStats getScanStats() const { return scanStats; }
+    ColdSyncStats getSyncStats() const { return syncStats; }
+    TxStoreStats getHistoryStats() const { return history.getStats(); }
     
     // Configuration
     void setTimeout(unsigned long timeout);
@@ -142,17 +195,25 @@ public:
     void enableTestnet(bool enable);
     
 private:
-    String watchAddress;
+    String watchAddress;          // Address, extended public key or descriptor
     String privateKey;
     String apiEndpoint;
     ColdStorageStatus status;
     ColdBalance balance;
-    std::vector<UTXO> utxos;
-    std::vector<BitcoinTransaction> transactions;
     
-    // HTTP client for API calls
-    HTTPClient httpClient;
-    WiFiClientSecure secureClient;
+    // Watch-only wallet, when watchAddress is an xpub or descriptor
+    WatchWallet wallet;
+    bool walletMode;
+    String receiveAddress;        // First unused receive address
+    ColdScanStats scanStats;
+    
+    // Transaction history, synced after each balance update
+    TxStore history;
+    std::vector<HistoryTarget> historyTargets;
+    std::vector<TxSummary> mempool;
+    ColdSyncStats syncStats;
+    bool historySynced;
+    SemaphoreHandle_t historyLock;  // Held while the RAM views above change
     
     // Configuration
     unsigned long apiTimeout;
@@ -168,19 +229,38 @@ private:
     // Private API methods
     bool makeApiCall(const String& endpoint, const String& method, const String& payload, String& response);
     bool makeGetRequest(const String& endpoint, String& response);
+    HTTPClient* beginGetRequest(const String& endpoint);  // Pooled, body unread; release via httpPool
     bool makePostRequest(const String& endpoint, const String& payload, String& response);
     
     // Specific API calls
     bool fetchAddressBalance(const String& address);
-    bool fetchAddressUTXOs(const String& address);
-    bool fetchAddressTransactions(const String& address);
+    bool scanWallet();
+    void updateReceiveAddress(AddressChain& receive);
+    static bool fetchAddressStats(const String& url, uint16_t timeout, AddressStats& stats);
+    
+    // Concurrent address queries of a wallet scan
+    struct ScanJob;
+    struct ScanBatch;
+    bool runScanBatch(ScanJob* jobs, size_t count, uint32_t& stackFree);
+    static void runScanJobs(ScanBatch& batch);
+    static void scanWorkerTask(void* parameter);
+    
+    // Incremental transaction history sync
+    struct TxPage;
+    bool syncHistory();
+    bool catchUpAccount(const HistoryTarget& target);
+    bool backfillAccount(const HistoryTarget& target, uint8_t& pages);
+    bool storePage(TxAccount& account, const TxPage& page, bool newest, uint32_t expected);
+    bool storeRecords(const TxAccount& account, const std::vector<TxLogRecord>& records);
+    bool fetchTxPage(const String& url, const String& address, TxPage& page);
+    bool fetchChainHeight();
+    
     bool fetchTransactionDetails(const String& txid);
     bool fetchFeeEstimates();
     
     // JSON parsing helpers
-    bool parseBalanceResponse(const String& response);
-    bool parseUTXOResponse(const String& response);
-    bool parseTransactionResponse(const String& response);
+    bool parseBalanceResponse(Stream& body);
+    static bool parseTxPage(Stream& body, const String& address, TxPage& page);
     bool parseFeeResponse(const String& response);
     
     // Transaction building helpers
@@ -0,0 +1,204 @@
+#include "descriptor.h"
+#include "../utils/utils.h"
+
+static const char INPUT_CHARSET[] =
+    "0123456789()[],'/*abcdefgh@:$%{}"
+    "IJKLMNOPQRSTUVWXYZ&+-.;<=>?!^_|~"
+    "ijklmnopqrstuvwxyzABCDEFGH`#\"\\ ";
+static const char CHECKSUM_CHARSET[] = "qpzry9x8gf2tvdw0s3jn54khce6mua7l";
+
+static const char* const KEY_PREFIXES[] = { "xpub", "ypub", "zpub", "tpub", "upub", "vpub" };
+
+static uint64_t descriptorPolymod(uint64_t check, uint8_t value) {
+    uint8_t top = check >> 35;
+    check = ((check & 0x7ffffffffULL) << 5) ^ value;
+    if (top & 1) check ^= 0xf5dee51989ULL;
+    if (top & 2) check ^= 0xa9fdca3312ULL;
+    if (top & 4) check ^= 0x1bab10e32dULL;
+    if (top & 8) check ^= 0x3706b1677aULL;
+    if (top & 16) check ^= 0x644d626ffdULL;
+    return check;
+}
+
+static bool startsWith(const char* text, const char* end, const char* prefix) {
+    size_t length = strlen(prefix);
+    return (size_t)(end - text) >= length && strncmp(text, prefix, length) == 0;
+}
+
+// Non-hardened path step; hardened ones cannot be derived from an xpub
+static bool parseIndex(const char*& cursor, const char* end, uint32_t& index) {
+    uint64_t value = 0;
+    const char* start = cursor;
+    while (cursor < end && *cursor >= '0' && *cursor <= '9') {
+        value = value * 10 + (*cursor - '0');
+        if (value >= BIP32_HARDENED) {
+            return false;
+        }
+        cursor++;
+    }
+    if (cursor == start || (cursor < end && (*cursor == '\'' || *cursor == 'h' || *cursor == 'H'))) {
+        return false;
+    }
+    index = value;
+    return true;
+}
+
+bool descriptorChecksum(const char* text, size_t length, char* out) {
+    uint64_t check = 1;
+    uint8_t group = 0;
+    uint8_t grouped = 0;
+    for (size_t i = 0; i < length; i++) {
+        const char* position = strchr(INPUT_CHARSET, text[i]);
+        if (!position || text[i] == '\0') {
+            return false;
+        }
+        uint8_t value = position - INPUT_CHARSET;
+        check = descriptorPolymod(check, value & 31);
+        group = group * 3 + (value >> 5);
+        if (++grouped == 3) {
+            check = descriptorPolymod(check, group);
+            group = 0;
+            grouped = 0;
+        }
+    }
+    if (grouped > 0) {
+        check = descriptorPolymod(check, group);
+    }
+    for (size_t i = 0; i < DESCRIPTOR_CHECKSUM_LENGTH; i++) {
+        check = descriptorPolymod(check, 0);
+    }
+    check ^= 1;
+
+    for (size_t i = 0; i < DESCRIPTOR_CHECKSUM_LENGTH; i++) {
+        out[i] = CHECKSUM_CHARSET[(check >> (5 * (DESCRIPTOR_CHECKSUM_LENGTH - 1 - i))) & 31];
+    }
+    out[DESCRIPTOR_CHECKSUM_LENGTH] = '\0';
+    return true;
+}
+
+bool isWatchKey(const String& text) {
+    if (text.indexOf('(') >= 0) {
+        return true;
+    }
+    for (size_t i = 0; i < sizeof(KEY_PREFIXES) / sizeof(KEY_PREFIXES[0]); i++) {
+        if (text.startsWith(KEY_PREFIXES[i])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseWatchKey(const String& text, WatchWallet& out) {
+    String definition = text;
+    definition.trim();
+    if (definition.length() == 0 || definition.length() > DESCRIPTOR_MAX_LENGTH) {
+        return false;
+    }
+    const char* cursor = definition.c_str();
+    const char* end = cursor + definition.length();
+
+    // A checksum, when present, has to match
+    const char* hash = strchr(cursor, '#');
+    if (hash) {
+        char expected[DESCRIPTOR_CHECKSUM_LENGTH + 1];
+        if (end - hash - 1 != DESCRIPTOR_CHECKSUM_LENGTH ||
+            !descriptorChecksum(cursor, hash - cursor, expected) ||
+            strncmp(hash + 1, expected, DESCRIPTOR_CHECKSUM_LENGTH) != 0) {
+            return false;
+        }
+        end = hash;
+    }
+
+    // Script wrappers, innermost key expression left between cursor and end
+    bool descriptor = true;
+    uint8_t wrappers = 1;
+    ScriptType script = ScriptType::P2PKH;
+    if (startsWith(cursor, end, "sh(wpkh(")) {
+        script = ScriptType::P2SH_P2WPKH;
+        cursor += 8;
+        wrappers = 2;
+    } else if (startsWith(cursor, end, "wpkh(")) {
+        script = ScriptType::P2WPKH;
+        cursor += 5;
+    } else if (startsWith(cursor, end, "pkh(")) {
+        script = ScriptType::P2PKH;
+        cursor += 4;
+    } else {
+        descriptor = false;
+        wrappers = 0;
+    }
+    for (uint8_t i = 0; i < wrappers; i++) {
+        if (end <= cursor || end[-1] != ')') {
+            return false;
+        }
+        end--;
+    }
+
+    // Key origin is informational only
+    if (descriptor && cursor < end && *cursor == '[') {
+        cursor = (const char*)memchr(cursor, ']', end - cursor);
+        if (!cursor) {
+            return false;
+        }
+        cursor++;
+    }
+
+    const char* keyEnd = cursor;
+    while (keyEnd < end && *keyEnd != '/') {
+        keyEnd++;
+    }
+    ExtendedPubKey key;
+    if (!parseExtendedPubKey(cursor, keyEnd - cursor, key)) {
+        return false;
+    }
+    if (!descriptor) {
+        script = key.script;
+    }
+    cursor = keyEnd;
+
+    Bip32Deriver deriver;
+    bool ok = false;
+    if (!descriptor) {
+        // Bare key: standard receive and change chains
+        ok = cursor == end && deriver.begin(key) &&
+             deriver.derive(0, out.chains[0]) && deriver.derive(1, out.chains[1]);
+        out.chainCount = 2;
+    } else {
+        while (cursor < end && *cursor == '/') {
+            cursor++;
+            if (end - cursor == 1 && *cursor == '*') {
+                out.chains[0] = key;
+                out.chainCount = 1;
+                ok = true;
+                break;
+            }
+            if (*cursor == '<') {
+                uint32_t receive;
+                uint32_t change;
+                cursor++;
+                ok = parseIndex(cursor, end, receive) && cursor < end && *cursor++ == ';' &&
+                     parseIndex(cursor, end, change) && cursor < end && *cursor++ == '>' &&
+                     end - cursor == 2 && strncmp(cursor, "/*", 2) == 0 &&
+                     deriver.begin(key) &&
+                     deriver.derive(receive, out.chains[0]) && deriver.derive(change, out.chains[1]);
+                out.chainCount = 2;
+                break;
+            }
+            uint32_t index;
+            if (!parseIndex(cursor, end, index) || !deriver.begin(key) || !deriver.derive(index, key)) {
+                return false;
+            }
+        }
+    }
+    if (!ok) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < out.chainCount; i++) {
+        out.chains[i].script = script;
+    }
+    out.script = script;
+    out.testnet = key.testnet;
+    out.id = utils.crc32((const uint8_t*)definition.c_str(), definition.length());
+    return true;
+}
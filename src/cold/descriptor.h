@@ -0,0 +1,33 @@
+#ifndef DESCRIPTOR_H
+#define DESCRIPTOR_H
+
+#include <Arduino.h>
+#include "bip32.h"
+
+// Watch-only wallet definitions. Accepted forms:
+//   xpub... / ypub... / zpub...   receive chain /0/*, change chain /1/*
+//   pkh(KEY) wpkh(KEY) sh(wpkh(KEY)) output descriptors with an optional
+//   [origin] and #checksum, where KEY is an extended public key followed
+//   by non-hardened steps ending in /* or /<a;b>/* (receive;change)
+#define WALLET_MAX_CHAINS       2
+#define DESCRIPTOR_MAX_LENGTH   256
+#define DESCRIPTOR_CHECKSUM_LENGTH 8
+
+struct WatchWallet {
+    ExtendedPubKey chains[WALLET_MAX_CHAINS];   // Addresses are the children of these
+    uint8_t chainCount;
+    ScriptType script;
+    bool testnet;
+    uint32_t id;                                // CRC-32 of the definition, names its cache files
+};
+
+// True if text looks like a wallet definition rather than a single address
+bool isWatchKey(const String& text);
+
+// Parses and validates a wallet definition, deriving the chain keys
+bool parseWatchKey(const String& text, WatchWallet& out);
+
+// BIP380 descriptor checksum of text, written to out (9 bytes)
+bool descriptorChecksum(const char* text, size_t length, char* out);
+
+#endif // DESCRIPTOR_H
@@ -0,0 +1,32 @@
+#include "esplora.h"
+#include "../utils/log.h"
+#include "../utils/jsonpool.h"
+#include <ArduinoJson.h>
+
+bool esploraParseAddressStats(Stream& body, AddressStats& stats) {
+    JsonDocument filter(&jsonPool);
+    filter["chain_stats"] = true;
+    filter["mempool_stats"] = true;
+    
+    JsonDocument doc(&jsonPool);
+    DeserializationError error = deserializeJson(doc, body, DeserializationOption::Filter(filter));
+    if (error) {
+        LOG_E(COLD, "Esplora: JSON parsing failed: %s\n", error.c_str());
+        return false;
+    }
+    
+    JsonObjectConst chainStats = doc["chain_stats"].as<JsonObjectConst>();
+    JsonObjectConst mempoolStats = doc["mempool_stats"].as<JsonObjectConst>();
+    if (chainStats.isNull() || mempoolStats.isNull()) {
+        LOG_E(COLD, "Esplora: Invalid API response format\n");
+        return false;
+    }
+    
+    stats.funded = chainStats["funded_txo_sum"];
+    stats.spent = chainStats["spent_txo_sum"];
+    stats.txCount = chainStats["tx_count"];
+    stats.mempoolFunded = mempoolStats["funded_txo_sum"];
+    stats.mempoolSpent = mempoolStats["spent_txo_sum"];
+    stats.mempoolTxCount = mempoolStats["tx_count"];
+    return true;
+}
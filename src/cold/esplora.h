@@ -0,0 +1,21 @@
+#ifndef ESPLORA_H
+#define ESPLORA_H
+
+#include <Arduino.h>
+
+// Esplora chain and mempool totals of one address
+struct AddressStats {
+    uint64_t funded;
+    uint64_t spent;
+    uint64_t mempoolFunded;
+    uint64_t mempoolSpent;
+    uint32_t txCount;
+    uint32_t mempoolTxCount;
+};
+
+// Parses an /address/<addr> response as it streams in. Only the two stats
+// objects are kept; the rest of the body is skipped as it arrives, and the
+// documents live in the JSON block pool.
+bool esploraParseAddressStats(Stream& body, AddressStats& stats);
+
+#endif // ESPLORA_H
@@ -0,0 +1,308 @@
+#include "txstore.h"
+#include "../utils/log.h"
+#include <LittleFS.h>
+
+struct TxStoreHeader {
+    uint32_t magic;
+    uint32_t storeId;
+    uint32_t committed;
+    uint32_t chainHeight;
+    uint32_t accountCount;
+};
+
+static TxOutpoint makeOutpoint(const TxLogRecord& record) {
+    TxOutpoint outpoint;
+    memcpy(outpoint.txid, record.txid, TXID_SIZE);
+    outpoint.index = record.index;
+    outpoint.value = record.value;
+    outpoint.height = record.height;
+    return outpoint;
+}
+
+static bool removeOutpoint(std::vector<TxOutpoint>& list, const TxLogRecord& record) {
+    for (size_t i = 0; i < list.size(); i++) {
+        if (list[i].index == record.index && memcmp(list[i].txid, record.txid, TXID_SIZE) == 0) {
+            list.erase(list.begin() + i);
+            return true;
+        }
+    }
+    return false;
+}
+
+TxStore::TxStore() {
+    storeId = 0;
+    committed = 0;
+    chainHeight = 0;
+}
+
+void TxStore::load(uint32_t storeId) {
+    char name[32];
+    snprintf(name, sizeof(name), TX_STORE_PREFIX "%08x", (unsigned)storeId);
+    logPath = String(name) + ".log";
+    statePath = String(name) + ".idx";
+    this->storeId = storeId;
+    committed = 0;
+    chainHeight = 0;
+    accounts.clear();
+    recent.clear();
+    unspent.clear();
+    orphanSpends.clear();
+
+    if (!LittleFS.exists(statePath)) {
+        return;
+    }
+    File state = LittleFS.open(statePath, "r");
+    if (!state) {
+        return;
+    }
+    TxStoreHeader header;
+    bool valid = state.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+                 header.magic == TX_STORE_MAGIC && header.storeId == storeId &&
+                 header.accountCount <= TX_STORE_ACCOUNTS_MAX &&
+                 header.committed % sizeof(TxLogRecord) == 0;
+    if (valid) {
+        accounts.resize(header.accountCount);
+        size_t length = header.accountCount * sizeof(TxAccount);
+        valid = state.read((uint8_t*)accounts.data(), length) == length;
+    }
+    state.close();
+    if (!valid) {
+        LOG_W(COLD, "TxStore: Ignoring invalid state %s\n", statePath.c_str());
+        reset();
+        return;
+    }
+    chainHeight = header.chainHeight;
+
+    // Records of an address logged before it was last started over
+    std::vector<TxAccount> restarted;
+    for (const TxAccount& account : accounts) {
+        if (account.since > 0) {
+            restarted.push_back(account);
+        }
+    }
+
+    // Replay the committed part; anything after it is an append that never
+    // got its commit. Positions of addresses without history are committed
+    // before any log exists.
+    File log = LittleFS.open(logPath, "r");
+    if (header.committed > 0 && (!log || log.size() < header.committed)) {
+        LOG_W(COLD, "TxStore: Log %s shorter than its state, starting over\n", logPath.c_str());
+        if (log) {
+            log.close();
+        }
+        reset();
+        return;
+    }
+    TxLogRecord records[TX_STORE_READ_RECORDS];
+    while (committed < header.committed) {
+        size_t length = header.committed - committed;
+        if (length > sizeof(records)) {
+            length = sizeof(records);
+        }
+        if (log.read((uint8_t*)records, length) != length) {
+            break;
+        }
+        for (size_t i = 0; i < length / sizeof(TxLogRecord); i++) {
+            if (!superseded(restarted, records[i], committed + i * sizeof(TxLogRecord))) {
+                apply(records[i]);
+            }
+        }
+        committed += length;
+    }
+    if (log) {
+        log.close();
+    }
+
+    if (committed != header.committed) {
+        LOG_W(COLD, "TxStore: Failed to read %s, starting over\n", logPath.c_str());
+        reset();
+        return;
+    }
+    LOG_I(COLD, "TxStore: Loaded %u records for %u addresses, %u unspent outputs\n",
+                (unsigned)(committed / sizeof(TxLogRecord)), (unsigned)accounts.size(),
+                (unsigned)unspent.size());
+}
+
+void TxStore::reset() {
+    if (LittleFS.exists(logPath)) {
+        LittleFS.remove(logPath);
+    }
+    if (LittleFS.exists(statePath)) {
+        LittleFS.remove(statePath);
+    }
+    committed = 0;
+    accounts.clear();
+    recent.clear();
+    unspent.clear();
+    orphanSpends.clear();
+}
+
+bool TxStore::resetAccount(uint32_t account) {
+    TxAccount entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.account = account;
+    entry.since = committed;
+    setAccount(entry);
+    if (!commit()) {
+        return false;
+    }
+
+    // Rebuild the recent and unspent views without the skipped records
+    load(storeId);
+    return true;
+}
+
+bool TxStore::getAccount(uint32_t account, TxAccount& out) {
+    for (const TxAccount& entry : accounts) {
+        if (entry.account == account) {
+            out = entry;
+            return true;
+        }
+    }
+    if (accounts.size() >= TX_STORE_ACCOUNTS_MAX) {
+        return false;
+    }
+    memset(&out, 0, sizeof(out));
+    out.account = account;
+    accounts.push_back(out);
+    return true;
+}
+
+void TxStore::setAccount(const TxAccount& entry) {
+    for (TxAccount& existing : accounts) {
+        if (existing.account == entry.account) {
+            existing = entry;
+            return;
+        }
+    }
+    if (accounts.size() < TX_STORE_ACCOUNTS_MAX) {
+        accounts.push_back(entry);
+    }
+}
+
+bool TxStore::append(const std::vector<TxLogRecord>& records) {
+    if (records.empty()) {
+        return true;
+    }
+
+    // "r+" keeps the file and lets the write start at the committed end,
+    // over whatever an interrupted append left there
+    size_t length = records.size() * sizeof(TxLogRecord);
+    File log = LittleFS.open(logPath, LittleFS.exists(logPath) ? "r+" : "w");
+    bool written = log && log.seek(committed) &&
+                   log.write((const uint8_t*)records.data(), length) == length;
+    if (log) {
+        log.close();
+    }
+    if (!written) {
+        LOG_E(COLD, "TxStore: Failed to append to %s\n", logPath.c_str());
+        load(storeId);
+        return false;
+    }
+
+    committed += length;
+    for (const TxLogRecord& record : records) {
+        apply(record);
+    }
+    return true;
+}
+
+bool TxStore::commit() {
+    TxStoreHeader header;
+    header.magic = TX_STORE_MAGIC;
+    header.storeId = storeId;
+    header.committed = committed;
+    header.chainHeight = chainHeight;
+    header.accountCount = accounts.size();
+
+    // Same temp-and-rename swap as the settings records
+    String temp = statePath + ".tmp";
+    File state = LittleFS.open(temp, "w");
+    if (!state) {
+        LOG_E(COLD, "TxStore: Failed to open %s\n", temp.c_str());
+        load(storeId);
+        return false;
+    }
+    size_t length = accounts.size() * sizeof(TxAccount);
+    size_t written = state.write((const uint8_t*)&header, sizeof(header));
+    written += state.write((const uint8_t*)accounts.data(), length);
+    state.close();
+
+    if (written != sizeof(header) + length || !LittleFS.rename(temp, statePath)) {
+        LOG_E(COLD, "TxStore: Failed to write %s\n", statePath.c_str());
+        LittleFS.remove(temp);
+        load(storeId);
+        return false;
+    }
+    return true;
+}
+
+TxStoreStats TxStore::getStats() const {
+    TxStoreStats stats;
+    stats.records = committed / sizeof(TxLogRecord);
+    stats.accounts = accounts.size();
+    stats.unspent = unspent.size();
+    stats.logBytes = committed;
+    return stats;
+}
+
+void TxStore::addSummary(std::vector<TxSummary>& list, const TxLogRecord& record, size_t limit) {
+    for (TxSummary& summary : list) {
+        if (memcmp(summary.txid, record.txid, TXID_SIZE) == 0) {
+            summary.delta += record.value;
+            return;
+        }
+    }
+
+    // Newest block first, arrival order within a block
+    size_t position = 0;
+    while (position < list.size() && list[position].height >= record.height) {
+        position++;
+    }
+    if (position >= limit) {
+        return;
+    }
+    TxSummary summary;
+    memcpy(summary.txid, record.txid, TXID_SIZE);
+    summary.delta = record.value;
+    summary.height = record.height;
+    summary.time = record.time;
+    summary.fee = record.fee;
+    list.insert(list.begin() + position, summary);
+    if (list.size() > limit) {
+        list.pop_back();
+    }
+}
+
+// Private methods
+
+bool TxStore::superseded(const std::vector<TxAccount>& restarted, const TxLogRecord& record, uint32_t offset) {
+    for (const TxAccount& account : restarted) {
+        if (account.account == record.account) {
+            return offset < account.since;
+        }
+    }
+    return false;
+}
+
+// Backfilled history arrives newest first, so a spend can be replayed
+// before the output it spends; it waits in orphanSpends until then.
+void TxStore::apply(const TxLogRecord& record) {
+    switch (record.type) {
+        case TxRecordType::TRANSACTION:
+            addSummary(recent, record, TX_STORE_RECENT);
+            break;
+
+        case TxRecordType::OUTPUT:
+            if (!removeOutpoint(orphanSpends, record)) {
+                unspent.push_back(makeOutpoint(record));
+            }
+            break;
+
+        case TxRecordType::SPEND:
+            if (!removeOutpoint(unspent, record)) {
+                orphanSpends.push_back(makeOutpoint(record));
+            }
+            break;
+    }
+}
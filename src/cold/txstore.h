@@ -0,0 +1,125 @@
+#ifndef TXSTORE_H
+#define TXSTORE_H
+
+#include <Arduino.h>
+#include <vector>
+
+// Transaction history store. Synced transactions are appended to a LittleFS
+// log as fixed 64-byte records and never rewritten; a small state file holds
+// the committed log length and each address's sync position, so a write cut
+// short is simply overwritten by the next append.
+#define TX_STORE_MAGIC          0x32535448  // "HTS2"
+#define TX_STORE_PREFIX         "/tx_"      // + store id, .log and .idx
+#define TX_STORE_ACCOUNTS_MAX   2000        // Every cached address of a two-chain wallet
+#define TX_STORE_RECENT         50          // Newest transactions kept in RAM
+#define TX_STORE_READ_RECORDS   16          // Records per read while replaying
+#define TXID_SIZE               32
+
+enum class TxRecordType : uint8_t {
+    TRANSACTION,    // Net effect of a transaction on one address
+    OUTPUT,         // Output paid to the address
+    SPEND           // Input spending an output of the address
+};
+
+// Log record. txid is the spent transaction for SPEND records.
+struct TxLogRecord {
+    TxRecordType type;
+    uint8_t reserved[3];
+    uint32_t account;             // CRC-32 of the address
+    uint8_t txid[TXID_SIZE];
+    int64_t value;                // Net change, or the output value
+    uint32_t index;               // Output index for OUTPUT and SPEND
+    uint32_t height;              // Block height, 0 while unconfirmed
+    uint32_t time;                // Block time (Unix seconds)
+    uint32_t fee;
+};
+
+// Sync position of one address
+struct TxAccount {
+    uint32_t account;
+    uint32_t txCount;             // Confirmed transactions in the log
+    uint32_t tipHeight;
+    uint8_t tipTxid[TXID_SIZE];   // Newest confirmed transaction in the log
+    uint8_t cursorTxid[TXID_SIZE];// Oldest one, where the backfill continues
+    uint32_t since;               // Log offset its history starts at; older records are skipped
+    bool complete;                // Synced back to the first transaction
+};
+
+// Transaction net of all watched addresses
+struct TxSummary {
+    uint8_t txid[TXID_SIZE];
+    int64_t delta;
+    uint32_t height;
+    uint32_t time;
+    uint32_t fee;
+};
+
+struct TxOutpoint {
+    uint8_t txid[TXID_SIZE];
+    uint32_t index;
+    uint64_t value;
+    uint32_t height;
+};
+
+struct TxStoreStats {
+    uint32_t records;
+    uint32_t accounts;
+    uint32_t unspent;
+    uint32_t logBytes;
+};
+
+class TxStore {
+public:
+    TxStore();
+
+    // Loads the state and replays the committed log into the RAM views.
+    // Only done when the watched address changes, never per refresh.
+    void load(uint32_t storeId);
+
+    // Drops the whole history, for when the files cannot be trusted
+    void reset();
+
+    // Starts one address over, for when a reorg or a long absence leaves a
+    // gap its sync cannot bridge. Its records stay in the log but are
+    // skipped from here on, so other addresses keep their history.
+    bool resetAccount(uint32_t account);
+
+    // Copies out the sync position of an address, created empty; false
+    // when the store is full. Positions are copied rather than referenced
+    // since the table grows and reloads while a sync waits on the network.
+    bool getAccount(uint32_t account, TxAccount& out);
+
+    // Replaces a sync position; saved by the next commit()
+    void setAccount(const TxAccount& entry);
+
+    // Writes records past the committed end; they only count once commit()
+    // has saved the state. On failure the store reloads its last commit.
+    bool append(const std::vector<TxLogRecord>& records);
+    bool commit();
+
+    uint32_t getChainHeight() const { return chainHeight; }
+    void setChainHeight(uint32_t height) { chainHeight = height; }
+    const std::vector<TxSummary>& getRecent() const { return recent; }
+    const std::vector<TxOutpoint>& getUnspent() const { return unspent; }
+    TxStoreStats getStats() const;
+
+    // Adds a TRANSACTION record to a newest-first list, merging the records
+    // of several addresses for one transaction
+    static void addSummary(std::vector<TxSummary>& list, const TxLogRecord& record, size_t limit);
+
+private:
+    void apply(const TxLogRecord& record);
+    static bool superseded(const std::vector<TxAccount>& restarted, const TxLogRecord& record, uint32_t offset);
+
+    String logPath;
+    String statePath;
+    uint32_t storeId;
+    uint32_t committed;           // Valid log bytes
+    uint32_t chainHeight;
+    std::vector<TxAccount> accounts;
+    std::vector<TxSummary> recent;
+    std::vector<TxOutpoint> unspent;
+    std::vector<TxOutpoint> orphanSpends;   // Replayed before the output they spend
+};
+
+#endif // TXSTORE_H
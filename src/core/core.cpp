@@ -1,4 +1,5 @@
 #include "core.h"
+#include "../utils/log.h"
 #include <Arduino.h>
 
 // Global instance
@@ -13,10 +14,11 @@ CoreManager::CoreManager() {
     stateStartTime = 0;
     wifiConnected = false;
     updating = false;
+    stateChangeCallback = nullptr;
 }
 
 void CoreManager::init() {
-    Serial.println("CoreManager: Initialized");
+    LOG_I(CORE, "CoreManager: Initialized\n");
     stateStartTime = millis();
 }
 
@@ -59,22 +61,47 @@ void CoreManager::handleStateTransition(SystemState newState) {
         previousState = currentState;
         currentState = newState;
         stateStartTime = millis();
+        
+        if (stateChangeCallback) {
+            stateChangeCallback(previousState, currentState);
+        }
     }
 }
 
+void CoreManager::setStateChangeCallback(void (*callback)(SystemState from, SystemState to)) {
+    stateChangeCallback = callback;
+}
+
+const char* CoreManager::getStateName(SystemState state) {
+    switch (state) {
+        case SystemState::BOOT:                 return "boot";
+        case SystemState::WIFI_CONNECTING:      return "wifi_connecting";
+        case SystemState::WIFI_CONNECTED:       return "wifi_connected";
+        case SystemState::OFFLINE:              return "offline";
+        case SystemState::DISPLAYING_LIGHTNING: return "displaying_lightning";
+        case SystemState::DISPLAYING_COLD:      return "displaying_cold";
+        case SystemState::DISPLAYING_COMBINED:  return "displaying_combined";
+        case SystemState::DISPLAYING_CONFIG:    return "displaying_config";
+        case SystemState::UPDATING_BALANCES:    return "updating_balances";
+        case SystemState::SLEEPING:             return "sleeping";
+        case SystemState::CONFIG_MODE:          return "config_mode";
+    }
+    return "unknown";
+}
+
 void CoreManager::enterSleepMode() {
-    Serial.println("CoreManager: Entering sleep mode");
+    LOG_I(CORE, "CoreManager: Entering sleep mode\n");
     handleStateTransition(SystemState::SLEEPING);
 }
 
 void CoreManager::wakeUp(WakeReason reason) {
-    Serial.printf("CoreManager: Wake up (reason: %d)\n", (int)reason);
+    LOG_I(CORE, "CoreManager: Wake up (reason: %d)\n", (int)reason);
     wakeReason = reason;
     handleStateTransition(SystemState::WIFI_CONNECTING);
 }
 
 void CoreManager::cycleScreen() {
-    Serial.println("CoreManager: Cycling screen");
+    LOG_I(CORE, "CoreManager: Cycling screen\n");
     lastScreenChange = millis();
     
     switch (currentState) {
@@ -94,12 +121,12 @@ void CoreManager::cycleScreen() {
 }
 
 void CoreManager::enterConfigMode() {
-    Serial.println("CoreManager: Entering config mode");
+    LOG_I(CORE, "CoreManager: Entering config mode\n");
     handleStateTransition(SystemState::CONFIG_MODE);
 }
 
 void CoreManager::updateBalances() {
-    Serial.println("CoreManager: Triggering balance update");
+    LOG_I(CORE, "CoreManager: Triggering balance update\n");
     if (!updating) {
         handleStateTransition(SystemState::UPDATING_BALANCES);
     }
@@ -152,5 +179,5 @@ bool CoreManager::shouldSleep() {
 }
 
 void CoreManager::logStateChange(SystemState from, SystemState to) {
-    Serial.printf("CoreManager: State change %d -> %d\n", (int)from, (int)to);
+    LOG_I(CORE, "CoreManager: State change %d -> %d\n", (int)from, (int)to);
 } 
\ No newline at end of file
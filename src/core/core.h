@@ -43,6 +43,10 @@ public:
     void enterConfigMode();
     void updateBalances();
     
+    // State change notification (called after every transition)
+    void setStateChangeCallback(void (*callback)(SystemState from, SystemState to));
+    static const char* getStateName(SystemState state);
+    
     // Status indicators
     bool isWiFiConnected() const { return wifiConnected; }
     bool isUpdating() const { return updating; }
@@ -60,6 +64,9 @@ private:
     bool wifiConnected;
     bool updating;
     
+    // Callbacks
+    void (*stateChangeCallback)(SystemState from, SystemState to);
+    
     // State machine handlers
     void handleBootState();
     void handleWiFiConnecting();
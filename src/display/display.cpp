@@ -1,5 +1,6 @@
 #include "display.h"
 #include "../utils/utils.h"
+#include "../utils/log.h"
 #include <Arduino.h>
 
 // Global instance
@@ -28,7 +29,7 @@ DisplayManager::DisplayManager()
 }
 
 void DisplayManager::init() {
-    Serial.println("DisplayManager: Initializing e-paper display");
+    LOG_I(DISPLAY, "DisplayManager: Initializing e-paper display\n");
     
     // Initialize SPI and display
     display.init();
@@ -37,14 +38,14 @@ void DisplayManager::init() {
     display.setTextColor(GxEPD_BLACK);
     
     initialized = true;
-    Serial.println("DisplayManager: Display initialized");
+    LOG_I(DISPLAY, "DisplayManager: Display initialized\n");
 }
 
 void DisplayManager::showScreen(ScreenType screen) {
     if (!initialized) return;
     
     currentScreen = screen;
-    Serial.printf("DisplayManager: Showing screen %d\n", (int)screen);
+    LOG_I(DISPLAY, "DisplayManager: Showing screen %d\n", (int)screen);
     
     switch (screen) {
         case ScreenType::SETUP_WELCOME:
@@ -66,8 +67,8 @@ void DisplayManager::showScreen(ScreenType screen) {
 }
 
 void DisplayManager::updateBalances(const BalanceData& balances) {
-    Serial.printf("DisplayManager: Updating balances - Lightning: %llu, Cold: %llu\n", 
-                  balances.lightningBalance, balances.coldBalance);
+    LOG_I(DISPLAY, "DisplayManager: Updating balances - Lightning: %llu, Cold: %llu\n", 
+                   balances.lightningBalance, balances.coldBalance);
     balanceData = balances;
     
     // Refresh current screen with new data
@@ -75,12 +76,12 @@ void DisplayManager::updateBalances(const BalanceData& balances) {
 }
 
 void DisplayManager::updateQRData(const QRData& qrData) {
-    Serial.println("DisplayManager: Updating QR data");
+    LOG_I(DISPLAY, "DisplayManager: Updating QR data\n");
     this->qrData = qrData;
 }
 
 void DisplayManager::showErrorScreen(const String& error) {
-    Serial.printf("DisplayManager: Showing error: %s\n", error.c_str());
+    LOG_E(DISPLAY, "DisplayManager: Showing error: %s\n", error.c_str());
     drawErrorScreen(error);
 }
 
@@ -133,14 +134,14 @@ void DisplayManager::clear() {
 }
 
 void DisplayManager::sleep() {
-    Serial.println("DisplayManager: Entering sleep mode");
+    LOG_I(DISPLAY, "DisplayManager: Entering sleep mode\n");
     if (initialized) {
         display.hibernate();
     }
 }
 
 void DisplayManager::wake() {
-    Serial.println("DisplayManager: Waking from sleep");
+    LOG_I(DISPLAY, "DisplayManager: Waking from sleep\n");
     if (initialized) {
         display.init();
     }
@@ -1,4 +1,5 @@
 #include "input.h"
+#include "../utils/log.h"
 #include <Arduino.h>
 
 // Global instance
@@ -42,7 +43,7 @@ InputManager::InputManager() {
 }
 
 void InputManager::init() {
-    Serial.println("InputManager: Initializing input handling");
+    LOG_I(INPUT, "InputManager: Initializing input handling\n");
     
     // Configure button pin
     pinMode(BUTTON_PIN, INPUT_PULLUP);
@@ -55,7 +56,7 @@ void InputManager::init() {
     attachInterrupt(digitalPinToInterrupt(TILT_PIN), tiltISR, CHANGE);
     
     lastInputTime = millis();
-    Serial.println("InputManager: Input initialization complete");
+    LOG_I(INPUT, "InputManager: Input initialization complete\n");
 }
 
 void InputManager::loop() {
@@ -81,16 +82,16 @@ bool InputManager::isTiltActivated() const {
 
 void InputManager::enableWakeOnButton(bool enable) {
     wakeOnButton = enable;
-    Serial.printf("InputManager: Wake on button %s\n", enable ? "enabled" : "disabled");
+    LOG_I(INPUT, "InputManager: Wake on button %s\n", enable ? "enabled" : "disabled");
 }
 
 void InputManager::enableWakeOnTilt(bool enable) {
     wakeOnTilt = enable;
-    Serial.printf("InputManager: Wake on tilt %s\n", enable ? "enabled" : "disabled");
+    LOG_I(INPUT, "InputManager: Wake on tilt %s\n", enable ? "enabled" : "disabled");
 }
 
 void InputManager::setupDeepSleepWakeup() {
-    Serial.println("InputManager: Setting up deep sleep wake sources");
+    LOG_I(INPUT, "InputManager: Setting up deep sleep wake sources\n");
     
     if (wakeOnButton) {
         esp_sleep_enable_ext0_wakeup(GPIO_NUM_0, 0); // Button (active low)
@@ -106,28 +107,28 @@ bool InputManager::wasWokenByInput() const {
 }
 
 void InputManager::calibrateTiltSensor() {
-    Serial.println("InputManager: Calibrating tilt sensor");
+    LOG_I(INPUT, "InputManager: Calibrating tilt sensor\n");
     tiltCalibrated = true;
 }
 
 void InputManager::setTiltSensitivity(uint8_t sensitivity) {
     tiltSensitivity = sensitivity;
-    Serial.printf("InputManager: Tilt sensitivity set to %d\n", sensitivity);
+    LOG_I(INPUT, "InputManager: Tilt sensitivity set to %d\n", sensitivity);
 }
 
 void InputManager::setButtonHoldTime(unsigned long holdTime) {
     longPressThreshold = holdTime;
-    Serial.printf("InputManager: Button hold time set to %lu ms\n", holdTime);
+    LOG_I(INPUT, "InputManager: Button hold time set to %lu ms\n", holdTime);
 }
 
 void InputManager::setButtonCallback(void (*callback)(InputEvent)) {
     buttonCallback = callback;
-    Serial.println("InputManager: Button callback set");
+    LOG_I(INPUT, "InputManager: Button callback set\n");
 }
 
 void InputManager::setTiltCallback(void (*callback)(InputEvent)) {
     tiltCallback = callback;
-    Serial.println("InputManager: Tilt callback set");
+    LOG_I(INPUT, "InputManager: Tilt callback set\n");
 }
 
 // Private methods
@@ -284,12 +285,12 @@ void InputManager::checkWakeSource() {
     
     switch (wakeup_reason) {
         case ESP_SLEEP_WAKEUP_EXT0:
-            Serial.println("InputManager: Woken by button");
+            LOG_I(INPUT, "InputManager: Woken by button\n");
             wokenByInput = true;
             triggerEvent(InputEvent::WAKE_FROM_SLEEP);
             break;
         case ESP_SLEEP_WAKEUP_EXT1:
-            Serial.println("InputManager: Woken by tilt switch");
+            LOG_I(INPUT, "InputManager: Woken by tilt switch\n");
             wokenByInput = true;
             triggerEvent(InputEvent::WAKE_FROM_SLEEP);
             break;
@@ -306,6 +307,6 @@ void InputManager::logInputEvent(InputEvent event) {
     };
     
     if ((int)event < sizeof(eventNames) / sizeof(eventNames[0])) {
-        Serial.printf("InputManager: Event triggered - %s\n", eventNames[(int)event]);
+        LOG_I(INPUT, "InputManager: Event triggered - %s\n", eventNames[(int)event]);
     }
 } 
\ No newline at end of file
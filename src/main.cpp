@@ -14,6 +14,11 @@
 #include "web/web.h"
 #include "settings/settings.h"
 #include "utils/utils.h"
+#include "utils/stateversion.h"
+#include "utils/log.h"
+#include "utils/jobs.h"
+#include "utils/httppool.h"
+#include "utils/tlsclient.h"
 
 // Application constants
 #define FIRMWARE_VERSION        "1.0.0"
@@ -31,7 +36,8 @@ unsigned long lastInputTime = 0;
 unsigned long bootStartTime = 0;
 bool wifiConnected = false;
 bool configModeActive = false;
-bool balanceUpdateInProgress = false;
+SemaphoreHandle_t balanceLock = xSemaphoreCreateMutex();   // Held for a whole balance refresh
+uint32_t loopMaxUs = 0;         // Slowest loop pass since the last status report
 
 // Forward declarations
 void initializeSystem();
@@ -45,16 +51,17 @@ void logSystemStatus();
 // Setup function - called once at startup
 void setup() {
     Serial.begin(9600);
+    logInit();
     
     // Add delay for serial monitor
     delay(1000);
     
-    Serial.println();
-    Serial.println("========================================");
-    Serial.println("     Hodling Hog Bitcoin Piggy Bank");
-    Serial.println("     Saving your future, one oink at a time!");
-    Serial.println("     Version: " FIRMWARE_VERSION);
-    Serial.println("========================================");
+    LOG_I(MAIN, "\n");
+    LOG_I(MAIN, "========================================\n");
+    LOG_I(MAIN, "     Hodling Hog Bitcoin Piggy Bank\n");
+    LOG_I(MAIN, "     Saving your future, one oink at a time!\n");
+    LOG_I(MAIN, "     Version: " FIRMWARE_VERSION "\n");
+    LOG_I(MAIN, "========================================\n");
     
     bootStartTime = millis();
     
@@ -62,18 +69,18 @@ void setup() {
     initializeSystem();
     
     // Initialize all modules
-    Serial.println("Initializing modules...");
+    LOG_I(MAIN, "Initializing modules...\n");
     
     // Initialize settings first (needed by other modules)
     if (!settings.init()) {
-        Serial.println("ERROR: Settings initialization failed");
+        LOG_E(MAIN, "ERROR: Settings initialization failed\n");
         handleSystemError("Settings initialization failed");
         return;
     }
     
     // Load configuration
     if (!settings.loadConfig()) {
-        Serial.println("WARNING: Using default configuration");
+        LOG_W(MAIN, "WARNING: Using default configuration\n");
         settings.resetToDefaults();
         settings.saveConfig();
     }
@@ -86,16 +93,16 @@ void setup() {
     displayMgr.init();
     
     // Set initial device setup status and show appropriate screen
-    auto config = settings.getConfig();
+    ConfigSnapshot config = settings.getConfig();
     // Consider setup complete if WiFi credentials are configured
-    bool isSetup = !config.wifi.ssid.isEmpty();
+    bool isSetup = !config->wifi.ssid.isEmpty();
     
     displayMgr.setDeviceSetup(isSetup);
-    displayMgr.setDeviceName(config.system.deviceName);
+    displayMgr.setDeviceName(config->system.deviceName);
     displayMgr.setWiFiStatus(false); // Initially disconnected
     
-    Serial.printf("Device setup status: %s (WiFi SSID: '%s')\n", 
-                  isSetup ? "SETUP" : "NOT_SETUP", config.wifi.ssid.c_str());
+    LOG_I(MAIN, "Device setup status: %s (WiFi SSID: '%s')\n", 
+                isSetup ? "SETUP" : "NOT_SETUP", config->wifi.ssid.c_str());
     
     if (isSetup) {
         displayMgr.showScreen(ScreenType::LIGHTNING_BALANCE);
@@ -103,7 +110,7 @@ void setup() {
         displayMgr.showScreen(ScreenType::SETUP_WELCOME);
     }
     
-    Serial.println("Display initialized");
+    LOG_I(MAIN, "Display initialized\n");
     
     // Initialize input manager
     inputMgr.init();
@@ -112,21 +119,21 @@ void setup() {
         
         switch (event) {
             case InputEvent::BUTTON_SHORT_PRESS:
-                Serial.printf("Button short press - Device setup: %s\n", 
-                              displayMgr.isDeviceSetup() ? "YES" : "NO");
+                LOG_I(MAIN, "Button short press - Device setup: %s\n", 
+                            displayMgr.isDeviceSetup() ? "YES" : "NO");
                 // Only cycle screens if device is set up
                 if (displayMgr.isDeviceSetup()) {
                     displayMgr.nextSetupScreen();
                 } else {
-                    Serial.println("Device not set up - button press ignored");
+                    LOG_I(MAIN, "Device not set up - button press ignored\n");
                 }
                 break;
             case InputEvent::BUTTON_LONG_PRESS:
-                Serial.println("Button long press - entering config mode");
+                LOG_I(MAIN, "Button long press - entering config mode\n");
                 core.enterConfigMode();
                 break;
             case InputEvent::BUTTON_DOUBLE_CLICK:
-                Serial.println("Button double click - updating balances");
+                LOG_I(MAIN, "Button double click - updating balances\n");
                 core.updateBalances();
                 break;
         }
@@ -138,16 +145,19 @@ void setup() {
             core.wakeUp(WakeReason::TILT_SWITCH);
             // Update balances immediately on tilt to show fresh data
             if (wifiConnected) {
-                Serial.println("Triggering balance update on tilt");
+                LOG_I(MAIN, "Triggering balance update on tilt\n");
                 updateBalances();
             }
         }
     });
-    Serial.println("Input manager initialized");
+    LOG_I(MAIN, "Input manager initialized\n");
     
     // Initialize core state machine
     core.init();
-    Serial.println("Core state machine initialized");
+    core.setStateChangeCallback([](SystemState from, SystemState to) {
+        webInterface.pushState(to);
+    });
+    LOG_I(MAIN, "Core state machine initialized\n");
     
     // Initialize wallet modules
     lightningWallet.init();
@@ -155,26 +165,29 @@ void setup() {
     
     // Initialize or create WoS wallet if needed
     if (lightningWallet.createWalletIfNeeded()) {
-        Serial.println("Lightning wallet initialized successfully");
+        LOG_I(MAIN, "Lightning wallet initialized successfully\n");
     } else {
-        Serial.println("Lightning wallet initialization failed - will retry on login");
+        LOG_E(MAIN, "Lightning wallet initialization failed - will retry on login\n");
     }
     
     coldStorage.init();
     // Load address from settings instead of hardcoded value
-    String savedAddress = settings.getConfig().coldStorage.watchAddress;
+    String savedAddress = settings.getConfig()->coldStorage.watchAddress;
     if (!savedAddress.isEmpty()) {
         coldStorage.setAddress(savedAddress);
-        Serial.printf("Cold storage loaded saved address: %s\n", savedAddress.c_str());
+        LOG_I(MAIN, "Cold storage loaded saved address: %s\n", savedAddress.c_str());
     } else {
-        Serial.println("Cold storage: No saved address found");
+        LOG_I(MAIN, "Cold storage: No saved address found\n");
     }
     coldStorage.setApiEndpoint(BLOCKSTREAM_API);
-    Serial.println("Cold storage initialized");
+    LOG_I(MAIN, "Cold storage initialized\n");
+    
+    // Start the deferred job worker before anything can post to it
+    jobs.init();
     
     // Initialize web interface
     webInterface.init();
-    Serial.println("Web interface initialized");
+    LOG_I(MAIN, "Web interface initialized\n");
     
     // Setup Wi-Fi with non-blocking pattern
     WiFi.mode(WIFI_STA);
@@ -182,23 +195,27 @@ void setup() {
     
     // Check if we should enter configuration mode immediately
     if (inputMgr.isButtonPressed()) {
-        Serial.println("Button pressed during boot - entering config mode");
+        LOG_I(MAIN, "Button pressed during boot - entering config mode\n");
         core.handleStateTransition(SystemState::CONFIG_MODE);
     } else {
         // Normal startup - try to connect to WiFi
         core.handleStateTransition(SystemState::WIFI_CONNECTING);
     }
     
-    Serial.printf("Boot completed in %lums\n", millis() - bootStartTime);
-    Serial.println("========================================");
+    LOG_I(MAIN, "Boot completed in %lums\n", millis() - bootStartTime);
+    LOG_I(MAIN, "========================================\n");
 }
 
 // Main loop - called repeatedly
 void loop() {
+    unsigned long loopStart = micros();
+    
     // Update all modules
     core.loop();
     inputMgr.loop();
     webInterface.loop();
+    settings.loop();
+    httpPool.evictIdle();
     
     // Handle input events
     handleInputEvents();
@@ -222,6 +239,11 @@ void loop() {
         lastStatusLog = millis();
     }
     
+    uint32_t loopUs = micros() - loopStart;
+    if (loopUs > loopMaxUs) {
+        loopMaxUs = loopUs;
+    }
+    
     // Yield to other tasks
     yield();
     delay(10);
@@ -231,33 +253,33 @@ void loop() {
 void initializeSystem() {
     // Initialize file system
     if (!LittleFS.begin(true)) {
-        Serial.println("ERROR: LittleFS mount failed");
+        LOG_E(MAIN, "ERROR: LittleFS mount failed\n");
         handleSystemError("File system initialization failed");
         return;
     }
-    Serial.println("LittleFS mounted successfully");
+    LOG_I(MAIN, "LittleFS mounted successfully\n");
     
     // Check wake reason
     esp_sleep_wakeup_cause_t wakeup_reason = esp_sleep_get_wakeup_cause();
     
     switch (wakeup_reason) {
         case ESP_SLEEP_WAKEUP_EXT0:
-            Serial.println("Wake up from button press");
+            LOG_I(MAIN, "Wake up from button press\n");
             break;
         case ESP_SLEEP_WAKEUP_EXT1:
-            Serial.println("Wake up from tilt switch");
+            LOG_I(MAIN, "Wake up from tilt switch\n");
             break;
         case ESP_SLEEP_WAKEUP_TIMER:
-            Serial.println("Wake up from timer");
+            LOG_I(MAIN, "Wake up from timer\n");
             break;
         case ESP_SLEEP_WAKEUP_TOUCHPAD:
-            Serial.println("Wake up from touchpad");
+            LOG_I(MAIN, "Wake up from touchpad\n");
             break;
         case ESP_SLEEP_WAKEUP_ULP:
-            Serial.println("Wake up from ULP program");
+            LOG_I(MAIN, "Wake up from ULP program\n");
             break;
         default:
-            Serial.printf("Wake up from reset: %d\n", wakeup_reason);
+            LOG_I(MAIN, "Wake up from reset: %d\n", wakeup_reason);
             break;
     }
     
@@ -265,7 +287,7 @@ void initializeSystem() {
     esp_sleep_enable_ext0_wakeup(GPIO_NUM_21, 0);  // Button (active low)
     esp_sleep_enable_ext1_wakeup(1ULL << GPIO_NUM_2, ESP_EXT1_WAKEUP_ANY_HIGH); // Tilt switch
     
-    Serial.println("System initialization completed");
+    LOG_I(MAIN, "System initialization completed\n");
 }
 
 // Handle WiFi connection with non-blocking pattern
@@ -276,7 +298,7 @@ void handleWiFiConnection() {
     switch (core.getCurrentState()) {
         case SystemState::WIFI_CONNECTING:
             if (!wifiConnecting) {
-                Serial.println("Starting WiFi connection...");
+                LOG_I(MAIN, "Starting WiFi connection...\n");
                 WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
                 wifiStartTime = millis();
                 wifiConnecting = true;
@@ -287,7 +309,7 @@ void handleWiFiConnection() {
             if (WiFi.status() == WL_CONNECTED) {
                 wifiConnected = true;
                 wifiConnecting = false;
-                Serial.printf("WiFi connected! IP: %s\n", WiFi.localIP().toString().c_str());
+                LOG_I(MAIN, "WiFi connected! IP: %s\n", WiFi.localIP().toString().c_str());
                 
                 // Mark device as setup and update display
                 displayMgr.setDeviceSetup(true);
@@ -299,6 +321,7 @@ void handleWiFiConnection() {
                 
                 // Start web interface
                 webInterface.start();
+                webInterface.pushWiFiStatus(true);
                 
                 core.handleStateTransition(SystemState::WIFI_CONNECTED);
                 
@@ -310,7 +333,7 @@ void handleWiFiConnection() {
                 
             } else if (millis() - wifiStartTime > WIFI_TIMEOUT) {
                 // WiFi timeout - go offline
-                Serial.println("WiFi connection timeout - going offline");
+                LOG_I(MAIN, "WiFi connection timeout - going offline\n");
                 wifiConnected = false;
                 wifiConnecting = false;
                 WiFi.disconnect();
@@ -318,6 +341,7 @@ void handleWiFiConnection() {
                 // Update display WiFi status
                 displayMgr.setWiFiStatus(false);
                 displayMgr.showScreen(displayMgr.getCurrentScreen());
+                webInterface.pushWiFiStatus(false);
                 
                 core.handleStateTransition(SystemState::OFFLINE);
             }
@@ -326,9 +350,10 @@ void handleWiFiConnection() {
         case SystemState::WIFI_CONNECTED:
             // Monitor connection status
             if (WiFi.status() != WL_CONNECTED) {
-                Serial.println("WiFi connection lost");
+                LOG_I(MAIN, "WiFi connection lost\n");
                 wifiConnected = false;
                 displayMgr.setWiFiStatus(false);
+                webInterface.pushWiFiStatus(false);
                 displayMgr.showScreen(displayMgr.getCurrentScreen());
                 core.handleStateTransition(SystemState::WIFI_CONNECTING);
             }
@@ -336,7 +361,7 @@ void handleWiFiConnection() {
             
         case SystemState::CONFIG_MODE:
             if (!webInterface.isAPMode()) {
-                Serial.println("Starting configuration AP mode");
+                LOG_I(MAIN, "Starting configuration AP mode\n");
                 webInterface.startAPMode();
                 displayMgr.setSetupIP(webInterface.getAPIP());
                 displayMgr.showScreen(ScreenType::SETUP_WELCOME);
@@ -347,12 +372,13 @@ void handleWiFiConnection() {
 
 // Update wallet balances
 void updateBalances() {
-    if (balanceUpdateInProgress) {
+    // Runs on the main loop and on the job worker; a caller arriving while
+    // a refresh is under way skips, the running one covers it
+    if (xSemaphoreTake(balanceLock, 0) != pdTRUE) {
         return;
     }
     
-    Serial.println("Updating balances...");
-    balanceUpdateInProgress = true;
+    LOG_I(MAIN, "Updating balances...\n");
     core.handleStateTransition(SystemState::UPDATING_BALANCES);
     
     BalanceData balances = {};
@@ -364,9 +390,9 @@ void updateBalances() {
             LightningBalance lnBalance = lightningWallet.getBalance();
             balances.lightningBalance = lnBalance.total;
             balances.lightningValid = true;
-            Serial.printf("Lightning balance: %llu sats\n", balances.lightningBalance);
+            LOG_I(MAIN, "Lightning balance: %llu sats\n", balances.lightningBalance);
         } else {
-            Serial.printf("Lightning balance update failed: %s\n", lightningWallet.getLastError().c_str());
+            LOG_E(MAIN, "Lightning balance update failed: %s\n", lightningWallet.getLastError().c_str());
             balances.lightningValid = false;
         }
         
@@ -375,9 +401,9 @@ void updateBalances() {
             ColdBalance coldBalance = coldStorage.getBalance();
             balances.coldBalance = coldBalance.total;
             balances.coldValid = true;
-            Serial.printf("Cold storage balance: %llu sats\n", balances.coldBalance);
+            LOG_I(MAIN, "Cold storage balance: %llu sats\n", balances.coldBalance);
         } else {
-            Serial.printf("Cold storage balance update failed: %s\n", coldStorage.getLastError().c_str());
+            LOG_E(MAIN, "Cold storage balance update failed: %s\n", coldStorage.getLastError().c_str());
             balances.coldValid = false;
         }
     }
@@ -388,6 +414,11 @@ void updateBalances() {
     // Update display
     displayMgr.updateBalances(balances);
     
+    // Wake-to-balance time, split by whether TLS sessions were resumed
+    if (balances.lightningValid || balances.coldValid) {
+        tlsSessions.recordWakeLatency(millis());
+    }
+    
     // Update QR codes
     QRData qrData = {};
     qrData.lightningAddress = lightningWallet.getReceiveAddress();
@@ -395,7 +426,12 @@ void updateBalances() {
     displayMgr.updateQRData(qrData);
     
     lastUpdateTime = millis();
-    balanceUpdateInProgress = false;
+    
+    // Published before the lock is released, so a refresh that follows
+    // cannot get its push out ahead of this one's
+    bumpStateVersion();
+    webInterface.pushBalances();
+    xSemaphoreGive(balanceLock);
     
     // Return to appropriate display state
     if (wifiConnected) {
@@ -404,7 +440,7 @@ void updateBalances() {
         core.handleStateTransition(SystemState::OFFLINE);
     }
     
-    Serial.printf("Balance update completed. Total: %llu sats\n", balances.totalBalance);
+    LOG_I(MAIN, "Balance update completed. Total: %llu sats\n", balances.totalBalance);
 }
 
 // Handle input events
@@ -415,11 +451,11 @@ void handleInputEvents() {
         
         switch (event) {
             case InputEvent::WAKE_FROM_SLEEP:
-                Serial.println("Device woke from sleep");
+                LOG_I(MAIN, "Device woke from sleep\n");
                 core.wakeUp(WakeReason::BUTTON_PRESS);
                 // Update balances on wake up to show fresh data
                 if (wifiConnected) {
-                    Serial.println("Triggering balance update on wake up");
+                    LOG_I(MAIN, "Triggering balance update on wake up\n");
                     updateBalances();
                 }
                 break;
@@ -451,14 +487,14 @@ void checkPowerManagement() {
         case SystemState::DISPLAYING_COMBINED:
         case SystemState::OFFLINE:
             // Use configurable sleep timeout from settings
-            if (millis() - lastActivity > settings.getConfig().power.sleepTimeout) {
+            if (millis() - lastActivity > settings.getConfig()->power.sleepTimeout) {
                 shouldSleep = true;
             }
             break;
             
         case SystemState::CONFIG_MODE:
             if (millis() - lastActivity > CONFIG_MODE_TIMEOUT) {
-                Serial.println("Config mode timeout - exiting");
+                LOG_I(MAIN, "Config mode timeout - exiting\n");
                 webInterface.stopAPMode();
                 core.handleStateTransition(SystemState::WIFI_CONNECTING);
             }
@@ -470,7 +506,7 @@ void checkPowerManagement() {
     }
     
     if (shouldSleep) {
-        Serial.println("Entering sleep mode");
+        LOG_I(MAIN, "Entering sleep mode\n");
         core.enterSleepMode();
         
         // Prepare for deep sleep
@@ -481,8 +517,11 @@ void checkPowerManagement() {
         // Configure wake sources
         inputMgr.setupDeepSleepWakeup();
         
-        Serial.println("Going to deep sleep...");
-        Serial.flush();
+        // Nothing may be left in the write-behind window
+        settings.flush();
+        
+        LOG_I(MAIN, "Going to deep sleep...\n");
+        logFlush();
         
         // Enter deep sleep
         esp_deep_sleep_start();
@@ -491,7 +530,7 @@ void checkPowerManagement() {
 
 // Handle system errors
 void handleSystemError(const String& error) {
-    Serial.printf("SYSTEM ERROR: %s\n", error.c_str());
+    LOG_E(MAIN, "SYSTEM ERROR: %s\n", error.c_str());
     
     // Show error on display
     displayMgr.showErrorScreen(error);
@@ -507,37 +546,42 @@ void handleSystemError(const String& error) {
         inputMgr.loop();
         if (inputMgr.getLastEvent() != InputEvent::NONE) {
             // User pressed button - restart
-            Serial.println("User input detected - restarting");
+            LOG_I(MAIN, "User input detected - restarting\n");
             utils.restart();
         }
         delay(100);
     }
     
     // Auto-restart after timeout
-    Serial.println("Error timeout - restarting");
+    LOG_E(MAIN, "Error timeout - restarting\n");
     utils.restart();
 }
 
 // Log system status for debugging
 void logSystemStatus() {
-    Serial.println("--- System Status ---");
-    Serial.printf("State: %d\n", (int)core.getCurrentState());
-    Serial.printf("WiFi: %s\n", wifiConnected ? "Connected" : "Disconnected");
-    Serial.printf("Free heap: %u bytes\n", ESP.getFreeHeap());
-    Serial.printf("Uptime: %s\n", utils.formatUptime().c_str());
-    Serial.printf("Last update: %s ago\n", utils.getTimeAgo(lastUpdateTime).c_str());
-    Serial.printf("Last input: %s ago\n", utils.getTimeAgo(lastInputTime).c_str());
+    LOG_I(MAIN, "--- System Status ---\n");
+    LOG_I(MAIN, "State: %d\n", (int)core.getCurrentState());
+    LOG_I(MAIN, "WiFi: %s\n", wifiConnected ? "Connected" : "Disconnected");
+    LOG_I(MAIN, "Free heap: %u bytes\n", ESP.getFreeHeap());
+    LOG_I(MAIN, "Uptime: %s\n", utils.formatUptime().c_str());
+    LOG_I(MAIN, "Last update: %s ago\n", utils.getTimeAgo(lastUpdateTime).c_str());
+    LOG_I(MAIN, "Last input: %s ago\n", utils.getTimeAgo(lastInputTime).c_str());
+    LOG_I(MAIN, "Loop: max %lu us\n", (unsigned long)loopMaxUs);
+    loopMaxUs = 0;
+    
+    LogStats logStats = logGetStats();
+    LOG_I(MAIN, "Log: %u lines, %u dropped\n", logStats.written, logStats.dropped);
     
     if (wifiConnected) {
-        Serial.printf("IP: %s\n", WiFi.localIP().toString().c_str());
-        Serial.printf("RSSI: %d dBm\n", WiFi.RSSI());
+        LOG_I(MAIN, "IP: %s\n", WiFi.localIP().toString().c_str());
+        LOG_I(MAIN, "RSSI: %d dBm\n", WiFi.RSSI());
     }
     
     // Battery status if available
     BatteryStatus battery = utils.getBatteryStatus();
     if (battery.voltage > 0) {
-        Serial.printf("Battery: %.2fV (%d%%)\n", battery.voltage, battery.percentage);
+        LOG_I(MAIN, "Battery: %.2fV (%d%%)\n", battery.voltage, battery.percentage);
     }
     
-    Serial.println("--------------------");
+    LOG_I(MAIN, "--------------------\n");
 }
\ No newline at end of file
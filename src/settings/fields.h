@@ -0,0 +1,255 @@
+#ifndef FIELDS_H
+#define FIELDS_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "tlv.h"
+
+// Settings schema. Every settings struct is described by a constexpr table
+// with one row per field (JSON key, TLV tag, member, default, valid range),
+// and the functors below derive defaults, validation and both encodings
+// from it. Adding a setting means adding its member and one table row.
+
+enum class FieldType : uint8_t {
+    TEXT,
+    FLAG,
+    U8,
+    U32,
+    U64
+};
+
+#define FIELD_REQUIRED  0x01    // Text may not be empty
+
+template <typename T>
+struct FieldDescriptor {
+    union Member {
+        String T::* text;
+        bool T::* flag;
+        uint8_t T::* u8;
+        uint32_t T::* u32;
+        uint64_t T::* u64;
+
+        constexpr Member(String T::* m) : text(m) {}
+        constexpr Member(bool T::* m) : flag(m) {}
+        constexpr Member(uint8_t T::* m) : u8(m) {}
+        constexpr Member(uint32_t T::* m) : u32(m) {}
+        constexpr Member(uint64_t T::* m) : u64(m) {}
+    };
+
+    const char* key;                    // JSON name
+    uint8_t tag;                        // TLV tag, never renumbered or reused
+    FieldType type;
+    Member member;
+    uint64_t minimum;                   // Value range, or length range of non-empty text
+    uint64_t maximum;
+    uint64_t defaultValue;
+    const char* defaultText;
+    uint8_t flags;
+    bool (*check)(const String& value); // Optional format check for non-empty text
+
+    constexpr FieldDescriptor(const char* key, uint8_t tag, String T::* m, const char* defaultText,
+                              uint64_t minLength, uint64_t maxLength, uint8_t flags = 0,
+                              bool (*check)(const String&) = nullptr)
+        : key(key), tag(tag), type(FieldType::TEXT), member(m), minimum(minLength), maximum(maxLength),
+          defaultValue(0), defaultText(defaultText), flags(flags), check(check) {}
+
+    constexpr FieldDescriptor(const char* key, uint8_t tag, bool T::* m, bool defaultValue)
+        : key(key), tag(tag), type(FieldType::FLAG), member(m), minimum(0), maximum(1),
+          defaultValue(defaultValue), defaultText(nullptr), flags(0), check(nullptr) {}
+
+    constexpr FieldDescriptor(const char* key, uint8_t tag, uint8_t T::* m, uint64_t defaultValue,
+                              uint64_t minimum, uint64_t maximum)
+        : key(key), tag(tag), type(FieldType::U8), member(m), minimum(minimum), maximum(maximum),
+          defaultValue(defaultValue), defaultText(nullptr), flags(0), check(nullptr) {}
+
+    constexpr FieldDescriptor(const char* key, uint8_t tag, uint32_t T::* m, uint64_t defaultValue,
+                              uint64_t minimum, uint64_t maximum)
+        : key(key), tag(tag), type(FieldType::U32), member(m), minimum(minimum), maximum(maximum),
+          defaultValue(defaultValue), defaultText(nullptr), flags(0), check(nullptr) {}
+
+    constexpr FieldDescriptor(const char* key, uint8_t tag, uint64_t T::* m, uint64_t defaultValue,
+                              uint64_t minimum, uint64_t maximum)
+        : key(key), tag(tag), type(FieldType::U64), member(m), minimum(minimum), maximum(maximum),
+          defaultValue(defaultValue), defaultText(nullptr), flags(0), check(nullptr) {}
+
+    // Numeric view of FLAG and integer fields
+    uint64_t getNumber(const T& settings) const {
+        switch (type) {
+            case FieldType::FLAG: return settings.*member.flag ? 1 : 0;
+            case FieldType::U8: return settings.*member.u8;
+            case FieldType::U32: return settings.*member.u32;
+            case FieldType::U64: return settings.*member.u64;
+            default: return 0;
+        }
+    }
+
+    void setNumber(T& settings, uint64_t value) const {
+        switch (type) {
+            case FieldType::FLAG: settings.*member.flag = value != 0; break;
+            case FieldType::U8: settings.*member.u8 = value; break;
+            case FieldType::U32: settings.*member.u32 = value; break;
+            case FieldType::U64: settings.*member.u64 = value; break;
+            default: break;
+        }
+    }
+
+    bool accepts(uint64_t value) const {
+        return value >= minimum && value <= maximum;
+    }
+
+    bool accepts(const String& value) const {
+        if (value.length() == 0) {
+            return !(flags & FIELD_REQUIRED);
+        }
+        return accepts((uint64_t)value.length()) && (!check || check(value));
+    }
+
+    bool isValid(const T& settings) const {
+        if (type == FieldType::TEXT) {
+            return accepts(settings.*member.text);
+        }
+        return accepts(getNumber(settings));
+    }
+};
+
+// Each functor is called as f(table, settings) so one dispatch over the
+// categories serves every operation
+
+struct FieldDefaults {
+    template <typename T, size_t N>
+    void operator()(const FieldDescriptor<T> (&fields)[N], T& settings) const {
+        for (const FieldDescriptor<T>& field : fields) {
+            if (field.type == FieldType::TEXT) {
+                settings.*field.member.text = field.defaultText;
+            } else {
+                field.setNumber(settings, field.defaultValue);
+            }
+        }
+    }
+};
+
+// Records the first field outside its range
+struct FieldValidator {
+    const char* invalid;
+
+    template <typename T, size_t N>
+    void operator()(const FieldDescriptor<T> (&fields)[N], const T& settings) {
+        for (const FieldDescriptor<T>& field : fields) {
+            if (!field.isValid(settings)) {
+                invalid = field.key;
+                return;
+            }
+        }
+    }
+};
+
+struct FieldJsonWriter {
+    JsonObject obj;
+
+    template <typename T, size_t N>
+    void operator()(const FieldDescriptor<T> (&fields)[N], const T& settings) {
+        for (const FieldDescriptor<T>& field : fields) {
+            switch (field.type) {
+                case FieldType::TEXT: obj[field.key] = settings.*field.member.text; break;
+                case FieldType::FLAG: obj[field.key] = settings.*field.member.flag; break;
+                case FieldType::U64: obj[field.key] = settings.*field.member.u64; break;
+                default: obj[field.key] = (uint32_t)field.getNumber(settings); break;
+            }
+        }
+    }
+};
+
+// Missing keys keep their current value; values of the wrong type or out
+// of range are skipped and the first one is recorded
+struct FieldJsonReader {
+    JsonObjectConst obj;
+    const char* rejected;
+
+    template <typename T, size_t N>
+    void operator()(const FieldDescriptor<T> (&fields)[N], T& settings) {
+        for (const FieldDescriptor<T>& field : fields) {
+            JsonVariantConst value = obj[field.key];
+            if (!value.isNull() && !read(field, settings, value) && !rejected) {
+                rejected = field.key;
+            }
+        }
+    }
+
+    template <typename T>
+    static bool read(const FieldDescriptor<T>& field, T& settings, JsonVariantConst value) {
+        if (field.type == FieldType::TEXT) {
+            if (!value.is<const char*>()) {
+                return false;
+            }
+            String text = value.as<String>();
+            if (!field.accepts(text)) {
+                return false;
+            }
+            settings.*field.member.text = text;
+            return true;
+        }
+
+        uint64_t number;
+        if (field.type == FieldType::FLAG && value.is<bool>()) {
+            number = value.as<bool>() ? 1 : 0;
+        } else if (field.type != FieldType::FLAG && value.is<uint64_t>()) {
+            number = value.as<uint64_t>();
+        } else {
+            return false;
+        }
+        if (!field.accepts(number)) {
+            return false;
+        }
+        field.setNumber(settings, number);
+        return true;
+    }
+};
+
+struct FieldTlvWriter {
+    TlvWriter& out;
+
+    template <typename T, size_t N>
+    void operator()(const FieldDescriptor<T> (&fields)[N], const T& settings) {
+        for (const FieldDescriptor<T>& field : fields) {
+            if (field.type == FieldType::TEXT) {
+                out.putString(field.tag, settings.*field.member.text);
+            } else {
+                out.putUint(field.tag, field.getNumber(settings));
+            }
+        }
+    }
+};
+
+// Applies the reader's current entry. Unknown tags are ignored; a known
+// tag with an out-of-range value is skipped and recorded.
+struct FieldTlvReader {
+    const TlvReader& entry;
+    const char* rejected;
+
+    template <typename T, size_t N>
+    void operator()(const FieldDescriptor<T> (&fields)[N], T& settings) {
+        for (const FieldDescriptor<T>& field : fields) {
+            if (field.tag != entry.tag()) {
+                continue;
+            }
+            if (field.type == FieldType::TEXT) {
+                String text = entry.asString();
+                if (field.accepts(text)) {
+                    settings.*field.member.text = text;
+                } else {
+                    rejected = field.key;
+                }
+            } else {
+                uint64_t number = entry.asUint();
+                if (field.accepts(number)) {
+                    field.setNumber(settings, number);
+                } else {
+                    rejected = field.key;
+                }
+            }
+            return;
+        }
+    }
+};
+
+#endif // FIELDS_H
@@ -0,0 +1,108 @@
+#include "records.h"
+#include "../utils/log.h"
+#include <LittleFS.h>
+#include <esp_rom_crc.h>
+
+bool recordWrite(const String& path, const uint8_t* data, size_t length, size_t& written) {
+    SettingsRecordHeader header;
+    header.magic = SETTINGS_RECORD_MAGIC;
+    header.length = length;
+    header.crc = recordCrc(data, length);
+    written = 0;
+    
+    // Never truncate the live file: write a temp copy and swap it in
+    String temp = path + SETTINGS_TEMP_SUFFIX;
+    File file = LittleFS.open(temp, "w");
+    if (!file) {
+        LOG_E(SETTINGS, "Records: Failed to open %s for writing\n", temp.c_str());
+        return false;
+    }
+    
+    written = file.write((const uint8_t*)&header, sizeof(header));
+    written += file.write(data, length);
+    file.flush();
+    file.close();
+    
+    if (written != sizeof(header) + length) {
+        LOG_E(SETTINGS, "Records: Short write to %s (%u of %u bytes)\n", 
+                        temp.c_str(), (unsigned)written, (unsigned)(sizeof(header) + length));
+        LittleFS.remove(temp);
+        return false;
+    }
+    
+    // LittleFS replaces the target atomically
+    if (!LittleFS.rename(temp, path)) {
+        LOG_E(SETTINGS, "Records: Failed to rename %s\n", temp.c_str());
+        LittleFS.remove(temp);
+        return false;
+    }
+    
+    LOG_D(SETTINGS, "Records: Wrote %s (%u bytes)\n", path.c_str(), (unsigned)written);
+    return true;
+}
+
+uint8_t* recordRead(const String& path, size_t& length, bool allowUnframed, bool& corrupt) {
+    corrupt = false;
+    if (!LittleFS.exists(path)) {
+        return nullptr;
+    }
+    
+    File file = LittleFS.open(path, "r");
+    if (!file) {
+        LOG_E(SETTINGS, "Records: Failed to open %s\n", path.c_str());
+        return nullptr;
+    }
+    
+    size_t size = file.size();
+    if (size == 0 || size > SETTINGS_RECORD_MAX) {
+        LOG_E(SETTINGS, "Records: %s has invalid size %u\n", path.c_str(), (unsigned)size);
+        file.close();
+        corrupt = true;
+        return nullptr;
+    }
+    
+    uint8_t* data = (uint8_t*)malloc(size);
+    if (!data) {
+        file.close();
+        return nullptr;
+    }
+    size_t read = file.read(data, size);
+    file.close();
+    
+    SettingsRecordHeader header;
+    if (read < sizeof(header)) {
+        memset(&header, 0, sizeof(header));
+    } else {
+        memcpy(&header, data, sizeof(header));
+    }
+    
+    // Unframed files predate the record format. Only the legacy JSON loader
+    // takes them as they are; for a binary record a missing frame is damage
+    // and the caller falls back to the backup.
+    if (header.magic != SETTINGS_RECORD_MAGIC) {
+        if (allowUnframed) {
+            length = read;
+            return data;
+        }
+        LOG_E(SETTINGS, "Records: %s has no record header\n", path.c_str());
+        free(data);
+        corrupt = true;
+        return nullptr;
+    }
+    
+    if (header.length != read - sizeof(header) ||
+        header.crc != recordCrc(data + sizeof(header), header.length)) {
+        LOG_E(SETTINGS, "Records: %s failed its CRC check\n", path.c_str());
+        free(data);
+        corrupt = true;
+        return nullptr;
+    }
+    
+    length = header.length;
+    memmove(data, data + sizeof(header), length);
+    return data;
+}
+
+uint32_t recordCrc(const uint8_t* data, size_t length) {
+    return esp_rom_crc32_le(0, data, length);
+}
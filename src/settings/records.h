@@ -0,0 +1,31 @@
+#ifndef RECORDS_H
+#define RECORDS_H
+
+#include <Arduino.h>
+
+// Crash-safe record files: written to a temp file, synced, then renamed
+// over the old one, so a reader sees either the old or the new record
+#define SETTINGS_RECORD_MAGIC   0x31534848  // "HHS1"
+#define SETTINGS_RECORD_MAX     8192        // Larger files are treated as corrupt
+#define SETTINGS_TEMP_SUFFIX    ".tmp"
+
+// Header in front of every settings record
+struct SettingsRecordHeader {
+    uint32_t magic;
+    uint32_t length;            // Payload bytes
+    uint32_t crc;               // CRC-32 of the payload
+};
+
+// Frames data and swaps it in for path. written is what reached the temp
+// file, counted for the flash statistics even when the write fails.
+bool recordWrite(const String& path, const uint8_t* data, size_t length, size_t& written);
+
+// Reads and checks the record at path; the caller frees the payload.
+// corrupt is set when the file exists but fails a check. allowUnframed
+// also accepts the bare JSON files of older firmware.
+uint8_t* recordRead(const String& path, size_t& length, bool allowUnframed, bool& corrupt);
+
+// CRC-32 (IEEE 802.3) of the payload, from the ROM
+uint32_t recordCrc(const uint8_t* data, size_t length);
+
+#endif // RECORDS_H
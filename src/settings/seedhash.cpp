@@ -0,0 +1,154 @@
+#include "seedhash.h"
+#include <esp_system.h>
+#include <mbedtls/md.h>
+#include <mbedtls/pkcs5.h>
+#include <mbedtls/platform_util.h>
+
+// mbedtls runs SHA-256 on the hardware accelerator, so one context is
+// set up per derivation and every HMAC round stays on the peripheral
+static bool derive(const String& phrase, const uint8_t* salt, uint32_t iterations, uint8_t* key) {
+    mbedtls_md_context_t context;
+    mbedtls_md_init(&context);
+    bool ok = mbedtls_md_setup(&context, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 1) == 0 &&
+              mbedtls_pkcs5_pbkdf2_hmac(&context, (const unsigned char*)phrase.c_str(), phrase.length(),
+                                        salt, SEED_KDF_SALT_BYTES, iterations,
+                                        SEED_KDF_KEY_BYTES, key) == 0;
+    mbedtls_md_free(&context);
+    return ok;
+}
+
+static void appendHex(String& out, const uint8_t* data, size_t length) {
+    static const char DIGITS[] = "0123456789abcdef";
+    for (size_t i = 0; i < length; i++) {
+        out += DIGITS[data[i] >> 4];
+        out += DIGITS[data[i] & 0x0F];
+    }
+}
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Decodes exactly length bytes of hex at text, which must end there
+static bool parseHex(const char* text, char terminator, uint8_t* out, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        int high = hexValue(text[i * 2]);
+        int low = high < 0 ? -1 : hexValue(text[i * 2 + 1]);
+        if (low < 0) {
+            return false;
+        }
+        out[i] = (high << 4) | low;
+    }
+    return text[length * 2] == terminator;
+}
+
+// Splits a stored verifier into its parameters
+static bool parseVerifier(const String& stored, uint32_t& iterations, uint8_t* salt, uint8_t* key) {
+    const char* text = stored.c_str();
+    size_t prefixLength = strlen(SEED_KDF_PREFIX);
+    if (strncmp(text, SEED_KDF_PREFIX, prefixLength) != 0) {
+        return false;
+    }
+    text += prefixLength;
+
+    char* end;
+    unsigned long count = strtoul(text, &end, 10);
+    if (end == text || *end != '$' || count < 1 || count > SEED_KDF_MAX_ITERATIONS) {
+        return false;
+    }
+    iterations = count;
+    text = end + 1;
+
+    if (!parseHex(text, '$', salt, SEED_KDF_SALT_BYTES)) {
+        return false;
+    }
+    text += SEED_KDF_SALT_BYTES * 2 + 1;
+    return parseHex(text, '\0', key, SEED_KDF_KEY_BYTES);
+}
+
+uint32_t seedKdfCalibrate(uint32_t targetMs) {
+    uint8_t salt[SEED_KDF_SALT_BYTES];
+    uint8_t key[SEED_KDF_KEY_BYTES];
+    memset(salt, 0, sizeof(salt));
+
+    unsigned long start = micros();
+    if (!derive("calibration", salt, SEED_KDF_PROBE_ITERATIONS, key)) {
+        return SEED_KDF_MIN_ITERATIONS;
+    }
+    unsigned long elapsed = micros() - start;
+    if (elapsed == 0) {
+        elapsed = 1;
+    }
+
+    uint64_t iterations = (uint64_t)SEED_KDF_PROBE_ITERATIONS * targetMs * 1000 / elapsed;
+    if (iterations < SEED_KDF_MIN_ITERATIONS) {
+        return SEED_KDF_MIN_ITERATIONS;
+    }
+    if (iterations > SEED_KDF_MAX_ITERATIONS) {
+        return SEED_KDF_MAX_ITERATIONS;
+    }
+    return iterations;
+}
+
+bool seedKdfHash(const String& phrase, uint32_t iterations, String& out) {
+    uint8_t salt[SEED_KDF_SALT_BYTES];
+    uint8_t key[SEED_KDF_KEY_BYTES];
+    esp_fill_random(salt, sizeof(salt));
+    if (!derive(phrase, salt, iterations, key)) {
+        return false;
+    }
+
+    out = SEED_KDF_PREFIX;
+    out += iterations;
+    out += '$';
+    appendHex(out, salt, sizeof(salt));
+    out += '$';
+    appendHex(out, key, sizeof(key));
+    mbedtls_platform_zeroize(key, sizeof(key));
+    return true;
+}
+
+bool seedKdfVerify(const String& phrase, const String& stored) {
+    uint32_t iterations;
+    uint8_t salt[SEED_KDF_SALT_BYTES];
+    uint8_t expected[SEED_KDF_KEY_BYTES];
+    if (parseVerifier(stored, iterations, salt, expected)) {
+        uint8_t key[SEED_KDF_KEY_BYTES];
+        bool match = derive(phrase, salt, iterations, key) && seedKdfEqual(key, expected, sizeof(key));
+        mbedtls_platform_zeroize(key, sizeof(key));
+        return match;
+    }
+    if (stored.startsWith(SEED_KDF_PREFIX)) {
+        return false;
+    }
+
+    // Legacy record: the phrase's characters in hex, as written before the
+    // KDF. Accepted so the first login after the update can rehash it.
+    String legacy;
+    legacy.reserve(phrase.length() * 2);
+    for (size_t i = 0; i < phrase.length(); i++) {
+        legacy += String((int)phrase[i], HEX);
+    }
+    bool match = legacy.length() == stored.length() &&
+                 seedKdfEqual((const uint8_t*)legacy.c_str(), (const uint8_t*)stored.c_str(), legacy.length());
+    mbedtls_platform_zeroize((void*)legacy.c_str(), legacy.length());
+    return match;
+}
+
+uint32_t seedKdfIterations(const String& stored) {
+    uint32_t iterations;
+    uint8_t salt[SEED_KDF_SALT_BYTES];
+    uint8_t key[SEED_KDF_KEY_BYTES];
+    return parseVerifier(stored, iterations, salt, key) ? iterations : 0;
+}
+
+bool seedKdfEqual(const uint8_t* a, const uint8_t* b, size_t length) {
+    volatile uint8_t difference = 0;
+    for (size_t i = 0; i < length; i++) {
+        difference |= a[i] ^ b[i];
+    }
+    return difference == 0;
+}
@@ -0,0 +1,36 @@
+#ifndef SEEDHASH_H
+#define SEEDHASH_H
+
+#include <Arduino.h>
+
+// Seed phrase verifier: PBKDF2-HMAC-SHA256 over the normalized phrase with
+// a random salt. The stored form carries its own parameters,
+//   pbkdf2$<iterations>$<salt hex>$<key hex>
+// so records keep verifying after the calibrated count changes.
+#define SEED_KDF_PREFIX             "pbkdf2$"
+#define SEED_KDF_SALT_BYTES         16
+#define SEED_KDF_KEY_BYTES          32
+#define SEED_KDF_TARGET_MS          250     // Verification latency calibrated for
+#define SEED_KDF_PROBE_ITERATIONS   2048    // Timed run used to calibrate
+#define SEED_KDF_MIN_ITERATIONS     10000   // Floor however slow the probe was
+#define SEED_KDF_MAX_ITERATIONS     1000000
+
+// Iteration count that takes about targetMs on this chip, clamped to the
+// limits above. Runs for a few tens of milliseconds.
+uint32_t seedKdfCalibrate(uint32_t targetMs);
+
+// Derives a verifier for phrase with a fresh salt; false if the KDF failed
+bool seedKdfHash(const String& phrase, uint32_t iterations, String& out);
+
+// Checks phrase against a stored verifier in constant time. Records from
+// before the KDF (hex of the phrase) are still accepted.
+bool seedKdfVerify(const String& phrase, const String& stored);
+
+// Iterations of a stored verifier, 0 for a legacy or unreadable one
+uint32_t seedKdfIterations(const String& stored);
+
+// Compares without an early exit, so timing shows nothing about where
+// the inputs differ
+bool seedKdfEqual(const uint8_t* a, const uint8_t* b, size_t length);
+
+#endif // SEEDHASH_H
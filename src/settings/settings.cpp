@@ -1,42 +1,240 @@
 #include "settings.h"
+#include "../utils/stateversion.h"
+#include "../utils/log.h"
+#include "../utils/utils.h"
+#include "../utils/jobs.h"
+#include "fields.h"
+#include "wordlists.h"
+#include "seedhash.h"
 
 // Global instance
 SettingsManager settings;
 
+// Config layout 1 stored JSON, either in SETTINGS_FILE or one file per
+// category (indexed by SettingsCategory) plus a JSON backup
+static const char* const LEGACY_JSON_FILES[SETTINGS_CATEGORY_COUNT] = {
+    "/wifi.json", "/wallet.json", "/cold.json", "/display.json", "/power.json", "/system.json"
+};
+#define LEGACY_JSON_BACKUP  "/config_backup.json"
+
+// Config version stored as tag 0 of every binary record
+#define TLV_TAG_SCHEMA  0
+
+static bool isHttpUrl(const String& url) {
+    return url.startsWith("http://") || url.startsWith("https://");
+}
+
+// Settings schema, one row per field. Tags are part of the on-flash format:
+// never renumber or reuse one, give new fields the next free tag.
+static constexpr FieldDescriptor<WiFiSettings> WIFI_FIELDS[] = {
+    // key                  tag  member                                  default, range
+    { "ssid",               1,  &WiFiSettings::ssid,                    "", 1, 32 },
+    { "password",           2,  &WiFiSettings::password,                "", 8, 64 },
+    { "autoConnect",        3,  &WiFiSettings::autoConnect,             true },
+    { "hostname",           4,  &WiFiSettings::hostname,                "hodlinghog", 1, 32, FIELD_REQUIRED },
+    { "connectionTimeout",  5,  &WiFiSettings::connectionTimeout,       30, 5, 120 },
+    { "enableAP",           6,  &WiFiSettings::enableAP,                true },
+    { "apSSID",             7,  &WiFiSettings::apSSID,                  "HodlingHog-Config", 1, 32, FIELD_REQUIRED },
+    { "apPassword",         8,  &WiFiSettings::apPassword,              "hodling123", 8, 64 },
+};
+
+static constexpr FieldDescriptor<LightningSettings> LIGHTNING_FIELDS[] = {
+    { "apiToken",           1,  &LightningSettings::apiToken,           "", 11, 256 },
+    { "apiSecret",          2,  &LightningSettings::apiSecret,          "", 1, 128 },
+    { "baseUrl",            3,  &LightningSettings::baseUrl,            "https://api.getalby.com", 8, 128, FIELD_REQUIRED, isHttpUrl },
+    { "receiveAddress",     4,  &LightningSettings::receiveAddress,     "", 3, 128 },
+    { "walletCreated",      5,  &LightningSettings::walletCreated,      false },
+    { "autoUpdate",         6,  &LightningSettings::autoUpdate,         true },
+    { "updateInterval",     7,  &LightningSettings::updateInterval,     DEFAULT_UPDATE_INTERVAL, MIN_TIMEOUT, MAX_TIMEOUT },
+    { "enableTransfers",    8,  &LightningSettings::enableTransfers,    true },
+    { "maxTransferAmount",  9,  &LightningSettings::maxTransferAmount,  1000000, 0, MAX_SATS },
+};
+
+static constexpr FieldDescriptor<ColdStorageSettings> COLD_STORAGE_FIELDS[] = {
+    { "watchAddress",       1,  &ColdStorageSettings::watchAddress,     "", 26, 256 },
+    { "apiEndpoint",        2,  &ColdStorageSettings::apiEndpoint,      "https://blockstream.info/api", 8, 128, FIELD_REQUIRED, isHttpUrl },
+    { "autoUpdate",         3,  &ColdStorageSettings::autoUpdate,       true },
+    { "updateInterval",     4,  &ColdStorageSettings::updateInterval,   DEFAULT_UPDATE_INTERVAL, MIN_TIMEOUT, MAX_TIMEOUT },
+    { "privateKey",         5,  &ColdStorageSettings::privateKey,       "", 1, 256 },
+    { "enableSigning",      6,  &ColdStorageSettings::enableSigning,    false },
+    { "defaultFeeRate",     7,  &ColdStorageSettings::defaultFeeRate,   10, 1, 1000 },     // sat/vB
+};
+
+static constexpr FieldDescriptor<DisplaySettings> DISPLAY_FIELDS[] = {
+    { "brightness",         1,  &DisplaySettings::brightness,           DEFAULT_DISPLAY_BRIGHTNESS, 0, 255 },
+    { "fastUpdate",         2,  &DisplaySettings::fastUpdate,           false },
+    { "screenTimeout",      3,  &DisplaySettings::screenTimeout,        DEFAULT_SLEEP_TIMEOUT, MIN_TIMEOUT, MAX_TIMEOUT },
+    { "defaultScreen",      4,  &DisplaySettings::defaultScreen,        "lightning", 1, 16, FIELD_REQUIRED },
+    { "showStatusBar",      5,  &DisplaySettings::showStatusBar,        true },
+    { "showQRCodes",        6,  &DisplaySettings::showQRCodes,          true },
+    { "qrCodeSize",         7,  &DisplaySettings::qrCodeSize,           2, 1, 8 },
+    { "enableAnimations",   8,  &DisplaySettings::enableAnimations,     false },
+};
+
+static constexpr FieldDescriptor<PowerSettings> POWER_FIELDS[] = {
+    { "sleepTimeout",       1,  &PowerSettings::sleepTimeout,           DEFAULT_SLEEP_TIMEOUT, MIN_TIMEOUT, MAX_TIMEOUT },
+    { "enableDeepSleep",    2,  &PowerSettings::enableDeepSleep,        true },
+    { "wakeOnButton",       3,  &PowerSettings::wakeOnButton,           true },
+    { "wakeOnTilt",         4,  &PowerSettings::wakeOnTilt,             true },
+    { "batteryWarningLevel", 5, &PowerSettings::batteryWarningLevel,    20, 0, 100 },    // Percent
+    { "enablePowerSaving",  6,  &PowerSettings::enablePowerSaving,      true },
+    { "updateInterval",     7,  &PowerSettings::updateInterval,         DEFAULT_UPDATE_INTERVAL, MIN_TIMEOUT, MAX_TIMEOUT },
+};
+
+// Tags 9 and 10 of the system record belong to METADATA_FIELDS
+static constexpr FieldDescriptor<SystemSettings> SYSTEM_FIELDS[] = {
+    { "deviceName",         1,  &SystemSettings::deviceName,            "Hodling Hog", 1, 31, FIELD_REQUIRED },
+    { "timezone",           2,  &SystemSettings::timezone,              "UTC", 1, 64, FIELD_REQUIRED },
+    { "seedPhraseHash",     3,  &SystemSettings::seedPhraseHash,        "", 1, 160 },
+    { "requireSeedAuth",    4,  &SystemSettings::requireSeedAuth,       false },
+    { "maxLoginAttempts",   5,  &SystemSettings::maxLoginAttempts,      DEFAULT_MAX_LOGIN_ATTEMPTS, 1, 100 },
+    { "lockoutDuration",    6,  &SystemSettings::lockoutDuration,       DEFAULT_LOCKOUT_DURATION, 0, 86400 },   // Seconds
+    // Tags 7 and 8 held the login counters, now in NVS
+    { "enableLogging",      11, &SystemSettings::enableLogging,         true },
+    { "logLevel",           12, &SystemSettings::logLevel,              LOG_LEVEL_INFO, LOG_LEVEL_NONE, LOG_LEVEL_DEBUG },
+    { "enableOTA",          13, &SystemSettings::enableOTA,             true },
+    { "ntpServer",          14, &SystemSettings::ntpServer,             "pool.ntp.org", 1, 64, FIELD_REQUIRED },
+    { "heartbeatInterval",  15, &SystemSettings::heartbeatInterval,     60000, MIN_TIMEOUT, MAX_TIMEOUT },
+    { "enableWatchdog",     16, &SystemSettings::enableWatchdog,        true },
+};
+
+// Stored with the system category; defaults are computed in setDefaults()
+static constexpr FieldDescriptor<HodlingHogConfig> METADATA_FIELDS[] = {
+    { "version",            9,  &HodlingHogConfig::version,             "", 1, 16 },
+    { "lastModified",       10, &HodlingHogConfig::lastModified,        0, 0, UINT32_MAX },
+};
+
+// JSON section names, indexed by SettingsCategory
+static const char* const JSON_SECTIONS[SETTINGS_CATEGORY_COUNT] = {
+    "wifi", "lightning", "coldStorage", "display", "power", "system"
+};
+
+// Background save posted by the write-behind window
+static bool jobFlushSettings() {
+    return settings.saveConfig();
+}
+
+// Calls visit(table, settings) for one category; Config may be const for
+// visitors that only read
+template <typename Config, typename Visitor>
+static bool visitCategory(Config& config, SettingsCategory category, Visitor& visit) {
+    switch (category) {
+        case SettingsCategory::WIFI: visit(WIFI_FIELDS, config.wifi); return true;
+        case SettingsCategory::LIGHTNING: visit(LIGHTNING_FIELDS, config.lightning); return true;
+        case SettingsCategory::COLD_STORAGE: visit(COLD_STORAGE_FIELDS, config.coldStorage); return true;
+        case SettingsCategory::DISPLAY_SETTINGS: visit(DISPLAY_FIELDS, config.display); return true;
+        case SettingsCategory::POWER: visit(POWER_FIELDS, config.power); return true;
+        case SettingsCategory::SYSTEM: visit(SYSTEM_FIELDS, config.system); return true;
+        default: return false;
+    }
+}
+
 SettingsManager::SettingsManager() {
+    editLock = xSemaphoreCreateRecursiveMutex();
+    saveLock = xSemaphoreCreateRecursiveMutex();
+    editDepth = 0;
+    unpublished = false;
     initialized = false;
-    configChanged = false;
+    dirtyCategories = 0;
+    dirtySince = 0;
+    writeDelay = SETTINGS_WRITE_DELAY;
+    countersOpen = false;
+    kdfIterations = SEED_KDF_MIN_ITERATIONS;
+    memset(&stats, 0, sizeof(stats));
+    lastBackup = 0;
+    published.publish(config);
+}
+
+SettingsManager::Edit::Edit(SettingsManager& manager) : manager(manager) {
+    xSemaphoreTakeRecursive(manager.editLock, portMAX_DELAY);
+    manager.editDepth++;
+}
+
+SettingsManager::Edit::~Edit() {
+    if (--manager.editDepth == 0 && manager.unpublished) {
+        manager.publish();
+    }
+    xSemaphoreGiveRecursive(manager.editLock);
+}
+
+SettingsManager::Save::Save(SettingsManager& manager) : manager(manager) {
+    xSemaphoreTakeRecursive(manager.saveLock, portMAX_DELAY);
+}
+
+SettingsManager::Save::~Save() {
+    xSemaphoreGiveRecursive(manager.saveLock);
+}
+
+ConfigSnapshot SettingsManager::getConfig() const {
+    return published.get();
 }
 
 bool SettingsManager::init() {
-    Serial.println("SettingsManager: Initializing");
+    LOG_I(SETTINGS, "SettingsManager: Initializing\n");
     
     if (!LittleFS.begin(true)) {
         setError("Failed to mount LittleFS");
         return false;
     }
     
+    Edit edit(*this);
     setDefaults();
+    loadCounters();
+    loadKdfIterations();
     initialized = true;
-    configChanged = false;
+    dirtyCategories = 0;
     
-    Serial.println("SettingsManager: Initialization complete");
+    LOG_I(SETTINGS, "SettingsManager: Initialization complete\n");
     return true;
 }
 
 bool SettingsManager::formatFileSystem() {
-    Serial.println("SettingsManager: Formatting file system");
+    LOG_I(SETTINGS, "SettingsManager: Formatting file system\n");
     return LittleFS.format();
 }
 
 bool SettingsManager::backupSettings() {
-    Serial.println("SettingsManager: Backing up settings");
-    return true; // Stub
+    LOG_I(SETTINGS, "SettingsManager: Backing up settings\n");
+    Save save(*this);
+    
+    // All categories in one record, each nested under its category number
+    uint8_t* buffer = (uint8_t*)malloc(SETTINGS_RECORD_MAX);
+    uint8_t* section = (uint8_t*)malloc(SETTINGS_TLV_MAX);
+    if (!buffer || !section) {
+        free(buffer);
+        free(section);
+        return false;
+    }
+    
+    ConfigSnapshot source = getConfig();
+    TlvWriter out(buffer, SETTINGS_RECORD_MAX);
+    for (int i = 0; i < SETTINGS_CATEGORY_COUNT; i++) {
+        size_t length = encodeCategory(*source, (SettingsCategory)i, section, SETTINGS_TLV_MAX);
+        out.putBytes(i, section, length);
+    }
+    
+    bool success = !out.overflow() && writeRecord(BACKUP_SETTINGS, buffer, out.length());
+    free(buffer);
+    free(section);
+    
+    if (success) {
+        lastBackup = millis();
+    }
+    return success;
 }
 
 bool SettingsManager::restoreFromBackup() {
-    Serial.println("SettingsManager: Restoring from backup");
-    return true; // Stub
+    LOG_I(SETTINGS, "SettingsManager: Restoring from backup\n");
+    
+    Save save(*this);
+    Edit edit(*this);
+    if (!loadBackup(categoryBit(SettingsCategory::ALL))) {
+        setError("No usable settings backup");
+        return false;
+    }
+    
+    markChanged();
+    return saveConfig();
 }
 
 size_t SettingsManager::getUsedSpace() {
@@ -48,307 +246,269 @@ size_t SettingsManager::getTotalSpace() {
 }
 
 bool SettingsManager::loadConfig() {
-    Serial.println("SettingsManager: Loading configuration");
+    LOG_I(SETTINGS, "SettingsManager: Loading configuration\n");
+    unsigned long start = micros();
+    Save save(*this);
+    Edit edit(*this);
     
-    if (!fileExists(SETTINGS_FILE)) {
-        Serial.println("SettingsManager: No config file found, using defaults");
-        setDefaults();
-        return false;
-    }
+    // Leftovers from a write cut off before its rename
+    removeTempFiles();
     
-    // Try to load actual config file
-    File configFile = LittleFS.open(SETTINGS_FILE, "r");
-    if (!configFile) {
-        Serial.println("SettingsManager: Failed to open config file");
-        setDefaults();
-        return false;
+    // Devices upgraded from a JSON layout have no binary records yet
+    if (!fileExists(SYSTEM_SETTINGS) &&
+        (fileExists(SETTINGS_FILE) || fileExists(LEGACY_JSON_FILES[(int)SettingsCategory::SYSTEM]))) {
+        bool migrated = migrateConfig(1, getCurrentConfigVersion());
+        stats.loadUs = micros() - start;
+        return migrated;
     }
     
-    // Read JSON from file
-    String jsonString = configFile.readString();
-    configFile.close();
+    dirtyCategories = 0;
+    uint8_t missing = 0;
+    int loaded = 0;
+    for (int i = 0; i < SETTINGS_CATEGORY_COUNT; i++) {
+        SettingsCategory category = (SettingsCategory)i;
+        if (loadCategory(category)) {
+            loaded++;
+        } else {
+            missing |= categoryBit(category);
+        }
+    }
     
-    if (jsonString.length() == 0) {
-        Serial.println("SettingsManager: Config file is empty");
-        setDefaults();
-        return false;
+    // Fill missing or corrupt categories from the last full backup and
+    // write them back, so the seed hash survives a damaged file
+    if (missing && fileExists(BACKUP_SETTINGS)) {
+        uint8_t restored = loadBackup(missing);
+        if (restored) {
+            dirtyCategories |= restored;
+            stats.recovered += __builtin_popcount(restored);
+            loaded += __builtin_popcount(restored);
+            LOG_W(SETTINGS, "SettingsManager: Recovered categories 0x%02x from backup\n", restored);
+            saveConfig();
+        }
     }
     
-    // Parse JSON
-    JsonDocument doc;
-    DeserializationError error = deserializeJson(doc, jsonString);
+    stats.loadUs = micros() - start;
     
-    if (error) {
-        Serial.printf("SettingsManager: JSON parsing failed: %s\n", error.c_str());
+    if (loaded == 0) {
+        LOG_I(SETTINGS, "SettingsManager: No config files found, using defaults\n");
         setDefaults();
         return false;
     }
     
-    // Load system settings (especially seed phrase data)  
-    if (doc["system"].is<JsonObject>()) {
-        JsonObject systemObj = doc["system"];
-        if (!systemObj["seedPhraseHash"].isNull()) {
-            config.system.seedPhraseHash = systemObj["seedPhraseHash"].as<String>();
-        }
-        if (!systemObj["requireSeedAuth"].isNull()) {
-            config.system.requireSeedAuth = systemObj["requireSeedAuth"].as<bool>();
-        }
-        if (!systemObj["failedLoginCount"].isNull()) {
-            config.system.failedLoginCount = systemObj["failedLoginCount"].as<int>();
-        }
-        if (!systemObj["lastFailedLogin"].isNull()) {
-            config.system.lastFailedLogin = systemObj["lastFailedLogin"].as<unsigned long>();
-        }
-    }
-    
-    // Load cold storage settings
-    if (doc["coldStorage"].is<JsonObject>()) {
-        JsonObject coldObj = doc["coldStorage"];
-        if (!coldObj["watchAddress"].isNull()) {
-            config.coldStorage.watchAddress = coldObj["watchAddress"].as<String>();
-        }
-        if (!coldObj["apiEndpoint"].isNull()) {
-            config.coldStorage.apiEndpoint = coldObj["apiEndpoint"].as<String>();
+    LOG_I(SETTINGS, "SettingsManager: Configuration loaded (%d/%d categories in %lu us). Seed phrase set: %s\n", 
+                    loaded, SETTINGS_CATEGORY_COUNT, (unsigned long)stats.loadUs, isSeedPhraseSet() ? "YES" : "NO");
+    return true;
+}
+
+bool SettingsManager::saveConfig() {
+    // Claim the dirty categories and publish the draft, then write the
+    // snapshot without holding writers up for the flash I/O. Other saves
+    // wait until this one has renamed its last file.
+    Save save(*this);
+    ConfigSnapshot source;
+    uint8_t categories;
+    {
+        Edit edit(*this);
+        if (dirtyCategories == 0) {
+            LOG_D(SETTINGS, "SettingsManager: No changes to save\n");
+            return true;
         }
+        
+        LOG_I(SETTINGS, "SettingsManager: Saving configuration (dirty 0x%02x)\n", dirtyCategories);
+        
+        // Update metadata (written with the system category)
+        config.lastModified = getCurrentTimestamp();
+        config.configVersion = getCurrentConfigVersion();
+        publish();
+        
+        source = getConfig();
+        categories = dirtyCategories;
+        dirtyCategories = 0;
     }
     
-    // Load WiFi settings
-    if (doc["wifi"].is<JsonObject>()) {
-        JsonObject wifiObj = doc["wifi"];
-        if (!wifiObj["ssid"].isNull()) {
-            config.wifi.ssid = wifiObj["ssid"].as<String>();
-        }
-        if (!wifiObj["password"].isNull()) {
-            config.wifi.password = wifiObj["password"].as<String>();
+    uint32_t bytesBefore = stats.bytesWritten;
+    uint8_t failed = 0;
+    for (int i = 0; i < SETTINGS_CATEGORY_COUNT; i++) {
+        SettingsCategory category = (SettingsCategory)i;
+        if ((categories & categoryBit(category)) && !writeCategory(*source, category)) {
+            failed |= categoryBit(category);
         }
     }
     
-    // Load Lightning settings
-    if (doc["lightning"].is<JsonObject>()) {
-        JsonObject lightningObj = doc["lightning"];
-        if (!lightningObj["apiToken"].isNull()) {
-            config.lightning.apiToken = lightningObj["apiToken"].as<String>();
-        }
-        if (!lightningObj["apiSecret"].isNull()) {
-            config.lightning.apiSecret = lightningObj["apiSecret"].as<String>();
-        }
-        if (!lightningObj["baseUrl"].isNull()) {
-            config.lightning.baseUrl = lightningObj["baseUrl"].as<String>();
-        }
-        if (!lightningObj["receiveAddress"].isNull()) {
-            config.lightning.receiveAddress = lightningObj["receiveAddress"].as<String>();
-        }
-        if (!lightningObj["walletCreated"].isNull()) {
-            config.lightning.walletCreated = lightningObj["walletCreated"].as<bool>();
-        }
+    // Failed categories are retried by the next save
+    bool success = failed == 0;
+    if (!success) {
+        Edit edit(*this);
+        markUnsaved(failed);
     }
     
-    // Load Power settings
-    if (doc["power"].is<JsonObject>()) {
-        JsonObject powerObj = doc["power"];
-        if (!powerObj["sleepTimeout"].isNull()) {
-            config.power.sleepTimeout = powerObj["sleepTimeout"].as<uint32_t>();
-        }
-        if (!powerObj["enableDeepSleep"].isNull()) {
-            config.power.enableDeepSleep = powerObj["enableDeepSleep"].as<bool>();
-        }
-        if (!powerObj["wakeOnButton"].isNull()) {
-            config.power.wakeOnButton = powerObj["wakeOnButton"].as<bool>();
-        }
-        if (!powerObj["wakeOnTilt"].isNull()) {
-            config.power.wakeOnTilt = powerObj["wakeOnTilt"].as<bool>();
-        }
-        if (!powerObj["batteryWarningLevel"].isNull()) {
-            config.power.batteryWarningLevel = powerObj["batteryWarningLevel"].as<uint8_t>();
-        }
-        if (!powerObj["enablePowerSaving"].isNull()) {
-            config.power.enablePowerSaving = powerObj["enablePowerSaving"].as<bool>();
-        }
-        if (!powerObj["updateInterval"].isNull()) {
-            config.power.updateInterval = powerObj["updateInterval"].as<uint32_t>();
-        }
+    // The backup trails the live files by at most SETTINGS_BACKUP_INTERVAL
+    if (success && (lastBackup == 0 || millis() - lastBackup > SETTINGS_BACKUP_INTERVAL)) {
+        backupSettings();
     }
     
-    configChanged = false;
-    Serial.printf("SettingsManager: Configuration loaded successfully. Seed phrase set: %s\n", 
-                  isSeedPhraseSet() ? "YES" : "NO");
-    return true;
+    stats.saves++;
+    stats.lastSaveBytes = stats.bytesWritten - bytesBefore;
+    LOG_I(SETTINGS, "SettingsManager: Configuration saved (%u bytes). Seed phrase set: %s\n", 
+                    stats.lastSaveBytes, isSeedPhraseSet() ? "YES" : "NO");
+    return success;
 }
 
-bool SettingsManager::saveConfig() {
-    Serial.println("SettingsManager: Saving configuration");
-    
-    // Update metadata
-    config.lastModified = getCurrentTimestamp();
-    config.configVersion = getCurrentConfigVersion();
-    
-    // Create JSON document
-    JsonDocument doc;
-    
-    // System settings (most critical - seed phrase data)
-    JsonObject systemObj = doc.createNestedObject("system");
-    systemObj["deviceName"] = config.system.deviceName;
-    systemObj["timezone"] = config.system.timezone;
-    systemObj["seedPhraseHash"] = config.system.seedPhraseHash;
-    systemObj["requireSeedAuth"] = config.system.requireSeedAuth;
-    systemObj["maxLoginAttempts"] = config.system.maxLoginAttempts;
-    systemObj["lockoutDuration"] = config.system.lockoutDuration;
-    systemObj["failedLoginCount"] = config.system.failedLoginCount;
-    systemObj["lastFailedLogin"] = config.system.lastFailedLogin;
-    
-    // Cold storage settings
-    JsonObject coldObj = doc.createNestedObject("coldStorage");
-    coldObj["watchAddress"] = config.coldStorage.watchAddress;
-    coldObj["apiEndpoint"] = config.coldStorage.apiEndpoint;
-    coldObj["autoUpdate"] = config.coldStorage.autoUpdate;
-    coldObj["updateInterval"] = config.coldStorage.updateInterval;
-    
-    // WiFi settings
-    JsonObject wifiObj = doc.createNestedObject("wifi");
-    wifiObj["ssid"] = config.wifi.ssid;
-    wifiObj["password"] = config.wifi.password;
-    wifiObj["autoConnect"] = config.wifi.autoConnect;
-    wifiObj["hostname"] = config.wifi.hostname;
-    
-    // Lightning settings
-    JsonObject lightningObj = doc.createNestedObject("lightning");
-    lightningObj["apiToken"] = config.lightning.apiToken;
-    lightningObj["apiSecret"] = config.lightning.apiSecret;
-    lightningObj["baseUrl"] = config.lightning.baseUrl;
-    lightningObj["receiveAddress"] = config.lightning.receiveAddress;
-    lightningObj["walletCreated"] = config.lightning.walletCreated;
-    lightningObj["autoUpdate"] = config.lightning.autoUpdate;
-    lightningObj["updateInterval"] = config.lightning.updateInterval;
-    
-    // Power settings
-    JsonObject powerObj = doc.createNestedObject("power");
-    powerObj["sleepTimeout"] = config.power.sleepTimeout;
-    powerObj["enableDeepSleep"] = config.power.enableDeepSleep;
-    powerObj["wakeOnButton"] = config.power.wakeOnButton;
-    powerObj["wakeOnTilt"] = config.power.wakeOnTilt;
-    powerObj["batteryWarningLevel"] = config.power.batteryWarningLevel;
-    powerObj["enablePowerSaving"] = config.power.enablePowerSaving;
-    powerObj["updateInterval"] = config.power.updateInterval;
-    
-    // Metadata
-    doc["version"] = config.version;
-    doc["lastModified"] = config.lastModified;
-    doc["configVersion"] = config.configVersion;
-    
-    // Write to file
-    File configFile = LittleFS.open(SETTINGS_FILE, "w");
-    if (!configFile) {
-        Serial.println("SettingsManager: Failed to open config file for writing");
-        return false;
+void SettingsManager::loop() {
+    if (dirtyCategories == 0 || millis() - dirtySince < writeDelay) {
+        return;
     }
     
-    size_t bytesWritten = serializeJson(doc, configFile);
-    configFile.close();
-    
-    if (bytesWritten == 0) {
-        Serial.println("SettingsManager: Failed to write config data");
-        return false;
+    // Saves run on the job worker so they never overlap the ones web
+    // handlers post; restart the window so a full queue is retried later
+    dirtySince = millis();
+    if (jobs.post("settings-flush", jobFlushSettings)) {
+        stats.deferredSaves++;
     }
-    
-    configChanged = false;
-    Serial.printf("SettingsManager: Configuration saved successfully (%d bytes). Seed phrase set: %s\n", 
-                  bytesWritten, isSeedPhraseSet() ? "YES" : "NO");
-    return true;
+}
+
+bool SettingsManager::flush() {
+    unsigned long start = millis();
+    while (jobs.getPending() > 0 && millis() - start < SETTINGS_FLUSH_TIMEOUT) {
+        delay(10);
+    }
+    return saveConfig();
 }
 
 bool SettingsManager::resetToDefaults() {
-    Serial.println("SettingsManager: Resetting to defaults");
+    LOG_I(SETTINGS, "SettingsManager: Resetting to defaults\n");
+    Save save(*this);
+    Edit edit(*this);
     setDefaults();
-    configChanged = true;
+    markChanged();
     return saveConfig();
 }
 
 bool SettingsManager::isConfigValid() {
-    return validateWiFiSettings(config.wifi) &&
-           validateLightningSettings(config.lightning) &&
-           validateColdStorageSettings(config.coldStorage) &&
-           validateDisplaySettings(config.display) &&
-           validatePowerSettings(config.power) &&
-           validateSystemSettings(config.system);
+    ConfigSnapshot current = getConfig();
+    for (int i = 0; i < SETTINGS_CATEGORY_COUNT; i++) {
+        FieldValidator validator = { nullptr };
+        visitCategory(*current, (SettingsCategory)i, validator);
+        if (validator.invalid) {
+            LOG_W(SETTINGS, "SettingsManager: Invalid %s.%s\n", JSON_SECTIONS[i], validator.invalid);
+            return false;
+        }
+    }
+    return true;
 }
 
 bool SettingsManager::loadCategory(SettingsCategory category) {
-    Serial.printf("SettingsManager: Loading category %d\n", (int)category);
-    return true; // Stub
+    if (category == SettingsCategory::ALL) {
+        return loadConfig();
+    }
+    
+    size_t length;
+    uint8_t* data = readRecord(getFilePath(category), length);
+    if (!data) {
+        return false;
+    }
+    
+    Edit edit(*this);
+    bool success = decodeCategory(category, data, length);
+    free(data);
+    return success;
 }
 
 bool SettingsManager::saveCategory(SettingsCategory category) {
-    Serial.printf("SettingsManager: Saving category %d\n", (int)category);
-    return true; // Stub
+    Save save(*this);
+    if (category == SettingsCategory::ALL) {
+        {
+            Edit edit(*this);
+            markUnsaved(categoryBit(category));
+        }
+        return saveConfig();
+    }
+    
+    ConfigSnapshot source;
+    {
+        Edit edit(*this);
+        if (unpublished) {
+            publish();
+        }
+        source = getConfig();
+        dirtyCategories &= ~categoryBit(category);
+    }
+    
+    if (!writeCategory(*source, category)) {
+        Edit edit(*this);
+        markUnsaved(categoryBit(category));
+        return false;
+    }
+    return true;
+}
+
+bool SettingsManager::writeCategory(const HodlingHogConfig& source, SettingsCategory category) {
+    uint8_t* buffer = (uint8_t*)malloc(SETTINGS_TLV_MAX);
+    if (!buffer) {
+        return false;
+    }
+    
+    size_t length = encodeCategory(source, category, buffer, SETTINGS_TLV_MAX);
+    bool success = length > 0 && writeRecord(getFilePath(category), buffer, length);
+    free(buffer);
+    return success;
 }
 
 bool SettingsManager::resetCategory(SettingsCategory category) {
-    Serial.printf("SettingsManager: Resetting category %d\n", (int)category);
+    LOG_I(SETTINGS, "SettingsManager: Resetting category %d\n", (int)category);
     
-    switch (category) {
-        case SettingsCategory::WIFI:
-            setDefaultWiFi();
-            break;
-        case SettingsCategory::LIGHTNING:
-            setDefaultLightning();
-            break;
-        case SettingsCategory::COLD_STORAGE:
-            setDefaultColdStorage();
-            break;
-        case SettingsCategory::DISPLAY_SETTINGS:
-            setDefaultDisplay();
-            break;
-        case SettingsCategory::POWER:
-            setDefaultPower();
-            break;
-        case SettingsCategory::SYSTEM:
-            setDefaultSystem();
-            break;
-        default:
-            return false;
+    Edit edit(*this);
+    FieldDefaults defaults;
+    if (!visitCategory(config, category, defaults)) {
+        return false;
     }
     
-    configChanged = true;
+    markChanged(category);
     return true;
 }
 
 // Setting modification methods
 bool SettingsManager::setWiFiCredentials(const String& ssid, const String& password) {
+    Edit edit(*this);
     config.wifi.ssid = ssid;
     config.wifi.password = password;
-    configChanged = true;
-    Serial.printf("SettingsManager: WiFi credentials updated - SSID: %s\n", ssid.c_str());
+    markChanged(SettingsCategory::WIFI);
+    LOG_I(SETTINGS, "SettingsManager: WiFi credentials updated - SSID: %s\n", ssid.c_str());
     return true;
 }
 
 bool SettingsManager::setLightningToken(const String& token) {
+    Edit edit(*this);
     config.lightning.apiToken = token;
-    configChanged = true;
-    Serial.println("SettingsManager: Lightning API token updated");
+    markChanged(SettingsCategory::LIGHTNING);
+    LOG_I(SETTINGS, "SettingsManager: Lightning API token updated\n");
     return true;
 }
 
 bool SettingsManager::setLightningCredentials(const String& token, const String& secret, const String& address) {
+    Edit edit(*this);
     config.lightning.apiToken = token;
     config.lightning.apiSecret = secret;
     config.lightning.receiveAddress = address;
     config.lightning.walletCreated = true;
-    configChanged = true;
-    Serial.printf("SettingsManager: Lightning wallet credentials updated - Address: %s\n", address.c_str());
+    markChanged(SettingsCategory::LIGHTNING);
+    LOG_I(SETTINGS, "SettingsManager: Lightning wallet credentials updated - Address: %s\n", address.c_str());
     return true;
 }
 
 bool SettingsManager::setLightningWalletCreated(bool created) {
+    Edit edit(*this);
     config.lightning.walletCreated = created;
-    configChanged = true;
-    Serial.printf("SettingsManager: Lightning wallet created status: %s\n", created ? "true" : "false");
+    markChanged(SettingsCategory::LIGHTNING);
+    LOG_I(SETTINGS, "SettingsManager: Lightning wallet created status: %s\n", created ? "true" : "false");
     return true;
 }
 
 bool SettingsManager::setColdStorageAddress(const String& address) {
+    Edit edit(*this);
     config.coldStorage.watchAddress = address;
-    configChanged = true;
-    Serial.printf("SettingsManager: Cold storage address updated - %s\n", address.c_str());
+    markChanged(SettingsCategory::COLD_STORAGE);
+    LOG_I(SETTINGS, "SettingsManager: Cold storage address updated - %s\n", address.c_str());
     return true;
 }
 
@@ -360,15 +520,22 @@ bool SettingsManager::setSeedPhrase(const String& seedPhrase) {
     }
     
     String normalized = normalizeSeedPhrase(seedPhrase);
-    config.system.seedPhraseHash = hashSeedPhrase(normalized);
+    String verifier = hashSeedPhrase(normalized);
+    if (verifier.isEmpty()) {
+        setError("Failed to derive seed phrase verifier");
+        return false;
+    }
+    
+    Edit edit(*this);
+    config.system.seedPhraseHash = verifier;
     config.system.requireSeedAuth = true;
-    configChanged = true;
+    markChanged(SettingsCategory::SYSTEM);
     
-    Serial.println("SettingsManager: Seed phrase authentication configured");
+    LOG_I(SETTINGS, "SettingsManager: Seed phrase authentication configured\n");
     return true;
 }
 
-bool SettingsManager::validateSeedPhrase(const String& seedPhrase) {
+bool SettingsManager::validateSeedPhrase(const String& seedPhrase, bool countFailure) {
     if (!isSeedPhraseSet()) {
         setError("No seed phrase configured");
         return false;
@@ -379,31 +546,54 @@ bool SettingsManager::validateSeedPhrase(const String& seedPhrase) {
         return false;
     }
     
+    // The expensive step, by design; callers mint a session or cache the
+    // credential on success so it runs once per login. It works on the
+    // snapshot, so other writers are not held up meanwhile.
+    String stored = getConfig()->system.seedPhraseHash;
     String normalized = normalizeSeedPhrase(seedPhrase);
-    String inputHash = hashSeedPhrase(normalized);
+    unsigned long start = millis();
+    bool match = seedKdfVerify(normalized, stored);
+    stats.verifyMs = millis() - start;
     
-    if (inputHash == config.system.seedPhraseHash) {
+    if (match) {
         resetLoginAttempts();
-        Serial.println("SettingsManager: Seed phrase validation successful");
+        
+        // Legacy records and ones weaker than this device's calibration are
+        // replaced while the phrase is at hand, unless the phrase changed
+        if (seedKdfIterations(stored) < kdfIterations) {
+            String verifier = hashSeedPhrase(normalized);
+            Edit edit(*this);
+            if (!verifier.isEmpty() && config.system.seedPhraseHash == stored) {
+                config.system.seedPhraseHash = verifier;
+                markChanged(SettingsCategory::SYSTEM);
+                LOG_I(SETTINGS, "SettingsManager: Seed phrase verifier upgraded\n");
+            }
+        }
+        
+        LOG_I(SETTINGS, "SettingsManager: Seed phrase validation successful (%u ms)\n", (unsigned)stats.verifyMs);
         return true;
     } else {
-        recordFailedLogin();
-        Serial.println("SettingsManager: Seed phrase validation failed");
+        if (countFailure) {
+            recordFailedLogin();
+        }
+        LOG_W(SETTINGS, "SettingsManager: Seed phrase validation failed\n");
         return false;
     }
 }
 
 bool SettingsManager::isSeedPhraseSet() const {
-    return !config.system.seedPhraseHash.isEmpty() && config.system.requireSeedAuth;
+    ConfigSnapshot current = getConfig();
+    return !current->system.seedPhraseHash.isEmpty() && current->system.requireSeedAuth;
 }
 
 String SettingsManager::hashSeedPhrase(const String& seedPhrase) {
-    // Simple SHA256 hash implementation for ESP32
-    String hash = "";
-    for (int i = 0; i < seedPhrase.length(); i++) {
-        hash += String((int)seedPhrase[i], HEX);
+    // Empty if the KDF failed
+    String verifier;
+    if (!seedKdfHash(seedPhrase, kdfIterations, verifier)) {
+        LOG_E(SETTINGS, "SettingsManager: PBKDF2 failed\n");
+        return "";
     }
-    return hash;
+    return verifier;
 }
 
 String SettingsManager::normalizeSeedPhrase(const String& seedPhrase) {
@@ -420,137 +610,191 @@ String SettingsManager::normalizeSeedPhrase(const String& seedPhrase) {
 }
 
 bool SettingsManager::isAccountLocked() const {
-    if (config.system.failedLoginCount < config.system.maxLoginAttempts) {
+    ConfigSnapshot current = getConfig();
+    const SystemSettings& system = current->system;
+    if (system.failedLoginCount < system.maxLoginAttempts) {
         return false;
     }
     
-    unsigned long lockoutEnd = config.system.lastFailedLogin + (config.system.lockoutDuration * 1000);
+    unsigned long lockoutEnd = system.lastFailedLogin + (system.lockoutDuration * 1000);
     return millis() < lockoutEnd;
 }
 
 void SettingsManager::recordFailedLogin() {
-    config.system.failedLoginCount++;
+    Edit edit(*this);
+    if (config.system.failedLoginCount < UINT8_MAX) {
+        config.system.failedLoginCount++;
+    }
     config.system.lastFailedLogin = millis();
-    configChanged = true;
+    unpublished = true;
+    saveFailedLogins();
     
-    Serial.printf("SettingsManager: Failed login recorded (%d/%d)\n", 
-                  config.system.failedLoginCount, config.system.maxLoginAttempts);
+    LOG_W(SETTINGS, "SettingsManager: Failed login recorded (%d/%d)\n", 
+                    config.system.failedLoginCount, config.system.maxLoginAttempts);
 }
 
 void SettingsManager::resetLoginAttempts() {
+    Edit edit(*this);
+    if (config.system.failedLoginCount == 0) {
+        return;
+    }
     config.system.failedLoginCount = 0;
     config.system.lastFailedLogin = 0;
-    configChanged = true;
+    unpublished = true;
+    saveFailedLogins();
     
-    Serial.println("SettingsManager: Login attempts reset");
+    LOG_I(SETTINGS, "SettingsManager: Login attempts reset\n");
 }
 
+bool SettingsManager::isValidBIP39Word(const String& word) {
+    char lower[WORD_MAX_LENGTH + 1];
+    const char* cursor = word.c_str();
+    size_t length = nextWord(cursor, lower);
+    return bip39Index(lower, length) >= 0;
+}
+
+bool SettingsManager::isValidBIP39Mnemonic(const String& mnemonic) {
+    return bip39IsValid(mnemonic.c_str());
+}
+
+// Either SEED_PHRASE_WORD_COUNT words from the kid or BIP39 tables, or a
+// complete BIP39 mnemonic with a valid checksum
 bool SettingsManager::isSeedPhraseValid(const String& seedPhrase) {
-    String normalized = normalizeSeedPhrase(seedPhrase);
-    
-    // Split into words
-    std::vector<String> words;
-    int start = 0;
-    int end = normalized.indexOf(' ');
-    
-    while (end != -1) {
-        words.push_back(normalized.substring(start, end));
-        start = end + 1;
-        end = normalized.indexOf(' ', start);
-    }
-    words.push_back(normalized.substring(start));
-    
-    // Check word count
-    if (words.size() != SEED_PHRASE_WORD_COUNT) {
-        Serial.printf("SettingsManager: Invalid word count: %d (expected %d)\n", 
-                      words.size(), SEED_PHRASE_WORD_COUNT);
-        return false;
-    }
-    
-    // Validate each word (simplified - in real implementation would check against BIP39 wordlist)
-    for (const String& word : words) {
-        if (word.length() < 3 || word.length() > 8) {
-            Serial.printf("SettingsManager: Invalid word length: %s\n", word.c_str());
+    char word[WORD_MAX_LENGTH + 1];
+    const char* cursor = seedPhrase.c_str();
+    size_t words = 0;
+    size_t length;
+    while ((length = nextWord(cursor, word)) > 0) {
+        if (kidWordIndex(word, length) < 0 && bip39Index(word, length) < 0) {
+            LOG_W(SETTINGS, "SettingsManager: Unknown word %d in seed phrase\n", (int)words + 1);
             return false;
         }
-        
-        // Check for invalid characters
-        for (int i = 0; i < word.length(); i++) {
-            if (!isalpha(word[i])) {
-                Serial.printf("SettingsManager: Invalid character in word: %s\n", word.c_str());
-                return false;
-            }
-        }
+        words++;
     }
     
-    return true;
+    if (words == SEED_PHRASE_WORD_COUNT || bip39IsValid(seedPhrase.c_str())) {
+        return true;
+    }
+    
+    LOG_W(SETTINGS, "SettingsManager: Invalid word count: %d (expected %d)\n", 
+                    (int)words, SEED_PHRASE_WORD_COUNT);
+    return false;
 }
 
 bool SettingsManager::setPrivateKey(const String& key) {
+    Edit edit(*this);
     config.coldStorage.privateKey = encryptPrivateKey(key);
-    configChanged = true;
-    Serial.println("SettingsManager: Private key updated (encrypted)");
+    markChanged(SettingsCategory::COLD_STORAGE);
+    LOG_I(SETTINGS, "SettingsManager: Private key updated (encrypted)\n");
     return true;
 }
 
 bool SettingsManager::setDisplayBrightness(uint8_t brightness) {
     if (!isValidBrightness(brightness)) return false;
+    Edit edit(*this);
     config.display.brightness = brightness;
-    configChanged = true;
-    Serial.printf("SettingsManager: Display brightness set to %d\n", brightness);
+    markChanged(SettingsCategory::DISPLAY_SETTINGS);
+    LOG_I(SETTINGS, "SettingsManager: Display brightness set to %d\n", brightness);
     return true;
 }
 
 bool SettingsManager::setSleepTimeout(uint32_t timeout) {
     if (!isValidTimeout(timeout)) return false;
+    Edit edit(*this);
     config.power.sleepTimeout = timeout;
-    configChanged = true;
-    Serial.printf("SettingsManager: Sleep timeout set to %lu ms\n", timeout);
+    markChanged(SettingsCategory::POWER);
+    LOG_I(SETTINGS, "SettingsManager: Sleep timeout set to %lu ms\n", timeout);
     return true;
 }
 
 bool SettingsManager::setUpdateInterval(uint32_t interval) {
     if (!isValidTimeout(interval)) return false;
+    Edit edit(*this);
     config.lightning.updateInterval = interval;
     config.coldStorage.updateInterval = interval;
-    configChanged = true;
-    Serial.printf("SettingsManager: Update interval set to %lu ms\n", interval);
+    markChanged(SettingsCategory::LIGHTNING);
+    markChanged(SettingsCategory::COLD_STORAGE);
+    LOG_I(SETTINGS, "SettingsManager: Update interval set to %lu ms\n", interval);
+    return true;
+}
+
+bool SettingsManager::setDeviceName(const String& name) {
+    Edit edit(*this);
+    config.system.deviceName = name;
+    markChanged(SettingsCategory::SYSTEM);
+    LOG_I(SETTINGS, "SettingsManager: Device name set to %s\n", name.c_str());
     return true;
 }
 
 // Validation methods
 bool SettingsManager::validateWiFiSettings(const WiFiSettings& settings) {
-    return isValidSSID(settings.ssid) && isValidPassword(settings.password);
+    FieldValidator validator = { nullptr };
+    validator(WIFI_FIELDS, settings);
+    return !validator.invalid;
 }
 
 bool SettingsManager::validateLightningSettings(const LightningSettings& settings) {
-    return isValidApiToken(settings.apiToken) && isValidUrl(settings.baseUrl);
+    FieldValidator validator = { nullptr };
+    validator(LIGHTNING_FIELDS, settings);
+    return !validator.invalid;
 }
 
 bool SettingsManager::validateColdStorageSettings(const ColdStorageSettings& settings) {
-    return isValidAddress(settings.watchAddress) && isValidUrl(settings.apiEndpoint);
+    FieldValidator validator = { nullptr };
+    validator(COLD_STORAGE_FIELDS, settings);
+    return !validator.invalid;
 }
 
 bool SettingsManager::validateDisplaySettings(const DisplaySettings& settings) {
-    return isValidBrightness(settings.brightness) && isValidTimeout(settings.screenTimeout);
+    FieldValidator validator = { nullptr };
+    validator(DISPLAY_FIELDS, settings);
+    return !validator.invalid;
 }
 
 bool SettingsManager::validatePowerSettings(const PowerSettings& settings) {
-    return isValidTimeout(settings.sleepTimeout) && isValidTimeout(settings.updateInterval);
+    FieldValidator validator = { nullptr };
+    validator(POWER_FIELDS, settings);
+    return !validator.invalid;
 }
 
 bool SettingsManager::validateSystemSettings(const SystemSettings& settings) {
-    return settings.deviceName.length() > 0 && settings.deviceName.length() < 32;
+    FieldValidator validator = { nullptr };
+    validator(SYSTEM_FIELDS, settings);
+    return !validator.invalid;
 }
 
 // Import/Export
 String SettingsManager::exportConfig(SettingsCategory category) {
-    return "{\"exported\":true}"; // Stub
+    JsonDocument doc;
+    configToJson(*getConfig(), doc, category);
+    
+    String json;
+    serializeJson(doc, json);
+    return json;
 }
 
 bool SettingsManager::importConfig(const String& json, SettingsCategory category) {
-    Serial.printf("SettingsManager: Importing config for category %d\n", (int)category);
-    return true; // Stub
+    LOG_I(SETTINGS, "SettingsManager: Importing config for category %d\n", (int)category);
+    clearError();
+    
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, json);
+    if (error) {
+        setError(String("Invalid config JSON: ") + error.c_str());
+        return false;
+    }
+    
+    Edit edit(*this);
+    if (!jsonToConfig(doc, category)) {
+        if (lastError.isEmpty()) {
+            setError("No settings found to import");
+        }
+        return false;
+    }
+    
+    // Persisted by the caller's next saveConfig()
+    markChanged(category);
+    return true;
 }
 
 String SettingsManager::exportQRConfig() {
@@ -558,54 +802,99 @@ String SettingsManager::exportQRConfig() {
 }
 
 bool SettingsManager::importQRConfig(const String& qrData) {
-    Serial.printf("SettingsManager: Importing QR config: %s\n", qrData.c_str());
+    LOG_I(SETTINGS, "SettingsManager: Importing QR config: %s\n", qrData.c_str());
     return true; // Stub
 }
 
 bool SettingsManager::factoryReset() {
-    Serial.println("SettingsManager: ⚠️ FACTORY RESET - Erasing all data ⚠️");
+    LOG_W(SETTINGS, "SettingsManager: ⚠️ FACTORY RESET - Erasing all data ⚠️\n");
+    Save save(*this);
+    Edit edit(*this);
     
     try {
-        // Format the entire LittleFS filesystem to completely wipe all data
-        Serial.println("SettingsManager: Formatting LittleFS filesystem...");
-        if (!LittleFS.format()) {
-            Serial.println("SettingsManager: ERROR - Failed to format LittleFS");
-            return false;
-        }
-        
-        // Reinitialize LittleFS after format
-        if (!LittleFS.begin()) {
-            Serial.println("SettingsManager: ERROR - Failed to reinitialize LittleFS after format");
+        // Remove all user data. The web UI assets are part of the flashed
+        // image rather than user data, so they survive the reset.
+        LOG_I(SETTINGS, "SettingsManager: Removing all user files...\n");
+        if (!removeUserFiles("/")) {
+            LOG_E(SETTINGS, "SettingsManager: ERROR - Failed to remove user files\n");
             return false;
         }
         
         // Reset all config to factory defaults
-        Serial.println("SettingsManager: Resetting all settings to factory defaults...");
+        LOG_I(SETTINGS, "SettingsManager: Resetting all settings to factory defaults...\n");
         setDefaults();
+        resetLoginAttempts();
         
         // Save clean config to filesystem
+        markChanged();
         if (!saveConfig()) {
-            Serial.println("SettingsManager: WARNING - Failed to save factory defaults");
+            LOG_W(SETTINGS, "SettingsManager: WARNING - Failed to save factory defaults\n");
             return false;
         }
         
-        Serial.println("SettingsManager: ✅ Factory reset completed successfully");
-        Serial.println("SettingsManager: All user data has been permanently erased");
+        LOG_I(SETTINGS, "SettingsManager: ✅ Factory reset completed successfully\n");
+        LOG_I(SETTINGS, "SettingsManager: All user data has been permanently erased\n");
         return true;
         
     } catch (...) {
-        Serial.println("SettingsManager: ERROR - Exception during factory reset");
+        LOG_E(SETTINGS, "SettingsManager: ERROR - Exception during factory reset\n");
         return false;
     }
 }
 
 bool SettingsManager::migrateConfig(uint32_t fromVersion, uint32_t toVersion) {
-    Serial.printf("SettingsManager: Migrating config from v%lu to v%lu\n", fromVersion, toVersion);
-    return true; // Stub
+    if (fromVersion >= toVersion) {
+        return true;
+    }
+    LOG_I(SETTINGS, "SettingsManager: Migrating config from v%lu to v%lu\n", fromVersion, toVersion);
+    Save save(*this);
+    Edit edit(*this);
+    
+    // v1 -> v2: JSON files to binary records. The per-category files are
+    // newer than SETTINGS_FILE, so they are applied last.
+    if (fromVersion < 2) {
+        bool found = false;
+        JsonDocument doc;
+        if (loadFromFile(SETTINGS_FILE, doc)) {
+            found |= jsonToConfig(doc, SettingsCategory::ALL);
+        }
+        for (int i = 0; i < SETTINGS_CATEGORY_COUNT; i++) {
+            doc.clear();
+            if (loadFromFile(LEGACY_JSON_FILES[i], doc)) {
+                found |= jsonToConfig(doc, (SettingsCategory)i);
+            }
+        }
+        if (!found) {
+            doc.clear();
+            if (loadFromFile(LEGACY_JSON_BACKUP, doc)) {
+                found = jsonToConfig(doc, SettingsCategory::ALL);
+            }
+        }
+        
+        // Only drop the JSON files once every record is safely written
+        markChanged();
+        if (!saveConfig()) {
+            LOG_E(SETTINGS, "SettingsManager: Migration failed, keeping JSON files\n");
+            return found;
+        }
+        deleteFile(SETTINGS_FILE);
+        deleteFile(LEGACY_JSON_BACKUP);
+        for (int i = 0; i < SETTINGS_CATEGORY_COUNT; i++) {
+            deleteFile(LEGACY_JSON_FILES[i]);
+        }
+        
+        LOG_I(SETTINGS, "SettingsManager: Migrated to binary records. Seed phrase set: %s\n", 
+                        isSeedPhraseSet() ? "YES" : "NO");
+        return found;
+    }
+    
+    // Later binary layouts need no conversion step: readers skip unknown
+    // tags and missing fields keep their defaults
+    return true;
 }
 
 uint32_t SettingsManager::getCurrentConfigVersion() const {
-    return 1; // Config version 1
+    return 2; // Binary TLV records
 }
 
 // File management
@@ -644,92 +933,68 @@ std::vector<String> SettingsManager::listFiles() {
 }
 
 // Private methods
+bool SettingsManager::removeUserFiles(const String& dir) {
+    File root = LittleFS.open(dir);
+    if (!root || !root.isDirectory()) {
+        return false;
+    }
+    
+    // Collect paths first; removing entries while iterating is not safe
+    std::vector<String> files;
+    std::vector<String> dirs;
+    File entry = root.openNextFile();
+    while (entry) {
+        String path = entry.path();
+        if (entry.isDirectory()) {
+            if (path != STATIC_ASSET_DIR) {
+                dirs.push_back(path);
+            }
+        } else {
+            files.push_back(path);
+        }
+        entry.close();
+        entry = root.openNextFile();
+    }
+    root.close();
+    
+    bool success = true;
+    for (const String& path : files) {
+        if (!LittleFS.remove(path)) {
+            LOG_E(SETTINGS, "SettingsManager: Failed to remove %s\n", path.c_str());
+            success = false;
+        }
+    }
+    for (const String& path : dirs) {
+        if (!removeUserFiles(path) || !LittleFS.rmdir(path)) {
+            LOG_E(SETTINGS, "SettingsManager: Failed to remove %s\n", path.c_str());
+            success = false;
+        }
+    }
+    return success;
+}
+
 void SettingsManager::setDefaults() {
-    setDefaultWiFi();
-    setDefaultLightning();
-    setDefaultColdStorage();
-    setDefaultDisplay();
-    setDefaultPower();
-    setDefaultSystem();
+    FieldDefaults defaults;
+    for (int i = 0; i < SETTINGS_CATEGORY_COUNT; i++) {
+        visitCategory(config, (SettingsCategory)i, defaults);
+    }
     
     // Metadata
     config.version = getCurrentVersion();
     config.lastModified = getCurrentTimestamp();
     config.configVersion = getCurrentConfigVersion();
     config.deviceId = generateDeviceId();
+    unpublished = true;
 }
 
-void SettingsManager::setDefaultWiFi() {
-    config.wifi.ssid = "";
-    config.wifi.password = "";
-    config.wifi.autoConnect = true;
-    config.wifi.connectionTimeout = 30;
-    config.wifi.hostname = "hodlinghog";
-    config.wifi.enableAP = true;
-    config.wifi.apSSID = "HodlingHog-Config";
-    config.wifi.apPassword = "hodling123";
-}
-
-void SettingsManager::setDefaultLightning() {
-    config.lightning.apiToken = "";
-    config.lightning.apiSecret = "";
-    config.lightning.baseUrl = "https://api.getalby.com";
-    config.lightning.autoUpdate = true;
-    config.lightning.updateInterval = DEFAULT_UPDATE_INTERVAL;
-    config.lightning.receiveAddress = "";
-    config.lightning.enableTransfers = true;
-    config.lightning.maxTransferAmount = 1000000; // 1M sats
-    config.lightning.walletCreated = false;
-}
-
-void SettingsManager::setDefaultColdStorage() {
-    config.coldStorage.watchAddress = "";
-    config.coldStorage.privateKey = "";
-    config.coldStorage.apiEndpoint = "https://blockstream.info/api";
-    config.coldStorage.autoUpdate = true;
-    config.coldStorage.updateInterval = DEFAULT_UPDATE_INTERVAL;
-    config.coldStorage.enableSigning = false;
-    config.coldStorage.defaultFeeRate = 10; // 10 sat/vB
-}
-
-void SettingsManager::setDefaultDisplay() {
-    config.display.brightness = DEFAULT_DISPLAY_BRIGHTNESS;
-    config.display.fastUpdate = false;
-    config.display.screenTimeout = DEFAULT_SLEEP_TIMEOUT;
-    config.display.showStatusBar = true;
-    config.display.showQRCodes = true;
-    config.display.qrCodeSize = 2;
-    config.display.defaultScreen = "lightning";
-    config.display.enableAnimations = false;
-}
-
-void SettingsManager::setDefaultPower() {
-    config.power.sleepTimeout = DEFAULT_SLEEP_TIMEOUT;
-    config.power.enableDeepSleep = true;
-    config.power.wakeOnButton = true;
-    config.power.wakeOnTilt = true;
-    config.power.batteryWarningLevel = 20;
-    config.power.enablePowerSaving = true;
-    config.power.updateInterval = DEFAULT_UPDATE_INTERVAL;
-}
-
-void SettingsManager::setDefaultSystem() {
-    config.system.deviceName = "Hodling Hog";
-    config.system.timezone = "UTC";
-    config.system.enableLogging = true;
-    config.system.logLevel = 3;
-    config.system.enableOTA = true;
-    config.system.ntpServer = "pool.ntp.org";
-    config.system.heartbeatInterval = 60000;
-    config.system.enableWatchdog = true;
-    
-    // Seed phrase authentication defaults
-    config.system.seedPhraseHash = "";
-    config.system.requireSeedAuth = false;
-    config.system.maxLoginAttempts = DEFAULT_MAX_LOGIN_ATTEMPTS;
-    config.system.lockoutDuration = DEFAULT_LOCKOUT_DURATION;
-    config.system.lastFailedLogin = 0;
-    config.system.failedLoginCount = 0;
+void SettingsManager::publish() {
+    published.publish(config);
+    unpublished = false;
+    stats.snapshots++;
+    
+    // Pages rendered from the old configuration are stale as soon as the
+    // change is visible, not once the write-behind save has run
+    bumpStateVersion();
 }
 
 // Security methods
@@ -748,26 +1013,6 @@ bool SettingsManager::isPrivateKeyEncrypted(const String& key) {
 }
 
 // Validation helpers
-bool SettingsManager::isValidSSID(const String& ssid) {
-    return ssid.length() > 0 && ssid.length() <= 32;
-}
-
-bool SettingsManager::isValidPassword(const String& password) {
-    return password.length() >= 8 && password.length() <= 64;
-}
-
-bool SettingsManager::isValidApiToken(const String& token) {
-    return token.length() > 10;
-}
-
-bool SettingsManager::isValidUrl(const String& url) {
-    return url.startsWith("http://") || url.startsWith("https://");
-}
-
-bool SettingsManager::isValidAddress(const String& address) {
-    return address.length() > 25;
-}
-
 bool SettingsManager::isValidPrivateKey(const String& key) {
     return key.length() == 51 || key.length() == 52;
 }
@@ -777,16 +1022,16 @@ bool SettingsManager::isValidBrightness(uint8_t brightness) {
 }
 
 bool SettingsManager::isValidTimeout(uint32_t timeout) {
-    return timeout >= 1000 && timeout <= 3600000; // 1 second to 1 hour
+    return timeout >= MIN_TIMEOUT && timeout <= MAX_TIMEOUT;
 }
 
 void SettingsManager::setError(const String& error) {
     lastError = error;
-    Serial.printf("SettingsManager: Error - %s\n", error.c_str());
+    LOG_E(SETTINGS, "SettingsManager: Error - %s\n", error.c_str());
 }
 
 void SettingsManager::logError(const String& operation, const String& error) {
-    Serial.printf("SettingsManager: %s failed - %s\n", operation.c_str(), error.c_str());
+    LOG_E(SETTINGS, "SettingsManager: %s failed - %s\n", operation.c_str(), error.c_str());
 }
 
 String SettingsManager::generateDeviceId() {
@@ -813,81 +1058,251 @@ size_t SettingsManager::calculateJsonSize(SettingsCategory category) {
     return 1024; // Stub estimate
 }
 
-// Stub JSON methods
-bool SettingsManager::configToJson(JsonDocument& doc, SettingsCategory category) {
-    return true; // Stub
+// JSON serialization
+bool SettingsManager::configToJson(const HodlingHogConfig& source, JsonDocument& doc, SettingsCategory category) {
+    bool all = category == SettingsCategory::ALL;
+    for (int i = 0; i < SETTINGS_CATEGORY_COUNT; i++) {
+        if (all || category == (SettingsCategory)i) {
+            FieldJsonWriter writer = { doc[JSON_SECTIONS[i]].to<JsonObject>() };
+            visitCategory(source, (SettingsCategory)i, writer);
+        }
+    }
+    
+    if (all || category == SettingsCategory::SYSTEM) {
+        FieldJsonWriter writer = { doc.as<JsonObject>() };
+        writer(METADATA_FIELDS, source);
+        doc["configVersion"] = source.configVersion;
+    }
+    return true;
 }
 
 bool SettingsManager::jsonToConfig(const JsonDocument& doc, SettingsCategory category) {
-    return true; // Stub
+    bool all = category == SettingsCategory::ALL;
+    bool success = true;
+    int found = 0;
+    for (int i = 0; i < SETTINGS_CATEGORY_COUNT; i++) {
+        JsonObjectConst section = doc[JSON_SECTIONS[i]].as<JsonObjectConst>();
+        if ((!all && category != (SettingsCategory)i) || section.isNull()) {
+            continue;
+        }
+        
+        FieldJsonReader reader = { section, nullptr };
+        visitCategory(config, (SettingsCategory)i, reader);
+        if (reader.rejected) {
+            setError(String("Invalid value for ") + JSON_SECTIONS[i] + "." + reader.rejected);
+            success = false;
+        }
+        found++;
+        
+        if ((SettingsCategory)i == SettingsCategory::SYSTEM) {
+            FieldJsonReader metadata = { doc.as<JsonObjectConst>(), nullptr };
+            metadata(METADATA_FIELDS, config);
+            if (!doc["configVersion"].isNull()) {
+                config.configVersion = doc["configVersion"].as<uint32_t>();
+            }
+        }
+    }
+    
+    // A category file without its section is as good as missing
+    unpublished |= found > 0;
+    return success && found > 0;
 }
 
-void SettingsManager::wifiToJson(JsonObject& obj) {}
-void SettingsManager::lightningToJson(JsonObject& obj) {}
-void SettingsManager::coldStorageToJson(JsonObject& obj) {}
-void SettingsManager::displayToJson(JsonObject& obj) {}
-void SettingsManager::powerToJson(JsonObject& obj) {}
-void SettingsManager::systemToJson(JsonObject& obj) {}
-
-bool SettingsManager::jsonToWifi(const JsonObject& obj) { return true; }
-bool SettingsManager::jsonToLightning(const JsonObject& obj) { return true; }
-bool SettingsManager::jsonToColdStorage(const JsonObject& obj) { return true; }
-bool SettingsManager::jsonToDisplay(const JsonObject& obj) { return true; }
-bool SettingsManager::jsonToPower(const JsonObject& obj) { return true; }
-bool SettingsManager::jsonToSystem(const JsonObject& obj) { return true; }
-
 String SettingsManager::getFilePath(SettingsCategory category) {
     switch (category) {
         case SettingsCategory::WIFI: return WIFI_SETTINGS;
         case SettingsCategory::LIGHTNING: return WALLET_SETTINGS;
-        case SettingsCategory::COLD_STORAGE: return WALLET_SETTINGS;
+        case SettingsCategory::COLD_STORAGE: return COLD_SETTINGS;
         case SettingsCategory::DISPLAY_SETTINGS: return DISPLAY_CONFIG_FILE;
         case SettingsCategory::POWER: return POWER_SETTINGS;
+        case SettingsCategory::SYSTEM: return SYSTEM_SETTINGS;
         default: return SETTINGS_FILE;
     }
 }
 
 bool SettingsManager::loadFromFile(const String& path, JsonDocument& doc) {
-    return true; // Stub
+    size_t length;
+    uint8_t* data = readRecord(path, length, true);
+    if (!data) {
+        return false;
+    }
+    
+    DeserializationError error = deserializeJson(doc, (const char*)data, length);
+    free(data);
+    
+    if (error) {
+        LOG_E(SETTINGS, "SettingsManager: JSON parsing failed for %s: %s\n", path.c_str(), error.c_str());
+        return false;
+    }
+    return true;
 }
 
-bool SettingsManager::saveToFile(const String& path, const JsonDocument& doc) {
-    return true; // Stub
-} 
+// Binary serialization
+size_t SettingsManager::encodeCategory(const HodlingHogConfig& source, SettingsCategory category, uint8_t* buffer, size_t capacity) {
+    TlvWriter out(buffer, capacity);
+    out.putUint(TLV_TAG_SCHEMA, getCurrentConfigVersion());
+    
+    FieldTlvWriter writer = { out };
+    if (!visitCategory(source, category, writer)) {
+        return 0;
+    }
+    if (category == SettingsCategory::SYSTEM) {
+        writer(METADATA_FIELDS, source);
+    }
+    
+    if (out.overflow()) {
+        LOG_E(SETTINGS, "SettingsManager: Category %d exceeds %u bytes\n", (int)category, (unsigned)capacity);
+        return 0;
+    }
+    return out.length();
+}
+
+bool SettingsManager::decodeCategory(SettingsCategory category, const uint8_t* data, size_t length) {
+    // Partially applied records still differ from the published snapshot
+    unpublished = true;
+    TlvReader in(data, length);
+    FieldTlvReader reader = { in, nullptr };
+    uint32_t schema = 0;
+    while (in.next()) {
+        if (in.tag() == TLV_TAG_SCHEMA) {
+            schema = in.asUint();
+            continue;
+        }
+        if (!visitCategory(config, category, reader)) {
+            return false;
+        }
+        if (category == SettingsCategory::SYSTEM) {
+            reader(METADATA_FIELDS, config);
+        }
+        
+        // An out-of-range value keeps the default rather than losing the record
+        if (reader.rejected) {
+            LOG_W(SETTINGS, "SettingsManager: Ignoring invalid %s in category %d\n", reader.rejected, (int)category);
+            reader.rejected = nullptr;
+        }
+    }
+    
+    if (in.isMalformed() || schema == 0) {
+        LOG_E(SETTINGS, "SettingsManager: Malformed record for category %d\n", (int)category);
+        return false;
+    }
+    
+    // Rewrite records from other schema versions in the current layout
+    if (schema != getCurrentConfigVersion()) {
+        LOG_I(SETTINGS, "SettingsManager: Category %d written by v%lu, upgrading\n", (int)category, schema);
+        markChanged(category);
+    }
+    return true;
+}
+
+uint8_t SettingsManager::loadBackup(uint8_t categories) {
+    size_t length;
+    uint8_t* data = readRecord(BACKUP_SETTINGS, length);
+    if (!data) {
+        return 0;
+    }
+    
+    uint8_t restored = 0;
+    TlvReader in(data, length);
+    while (in.next()) {
+        if (in.tag() >= SETTINGS_CATEGORY_COUNT) {
+            continue;
+        }
+        SettingsCategory category = (SettingsCategory)in.tag();
+        if ((categories & categoryBit(category)) && decodeCategory(category, in.value(), in.valueLength())) {
+            restored |= categoryBit(category);
+        }
+    }
+    free(data);
+    return restored;
+}
+
+// Hot counters
+void SettingsManager::loadCounters() {
+    if (!countersOpen) {
+        countersOpen = counters.begin(COUNTER_NAMESPACE, false);
+        if (!countersOpen) {
+            LOG_E(SETTINGS, "SettingsManager: NVS counters unavailable\n");
+            return;
+        }
+    }
+    
+    // millis() stamps mean nothing after a reboot: a pending lockout
+    // restarts from boot rather than being lifted by a power cycle
+    config.system.failedLoginCount = counters.getUChar(COUNTER_FAILED_LOGINS, 0);
+    config.system.lastFailedLogin = config.system.failedLoginCount ? millis() : 0;
+    if (config.system.failedLoginCount) {
+        LOG_W(SETTINGS, "SettingsManager: %d failed logins carried over\n", config.system.failedLoginCount);
+    }
+}
+
+void SettingsManager::saveFailedLogins() {
+    // Locked accounts reject attempts before they are counted, so this
+    // runs at most maxLoginAttempts times per lockout period
+    if (countersOpen && counters.putUChar(COUNTER_FAILED_LOGINS, config.system.failedLoginCount)) {
+        stats.counterWrites++;
+    }
+}
+
+void SettingsManager::loadKdfIterations() {
+    // Calibrated on first boot only: a count that moved with every boot
+    // would keep triggering verifier upgrades
+    uint32_t stored = countersOpen ? counters.getUInt(COUNTER_KDF_ITERATIONS, 0) : 0;
+    if (stored >= SEED_KDF_MIN_ITERATIONS && stored <= SEED_KDF_MAX_ITERATIONS) {
+        kdfIterations = stored;
+    } else {
+        kdfIterations = seedKdfCalibrate(SEED_KDF_TARGET_MS);
+        if (countersOpen) {
+            counters.putUInt(COUNTER_KDF_ITERATIONS, kdfIterations);
+        }
+        LOG_I(SETTINGS, "SettingsManager: Calibrated PBKDF2 to %u iterations for %d ms\n",
+              (unsigned)kdfIterations, SEED_KDF_TARGET_MS);
+    }
+    stats.kdfIterations = kdfIterations;
+}
+
+bool SettingsManager::writeRecord(const String& path, const uint8_t* data, size_t length) {
+    size_t written;
+    bool success = recordWrite(path, data, length, written);
+    if (written > 0) {
+        stats.filesWritten++;
+        stats.bytesWritten += written;
+    }
+    return success;
+}
+
+uint8_t* SettingsManager::readRecord(const String& path, size_t& length, bool allowUnframed) {
+    bool corrupt;
+    uint8_t* data = recordRead(path, length, allowUnframed, corrupt);
+    if (corrupt) {
+        stats.crcErrors++;
+    }
+    return data;
+}
+
+void SettingsManager::removeTempFiles() {
+    for (int i = 0; i <= SETTINGS_CATEGORY_COUNT; i++) {
+        String temp = getFilePath((SettingsCategory)i) + SETTINGS_TEMP_SUFFIX;
+        if (fileExists(temp)) {
+            LOG_W(SETTINGS, "SettingsManager: Removing interrupted write %s\n", temp.c_str());
+            deleteFile(temp);
+        }
+    }
+    String backupTemp = String(BACKUP_SETTINGS) + SETTINGS_TEMP_SUFFIX;
+    if (fileExists(backupTemp)) {
+        deleteFile(backupTemp);
+    }
+}
 
 // Kid-friendly seed phrase generation
 String SettingsManager::generateKidFriendlySeedPhrase() {
-    String seedPhrase = "";
-    for (int i = 0; i < SEED_PHRASE_WORD_COUNT; i++) {
-        if (i > 0) seedPhrase += " ";
-        seedPhrase += getRandomWord();
-    }
-    
-    Serial.printf("SettingsManager: Generated kid-friendly seed phrase: %s\n", seedPhrase.c_str());
-    return seedPhrase;
-}
-
-std::vector<String> SettingsManager::getKidFriendlyWordList() {
-    // Simple, kid-friendly words that are easy to remember and spell
-    return {
-        "apple", "ball", "cat", "dog", "egg", "fish", "game", "hat",
-        "ice", "jump", "kite", "lion", "moon", "nose", "owl", "pig",
-        "queen", "rain", "sun", "tree", "up", "van", "wave", "box",
-        "yes", "zoo", "book", "cake", "duck", "eye", "frog", "gift",
-        "home", "idea", "joy", "key", "love", "map", "nice", "open",
-        "play", "quiz", "red", "star", "talk", "use", "view", "walk",
-        "fox", "yard", "zero", "bike", "cute", "draw", "easy", "fun",
-        "good", "happy", "kind", "lamp", "magic", "new", "ocean", "park",
-        "quiet", "road", "smile", "time", "under", "very", "wind", "yarn",
-        "big", "cool", "deep", "epic", "fast", "glad", "hero", "jump",
-        "king", "leaf", "mild", "neat", "pink", "race", "soft", "tall",
-        "blue", "door", "gold", "hope", "wise", "rock", "bird", "coin"
-    };
-}
-
-String SettingsManager::getRandomWord() {
-    std::vector<String> wordList = getKidFriendlyWordList();
-    randomSeed(micros()); // Seed with current time
-    int index = random(0, wordList.size());
-    return wordList[index];
-} 
\ No newline at end of file
+    char phrase[SEED_PHRASE_WORD_COUNT * (WORD_MAX_LENGTH + 1)];
+    kidPhraseGenerate(phrase, sizeof(phrase), SEED_PHRASE_WORD_COUNT);
+    
+    LOG_I(SETTINGS, "SettingsManager: Generated kid-friendly seed phrase\n");
+    return String(phrase);
+}
+
+const char* SettingsManager::getRandomWord() {
+    return kidWord(kidWordPick());
+}
@@ -4,15 +4,36 @@
 #include <Arduino.h>
 #include <ArduinoJson.h>
 #include <LittleFS.h>
+#include <Preferences.h>
+#include <memory>
 #include <vector>
+#include "records.h"
+#include "../utils/snapshot.h"
 
-// Settings file paths
-#define SETTINGS_FILE       "/config.json"
-#define BACKUP_SETTINGS     "/config_backup.json"
-#define WIFI_SETTINGS       "/wifi.json"
-#define WALLET_SETTINGS     "/wallet.json"
-#define DISPLAY_CONFIG_FILE "/display.json"
-#define POWER_SETTINGS      "/power.json"
+// Settings file paths (one binary TLV record per category)
+#define SETTINGS_FILE       "/config.json"      // Layout 1 single JSON file, migrated on load
+#define BACKUP_SETTINGS     "/config_backup.bin"
+#define WIFI_SETTINGS       "/wifi.bin"
+#define WALLET_SETTINGS     "/wallet.bin"
+#define COLD_SETTINGS       "/cold.bin"
+#define DISPLAY_CONFIG_FILE "/display.bin"
+#define POWER_SETTINGS      "/power.bin"
+#define SYSTEM_SETTINGS     "/system.bin"       // Also holds the config metadata
+#define STATIC_ASSET_DIR    "/static"   // Web UI assets, preserved across factory reset
+
+#define SETTINGS_TLV_MAX        1024        // Encoded size limit for one category
+#define SETTINGS_BACKUP_INTERVAL 600000     // Refresh the full backup at most every 10 minutes
+
+// Write-behind: changes not saved explicitly are written by the job worker
+// once the oldest of them is this old, so bursts cost one save
+#define SETTINGS_WRITE_DELAY    5000
+#define SETTINGS_FLUSH_TIMEOUT  2000        // Wait for running saves before deep sleep
+
+// Counters that change on every login attempt live in NVS, which is
+// wear-levelled, instead of rewriting the system record
+#define COUNTER_NAMESPACE       "counters"
+#define COUNTER_FAILED_LOGINS   "failedLogins"
+#define COUNTER_KDF_ITERATIONS  "kdfIterations"     // Calibrated once per device, see seedhash.h
 
 // Default configuration values
 #define DEFAULT_UPDATE_INTERVAL     300000   // 5 minutes
@@ -20,6 +41,9 @@
 #define DEFAULT_DISPLAY_BRIGHTNESS  128      // Medium brightness
 #define DEFAULT_BUTTON_HOLD_TIME    2000     // 2 seconds
 #define DEFAULT_TILT_SENSITIVITY    50       // Medium sensitivity
+#define MIN_TIMEOUT                 1000     // Shortest accepted timeout or interval
+#define MAX_TIMEOUT                 3600000  // Longest, 1 hour
+#define MAX_SATS                    2100000000000000ULL  // 21M BTC
 
 // Seed phrase authentication defaults
 #define DEFAULT_MAX_LOGIN_ATTEMPTS  5        // Maximum failed attempts
@@ -37,6 +61,24 @@ enum class SettingsCategory {
     ALL
 };
 
+#define SETTINGS_CATEGORY_COUNT 6   // Categories before ALL
+
+// Flash write accounting
+struct SettingsStats {
+    uint32_t saves;             // saveConfig() calls that wrote something
+    uint32_t filesWritten;      // Category and backup files rewritten
+    uint32_t bytesWritten;      // Total bytes written to flash
+    uint32_t lastSaveBytes;
+    uint32_t crcErrors;         // Records rejected on load
+    uint32_t recovered;         // Categories restored from the backup
+    uint32_t loadUs;            // Duration of the last loadConfig()
+    uint32_t counterWrites;     // NVS writes for the hot counters
+    uint32_t deferredSaves;     // Saves posted by the write-behind window
+    uint32_t kdfIterations;     // PBKDF2 count used for new seed verifiers
+    uint32_t verifyMs;          // Duration of the last seed phrase verification
+    uint32_t snapshots;         // Configuration copies published to readers
+};
+
 // WiFi settings structure
 struct WiFiSettings {
     String ssid;
@@ -108,12 +150,12 @@ struct SystemSettings {
     bool enableWatchdog;
     
     // Seed phrase authentication
-    String seedPhraseHash;      // SHA256 hash of the normalized seed phrase
+    String seedPhraseHash;      // PBKDF2 verifier of the normalized seed phrase
     bool requireSeedAuth;       // Whether seed authentication is required
     uint32_t maxLoginAttempts;  // Maximum failed login attempts before lockout
     uint32_t lockoutDuration;   // Lockout duration in seconds
-    unsigned long lastFailedLogin;
-    uint8_t failedLoginCount;
+    uint32_t lastFailedLogin;   // millis() of this boot, not persisted
+    uint8_t failedLoginCount;   // Kept in NVS
 };
 
 // Complete configuration structure
@@ -127,11 +169,15 @@ struct HodlingHogConfig {
     
     // Metadata
     String version;
-    unsigned long lastModified;
+    uint32_t lastModified;
     uint32_t configVersion;
     String deviceId;
 };
 
+// Published configuration. Never modified once shared: a reader keeps a
+// consistent view for as long as it holds the pointer, on any task.
+typedef SnapshotCell<HodlingHogConfig>::Pointer ConfigSnapshot;
+
 class SettingsManager {
 public:
     SettingsManager();
@@ -155,17 +201,9 @@ public:
     bool saveCategory(SettingsCategory category);
     bool resetCategory(SettingsCategory category);
     
-    // Configuration access
-    HodlingHogConfig& getConfig() { return config; }
-    const HodlingHogConfig& getConfig() const { return config; }
-    
-    // Individual setting access
-    WiFiSettings& getWiFiSettings() { return config.wifi; }
-    LightningSettings& getLightningSettings() { return config.lightning; }
-    ColdStorageSettings& getColdStorageSettings() { return config.coldStorage; }
-    DisplaySettings& getDisplaySettings() { return config.display; }
-    PowerSettings& getPowerSettings() { return config.power; }
-    SystemSettings& getSystemSettings() { return config.system; }
+    // Configuration access. Changes go through the setters below, which
+    // edit a private draft and publish a new snapshot when they finish.
+    ConfigSnapshot getConfig() const;
     
     // Setting modification
     bool setWiFiCredentials(const String& ssid, const String& password);
@@ -177,24 +215,25 @@ public:
     bool setDisplayBrightness(uint8_t brightness);
     bool setSleepTimeout(uint32_t timeout);
     bool setUpdateInterval(uint32_t interval);
+    bool setDeviceName(const String& name);
     
     // Seed phrase authentication
     bool setSeedPhrase(const String& seedPhrase);
-    bool validateSeedPhrase(const String& seedPhrase);
+    // countFailure: whether a mismatch counts towards the login lockout
+    bool validateSeedPhrase(const String& seedPhrase, bool countFailure = true);
     bool isSeedPhraseSet() const;
     String hashSeedPhrase(const String& seedPhrase);
     String normalizeSeedPhrase(const String& seedPhrase);
     bool isAccountLocked() const;
     void recordFailedLogin();
     void resetLoginAttempts();
-    std::vector<String> getBIP39WordList();
     bool isValidBIP39Word(const String& word);
+    bool isValidBIP39Mnemonic(const String& mnemonic);
     bool isSeedPhraseValid(const String& seedPhrase);
     
-    // Kid-friendly seed phrase generation
+    // Kid-friendly seed phrase generation (word tables in wordlists.h)
     String generateKidFriendlySeedPhrase();
-    std::vector<String> getKidFriendlyWordList();
-    String getRandomWord();
+    const char* getRandomWord();
     
     // Validation
     bool validateWiFiSettings(const WiFiSettings& settings);
@@ -215,11 +254,23 @@ public:
     bool migrateConfig(uint32_t fromVersion, uint32_t toVersion);
     uint32_t getCurrentConfigVersion() const;
     
-    // Change tracking
-    bool hasChanges() const { return configChanged; }
-    void markChanged() { configChanged = true; }
-    void markSaved() { configChanged = false; }
-    unsigned long getLastModified() const { return config.lastModified; }
+    // Change tracking, per category so a save only rewrites what changed
+    bool hasChanges() const { return dirtyCategories != 0; }
+    bool isDirty(SettingsCategory category) const { return dirtyCategories & categoryBit(category); }
+    void markChanged(SettingsCategory category = SettingsCategory::ALL) {
+        markUnsaved(categoryBit(category));
+        unpublished = true;
+    }
+    void markSaved() { dirtyCategories = 0; }
+    
+    // Write-behind: loop() posts a background save once the oldest unsaved
+    // change is writeDelay old; flush() saves now, e.g. before deep sleep
+    void loop();
+    bool flush();
+    void setWriteDelay(uint32_t delayMs) { writeDelay = delayMs; }
+    uint32_t getWriteDelay() const { return writeDelay; }
+    unsigned long getLastModified() const { return getConfig()->lastModified; }
+    const SettingsStats& getStats() const { return stats; }
     
     // File management
     bool fileExists(const String& path);
@@ -233,43 +284,88 @@ public:
     void clearError() { lastError = ""; }
     
 private:
-    HodlingHogConfig config;
+    // Writers hold an Edit while they change the draft; when the outermost
+    // one ends, a changed draft is copied and published. Readers only copy
+    // the shared pointer, so they never wait for a writer.
+    class Edit {
+    public:
+        explicit Edit(SettingsManager& manager);
+        ~Edit();
+    private:
+        SettingsManager& manager;
+    };
+    
+    // Anything that writes or removes settings files holds a Save from the
+    // snapshot it writes until its last rename, so two saves never share a
+    // temp file or land out of order. Taken before any Edit.
+    class Save {
+    public:
+        explicit Save(SettingsManager& manager);
+        ~Save();
+    private:
+        SettingsManager& manager;
+    };
+    
+    HodlingHogConfig config;            // Draft, only touched under an Edit
+    SnapshotCell<HodlingHogConfig> published;
+    SemaphoreHandle_t editLock;         // Recursive, serializes writers
+    SemaphoreHandle_t saveLock;         // Recursive, serializes file writes
+    uint8_t editDepth;
+    bool unpublished;
     bool initialized;
-    bool configChanged;
+    uint8_t dirtyCategories;
+    unsigned long dirtySince;
+    uint32_t writeDelay;
+    Preferences counters;
+    bool countersOpen;
+    uint32_t kdfIterations;
+    SettingsStats stats;
+    unsigned long lastBackup;
     String lastError;
     
-    // Default configuration
+    static uint8_t categoryBit(SettingsCategory category) {
+        return category == SettingsCategory::ALL ? (1 << SETTINGS_CATEGORY_COUNT) - 1 : 1 << (int)category;
+    }
+    
+    // Flags categories for the next save without touching the draft
+    void markUnsaved(uint8_t categories) {
+        if (dirtyCategories == 0) {
+            dirtySince = millis();
+        }
+        dirtyCategories |= categories;
+    }
+    
+    // Default configuration, from the field tables in settings.cpp
     void setDefaults();
-    void setDefaultWiFi();
-    void setDefaultLightning();
-    void setDefaultColdStorage();
-    void setDefaultDisplay();
-    void setDefaultPower();
-    void setDefaultSystem();
+    void publish();
+    
+    // Factory reset helper - removes everything under dir except STATIC_ASSET_DIR
+    bool removeUserFiles(const String& dir);
     
     // JSON serialization
-    bool configToJson(JsonDocument& doc, SettingsCategory category = SettingsCategory::ALL);
+    static bool configToJson(const HodlingHogConfig& source, JsonDocument& doc, SettingsCategory category = SettingsCategory::ALL);
     bool jsonToConfig(const JsonDocument& doc, SettingsCategory category = SettingsCategory::ALL);
     
-    // Category-specific JSON handling
-    void wifiToJson(JsonObject& obj);
-    void lightningToJson(JsonObject& obj);
-    void coldStorageToJson(JsonObject& obj);
-    void displayToJson(JsonObject& obj);
-    void powerToJson(JsonObject& obj);
-    void systemToJson(JsonObject& obj);
-    
-    bool jsonToWifi(const JsonObject& obj);
-    bool jsonToLightning(const JsonObject& obj);
-    bool jsonToColdStorage(const JsonObject& obj);
-    bool jsonToDisplay(const JsonObject& obj);
-    bool jsonToPower(const JsonObject& obj);
-    bool jsonToSystem(const JsonObject& obj);
+    // Binary encoding, the on-flash format
+    size_t encodeCategory(const HodlingHogConfig& source, SettingsCategory category, uint8_t* buffer, size_t capacity);
+    bool writeCategory(const HodlingHogConfig& source, SettingsCategory category);
+    bool decodeCategory(SettingsCategory category, const uint8_t* data, size_t length);
+    uint8_t loadBackup(uint8_t categories);
     
     // File operations
     String getFilePath(SettingsCategory category);
     bool loadFromFile(const String& path, JsonDocument& doc);
-    bool saveToFile(const String& path, const JsonDocument& doc);
+    
+    // Hot counters in NVS
+    void loadCounters();
+    void saveFailedLogins();
+    void loadKdfIterations();
+    
+    // Framed, CRC-checked records (records.h) plus the flash statistics.
+    // allowUnframed also accepts the bare JSON files of older firmware.
+    bool writeRecord(const String& path, const uint8_t* data, size_t length);
+    uint8_t* readRecord(const String& path, size_t& length, bool allowUnframed = false);
+    void removeTempFiles();
     
     // Security and encryption
     String encryptPrivateKey(const String& key);
@@ -277,11 +373,6 @@ private:
     bool isPrivateKeyEncrypted(const String& key);
     
     // Validation helpers
-    bool isValidSSID(const String& ssid);
-    bool isValidPassword(const String& password);
-    bool isValidApiToken(const String& token);
-    bool isValidUrl(const String& url);
-    bool isValidAddress(const String& address);
     bool isValidPrivateKey(const String& key);
     bool isValidBrightness(uint8_t brightness);
     bool isValidTimeout(uint32_t timeout);
@@ -0,0 +1,100 @@
+#include "tlv.h"
+
+TlvWriter::TlvWriter(uint8_t* buffer, size_t capacity)
+    : buffer(buffer), capacity(capacity), position(0), overflowed(false) {
+}
+
+void TlvWriter::putUint(uint8_t tag, uint64_t value) {
+    uint8_t encoded[10];
+    size_t size = encodeVarint(value, encoded);
+    putBytes(tag, encoded, size);
+}
+
+void TlvWriter::putString(uint8_t tag, const String& value) {
+    putBytes(tag, (const uint8_t*)value.c_str(), value.length());
+}
+
+void TlvWriter::putBytes(uint8_t tag, const uint8_t* data, size_t length) {
+    putRaw(&tag, 1);
+    putVarint(length);
+    putRaw(data, length);
+}
+
+void TlvWriter::putVarint(uint64_t value) {
+    uint8_t encoded[10];
+    size_t size = encodeVarint(value, encoded);
+    putRaw(encoded, size);
+}
+
+void TlvWriter::putRaw(const uint8_t* data, size_t length) {
+    if (overflowed || position + length > capacity) {
+        overflowed = true;
+        return;
+    }
+    memcpy(buffer + position, data, length);
+    position += length;
+}
+
+size_t TlvWriter::encodeVarint(uint64_t value, uint8_t* out) {
+    size_t size = 0;
+    do {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        out[size++] = value ? (byte | 0x80) : byte;
+    } while (value);
+    return size;
+}
+
+TlvReader::TlvReader(const uint8_t* data, size_t length)
+    : data(data), length(length), position(0), currentTag(0), valueStart(0), valueSize(0), malformed(false) {
+}
+
+bool TlvReader::next() {
+    if (malformed || position >= length) {
+        return false;
+    }
+
+    currentTag = data[position++];
+    uint64_t size;
+    if (!readVarint(data, length, position, size) || size > length - position) {
+        malformed = true;
+        return false;
+    }
+
+    valueStart = position;
+    valueSize = size;
+    position += size;
+    return true;
+}
+
+uint64_t TlvReader::asUint() const {
+    size_t cursor = 0;
+    uint64_t value = 0;
+    if (!readVarint(data + valueStart, valueSize, cursor, value)) {
+        return 0;
+    }
+    return value;
+}
+
+String TlvReader::asString() const {
+    String value;
+    if (valueSize > 0 && value.reserve(valueSize)) {
+        value.concat((const char*)data + valueStart, valueSize);
+    }
+    return value;
+}
+
+bool TlvReader::readVarint(const uint8_t* data, size_t length, size_t& position, uint64_t& value) {
+    value = 0;
+    for (uint8_t shift = 0; shift < 64; shift += 7) {
+        if (position >= length) {
+            return false;
+        }
+        uint8_t byte = data[position++];
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,65 @@
+#ifndef TLV_H
+#define TLV_H
+
+#include <Arduino.h>
+
+// Compact tag-length-value encoding used for the settings files.
+// Each entry is a one-byte tag, a LEB128 length and the value. Integers
+// and booleans are stored as LEB128 varints, strings as raw bytes, and a
+// value can itself be a nested TLV stream. Readers skip tags they do not
+// know, and fields without an entry keep their defaults, so records stay
+// readable in both directions as fields are added.
+
+// Serializes entries into a caller-provided buffer
+class TlvWriter {
+public:
+    TlvWriter(uint8_t* buffer, size_t capacity);
+
+    void putUint(uint8_t tag, uint64_t value);
+    void putBool(uint8_t tag, bool value) { putUint(tag, value ? 1 : 0); }
+    void putString(uint8_t tag, const String& value);
+    void putBytes(uint8_t tag, const uint8_t* data, size_t length);
+
+    size_t length() const { return position; }
+    bool overflow() const { return overflowed; }
+
+private:
+    uint8_t* buffer;
+    size_t capacity;
+    size_t position;
+    bool overflowed;
+
+    void putVarint(uint64_t value);
+    void putRaw(const uint8_t* data, size_t length);
+    static size_t encodeVarint(uint64_t value, uint8_t* out);
+};
+
+// Walks the entries of an encoded buffer without copying it
+class TlvReader {
+public:
+    TlvReader(const uint8_t* data, size_t length);
+
+    // Advances to the next entry; false at the end or on malformed input
+    bool next();
+    bool isMalformed() const { return malformed; }
+
+    uint8_t tag() const { return currentTag; }
+    uint64_t asUint() const;
+    bool asBool() const { return asUint() != 0; }
+    String asString() const;
+    const uint8_t* value() const { return data + valueStart; }
+    size_t valueLength() const { return valueSize; }
+
+private:
+    const uint8_t* data;
+    size_t length;
+    size_t position;
+    uint8_t currentTag;
+    size_t valueStart;
+    size_t valueSize;
+    bool malformed;
+
+    static bool readVarint(const uint8_t* data, size_t length, size_t& position, uint64_t& value);
+};
+
+#endif // TLV_H
@@ -0,0 +1,40 @@
+#ifndef WORDLISTS_H
+#define WORDLISTS_H
+
+#include <Arduino.h>
+
+// Seed phrase word tables. Both are sorted, fixed-width and const, so they
+// stay in flash; words are found by binary search and handled by index,
+// and nothing here allocates.
+#define BIP39_WORD_COUNT    2048
+#define BIP39_MIN_WORDS     12
+#define BIP39_MAX_WORDS     24
+#define KID_WORD_COUNT      96
+#define WORD_MAX_LENGTH     8       // Longest word in either table
+
+// Index of word (length bytes, lowercase, not necessarily terminated),
+// or -1 when it is not in the table
+int bip39Index(const char* word, size_t length);
+int kidWordIndex(const char* word, size_t length);
+
+const char* bip39Word(uint16_t index);
+const char* kidWord(uint8_t index);
+
+// Copies the next whitespace-separated word at cursor, lowercased, into
+// word (WORD_MAX_LENGTH + 1 bytes) and advances cursor. Returns the word
+// length, 0 at the end of the phrase; longer words are cut short and
+// reported as WORD_MAX_LENGTH + 1 so no lookup matches them.
+size_t nextWord(const char*& cursor, char* word);
+
+// Complete BIP39 check: 12 to 24 words in steps of 3, all in the table,
+// and the trailing checksum bits matching SHA-256 of the entropy
+bool bip39IsValid(const char* phrase);
+
+// Uniformly random index into the kid table, from the hardware RNG
+uint8_t kidWordPick();
+
+// Writes count words picked by kidWordPick(), separated by single spaces.
+// Returns the length, 0 if out is too small.
+size_t kidPhraseGenerate(char* out, size_t capacity, uint8_t count);
+
+#endif // WORDLISTS_H
@@ -0,0 +1,214 @@
+#include "httppool.h"
+#include "log.h"
+
+// Global instance
+HttpConnectionPool httpPool;
+
+HttpConnectionPool::HttpConnectionPool() {
+    memset(&stats, 0, sizeof(stats));
+    lock = portMUX_INITIALIZER_UNLOCKED;
+    for (size_t i = 0; i < HTTP_POOL_SLOTS; i++) {
+        Slot& slot = slots[i];
+        slot.host[0] = '\0';
+        slot.port = 0;
+        slot.https = false;
+        slot.inUse = false;
+        slot.lastUsed = 0;
+    }
+}
+
+HTTPClient* HttpConnectionPool::acquire(const String& url, uint16_t timeout) {
+    char host[HTTP_POOL_HOST_MAX];
+    uint16_t port;
+    bool https;
+    if (!parseOrigin(url, host, sizeof(host), port, https)) {
+        LOG_E(UTILS, "HttpConnectionPool: Unsupported URL %s\n", url.c_str());
+        return nullptr;
+    }
+
+    // An idle connection to the same origin, else an empty slot, else the
+    // least recently used idle connection
+    int match = -1;
+    int empty = -1;
+    int oldest = -1;
+    portENTER_CRITICAL(&lock);
+    for (size_t i = 0; i < HTTP_POOL_SLOTS; i++) {
+        const Slot& slot = slots[i];
+        if (slot.inUse) {
+            continue;
+        }
+        if (slot.host[0] == '\0') {
+            if (empty < 0) empty = i;
+        } else if (slot.port == port && slot.https == https && strcmp(slot.host, host) == 0) {
+            match = i;
+            break;
+        } else if (oldest < 0 || (long)(slot.lastUsed - slots[oldest].lastUsed) < 0) {
+            oldest = i;
+        }
+    }
+    int index = match >= 0 ? match : (empty >= 0 ? empty : oldest);
+    if (index >= 0) {
+        slots[index].inUse = true;
+        stats.requests++;
+    } else {
+        stats.exhausted++;
+    }
+    portEXIT_CRITICAL(&lock);
+
+    if (index < 0) {
+        LOG_W(UTILS, "HttpConnectionPool: All %d connections busy\n", HTTP_POOL_SLOTS);
+        return nullptr;
+    }
+
+    Slot& slot = slots[index];
+    if (index != match) {
+        if (slot.host[0] != '\0') {
+            close(slot);
+            portENTER_CRITICAL(&lock);
+            stats.evictions++;
+            portEXIT_CRITICAL(&lock);
+        }
+        strcpy(slot.host, host);
+        slot.port = port;
+        slot.https = https;
+    }
+
+    // HTTPClient reconnects by itself when the server dropped the socket
+    bool open = slot.client().connected();
+    portENTER_CRITICAL(&lock);
+    if (open) {
+        stats.reused++;
+    } else {
+        stats.handshakes++;
+    }
+    portEXIT_CRITICAL(&lock);
+
+    slot.http.setReuse(true);
+    slot.http.useHTTP10(false);
+    slot.http.setTimeout(timeout);
+    if (!slot.http.begin(slot.client(), url)) {
+        release(&slot.http, false);
+        return nullptr;
+    }
+    return &slot.http;
+}
+
+void HttpConnectionPool::release(HTTPClient* http, bool keep) {
+    for (size_t i = 0; i < HTTP_POOL_SLOTS; i++) {
+        Slot& slot = slots[i];
+        if (&slot.http != http) {
+            continue;
+        }
+
+        // end() keeps the socket when the response allowed keep-alive
+        if (keep) {
+            http->end();
+        } else {
+            close(slot);
+        }
+
+        portENTER_CRITICAL(&lock);
+        slot.lastUsed = millis();
+        slot.inUse = false;
+        portEXIT_CRITICAL(&lock);
+        return;
+    }
+}
+
+void HttpConnectionPool::evictIdle() {
+    unsigned long now = millis();
+    for (size_t i = 0; i < HTTP_POOL_SLOTS; i++) {
+        Slot& slot = slots[i];
+        portENTER_CRITICAL(&lock);
+        bool idle = !slot.inUse && slot.host[0] != '\0' && now - slot.lastUsed > HTTP_POOL_IDLE_TIMEOUT;
+        if (idle) {
+            slot.inUse = true;
+            stats.evictions++;
+        }
+        portEXIT_CRITICAL(&lock);
+
+        if (idle) {
+            LOG_D(UTILS, "HttpConnectionPool: Closing idle connection to %s\n", slot.host);
+            close(slot);
+            portENTER_CRITICAL(&lock);
+            slot.inUse = false;
+            portEXIT_CRITICAL(&lock);
+        }
+    }
+}
+
+void HttpConnectionPool::clear() {
+    for (size_t i = 0; i < HTTP_POOL_SLOTS; i++) {
+        Slot& slot = slots[i];
+        portENTER_CRITICAL(&lock);
+        bool idle = !slot.inUse;
+        if (idle) {
+            slot.inUse = true;
+        }
+        portEXIT_CRITICAL(&lock);
+
+        if (idle) {
+            close(slot);
+            portENTER_CRITICAL(&lock);
+            slot.inUse = false;
+            portEXIT_CRITICAL(&lock);
+        }
+    }
+}
+
+HttpPoolStats HttpConnectionPool::getStats() {
+    portENTER_CRITICAL(&lock);
+    HttpPoolStats copy = stats;
+    portEXIT_CRITICAL(&lock);
+    return copy;
+}
+
+uint8_t HttpConnectionPool::getOpen() {
+    uint8_t open = 0;
+    portENTER_CRITICAL(&lock);
+    for (size_t i = 0; i < HTTP_POOL_SLOTS; i++) {
+        if (slots[i].host[0] != '\0') {
+            open++;
+        }
+    }
+    portEXIT_CRITICAL(&lock);
+    return open;
+}
+
+// Private methods
+void HttpConnectionPool::close(Slot& slot) {
+    slot.http.end();
+    slot.client().stop();
+    slot.host[0] = '\0';
+}
+
+bool HttpConnectionPool::parseOrigin(const String& url, char* host, size_t size, uint16_t& port, bool& https) {
+    const char* cursor = url.c_str();
+    if (strncmp(cursor, "https://", 8) == 0) {
+        https = true;
+        port = 443;
+        cursor += 8;
+    } else if (strncmp(cursor, "http://", 7) == 0) {
+        https = false;
+        port = 80;
+        cursor += 7;
+    } else {
+        return false;
+    }
+
+    size_t length = strcspn(cursor, ":/?#");
+    if (length == 0 || length >= size) {
+        return false;
+    }
+    memcpy(host, cursor, length);
+    host[length] = '\0';
+
+    if (cursor[length] == ':') {
+        long value = strtol(cursor + length + 1, nullptr, 10);
+        if (value <= 0 || value > 65535) {
+            return false;
+        }
+        port = value;
+    }
+    return true;
+}
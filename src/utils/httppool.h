@@ -0,0 +1,73 @@
+#ifndef HTTPPOOL_H
+#define HTTPPOOL_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <HTTPClient.h>
+#include "tlsclient.h"
+
+// Connection pool configuration. Each open TLS connection holds its
+// buffers (~40 KB of heap) while idle, so only a few are kept.
+#define HTTP_POOL_SLOTS         3       // Wallet scan queries plus one for everything else
+#define HTTP_POOL_IDLE_TIMEOUT  30000   // Close connections unused this long
+#define HTTP_POOL_HOST_MAX      64
+
+// Pool counters
+struct HttpPoolStats {
+    uint32_t requests;
+    uint32_t handshakes;    // Requests that had to open a connection
+    uint32_t reused;        // Requests sent on an open keep-alive connection
+    uint32_t evictions;     // Connections closed for idleness or another host
+    uint32_t exhausted;     // No slot free, request not sent
+};
+
+// Keep-alive HTTP(S) clients shared by the wallet and explorer code, one
+// connection per slot and keyed by scheme, host and port. Callers check a
+// client out, use it like a fresh HTTPClient and give it back, so requests
+// to the same host within HTTP_POOL_IDLE_TIMEOUT skip the TCP and TLS
+// handshake. A checked-out slot belongs to one task until released.
+class HttpConnectionPool {
+public:
+    HttpConnectionPool();
+
+    // Returns a client begun on url, or nullptr if url is not http(s) or
+    // every slot is busy. Add headers and send as usual, then release().
+    HTTPClient* acquire(const String& url, uint16_t timeout);
+
+    // keep = false closes the connection, e.g. after an error or when the
+    // body was not read to the end
+    void release(HTTPClient* http, bool keep = true);
+
+    // Closes connections idle longer than HTTP_POOL_IDLE_TIMEOUT
+    void evictIdle();
+    void clear();
+
+    HttpPoolStats getStats();
+    uint8_t getOpen();
+
+private:
+    struct Slot {
+        HTTPClient http;
+        TlsClient secure;           // Resumes sessions cached across deep sleep
+        WiFiClient plain;
+        char host[HTTP_POOL_HOST_MAX];  // Empty while the slot holds no connection
+        uint16_t port;
+        bool https;
+        bool inUse;
+        unsigned long lastUsed;
+
+        WiFiClient& client() { return https ? secure : plain; }
+    };
+
+    Slot slots[HTTP_POOL_SLOTS];
+    HttpPoolStats stats;
+    portMUX_TYPE lock;
+
+    void close(Slot& slot);
+    static bool parseOrigin(const String& url, char* host, size_t size, uint16_t& port, bool& https);
+};
+
+// Global instance
+extern HttpConnectionPool httpPool;
+
+#endif // HTTPPOOL_H
@@ -0,0 +1,179 @@
+#include "jobs.h"
+#include "log.h"
+
+// Global instance
+JobQueue jobs;
+
+JobQueue::JobQueue() {
+    memset(slots, 0, sizeof(slots));
+    memset(&stats, 0, sizeof(stats));
+    nextId = 1;
+    queue = nullptr;
+    worker = nullptr;
+    lock = portMUX_INITIALIZER_UNLOCKED;
+}
+
+void JobQueue::init() {
+    if (worker) {
+        return;
+    }
+    queue = xQueueCreate(JOB_SLOTS, sizeof(uint8_t));
+    xTaskCreate(workerTask, "jobs", JOB_TASK_STACK, this, JOB_TASK_PRIORITY, &worker);
+    LOG_I(UTILS, "JobQueue: Worker started\n");
+}
+
+uint32_t JobQueue::post(const char* name, JobFunction function) {
+    if (!queue) {
+        // Worker not running yet: run inline
+        uint32_t id = nextId++;
+        LOG_W(UTILS, "JobQueue: Not initialized, running %s inline\n", name);
+        function();
+        return id;
+    }
+
+    int index = -1;
+    uint32_t id = 0;
+    bool coalesced = false;
+
+    portENTER_CRITICAL(&lock);
+    for (size_t i = 0; i < JOB_SLOTS; i++) {
+        if (slots[i].status.state == JobState::QUEUED && slots[i].function == function) {
+            id = slots[i].status.id;
+            coalesced = true;
+            break;
+        }
+    }
+    if (!coalesced) {
+        // Free slot first, otherwise the oldest finished job
+        for (size_t i = 0; i < JOB_SLOTS; i++) {
+            JobState state = slots[i].status.state;
+            if (state == JobState::FREE) {
+                index = i;
+                break;
+            }
+            if ((state == JobState::DONE || state == JobState::FAILED) &&
+                (index < 0 || slots[i].status.id < slots[index].status.id)) {
+                index = i;
+            }
+        }
+        if (index >= 0) {
+            id = nextId++;
+            Slot& slot = slots[index];
+            slot.function = function;
+            slot.status.id = id;
+            slot.status.name = name;
+            slot.status.state = JobState::QUEUED;
+            slot.status.queuedAt = millis();
+            slot.status.startedAt = 0;
+            slot.status.finishedAt = 0;
+            stats.posted++;
+        } else {
+            stats.rejected++;
+        }
+    } else {
+        stats.coalesced++;
+    }
+    portEXIT_CRITICAL(&lock);
+
+    if (index >= 0) {
+        uint8_t slotIndex = index;
+        xQueueSend(queue, &slotIndex, 0); // Never full: one entry per slot
+    } else if (!coalesced) {
+        LOG_W(UTILS, "JobQueue: Queue full, rejected %s\n", name);
+    }
+    return id;
+}
+
+bool JobQueue::getStatus(uint32_t id, JobStatus& status) {
+    bool found = false;
+    portENTER_CRITICAL(&lock);
+    for (size_t i = 0; i < JOB_SLOTS; i++) {
+        if (slots[i].status.state != JobState::FREE && slots[i].status.id == id) {
+            status = slots[i].status;
+            found = true;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&lock);
+    return found;
+}
+
+size_t JobQueue::getStatuses(JobStatus* out, size_t max) {
+    size_t count = 0;
+    portENTER_CRITICAL(&lock);
+    for (size_t i = 0; i < JOB_SLOTS && count < max; i++) {
+        if (slots[i].status.state != JobState::FREE) {
+            out[count++] = slots[i].status;
+        }
+    }
+    portEXIT_CRITICAL(&lock);
+    return count;
+}
+
+size_t JobQueue::getPending() {
+    size_t pending = 0;
+    portENTER_CRITICAL(&lock);
+    for (size_t i = 0; i < JOB_SLOTS; i++) {
+        JobState state = slots[i].status.state;
+        if (state == JobState::QUEUED || state == JobState::RUNNING) {
+            pending++;
+        }
+    }
+    portEXIT_CRITICAL(&lock);
+    return pending;
+}
+
+JobStats JobQueue::getStats() {
+    portENTER_CRITICAL(&lock);
+    JobStats copy = stats;
+    portEXIT_CRITICAL(&lock);
+    return copy;
+}
+
+const char* JobQueue::getStateName(JobState state) {
+    switch (state) {
+        case JobState::QUEUED: return "queued";
+        case JobState::RUNNING: return "running";
+        case JobState::DONE: return "done";
+        case JobState::FAILED: return "failed";
+        default: return "free";
+    }
+}
+
+// Private methods
+void JobQueue::run(uint8_t index) {
+    Slot& slot = slots[index];
+
+    portENTER_CRITICAL(&lock);
+    JobFunction function = slot.function;
+    const char* name = slot.status.name;
+    slot.status.state = JobState::RUNNING;
+    slot.status.startedAt = millis();
+    portEXIT_CRITICAL(&lock);
+
+    LOG_I(UTILS, "JobQueue: Running %s\n", name);
+    bool success = function();
+
+    portENTER_CRITICAL(&lock);
+    slot.status.state = success ? JobState::DONE : JobState::FAILED;
+    slot.status.finishedAt = millis();
+    if (success) {
+        stats.completed++;
+    } else {
+        stats.failed++;
+    }
+    unsigned long elapsed = slot.status.finishedAt - slot.status.startedAt;
+    portEXIT_CRITICAL(&lock);
+
+    LOG_I(UTILS, "JobQueue: %s %s in %lu ms\n", name, success ? "finished" : "failed", elapsed);
+}
+
+void JobQueue::workerTask(void* parameter) {
+    JobQueue* self = (JobQueue*)parameter;
+    uint8_t index;
+    while (true) {
+        if (xQueueReceive(self->queue, &index, portMAX_DELAY) == pdTRUE) {
+            self->run(index);
+        }
+    }
+}
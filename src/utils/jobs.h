@@ -0,0 +1,79 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <Arduino.h>
+
+// Deferred job configuration
+#define JOB_SLOTS           8       // Queued, running and recently finished jobs
+#define JOB_TASK_STACK      8192    // Room for an HTTPS request
+#define JOB_TASK_PRIORITY   1
+
+// Long-running work (network I/O, flash writes) posted from contexts that
+// must not block, such as AsyncWebServer handlers. Returns success.
+typedef bool (*JobFunction)();
+
+enum class JobState : uint8_t {
+    FREE,
+    QUEUED,
+    RUNNING,
+    DONE,
+    FAILED
+};
+
+struct JobStatus {
+    uint32_t id;
+    const char* name;
+    JobState state;
+    unsigned long queuedAt;
+    unsigned long startedAt;
+    unsigned long finishedAt;
+};
+
+// Queue counters
+struct JobStats {
+    uint32_t posted;
+    uint32_t coalesced;     // Already queued, existing job reused
+    uint32_t rejected;      // No free slot
+    uint32_t completed;
+    uint32_t failed;
+};
+
+// Bounded FIFO of jobs run one at a time by a dedicated worker task.
+// Finished jobs stay visible for status queries until their slot is reused.
+class JobQueue {
+public:
+    JobQueue();
+    void init();
+
+    // Returns the job id, or 0 when the queue is full. Posting a function
+    // that is already waiting returns the waiting job instead.
+    uint32_t post(const char* name, JobFunction function);
+
+    bool getStatus(uint32_t id, JobStatus& status);
+    size_t getStatuses(JobStatus* out, size_t max);
+    size_t getPending();
+    JobStats getStats();
+
+    static const char* getStateName(JobState state);
+
+private:
+    struct Slot {
+        JobStatus status;
+        JobFunction function;
+    };
+
+    Slot slots[JOB_SLOTS];
+    JobStats stats;
+    uint32_t nextId;
+    QueueHandle_t queue;
+    TaskHandle_t worker;
+    portMUX_TYPE lock;
+
+    void run(uint8_t index);
+    static void workerTask(void* parameter);
+};
+
+// Global instance
+extern JobQueue jobs;
+
+#endif // JOBS_H
@@ -0,0 +1,128 @@
+#include "jsonpool.h"
+
+// Global instance
+JsonPoolAllocator jsonPool;
+
+JsonPoolAllocator::JsonPoolAllocator() {
+    smallUsed = 0;
+    largeUsed = 0;
+    memset(&stats, 0, sizeof(stats));
+    lock = portMUX_INITIALIZER_UNLOCKED;
+}
+
+void* JsonPoolAllocator::allocate(size_t size) {
+    void* ptr = nullptr;
+
+    portENTER_CRITICAL(&lock);
+    if (size <= JSON_POOL_SMALL_SIZE) {
+        ptr = takeBlock(smallUsed, JSON_POOL_SMALL_COUNT, &smallBlocks[0][0], JSON_POOL_SMALL_SIZE,
+                        stats.smallInUse, stats.smallPeak);
+    }
+    if (!ptr && size <= JSON_POOL_LARGE_SIZE) {
+        ptr = takeBlock(largeUsed, JSON_POOL_LARGE_COUNT, &largeBlocks[0][0], JSON_POOL_LARGE_SIZE,
+                        stats.largeInUse, stats.largePeak);
+    }
+    if (ptr) {
+        stats.allocations++;
+    } else {
+        stats.fallbacks++;
+    }
+    portEXIT_CRITICAL(&lock);
+
+    return ptr ? ptr : malloc(size);
+}
+
+void JsonPoolAllocator::deallocate(void* ptr) {
+    if (isSmallBlock(ptr)) {
+        size_t index = ((uint8_t*)ptr - &smallBlocks[0][0]) / JSON_POOL_SMALL_SIZE;
+        portENTER_CRITICAL(&lock);
+        smallUsed &= ~(1ULL << index);
+        stats.smallInUse--;
+        portEXIT_CRITICAL(&lock);
+    } else if (isLargeBlock(ptr)) {
+        size_t index = ((uint8_t*)ptr - &largeBlocks[0][0]) / JSON_POOL_LARGE_SIZE;
+        portENTER_CRITICAL(&lock);
+        largeUsed &= ~(1ULL << index);
+        stats.largeInUse--;
+        portEXIT_CRITICAL(&lock);
+    } else {
+        free(ptr);
+    }
+}
+
+void* JsonPoolAllocator::reallocate(void* ptr, size_t newSize) {
+    size_t oldSize = blockSize(ptr);
+    if (oldSize == 0) {
+        // Heap block (or nullptr) - realloc keeps the contents
+        if (ptr) {
+            return realloc(ptr, newSize);
+        }
+        return allocate(newSize);
+    }
+
+    // Pool block: shrinking in place is free, growing moves to a bigger
+    // block. A string that outgrew a small block while being parsed moves
+    // back down once trimmed, so large blocks stay free for slot pools.
+    if (newSize <= oldSize) {
+        if (oldSize == JSON_POOL_SMALL_SIZE || newSize > JSON_POOL_SMALL_SIZE) {
+            return ptr;
+        }
+        portENTER_CRITICAL(&lock);
+        void* smaller = takeBlock(smallUsed, JSON_POOL_SMALL_COUNT, &smallBlocks[0][0], JSON_POOL_SMALL_SIZE,
+                                  stats.smallInUse, stats.smallPeak);
+        portEXIT_CRITICAL(&lock);
+        if (!smaller) {
+            return ptr;
+        }
+        memcpy(smaller, ptr, newSize);
+        deallocate(ptr);
+        return smaller;
+    }
+    void* moved = allocate(newSize);
+    if (moved) {
+        memcpy(moved, ptr, oldSize);
+        deallocate(ptr);
+    }
+    return moved;
+}
+
+JsonPoolStats JsonPoolAllocator::getStats() const {
+    portENTER_CRITICAL(&lock);
+    JsonPoolStats copy = stats;
+    portEXIT_CRITICAL(&lock);
+    return copy;
+}
+
+// Private methods
+void* JsonPoolAllocator::takeBlock(uint64_t& used, uint8_t count, uint8_t* base, size_t blockSize,
+                                   uint8_t& inUse, uint8_t& peak) {
+    uint64_t mask = (count >= 64) ? ~0ULL : ((1ULL << count) - 1);
+    uint64_t available = ~used & mask;
+    if (available == 0) {
+        return nullptr;
+    }
+
+    int index = __builtin_ctzll(available);
+    used |= (1ULL << index);
+    inUse++;
+    if (inUse > peak) {
+        peak = inUse;
+    }
+    return base + (size_t)index * blockSize;
+}
+
+bool JsonPoolAllocator::isSmallBlock(const void* ptr) const {
+    const uint8_t* p = (const uint8_t*)ptr;
+    return p >= &smallBlocks[0][0] && p < &smallBlocks[0][0] + sizeof(smallBlocks);
+}
+
+bool JsonPoolAllocator::isLargeBlock(const void* ptr) const {
+    const uint8_t* p = (const uint8_t*)ptr;
+    return p >= &largeBlocks[0][0] && p < &largeBlocks[0][0] + sizeof(largeBlocks);
+}
+
+size_t JsonPoolAllocator::blockSize(const void* ptr) const {
+    if (isSmallBlock(ptr)) return JSON_POOL_SMALL_SIZE;
+    if (isLargeBlock(ptr)) return JSON_POOL_LARGE_SIZE;
+    return 0;
+}
@@ -0,0 +1,63 @@
+#ifndef JSONPOOL_H
+#define JSONPOOL_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// Block pool configuration, from the requests ArduinoJson 7 makes on the
+// ESP32 (4-byte pointers):
+// - Variant slots come in 1024 B pools (64 x 16 B slots up to 7.2,
+//   128 x 8 B from 7.3), one large block each.
+// - A string is an 8 B node header plus its text and terminator. One being
+//   parsed starts at 40 B (31 chars), doubles to 71 B and then 133 B, and
+//   is shrunk to fit once complete: 73 B for a txid, at most 71 B for an
+//   address.
+// - The pool list leaves the document for a 64 B block once it holds more
+//   than four slot pools.
+#define JSON_POOL_SMALL_SIZE    80      // Finished strings up to 71 chars, pool list
+#define JSON_POOL_SMALL_COUNT   48      // Max 64 (bitmask)
+#define JSON_POOL_LARGE_SIZE    1088    // One 1024 B slot pool plus headroom
+#define JSON_POOL_LARGE_COUNT   8       // Max 64 (bitmask)
+
+// Pool usage counters
+struct JsonPoolStats {
+    uint32_t allocations;     // Served from the static blocks
+    uint32_t fallbacks;       // Too large or pool exhausted - served by malloc
+    uint8_t smallInUse;
+    uint8_t largeInUse;
+    uint8_t smallPeak;
+    uint8_t largePeak;
+};
+
+// ArduinoJson allocator backed by fixed blocks in .bss, so documents that
+// are built and freed on every API request never touch the general heap.
+// Requests that do not fit fall back to malloc.
+class JsonPoolAllocator : public ArduinoJson::Allocator {
+public:
+    JsonPoolAllocator();
+
+    void* allocate(size_t size) override;
+    void deallocate(void* ptr) override;
+    void* reallocate(void* ptr, size_t newSize) override;
+
+    JsonPoolStats getStats() const;
+
+private:
+    alignas(8) uint8_t smallBlocks[JSON_POOL_SMALL_COUNT][JSON_POOL_SMALL_SIZE];
+    alignas(8) uint8_t largeBlocks[JSON_POOL_LARGE_COUNT][JSON_POOL_LARGE_SIZE];
+    uint64_t smallUsed;
+    uint64_t largeUsed;
+    JsonPoolStats stats;
+    mutable portMUX_TYPE lock;
+
+    void* takeBlock(uint64_t& used, uint8_t count, uint8_t* base, size_t blockSize,
+                    uint8_t& inUse, uint8_t& peak);
+    bool isSmallBlock(const void* ptr) const;
+    bool isLargeBlock(const void* ptr) const;
+    size_t blockSize(const void* ptr) const;
+};
+
+// Global instance
+extern JsonPoolAllocator jsonPool;
+
+#endif // JSONPOOL_H
@@ -0,0 +1,122 @@
+#include "log.h"
+#include <atomic>
+
+static_assert((LOG_RING_SLOTS & (LOG_RING_SLOTS - 1)) == 0, "LOG_RING_SLOTS must be a power of two");
+
+// Bounded multi-producer queue of fixed-size lines. Each slot carries a
+// sequence number: a producer claims a position with one CAS, formats in
+// place and publishes by advancing the slot sequence, so the drain task
+// never sees half-written lines and producers never wait on each other.
+struct LogSlot {
+    std::atomic<uint32_t> sequence;
+    uint16_t length;
+    char text[LOG_LINE_MAX];
+};
+
+static LogSlot ring[LOG_RING_SLOTS];
+static std::atomic<uint32_t> enqueuePos(0);
+static std::atomic<uint32_t> dequeuePos(0);    // Advanced by the drain task only
+static std::atomic<uint32_t> written(0);
+static std::atomic<uint32_t> dropped(0);
+static std::atomic<uint32_t> truncated(0);
+static TaskHandle_t drainTask = nullptr;
+
+static bool drainOne() {
+    uint32_t pos = dequeuePos.load(std::memory_order_relaxed);
+    LogSlot& slot = ring[pos & (LOG_RING_SLOTS - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+        return false;
+    }
+    Serial.write((const uint8_t*)slot.text, slot.length);
+    slot.sequence.store(pos + LOG_RING_SLOTS, std::memory_order_release);
+    dequeuePos.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+static void logTask(void* parameter) {
+    while (true) {
+        while (drainOne()) {
+        }
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+    }
+}
+
+void logInit() {
+    if (drainTask) {
+        return;
+    }
+    for (uint32_t i = 0; i < LOG_RING_SLOTS; i++) {
+        ring[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    xTaskCreate(logTask, "log", LOG_TASK_STACK, nullptr, LOG_TASK_PRIORITY, &drainTask);
+}
+
+void logWrite(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    logWriteV(format, args);
+    va_end(args);
+}
+
+void logWriteV(const char* format, va_list args) {
+    if (!drainTask) {
+        // Early boot, or no task: write synchronously
+        char line[LOG_LINE_MAX];
+        int length = vsnprintf(line, sizeof(line), format, args);
+        if (length > 0) {
+            Serial.write((const uint8_t*)line, min((size_t)length, sizeof(line) - 1));
+        }
+        return;
+    }
+
+    uint32_t pos = enqueuePos.load(std::memory_order_relaxed);
+    LogSlot* slot;
+    while (true) {
+        slot = &ring[pos & (LOG_RING_SLOTS - 1)];
+        int32_t diff = (int32_t)(slot->sequence.load(std::memory_order_acquire) - pos);
+        if (diff == 0) {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            dropped++;  // Full: never block the caller
+            return;
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    int length = vsnprintf(slot->text, LOG_LINE_MAX, format, args);
+    if (length < 0) {
+        length = 0;
+    } else if (length >= LOG_LINE_MAX) {
+        length = LOG_LINE_MAX - 1;
+        slot->text[length - 1] = '\n';
+        truncated++;
+    }
+    slot->length = length;
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    written++;
+
+    xTaskNotifyGive(drainTask);
+}
+
+void logFlush() {
+    if (!drainTask) {
+        return;
+    }
+    unsigned long start = millis();
+    while (dequeuePos.load() != enqueuePos.load() && millis() - start < LOG_FLUSH_TIMEOUT) {
+        xTaskNotifyGive(drainTask);
+        vTaskDelay(pdMS_TO_TICKS(5));
+    }
+    Serial.flush();
+}
+
+LogStats logGetStats() {
+    LogStats stats;
+    stats.written = written.load();
+    stats.dropped = dropped.load();
+    stats.truncated = truncated.load();
+    return stats;
+}
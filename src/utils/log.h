@@ -0,0 +1,85 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <Arduino.h>
+
+// Log levels
+#define LOG_LEVEL_NONE      0
+#define LOG_LEVEL_ERROR     1
+#define LOG_LEVEL_WARN      2
+#define LOG_LEVEL_INFO      3
+#define LOG_LEVEL_DEBUG     4
+
+// Per-module levels, fixed at compile time. Override any of them from
+// build_flags, e.g. -DLOG_LEVEL_COLD=LOG_LEVEL_DEBUG. Calls above the
+// module level compile to nothing, arguments included.
+#ifndef LOG_LEVEL_DEFAULT
+#define LOG_LEVEL_DEFAULT   LOG_LEVEL_INFO
+#endif
+#ifndef LOG_LEVEL_MAIN
+#define LOG_LEVEL_MAIN      LOG_LEVEL_DEFAULT
+#endif
+#ifndef LOG_LEVEL_CORE
+#define LOG_LEVEL_CORE      LOG_LEVEL_DEFAULT
+#endif
+#ifndef LOG_LEVEL_DISPLAY
+#define LOG_LEVEL_DISPLAY   LOG_LEVEL_DEFAULT
+#endif
+#ifndef LOG_LEVEL_INPUT
+#define LOG_LEVEL_INPUT     LOG_LEVEL_DEFAULT
+#endif
+#ifndef LOG_LEVEL_WALLET
+#define LOG_LEVEL_WALLET    LOG_LEVEL_DEFAULT
+#endif
+#ifndef LOG_LEVEL_COLD
+#define LOG_LEVEL_COLD      LOG_LEVEL_DEFAULT
+#endif
+#ifndef LOG_LEVEL_SETTINGS
+#define LOG_LEVEL_SETTINGS  LOG_LEVEL_DEFAULT
+#endif
+#ifndef LOG_LEVEL_UTILS
+#define LOG_LEVEL_UTILS     LOG_LEVEL_DEFAULT
+#endif
+#ifndef LOG_LEVEL_WEB
+#define LOG_LEVEL_WEB       LOG_LEVEL_DEFAULT
+#endif
+#ifndef LOG_LEVEL_AUTH
+#define LOG_LEVEL_AUTH      LOG_LEVEL_DEFAULT
+#endif
+
+// Ring buffer and drain task
+#define LOG_RING_SLOTS      32      // Power of two; lines queued before new ones are dropped
+#define LOG_LINE_MAX        128     // Longer lines are truncated
+#define LOG_TASK_STACK      3072
+#define LOG_TASK_PRIORITY   1       // Below the loop and AsyncTCP tasks
+#define LOG_FLUSH_TIMEOUT   2000    // Max wait in logFlush(), ms
+
+#define LOG_AT(module, level, ...) \
+    do { if ((level) <= LOG_LEVEL_##module) logWrite(__VA_ARGS__); } while (0)
+
+#define LOG_E(module, ...) LOG_AT(module, LOG_LEVEL_ERROR, __VA_ARGS__)
+#define LOG_W(module, ...) LOG_AT(module, LOG_LEVEL_WARN, __VA_ARGS__)
+#define LOG_I(module, ...) LOG_AT(module, LOG_LEVEL_INFO, __VA_ARGS__)
+#define LOG_D(module, ...) LOG_AT(module, LOG_LEVEL_DEBUG, __VA_ARGS__)
+
+// Log output counters
+struct LogStats {
+    uint32_t written;
+    uint32_t dropped;       // Ring full
+    uint32_t truncated;     // Longer than LOG_LINE_MAX
+};
+
+// Starts the drain task. Lines logged before this are written to Serial
+// directly.
+void logInit();
+
+// Formats into the ring without blocking; safe from any task, not ISRs
+void logWrite(const char* format, ...) __attribute__((format(printf, 1, 2)));
+void logWriteV(const char* format, va_list args);
+
+// Waits until queued lines have reached Serial (before sleep or restart)
+void logFlush();
+
+LogStats logGetStats();
+
+#endif // LOG_H
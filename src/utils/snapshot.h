@@ -0,0 +1,41 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <Arduino.h>
+#include <memory>
+
+// Holds the published copy of a value that one writer changes and many
+// tasks read. A snapshot is never modified once shared, so a reader keeps
+// a consistent view for as long as it holds the pointer. Only the pointer
+// copy and swap happen in the critical section; the copy of the value is
+// made before it, and a replaced snapshot is freed after it by whichever
+// holder lets go last.
+template <typename T>
+class SnapshotCell {
+public:
+    typedef std::shared_ptr<const T> Pointer;
+
+    SnapshotCell() {
+        lock = portMUX_INITIALIZER_UNLOCKED;
+    }
+
+    Pointer get() const {
+        portENTER_CRITICAL(&lock);
+        Pointer snapshot = current;
+        portEXIT_CRITICAL(&lock);
+        return snapshot;
+    }
+
+    void publish(const T& value) {
+        Pointer next = std::make_shared<const T>(value);
+        portENTER_CRITICAL(&lock);
+        current.swap(next);
+        portEXIT_CRITICAL(&lock);
+    }
+
+private:
+    Pointer current;
+    mutable portMUX_TYPE lock;
+};
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,23 @@
+#include "stateversion.h"
+#include <atomic>
+#include <esp_system.h>
+
+static std::atomic<uint32_t> stateVersion(0);
+
+uint32_t getStateVersion() {
+    uint32_t version = stateVersion.load();
+    if (version == 0) {
+        // First use: seed with a random value (0 marks "unseeded")
+        uint32_t seed = esp_random() | 1;
+        stateVersion.compare_exchange_strong(version, seed);
+        version = stateVersion.load();
+    }
+    return version;
+}
+
+void bumpStateVersion() {
+    getStateVersion();
+    if (++stateVersion == 0) {
+        ++stateVersion;
+    }
+}
@@ -0,0 +1,13 @@
+#ifndef STATEVERSION_H
+#define STATEVERSION_H
+
+#include <Arduino.h>
+
+// Monotonic version of everything the web pages are rendered from
+// (balances and configuration). Bumped by writers, read by caches to
+// decide whether a previous render is still valid. Starts from a random
+// value each boot so validators issued before a restart never match.
+uint32_t getStateVersion();
+void bumpStateVersion();
+
+#endif // STATEVERSION_H
@@ -0,0 +1,584 @@
+#include "tlsclient.h"
+#include "log.h"
+#include "utils.h"
+#include <LittleFS.h>
+#include <esp_attr.h>
+#include <lwip/sockets.h>
+#include <mbedtls/net_sockets.h>
+#include <time.h>
+
+// Session slots in RTC slow memory. They keep their contents through deep
+// sleep and are zeroed on power-on, when the magic no longer matches.
+struct RtcSession {
+    char host[TLS_SESSION_HOST_MAX];    // Empty for an unused slot
+    uint16_t port;
+    uint16_t length;        // Serialized session size
+    uint32_t savedAt;       // time() when stored; RTC time runs on in deep sleep
+    uint32_t crc;
+    bool inFile;            // Too large for data[], stored on LittleFS
+    uint8_t data[TLS_SESSION_RTC_BYTES];
+};
+
+struct RtcSessionStore {
+    uint32_t magic;
+    RtcSession slots[TLS_SESSION_SLOTS];
+    uint32_t wakeResumedCount;
+    uint32_t wakeResumedMs;     // Sum over wakeResumedCount wakes
+    uint32_t wakeFullCount;
+    uint32_t wakeFullMs;
+};
+
+// Header of a session file on LittleFS
+struct TlsSessionFileHeader {
+    uint32_t magic;
+    uint32_t savedAt;
+    uint32_t length;
+    uint32_t crc;
+};
+
+RTC_DATA_ATTR static RtcSessionStore rtcStore;
+
+// Global instance
+TlsSessionCache tlsSessions;
+
+static int findSlot(const char* host, uint16_t port) {
+    for (size_t i = 0; i < TLS_SESSION_SLOTS; i++) {
+        const RtcSession& slot = rtcStore.slots[i];
+        if (slot.port == port && strcmp(slot.host, host) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// An unused slot, else the one stored longest ago
+static int pickSlot() {
+    int oldest = 0;
+    for (size_t i = 0; i < TLS_SESSION_SLOTS; i++) {
+        const RtcSession& slot = rtcStore.slots[i];
+        if (slot.host[0] == '\0') {
+            return i;
+        }
+        if (slot.savedAt < rtcStore.slots[oldest].savedAt) {
+            oldest = i;
+        }
+    }
+    return oldest;
+}
+
+TlsSessionCache::TlsSessionCache() {
+    memset(&stats, 0, sizeof(stats));
+    bootResumed = 0;
+    bootFull = 0;
+    wakeRecorded = false;
+    lock = portMUX_INITIALIZER_UNLOCKED;
+
+    if (rtcStore.magic != TLS_SESSION_MAGIC) {
+        memset(&rtcStore, 0, sizeof(rtcStore));
+        rtcStore.magic = TLS_SESSION_MAGIC;
+    }
+}
+
+size_t TlsSessionCache::load(const char* host, uint16_t port, uint8_t* out, size_t capacity) {
+    size_t length = 0;
+    uint32_t crc = 0;
+    uint32_t savedAt = 0;
+    bool inRtc = false;
+
+    portENTER_CRITICAL(&lock);
+    int index = findSlot(host, port);
+    if (index >= 0 && !rtcStore.slots[index].inFile) {
+        const RtcSession& slot = rtcStore.slots[index];
+        if (slot.length <= capacity) {
+            memcpy(out, slot.data, slot.length);
+            length = slot.length;
+            crc = slot.crc;
+            savedAt = slot.savedAt;
+        }
+        inRtc = true;
+    }
+    portEXIT_CRITICAL(&lock);
+
+    // Not in RTC memory: too large for a slot, or lost with a power cycle
+    if (!inRtc) {
+        String path = filePath(host, port);
+        if (!LittleFS.exists(path)) {
+            return 0;
+        }
+        File file = LittleFS.open(path, "r");
+        if (!file) {
+            return 0;
+        }
+        TlsSessionFileHeader header;
+        if (file.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+            header.magic == TLS_SESSION_MAGIC && header.length <= capacity &&
+            file.read(out, header.length) == header.length) {
+            length = header.length;
+            crc = header.crc;
+            savedAt = header.savedAt;
+        }
+        file.close();
+    }
+
+    if (length == 0 || utils.crc32(out, length) != crc || expired(savedAt)) {
+        return 0;
+    }
+    return length;
+}
+
+void TlsSessionCache::store(const char* host, uint16_t port, const uint8_t* data, size_t length) {
+    if (length == 0 || length > TLS_SESSION_FILE_MAX || strlen(host) >= TLS_SESSION_HOST_MAX) {
+        return;
+    }
+    uint32_t crc = utils.crc32(data, length);
+    uint32_t now = time(nullptr);
+    bool inFile = length > TLS_SESSION_RTC_BYTES;
+
+    portENTER_CRITICAL(&lock);
+    int index = findSlot(host, port);
+    bool unchanged = index >= 0 && rtcStore.slots[index].length == length && rtcStore.slots[index].crc == crc;
+    if (index < 0) {
+        index = pickSlot();
+    }
+    RtcSession& slot = rtcStore.slots[index];
+    strcpy(slot.host, host);
+    slot.port = port;
+    slot.length = length;
+    slot.crc = crc;
+    
+    // A ticket sent again is the same session and ages from its first
+    // store, which is also what the unrewritten file header says
+    if (!unchanged) {
+        slot.savedAt = now;
+    }
+    slot.inFile = inFile;
+    if (!inFile) {
+        memcpy(slot.data, data, length);
+        stats.rtcStores++;
+    }
+    portEXIT_CRITICAL(&lock);
+
+    // Servers often send the same ticket again; spare the flash then
+    if (!inFile || unchanged) {
+        return;
+    }
+
+    TlsSessionFileHeader header;
+    header.magic = TLS_SESSION_MAGIC;
+    header.savedAt = now;
+    header.length = length;
+    header.crc = crc;
+
+    String path = filePath(host, port);
+    File file = LittleFS.open(path, "w");
+    if (!file) {
+        LOG_W(UTILS, "TlsSessionCache: Failed to open %s\n", path.c_str());
+        return;
+    }
+    size_t written = file.write((const uint8_t*)&header, sizeof(header));
+    written += file.write(data, length);
+    file.close();
+
+    if (written != sizeof(header) + length) {
+        LOG_W(UTILS, "TlsSessionCache: Short write to %s\n", path.c_str());
+        LittleFS.remove(path);
+        return;
+    }
+
+    portENTER_CRITICAL(&lock);
+    stats.fileStores++;
+    portEXIT_CRITICAL(&lock);
+    LOG_D(UTILS, "TlsSessionCache: Stored %u byte session for %s in %s\n",
+          (unsigned)length, host, path.c_str());
+}
+
+void TlsSessionCache::forget(const char* host, uint16_t port) {
+    portENTER_CRITICAL(&lock);
+    int index = findSlot(host, port);
+    if (index >= 0) {
+        memset(&rtcStore.slots[index], 0, sizeof(RtcSession));
+    }
+    portEXIT_CRITICAL(&lock);
+
+    String path = filePath(host, port);
+    if (LittleFS.exists(path)) {
+        LittleFS.remove(path);
+    }
+}
+
+void TlsSessionCache::countHandshake(bool offered, bool resumed) {
+    portENTER_CRITICAL(&lock);
+    if (offered) {
+        stats.offered++;
+    }
+    if (resumed) {
+        stats.resumed++;
+        bootResumed++;
+    } else {
+        stats.full++;
+        bootFull++;
+    }
+    portEXIT_CRITICAL(&lock);
+}
+
+void TlsSessionCache::countFallback() {
+    portENTER_CRITICAL(&lock);
+    stats.fallbacks++;
+    portEXIT_CRITICAL(&lock);
+}
+
+void TlsSessionCache::recordWakeLatency(uint32_t ms) {
+    portENTER_CRITICAL(&lock);
+    if (!wakeRecorded && (bootResumed > 0 || bootFull > 0)) {
+        if (bootFull > 0) {
+            rtcStore.wakeFullCount++;
+            rtcStore.wakeFullMs += ms;
+        } else {
+            rtcStore.wakeResumedCount++;
+            rtcStore.wakeResumedMs += ms;
+        }
+    }
+    wakeRecorded = true;
+    portEXIT_CRITICAL(&lock);
+
+    LOG_I(UTILS, "TlsSessionCache: First balance %lums after boot (%s handshake)\n",
+          (unsigned long)ms, bootFull > 0 ? "full" : "resumed");
+}
+
+TlsSessionStats TlsSessionCache::getStats() {
+    portENTER_CRITICAL(&lock);
+    TlsSessionStats copy = stats;
+    copy.wakeResumedCount = rtcStore.wakeResumedCount;
+    copy.wakeResumedMs = rtcStore.wakeResumedCount ? rtcStore.wakeResumedMs / rtcStore.wakeResumedCount : 0;
+    copy.wakeFullCount = rtcStore.wakeFullCount;
+    copy.wakeFullMs = rtcStore.wakeFullCount ? rtcStore.wakeFullMs / rtcStore.wakeFullCount : 0;
+    portEXIT_CRITICAL(&lock);
+    return copy;
+}
+
+// Private methods
+String TlsSessionCache::filePath(const char* host, uint16_t port) {
+    char path[24];
+    uint32_t hash = utils.crc32((const uint8_t*)host, strlen(host)) ^ port;
+    snprintf(path, sizeof(path), "/tls_%08x.bin", (unsigned)hash);
+    return String(path);
+}
+
+bool TlsSessionCache::expired(uint32_t savedAt) {
+    // Without NTP the clock restarts at power-on; let the server judge then
+    uint32_t now = time(nullptr);
+    return now >= savedAt && now - savedAt > TLS_SESSION_MAX_AGE;
+}
+
+TlsClient::TlsClient() {
+    open = false;
+    offered = false;
+    resumed = false;
+    peeked = -1;
+    timeoutMs = TLS_HANDSHAKE_TIMEOUT;
+
+    mbedtls_ssl_init(&ssl);
+    mbedtls_ssl_config_init(&conf);
+    mbedtls_ctr_drbg_init(&drbg);
+    mbedtls_entropy_init(&entropy);
+}
+
+TlsClient::~TlsClient() {
+    stop();
+    mbedtls_ssl_free(&ssl);
+    mbedtls_ssl_config_free(&conf);
+    mbedtls_ctr_drbg_free(&drbg);
+    mbedtls_entropy_free(&entropy);
+}
+
+int TlsClient::connect(IPAddress ip, uint16_t port) {
+    return connect(ip, port, TLS_HANDSHAKE_TIMEOUT);
+}
+
+int TlsClient::connect(IPAddress ip, uint16_t port, int32_t timeout) {
+    return connect(ip.toString().c_str(), port, timeout);
+}
+
+int TlsClient::connect(const char* host, uint16_t port) {
+    return connect(host, port, TLS_HANDSHAKE_TIMEOUT);
+}
+
+int TlsClient::connect(const char* host, uint16_t port, int32_t timeout) {
+    if (timeout <= 0) {
+        timeout = TLS_HANDSHAKE_TIMEOUT;
+    }
+    if (handshake(host, port, timeout, true)) {
+        return 1;
+    }
+    if (!offered) {
+        return 0;
+    }
+
+    // Servers that cannot resume normally answer with a full handshake,
+    // but some abort instead; drop the session and try once without it
+    LOG_W(UTILS, "TlsClient: Resuming with %s failed, retrying with a full handshake\n", host);
+    tlsSessions.forget(host, port);
+    tlsSessions.countFallback();
+    return handshake(host, port, timeout, false) ? 1 : 0;
+}
+
+size_t TlsClient::write(uint8_t data) {
+    return write(&data, 1);
+}
+
+size_t TlsClient::write(const uint8_t* buf, size_t size) {
+    unsigned long start = millis();
+    size_t written = 0;
+    while (open && written < size) {
+        int ret = mbedtls_ssl_write(&ssl, buf + written, size - written);
+        if (ret > 0) {
+            written += ret;
+            continue;
+        }
+        if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
+            LOG_E(UTILS, "TlsClient: Write failed: -0x%04x\n", -ret);
+            stop();
+            break;
+        }
+        if (millis() - start > (unsigned long)timeoutMs) {
+            LOG_E(UTILS, "TlsClient: Write timed out\n");
+            stop();
+            break;
+        }
+        delay(1);
+    }
+    return written;
+}
+
+int TlsClient::available() {
+    int pending = peeked >= 0 ? 1 : 0;
+    if (!open) {
+        return pending;
+    }
+
+    // Reading zero bytes decrypts the next record if one has arrived
+    if (mbedtls_ssl_get_bytes_avail(&ssl) == 0) {
+        int ret = mbedtls_ssl_read(&ssl, nullptr, 0);
+        if (ret < 0 && ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
+            if (ret != MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY) {
+                LOG_D(UTILS, "TlsClient: Read failed: -0x%04x\n", -ret);
+            }
+            stop();
+            return pending;
+        }
+    }
+    return pending + mbedtls_ssl_get_bytes_avail(&ssl);
+}
+
+int TlsClient::read() {
+    uint8_t data;
+    return read(&data, 1) == 1 ? data : -1;
+}
+
+int TlsClient::read(uint8_t* buf, size_t size) {
+    if (size == 0) {
+        return 0;
+    }
+    size_t count = 0;
+    if (peeked >= 0) {
+        buf[0] = peeked;
+        peeked = -1;
+        count = 1;
+    }
+    if (!open || count == size) {
+        return count > 0 ? count : -1;
+    }
+
+    int ret = mbedtls_ssl_read(&ssl, buf + count, size - count);
+    if (ret > 0) {
+        return count + ret;
+    }
+    if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
+        // 0 or close-notify: the server is done with the connection
+        stop();
+    }
+    return count > 0 ? count : -1;
+}
+
+int TlsClient::peek() {
+    if (peeked < 0) {
+        uint8_t data;
+        if (read(&data, 1) == 1) {
+            peeked = data;
+        }
+    }
+    return peeked;
+}
+
+void TlsClient::flush() {
+    // Writes go straight to the socket. WiFiClient::flush() would discard
+    // received ciphertext, so it is not called.
+}
+
+void TlsClient::stop() {
+    if (open) {
+        mbedtls_ssl_close_notify(&ssl);
+    }
+    open = false;
+    peeked = -1;
+    freeTls();
+    WiFiClient::stop();
+}
+
+uint8_t TlsClient::connected() {
+    if (!open) {
+        return 0;
+    }
+    if (peeked >= 0 || mbedtls_ssl_get_bytes_avail(&ssl) > 0) {
+        return 1;
+    }
+    return WiFiClient::connected();
+}
+
+// Private methods
+bool TlsClient::handshake(const char* host, uint16_t port, int32_t timeout, bool offer) {
+    stop();
+    offered = false;
+    resumed = false;
+
+    // Resolved here: WiFiClient::connect(host, ...) would call back into
+    // the IPAddress overload above and nest a second handshake
+    IPAddress ip;
+    if (!WiFi.hostByName(host, ip)) {
+        LOG_E(UTILS, "TlsClient: Failed to resolve %s\n", host);
+        return false;
+    }
+    if (!WiFiClient::connect(ip, port, timeout)) {
+        LOG_E(UTILS, "TlsClient: Failed to connect to %s:%u\n", host, port);
+        return false;
+    }
+    unsigned long start = millis();
+
+    int socket = fd();
+    fcntl(socket, F_SETFL, fcntl(socket, F_GETFL, 0) | O_NONBLOCK);
+
+    bool ok = mbedtls_ctr_drbg_seed(&drbg, mbedtls_entropy_func, &entropy,
+                                    (const unsigned char*)host, strlen(host)) == 0 &&
+              mbedtls_ssl_config_defaults(&conf, MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_STREAM,
+                                          MBEDTLS_SSL_PRESET_DEFAULT) == 0;
+    if (ok) {
+        mbedtls_ssl_conf_authmode(&conf, MBEDTLS_SSL_VERIFY_NONE);
+        mbedtls_ssl_conf_rng(&conf, mbedtls_ctr_drbg_random, &drbg);
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+        mbedtls_ssl_conf_session_tickets(&conf, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+#endif
+        ok = mbedtls_ssl_setup(&ssl, &conf) == 0 && mbedtls_ssl_set_hostname(&ssl, host) == 0;
+    }
+    if (!ok) {
+        LOG_E(UTILS, "TlsClient: TLS setup failed\n");
+        stop();
+        return false;
+    }
+    mbedtls_ssl_set_bio(&ssl, this, sendCallback, recvCallback, nullptr);
+
+    mbedtls_ssl_session cached;
+    mbedtls_ssl_session_init(&cached);
+    if (offer) {
+        uint8_t* buffer = (uint8_t*)malloc(TLS_SESSION_FILE_MAX);
+        size_t length = buffer ? tlsSessions.load(host, port, buffer, TLS_SESSION_FILE_MAX) : 0;
+        offered = length > 0 &&
+                  mbedtls_ssl_session_load(&cached, buffer, length) == 0 &&
+                  mbedtls_ssl_set_session(&ssl, &cached) == 0;
+        free(buffer);
+    }
+
+    int ret;
+    while ((ret = mbedtls_ssl_handshake(&ssl)) != 0) {
+        if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
+            break;
+        }
+        if (millis() - start > (unsigned long)timeout) {
+            ret = MBEDTLS_ERR_SSL_TIMEOUT;
+            break;
+        }
+        delay(2);
+    }
+    if (ret != 0) {
+        LOG_E(UTILS, "TlsClient: Handshake with %s failed: -0x%04x\n", host, -ret);
+        mbedtls_ssl_session_free(&cached);
+        stop();
+        return false;
+    }
+
+    open = true;
+    timeoutMs = timeout;
+    saveSession(host, port, offered ? &cached : nullptr);
+    mbedtls_ssl_session_free(&cached);
+    tlsSessions.countHandshake(offered, resumed);
+
+    LOG_D(UTILS, "TlsClient: %s with %s in %lums\n",
+          resumed ? "Resumed session" : "Full handshake", host, millis() - start);
+    return true;
+}
+
+void TlsClient::saveSession(const char* host, uint16_t port, const mbedtls_ssl_session* cached) {
+    mbedtls_ssl_session session;
+    mbedtls_ssl_session_init(&session);
+    if (mbedtls_ssl_get_session(&ssl, &session) != 0) {
+        mbedtls_ssl_session_free(&session);
+        return;
+    }
+
+    // A resumed session keeps the master secret of the one offered; a
+    // full handshake derives a new one
+    resumed = cached && memcmp(session.master, cached->master, sizeof(session.master)) == 0;
+
+#if defined(MBEDTLS_SSL_KEEP_PEER_CERTIFICATE)
+    // The certificate is not verified and resumption does not need it, so
+    // it is left out to keep the session small enough for RTC memory
+    mbedtls_x509_crt* certificate = session.peer_cert;
+    session.peer_cert = nullptr;
+#endif
+
+    uint8_t* buffer = (uint8_t*)malloc(TLS_SESSION_FILE_MAX);
+    size_t length = 0;
+    if (buffer && mbedtls_ssl_session_save(&session, buffer, TLS_SESSION_FILE_MAX, &length) == 0) {
+        tlsSessions.store(host, port, buffer, length);
+    }
+    free(buffer);
+
+#if defined(MBEDTLS_SSL_KEEP_PEER_CERTIFICATE)
+    session.peer_cert = certificate;
+#endif
+    mbedtls_ssl_session_free(&session);
+}
+
+// Releases the mbedtls state and leaves fresh contexts for the next connect
+void TlsClient::freeTls() {
+    mbedtls_ssl_free(&ssl);
+    mbedtls_ssl_config_free(&conf);
+    mbedtls_ctr_drbg_free(&drbg);
+    mbedtls_entropy_free(&entropy);
+
+    mbedtls_ssl_init(&ssl);
+    mbedtls_ssl_config_init(&conf);
+    mbedtls_ctr_drbg_init(&drbg);
+    mbedtls_entropy_init(&entropy);
+}
+
+int TlsClient::sendCallback(void* context, const unsigned char* buf, size_t length) {
+    int sent = send(((TlsClient*)context)->fd(), buf, length, 0);
+    if (sent < 0) {
+        if (errno == EWOULDBLOCK || errno == EAGAIN || errno == EINTR) {
+            return MBEDTLS_ERR_SSL_WANT_WRITE;
+        }
+        return MBEDTLS_ERR_NET_SEND_FAILED;
+    }
+    return sent;
+}
+
+int TlsClient::recvCallback(void* context, unsigned char* buf, size_t length) {
+    int received = recv(((TlsClient*)context)->fd(), buf, length, 0);
+    if (received < 0) {
+        if (errno == EWOULDBLOCK || errno == EAGAIN || errno == EINTR) {
+            return MBEDTLS_ERR_SSL_WANT_READ;
+        }
+        return MBEDTLS_ERR_NET_RECV_FAILED;
+    }
+    return received;
+}
@@ -0,0 +1,116 @@
+#ifndef TLSCLIENT_H
+#define TLSCLIENT_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <mbedtls/ssl.h>
+#include <mbedtls/entropy.h>
+#include <mbedtls/ctr_drbg.h>
+
+// TLS session cache configuration. Sessions are kept in RTC slow memory,
+// which survives deep sleep, so the first request after a wake resumes
+// instead of running the full handshake. Serialized sessions that do not
+// fit a slot go to a LittleFS file instead.
+#define TLS_SESSION_SLOTS       2       // One per API host
+#define TLS_SESSION_HOST_MAX    64
+#define TLS_SESSION_RTC_BYTES   512     // Ticket plus session state, peer certificate dropped
+#define TLS_SESSION_FILE_MAX    4096    // Larger session files are treated as corrupt
+#define TLS_SESSION_MAX_AGE     86400   // Seconds; older sessions are not offered
+#define TLS_SESSION_MAGIC       0x31534C54  // "TLS1"
+#define TLS_HANDSHAKE_TIMEOUT   10000   // Used when connect() gets no timeout
+
+// Session cache counters. The wake figures are averaged over the wakes
+// since power-on and kept in RTC memory with the sessions.
+struct TlsSessionStats {
+    uint32_t offered;           // Handshakes started with a cached session
+    uint32_t resumed;           // Server accepted it, no certificate exchange
+    uint32_t full;              // Full handshakes
+    uint32_t fallbacks;         // Resumption failed, retried without a session
+    uint32_t rtcStores;
+    uint32_t fileStores;
+    uint32_t wakeResumedCount;  // First balance of a boot with resumed sessions only
+    uint32_t wakeResumedMs;
+    uint32_t wakeFullCount;     // First balance of a boot with a full handshake
+    uint32_t wakeFullMs;
+};
+
+// Serialized TLS sessions per host and port, in RTC memory or on LittleFS
+class TlsSessionCache {
+public:
+    TlsSessionCache();
+
+    // Copies the session for host:port into out (capacity bytes) and
+    // returns its length, 0 if there is none or it is too old
+    size_t load(const char* host, uint16_t port, uint8_t* out, size_t capacity);
+    void store(const char* host, uint16_t port, const uint8_t* data, size_t length);
+    void forget(const char* host, uint16_t port);
+
+    // Handshake outcomes, counted by TlsClient
+    void countHandshake(bool offered, bool resumed);
+    void countFallback();
+
+    // Records the time from boot to the first balance update of this boot,
+    // once, under the kind of handshake the boot needed
+    void recordWakeLatency(uint32_t ms);
+
+    TlsSessionStats getStats();
+
+private:
+    TlsSessionStats stats;
+    uint32_t bootResumed;
+    uint32_t bootFull;
+    bool wakeRecorded;
+    portMUX_TYPE lock;
+
+    static String filePath(const char* host, uint16_t port);
+    static bool expired(uint32_t savedAt);
+};
+
+// WiFiClient that runs TLS over its own socket with mbedtls, offering the
+// cached session for the host and storing the one the server hands back.
+// A resumption the server rejects falls back to a full handshake on its
+// own; a handshake that fails while resuming is retried once without the
+// session. Peer certificates are not verified, as with setInsecure().
+class TlsClient : public WiFiClient {
+public:
+    TlsClient();
+    ~TlsClient();
+
+    int connect(IPAddress ip, uint16_t port) override;
+    int connect(IPAddress ip, uint16_t port, int32_t timeout) override;
+    int connect(const char* host, uint16_t port) override;
+    int connect(const char* host, uint16_t port, int32_t timeout) override;
+
+    size_t write(uint8_t data) override;
+    size_t write(const uint8_t* buf, size_t size) override;
+    int available() override;
+    int read() override;
+    int read(uint8_t* buf, size_t size) override;
+    int peek() override;
+    void flush() override;
+    void stop() override;
+    uint8_t connected() override;
+
+private:
+    mbedtls_ssl_context ssl;
+    mbedtls_ssl_config conf;
+    mbedtls_ctr_drbg_context drbg;
+    mbedtls_entropy_context entropy;
+    bool open;
+    bool offered;           // Last handshake offered a cached session
+    bool resumed;           // and the server accepted it
+    int peeked;
+    int32_t timeoutMs;
+
+    bool handshake(const char* host, uint16_t port, int32_t timeout, bool offer);
+    void saveSession(const char* host, uint16_t port, const mbedtls_ssl_session* cached);
+    void freeTls();
+
+    static int sendCallback(void* context, const unsigned char* buf, size_t length);
+    static int recvCallback(void* context, unsigned char* buf, size_t length);
+};
+
+// Global instance
+extern TlsSessionCache tlsSessions;
+
+#endif // TLSCLIENT_H
@@ -1,5 +1,7 @@
 #include "utils.h"
+#include "log.h"
 #include <WiFi.h>
+#include <esp_rom_crc.h>
 
 // Global instance
 Utils utils;
@@ -23,14 +25,14 @@ Utils::Utils() {
 }
 
 void Utils::init() {
-    Serial.println("Utils: Initializing");
+    LOG_I(UTILS, "Utils: Initializing\n");
     initRandomSeed();
     debugEnabled = true;
 }
 
 bool Utils::initNTP(const String& server, int timezoneOffset) {
-    Serial.printf("Utils: Initializing NTP - Server: %s, Timezone: %+d\n", 
-                  server.c_str(), timezoneOffset);
+    LOG_I(UTILS, "Utils: Initializing NTP - Server: %s, Timezone: %+d\n", 
+                 server.c_str(), timezoneOffset);
     
     ntpServer = server;
     this->timezoneOffset = timezoneOffset;
@@ -45,7 +47,7 @@ bool Utils::initNTP(const String& server, int timezoneOffset) {
 bool Utils::syncTime() {
     if (!ntpInitialized) return false;
     
-    Serial.println("Utils: Syncing time with NTP server");
+    LOG_I(UTILS, "Utils: Syncing time with NTP server\n");
     
     // Wait for time sync with timeout
     unsigned long startTime = millis();
@@ -54,13 +56,13 @@ bool Utils::syncTime() {
         if (now > 1000000000) { // Valid timestamp
             timeValid = true;
             lastNTPSync = millis();
-            Serial.printf("Utils: Time synced - %s", ctime(&now));
+            LOG_I(UTILS, "Utils: Time synced - %s", ctime(&now));
             return true;
         }
         delay(100);
     }
     
-    Serial.println("Utils: NTP sync timeout");
+    LOG_I(UTILS, "Utils: NTP sync timeout\n");
     return false;
 }
 
@@ -263,13 +265,13 @@ QRCodeData Utils::generateQR(const String& data, uint8_t version) {
     qr.version = version;
     
     // Stub implementation
-    Serial.printf("Utils: Generating QR code for: %s\n", data.c_str());
+    LOG_I(UTILS, "Utils: Generating QR code for: %s\n", data.c_str());
     
     return qr;
 }
 
 bool Utils::generateQRToBuffer(const String& data, uint8_t* buffer, uint8_t& size, uint8_t version) {
-    Serial.printf("Utils: Generating QR to buffer: %s\n", data.c_str());
+    LOG_I(UTILS, "Utils: Generating QR to buffer: %s\n", data.c_str());
     size = 25; // Stub size
     return false; // Stub
 }
@@ -296,7 +298,7 @@ bool Utils::isValidQRData(const String& data) {
 
 // Battery monitoring
 void Utils::initBatteryMonitor() {
-    Serial.println("Utils: Initializing battery monitor");
+    LOG_I(UTILS, "Utils: Initializing battery monitor\n");
     pinMode(BATTERY_ADC_PIN, INPUT);
     updateBatteryStatus();
 }
@@ -373,12 +375,13 @@ String Utils::getWiFiSSID() {
 
 // System utilities
 void Utils::restart() {
-    Serial.println("Utils: Restarting system...");
+    LOG_I(UTILS, "Utils: Restarting system...\n");
+    logFlush();
     ESP.restart();
 }
 
 void Utils::deepSleep(uint64_t microseconds) {
-    Serial.printf("Utils: Entering deep sleep for %llu microseconds\n", microseconds);
+    LOG_I(UTILS, "Utils: Entering deep sleep for %llu microseconds\n", microseconds);
     esp_deep_sleep(microseconds);
 }
 
@@ -471,40 +474,45 @@ String Utils::urlDecode(const String& str) {
 // Debug and logging
 void Utils::enableDebug(bool enable) {
     debugEnabled = enable;
-    Serial.printf("Utils: Debug %s\n", enable ? "enabled" : "disabled");
+    LOG_I(UTILS, "Utils: Debug %s\n", enable ? "enabled" : "disabled");
 }
 
+// Runtime switch on top of the compile-time UTILS level
 void Utils::debugPrint(const String& message) {
     if (debugEnabled) {
-        Serial.print(message);
+        LOG_D(UTILS, "%s", message.c_str());
     }
 }
 
 void Utils::debugPrintln(const String& message) {
     if (debugEnabled) {
-        Serial.println(message);
+        LOG_D(UTILS, "%s\n", message.c_str());
     }
 }
 
 void Utils::debugPrintf(const char* format, ...) {
-    if (debugEnabled) {
+    if (LOG_LEVEL_UTILS >= LOG_LEVEL_DEBUG && debugEnabled) {
         va_list args;
         va_start(args, format);
-        Serial.printf(format, args);
+        logWriteV(format, args);
         va_end(args);
     }
 }
 
 void Utils::logMessage(const String& level, const String& message) {
-    Serial.printf("[%s] %s: %s\n", formatTime(getCurrentTime()).c_str(), level.c_str(), message.c_str());
+    LOG_I(UTILS, "[%s] %s: %s\n", formatTime(getCurrentTime()).c_str(), level.c_str(), message.c_str());
 }
 
 void Utils::dumpHex(const uint8_t* data, size_t length) {
-    for (size_t i = 0; i < length; i++) {
-        if (i % 16 == 0) Serial.printf("\n%04x: ", i);
-        Serial.printf("%02x ", data[i]);
+    // One log line per 16-byte row
+    char row[6 + 16 * 3 + 2];
+    for (size_t offset = 0; offset < length; offset += 16) {
+        size_t pos = snprintf(row, sizeof(row), "%04x: ", (unsigned)offset);
+        for (size_t i = offset; i < length && i < offset + 16; i++) {
+            pos += snprintf(row + pos, sizeof(row) - pos, "%02x ", data[i]);
+        }
+        LOG_D(UTILS, "%s\n", row);
     }
-    Serial.println();
 }
 
 void Utils::setError(const String& error) {
@@ -658,7 +666,8 @@ String Utils::generateUUID() {
 }
 
 uint32_t Utils::crc32(const uint8_t* data, size_t length) {
-    return 0x12345678; // Stub
+    // Standard CRC-32 (IEEE 802.3) from the ROM
+    return esp_rom_crc32_le(0, data, length);
 }
 
 String Utils::base64Encode(const uint8_t* data, size_t length) {
@@ -710,5 +719,5 @@ String Utils::qrToString(const QRCodeData& qr) {
 }
 
 void Utils::printQRCode(const QRCodeData& qr) {
-    Serial.println("QR Code (stub)");
+    LOG_I(UTILS, "QR Code (stub)\n");
 } 
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "wallet.h"
 #include "../settings/settings.h"
+#include "../utils/log.h"
+#include "../utils/httppool.h"
 
 // Global instance
 LightningWallet lightningWallet;
@@ -22,54 +24,54 @@ LightningWallet::LightningWallet() {
 }
 
 void LightningWallet::init() {
-    Serial.println("LightningWallet: Initializing");
+    LOG_I(WALLET, "LightningWallet: Initializing\n");
     status = WalletStatus::UNINITIALIZED;
 }
 
 void LightningWallet::setApiToken(const String& token) {
     apiToken = token;
-    Serial.println("LightningWallet: API token set");
+    LOG_I(WALLET, "LightningWallet: API token set\n");
 }
 
 void LightningWallet::setApiSecret(const String& secret) {
     apiSecret = secret;
-    Serial.println("LightningWallet: API secret set");
+    LOG_I(WALLET, "LightningWallet: API secret set\n");
 }
 
 void LightningWallet::setBaseUrl(const String& url) {
     baseUrl = url;
-    Serial.printf("LightningWallet: Base URL set to %s\n", url.c_str());
+    LOG_I(WALLET, "LightningWallet: Base URL set to %s\n", url.c_str());
 }
 
 bool LightningWallet::connect() {
-    Serial.println("LightningWallet: Connecting...");
+    LOG_I(WALLET, "LightningWallet: Connecting...\n");
     status = WalletStatus::CONNECTED;
     return true;
 }
 
 void LightningWallet::disconnect() {
-    Serial.println("LightningWallet: Disconnected");
+    LOG_I(WALLET, "LightningWallet: Disconnected\n");
     status = WalletStatus::UNINITIALIZED;
 }
 
 bool LightningWallet::authenticate() {
-    Serial.println("LightningWallet: Authenticating...");
+    LOG_I(WALLET, "LightningWallet: Authenticating...\n");
     status = WalletStatus::AUTHENTICATED;
     return true;
 }
 
 bool LightningWallet::updateBalance() {
-    Serial.println("LightningWallet: Updating balance...");
+    LOG_I(WALLET, "LightningWallet: Updating balance...\n");
     
     if (apiToken.isEmpty()) {
-        Serial.println("LightningWallet: No API token configured - wallet not set up");
+        LOG_I(WALLET, "LightningWallet: No API token configured - wallet not set up\n");
         balance.valid = false;
         return false;
     }
     
     // TODO: Implement real WoS API balance checking
     // For now, return a placeholder since WoS API endpoints need verification
-    Serial.println("LightningWallet: Balance checking not yet implemented - showing placeholder");
+    LOG_I(WALLET, "LightningWallet: Balance checking not yet implemented - showing placeholder\n");
     balance.confirmed = 0;
     balance.pending = 0;
     balance.total = 0;
@@ -96,33 +98,33 @@ LightningInvoice LightningWallet::createInvoice(uint64_t amount, const String& d
     invoice.expiry = millis() + 3600000; // 1 hour
     invoice.paid = false;
     
-    Serial.printf("LightningWallet: Invoice created for %llu sats\n", amount);
+    LOG_I(WALLET, "LightningWallet: Invoice created for %llu sats\n", amount);
     return invoice;
 }
 
 bool LightningWallet::checkInvoiceStatus(const String& paymentHash) {
-    Serial.printf("LightningWallet: Checking invoice %s\n", paymentHash.c_str());
+    LOG_I(WALLET, "LightningWallet: Checking invoice %s\n", paymentHash.c_str());
     return false; // Stub
 }
 
 String LightningWallet::getReceiveAddress() {
     // Return the Lightning address from settings if available
-    String address = settings.getConfig().lightning.receiveAddress;
+    String address = settings.getConfig()->lightning.receiveAddress;
     return address.isEmpty() ? "Not configured" : address;
 }
 
 bool LightningWallet::sendPayment(const String& paymentRequest) {
-    Serial.printf("LightningWallet: Sending payment %s\n", paymentRequest.c_str());
+    LOG_I(WALLET, "LightningWallet: Sending payment %s\n", paymentRequest.c_str());
     return true; // Stub
 }
 
 bool LightningWallet::sendToAddress(const String& address, uint64_t amount) {
-    Serial.printf("LightningWallet: Sending %llu sats to %s\n", amount, address.c_str());
+    LOG_I(WALLET, "LightningWallet: Sending %llu sats to %s\n", amount, address.c_str());
     return true; // Stub
 }
 
 bool LightningWallet::updateTransactionHistory() {
-    Serial.println("LightningWallet: Updating transaction history");
+    LOG_I(WALLET, "LightningWallet: Updating transaction history\n");
     return true; // Stub
 }
 
@@ -131,7 +133,7 @@ std::vector<LightningTransaction> LightningWallet::getRecentTransactions(int cou
 }
 
 bool LightningWallet::transferToColdStorage(const String& address, uint64_t amount) {
-    Serial.printf("LightningWallet: Transferring %llu sats to cold storage %s\n", amount, address.c_str());
+    LOG_I(WALLET, "LightningWallet: Transferring %llu sats to cold storage %s\n", amount, address.c_str());
     return true; // Stub
 }
 
@@ -208,12 +210,12 @@ void LightningWallet::handleApiError(int httpCode, const String& response) {
 }
 
 void LightningWallet::logApiCall(const String& endpoint, const String& method, int responseCode) {
-    Serial.printf("LightningWallet: %s %s -> %d\n", method.c_str(), endpoint.c_str(), responseCode);
+    LOG_I(WALLET, "LightningWallet: %s %s -> %d\n", method.c_str(), endpoint.c_str(), responseCode);
 }
 
 void LightningWallet::setError(const String& error) {
     lastError = error;
-    Serial.printf("LightningWallet: Error - %s\n", error.c_str());
+    LOG_E(WALLET, "LightningWallet: Error - %s\n", error.c_str());
 }
 
 void LightningWallet::clearError() {
@@ -250,15 +252,16 @@ bool LightningWallet::isValidJson(const String& json) {
 
 bool LightningWallet::createWalletIfNeeded() {
     // Load existing credentials from settings if available
-    if (!settings.getConfig().lightning.apiToken.isEmpty()) {
-        apiToken = settings.getConfig().lightning.apiToken;
-        apiSecret = settings.getConfig().lightning.apiSecret;
-        Serial.println("LightningWallet: Using configured WoS credentials");
+    ConfigSnapshot config = settings.getConfig();
+    if (!config->lightning.apiToken.isEmpty()) {
+        apiToken = config->lightning.apiToken;
+        apiSecret = config->lightning.apiSecret;
+        LOG_I(WALLET, "LightningWallet: Using configured WoS credentials\n");
         return true;
     }
     
     // No credentials configured - user needs to add them manually
-    Serial.println("LightningWallet: No WoS credentials configured. Please add API token in settings.");
+    LOG_I(WALLET, "LightningWallet: No WoS credentials configured. Please add API token in settings.\n");
     return false;
 }
 
@@ -269,8 +272,8 @@ bool LightningWallet::isWalletCreated() const {
 bool LightningWallet::createWoSWallet() {
     // WoS does not support programmatic wallet creation
     // Users must manually get credentials from the WoS app
-    Serial.println("LightningWallet: WoS wallet creation not supported - use manual credentials");
-    Serial.println("LightningWallet: Please get API credentials from Wallet of Satoshi app and enter them in Settings");
+    LOG_I(WALLET, "LightningWallet: WoS wallet creation not supported - use manual credentials\n");
+    LOG_I(WALLET, "LightningWallet: Please get API credentials from Wallet of Satoshi app and enter them in Settings\n");
     setError("Manual setup required - get WoS credentials from app");
     return false;
 }
@@ -310,33 +313,31 @@ bool LightningWallet::makeWoSGetRequest(const String& endpoint, String& response
         return false;
     }
     
-    HTTPClient http;
-    http.setTimeout(WOS_API_TIMEOUT);
-    
     String url = String(WOS_API_BASE_URL) + endpoint;
-    if (!http.begin(url)) {
+    HTTPClient* http = httpPool.acquire(url, WOS_API_TIMEOUT);
+    if (!http) {
         setError("Failed to initialize HTTP client");
         return false;
     }
     
     // Add WoS authentication headers
-    http.addHeader("Authorization", "Bearer " + apiToken);
-    http.addHeader("Content-Type", "application/json");
-    http.addHeader("User-Agent", "HodlingHog/1.0");
+    http->addHeader("Authorization", "Bearer " + apiToken);
+    http->addHeader("Content-Type", "application/json");
+    http->addHeader("User-Agent", "HodlingHog/1.0");
     
-    int httpCode = http.GET();
+    int httpCode = http->GET();
     lastHttpCode = httpCode;
     
     if (httpCode == 200) {
-        response = http.getString();
-        Serial.printf("LightningWallet: GET %s - Success (%d bytes)\n", endpoint.c_str(), response.length());
-        http.end();
+        response = http->getString();
+        LOG_I(WALLET, "LightningWallet: GET %s - Success (%d bytes)\n", endpoint.c_str(), response.length());
+        httpPool.release(http);
         clearError();
         return true;
     } else {
-        Serial.printf("LightningWallet: GET %s - Failed (HTTP %d)\n", endpoint.c_str(), httpCode);
+        LOG_E(WALLET, "LightningWallet: GET %s - Failed (HTTP %d)\n", endpoint.c_str(), httpCode);
         setError("GET request failed: HTTP " + String(httpCode));
-        http.end();
+        httpPool.release(http, false);
         return false;
     }
 }
@@ -347,11 +348,9 @@ bool LightningWallet::makeWoSPostRequest(const String& endpoint, const String& p
         return false;
     }
     
-    HTTPClient http;
-    http.setTimeout(WOS_API_TIMEOUT);
-    
     String url = String(WOS_API_BASE_URL) + endpoint;
-    if (!http.begin(url)) {
+    HTTPClient* http = httpPool.acquire(url, WOS_API_TIMEOUT);
+    if (!http) {
         setError("Failed to initialize HTTP client");
         return false;
     }
@@ -362,27 +361,27 @@ bool LightningWallet::makeWoSPostRequest(const String& endpoint, const String& p
     String signature = calculateHMAC(message, apiSecret);
     
     // Add WoS authentication headers
-    http.addHeader("Authorization", "Bearer " + apiToken);
-    http.addHeader("X-Nonce", nonce);
-    http.addHeader("X-Signature", signature);
-    http.addHeader("Content-Type", "application/json");
-    http.addHeader("User-Agent", "HodlingHog/1.0");
+    http->addHeader("Authorization", "Bearer " + apiToken);
+    http->addHeader("X-Nonce", nonce);
+    http->addHeader("X-Signature", signature);
+    http->addHeader("Content-Type", "application/json");
+    http->addHeader("User-Agent", "HodlingHog/1.0");
     
-    int httpCode = http.POST(payload);
+    int httpCode = http->POST(payload);
     lastHttpCode = httpCode;
     
     if (httpCode == 200 || httpCode == 201) {
-        response = http.getString();
-        Serial.printf("LightningWallet: POST %s - Success (%d bytes)\n", endpoint.c_str(), response.length());
-        http.end();
+        response = http->getString();
+        LOG_I(WALLET, "LightningWallet: POST %s - Success (%d bytes)\n", endpoint.c_str(), response.length());
+        httpPool.release(http);
         clearError();
         return true;
     } else {
-        Serial.printf("LightningWallet: POST %s - Failed (HTTP %d)\n", endpoint.c_str(), httpCode);
-        String errorResponse = http.getString();
-        Serial.printf("LightningWallet: Error response: %s\n", errorResponse.c_str());
+        LOG_E(WALLET, "LightningWallet: POST %s - Failed (HTTP %d)\n", endpoint.c_str(), httpCode);
+        String errorResponse = http->getString();
+        LOG_E(WALLET, "LightningWallet: Error response: %s\n", errorResponse.c_str());
         setError("POST request failed: HTTP " + String(httpCode));
-        http.end();
+        httpPool.release(http, false);
         return false;
     }
 }
@@ -392,7 +391,7 @@ bool LightningWallet::parseWalletCreationResponse(const String& response, String
     DeserializationError error = deserializeJson(doc, response);
     
     if (error) {
-        Serial.printf("LightningWallet: JSON parsing failed: %s\n", error.c_str());
+        LOG_E(WALLET, "LightningWallet: JSON parsing failed: %s\n", error.c_str());
         setError("Invalid JSON response");
         return false;
     }
@@ -413,12 +412,12 @@ bool LightningWallet::parseWalletCreationResponse(const String& response, String
                 address = token.substring(0, 8) + "@getalby.com";
             }
             
-            Serial.println("LightningWallet: Wallet creation response parsed successfully");
+            LOG_I(WALLET, "LightningWallet: Wallet creation response parsed successfully\n");
             return true;
         }
     }
     
-    Serial.println("LightningWallet: Invalid wallet creation response format");
+    LOG_E(WALLET, "LightningWallet: Invalid wallet creation response format\n");
     setError("Invalid wallet creation response");
     return false;
 }
@@ -428,7 +427,7 @@ bool LightningWallet::parseBalanceResponse(const String& response) {
     DeserializationError error = deserializeJson(doc, response);
     
     if (error) {
-        Serial.printf("LightningWallet: JSON parsing failed: %s\n", error.c_str());
+        LOG_E(WALLET, "LightningWallet: JSON parsing failed: %s\n", error.c_str());
         setError("Invalid JSON response");
         balance.valid = false;
         return false;
@@ -446,13 +445,13 @@ bool LightningWallet::parseBalanceResponse(const String& response) {
             balance.valid = true;
             balance.lastUpdate = millis();
             
-            Serial.printf("LightningWallet: Balance parsed successfully - %llu sats\n", balance.total);
+            LOG_I(WALLET, "LightningWallet: Balance parsed successfully - %llu sats\n", balance.total);
             clearError();
             return true;
         }
     }
     
-    Serial.println("LightningWallet: Invalid balance response format");
+    LOG_E(WALLET, "LightningWallet: Invalid balance response format\n");
     setError("Invalid balance response");
     balance.valid = false;
     return false;
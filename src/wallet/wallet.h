@@ -124,10 +124,6 @@ private:
     LightningBalance balance;
     std::vector<LightningTransaction> transactions;
     
-    // HTTP client for API calls
-    HTTPClient httpClient;
-    WiFiClientSecure secureClient;
-    
     // Configuration
     unsigned long apiTimeout;
     int retryAttempts;
@@ -0,0 +1,267 @@
+#include "auth.h"
+#include <mbedtls/md.h>
+
+static bool isSpace(char c) {
+    return c == ' ' || c == '\t';
+}
+
+bool findCookie(const char* header, const char* name, HeaderView& value) {
+    if (!header) {
+        return false;
+    }
+
+    size_t nameLength = strlen(name);
+    const char* p = header;
+    while (*p) {
+        // Skip separators before the next name=value pair
+        while (*p == ';' || isSpace(*p)) {
+            p++;
+        }
+
+        const char* pairStart = p;
+        while (*p && *p != ';') {
+            p++;
+        }
+        const char* pairEnd = p;
+
+        if ((size_t)(pairEnd - pairStart) > nameLength &&
+            strncmp(pairStart, name, nameLength) == 0 && pairStart[nameLength] == '=') {
+            const char* valueStart = pairStart + nameLength + 1;
+            while (pairEnd > valueStart && isSpace(pairEnd[-1])) {
+                pairEnd--;
+            }
+            value.data = valueStart;
+            value.length = pairEnd - valueStart;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool findBearer(const char* header, HeaderView& credential) {
+    if (!header || strncasecmp(header, "Bearer ", 7) != 0) {
+        return false;
+    }
+
+    const char* start = header + 7;
+    while (isSpace(*start)) {
+        start++;
+    }
+    const char* end = start + strlen(start);
+    while (end > start && isSpace(end[-1])) {
+        end--;
+    }
+    if (end == start) {
+        return false;
+    }
+
+    credential.data = start;
+    credential.length = end - start;
+    return true;
+}
+
+CredentialCache::CredentialCache() {
+    memset(entries, 0, sizeof(entries));
+    hits = 0;
+    misses = 0;
+    rejected = 0;
+    failures = 0;
+    lastFailure = 0;
+    lock = portMUX_INITIALIZER_UNLOCKED;
+}
+
+bool CredentialCache::lookup(const char* credential, size_t length, AuthLevel& level) {
+    uint8_t key[32];
+    digest(credential, length, key);
+
+    unsigned long now = millis();
+    bool found = false;
+    portENTER_CRITICAL(&lock);
+    for (size_t i = 0; i < AUTH_CACHE_SLOTS; i++) {
+        Entry& entry = entries[i];
+        if (!entry.valid) {
+            continue;
+        }
+        if (now - entry.verifiedAt > AUTH_CACHE_TTL) {
+            entry.valid = false;
+            continue;
+        }
+        if (memcmp(entry.digest, key, sizeof(key)) == 0) {
+            level = entry.level;
+            found = true;
+            break;
+        }
+    }
+    if (found) {
+        hits++;
+    } else {
+        misses++;
+    }
+    portEXIT_CRITICAL(&lock);
+    return found;
+}
+
+void CredentialCache::insert(const char* credential, size_t length, AuthLevel level) {
+    uint8_t key[32];
+    digest(credential, length, key);
+
+    // Reuse a free slot, otherwise replace the oldest verification
+    unsigned long now = millis();
+    portENTER_CRITICAL(&lock);
+    Entry* slot = &entries[0];
+    for (size_t i = 0; i < AUTH_CACHE_SLOTS; i++) {
+        if (!entries[i].valid) {
+            slot = &entries[i];
+            break;
+        }
+        if (now - entries[i].verifiedAt > now - slot->verifiedAt) {
+            slot = &entries[i];
+        }
+    }
+
+    memcpy(slot->digest, key, sizeof(key));
+    slot->level = level;
+    slot->verifiedAt = now;
+    slot->valid = true;
+    failures = 0;
+    portEXIT_CRITICAL(&lock);
+}
+
+void CredentialCache::recordFailure() {
+    portENTER_CRITICAL(&lock);
+    rejected++;
+    if (failures < AUTH_BEARER_FAILURES) {
+        failures++;
+    }
+    lastFailure = millis();
+    portEXIT_CRITICAL(&lock);
+}
+
+bool CredentialCache::isLocked() {
+    portENTER_CRITICAL(&lock);
+    bool locked = failures >= AUTH_BEARER_FAILURES;
+    if (locked && millis() - lastFailure > AUTH_BEARER_LOCKOUT) {
+        failures = 0;
+        locked = false;
+    }
+    portEXIT_CRITICAL(&lock);
+    return locked;
+}
+
+void CredentialCache::clear() {
+    portENTER_CRITICAL(&lock);
+    memset(entries, 0, sizeof(entries));
+    portEXIT_CRITICAL(&lock);
+}
+
+void CredentialCache::digest(const char* credential, size_t length, uint8_t* out) {
+    mbedtls_md(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256),
+               (const unsigned char*)credential, length, out);
+}
+
+PendingCredentials::PendingCredentials() {
+    memset(entries, 0, sizeof(entries));
+    memset(states, 0, sizeof(states));
+    lock = portMUX_INITIALIZER_UNLOCKED;
+}
+
+int PendingCredentials::add(const char* credential, size_t length, const char* sessionToken, uint32_t clientIP) {
+    if (length > AUTH_PHRASE_MAX) {
+        return -1;
+    }
+
+    int slot = -1;
+    size_t waiting = 0;
+    portENTER_CRITICAL(&lock);
+    for (size_t i = 0; i < AUTH_PENDING_SLOTS; i++) {
+        if (states[i] == SlotState::FREE) {
+            if (slot < 0) {
+                slot = i;
+            }
+            continue;
+        }
+        // An API client retrying before its first check ran
+        if (!sessionToken && states[i] == SlotState::QUEUED && entries[i].sessionToken[0] == '\0' &&
+            entries[i].length == length && memcmp(entries[i].credential, credential, length) == 0) {
+            portEXIT_CRITICAL(&lock);
+            return i;
+        }
+        if (entries[i].clientIP == clientIP) {
+            waiting++;
+        }
+    }
+    // Each verification costs the worker a full KDF run, so one client
+    // cannot fill every slot
+    if (waiting >= AUTH_PENDING_PER_CLIENT) {
+        slot = -1;
+    }
+    if (slot >= 0) {
+        Entry& entry = entries[slot];
+        memcpy(entry.credential, credential, length);
+        entry.credential[length] = '\0';
+        entry.length = length;
+        if (sessionToken) {
+            memcpy(entry.sessionToken, sessionToken, sizeof(entry.sessionToken));
+        } else {
+            entry.sessionToken[0] = '\0';
+        }
+        entry.clientIP = clientIP;
+        states[slot] = SlotState::QUEUED;
+    }
+    portEXIT_CRITICAL(&lock);
+    return slot;
+}
+
+void PendingCredentials::cancel(int slot) {
+    if (slot < 0 || slot >= AUTH_PENDING_SLOTS) {
+        return;
+    }
+    portENTER_CRITICAL(&lock);
+    if (states[slot] == SlotState::QUEUED) {
+        memset(&entries[slot], 0, sizeof(Entry));
+        states[slot] = SlotState::FREE;
+    }
+    portEXIT_CRITICAL(&lock);
+}
+
+int PendingCredentials::next(Entry& entry) {
+    int slot = -1;
+    portENTER_CRITICAL(&lock);
+    for (size_t i = 0; i < AUTH_PENDING_SLOTS; i++) {
+        if (states[i] == SlotState::QUEUED) {
+            states[i] = SlotState::RUNNING;
+            entry = entries[i];
+            slot = i;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&lock);
+    return slot;
+}
+
+void PendingCredentials::finish(int slot) {
+    if (slot < 0 || slot >= AUTH_PENDING_SLOTS) {
+        return;
+    }
+    portENTER_CRITICAL(&lock);
+    memset(&entries[slot], 0, sizeof(Entry));
+    states[slot] = SlotState::FREE;
+    portEXIT_CRITICAL(&lock);
+}
+
+bool PendingCredentials::isPending(const char* sessionToken, size_t length) {
+    if (length != SESSION_TOKEN_HEX_LEN) {
+        return false;
+    }
+
+    bool pending = false;
+    portENTER_CRITICAL(&lock);
+    for (size_t i = 0; i < AUTH_PENDING_SLOTS; i++) {
+        if (states[i] != SlotState::FREE && memcmp(entries[i].sessionToken, sessionToken, length) == 0) {
+            pending = true;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&lock);
+    return pending;
+}
@@ -0,0 +1,113 @@
+#ifndef AUTH_H
+#define AUTH_H
+
+#include <Arduino.h>
+#include "sessions.h"
+
+// Verified Bearer credential cache
+#define AUTH_CACHE_SLOTS    4       // Distinct credentials remembered
+#define AUTH_CACHE_TTL      60000   // Re-verify a cached credential after 1 minute
+#define AUTH_BEARER_FAILURES 5      // Rejected Bearer credentials before the Bearer lockout
+#define AUTH_BEARER_LOCKOUT 300000  // Bearer lockout: 5 minutes without verifications
+
+// Seed phrase checks deferred to the job worker
+#define AUTH_PENDING_SLOTS  4       // Logins and Bearer misses awaiting verification
+#define AUTH_PHRASE_MAX     256     // Longest credential taken for verification
+#define AUTH_PENDING_PER_CLIENT 1   // Verifications one client IP may have waiting
+
+// Non-owning view into a request header value
+struct HeaderView {
+    const char* data;
+    size_t length;
+};
+
+// Allocation-free header tokenizers
+bool findCookie(const char* header, const char* name, HeaderView& value);
+bool findBearer(const char* header, HeaderView& credential);
+
+// Remembers recently verified Bearer credentials by SHA-256 digest, so
+// API pollers do not pay for full seed phrase verification on every call.
+// Only successes are cached. Failures lock out further Bearer checks for a
+// while, kept apart from the login lockout so a misconfigured or hostile
+// API client cannot lock the owner out of the login page.
+// Looked up on the AsyncTCP task and filled by the job worker.
+class CredentialCache {
+public:
+    CredentialCache();
+
+    bool lookup(const char* credential, size_t length, AuthLevel& level);
+    void insert(const char* credential, size_t length, AuthLevel level);
+    void clear();
+
+    // Bearer lockout
+    void recordFailure();
+    bool isLocked();
+
+    // Statistics
+    uint32_t getHits() const { return hits; }
+    uint32_t getMisses() const { return misses; }
+    uint32_t getRejected() const { return rejected; }
+
+private:
+    struct Entry {
+        uint8_t digest[32];
+        AuthLevel level;
+        unsigned long verifiedAt;
+        bool valid;
+    };
+
+    Entry entries[AUTH_CACHE_SLOTS];
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t rejected;
+    uint8_t failures;               // Since the last success or lockout
+    unsigned long lastFailure;
+    portMUX_TYPE lock;
+
+    static void digest(const char* credential, size_t length, uint8_t* out);
+};
+
+// Seed phrase verifications handed from the AsyncTCP task to the job
+// worker, which runs the KDF. A login carries the session token already
+// sent in its cookie, and its session is only created once the phrase
+// checks out; a Bearer credential goes into the CredentialCache instead.
+class PendingCredentials {
+public:
+    struct Entry {
+        char credential[AUTH_PHRASE_MAX + 1];
+        size_t length;
+        char sessionToken[SESSION_TOKEN_HEX_LEN + 1];   // Empty for Bearer
+        uint32_t clientIP;
+    };
+
+    PendingCredentials();
+
+    // Returns the slot, or -1 when every slot is taken, the client already
+    // has AUTH_PENDING_PER_CLIENT entries waiting or the credential is too
+    // long. A Bearer credential already waiting is not queued twice.
+    int add(const char* credential, size_t length, const char* sessionToken, uint32_t clientIP);
+
+    // Withdraws an entry the worker has not started on
+    void cancel(int slot);
+
+    // Copies out a queued entry and returns its slot, or -1 when none is
+    // left; finish() frees the slot once the result has been applied
+    int next(Entry& entry);
+    void finish(int slot);
+
+    // True while the login behind this session token is being verified
+    bool isPending(const char* sessionToken, size_t length);
+
+private:
+    enum class SlotState : uint8_t {
+        FREE,
+        QUEUED,
+        RUNNING
+    };
+
+    Entry entries[AUTH_PENDING_SLOTS];
+    SlotState states[AUTH_PENDING_SLOTS];
+    portMUX_TYPE lock;
+};
+
+#endif // AUTH_H
@@ -0,0 +1,200 @@
+#include "ota.h"
+#include <Update.h>
+#include "../utils/log.h"
+
+// Inactive app partition, through the Arduino Update library
+static bool partitionBegin(size_t size) {
+    return Update.begin(size ? size : UPDATE_SIZE_UNKNOWN, U_FLASH);
+}
+
+static size_t partitionWrite(const uint8_t* data, size_t length) {
+    return Update.write(const_cast<uint8_t*>(data), length);
+}
+
+static bool partitionEnd() {
+    return Update.end(true);
+}
+
+static void partitionAbort() {
+    Update.abort();
+}
+
+const OtaTarget OTA_PARTITION_TARGET = {
+    partitionBegin,
+    partitionWrite,
+    partitionEnd,
+    partitionAbort
+};
+
+OtaUpdater::OtaUpdater(const OtaTarget& target) : target(target) {
+    mbedtls_md_init(&hash);
+    memset(expected, 0, sizeof(expected));
+    upload = 0;
+    lastUpload = 0;
+    state = OtaState::IDLE;
+    error = nullptr;
+    written = 0;
+    startedAt = 0;
+    lastChunkAt = 0;
+    finishedAt = 0;
+}
+
+bool OtaUpdater::begin(uint32_t& upload, const char* expectedSha256) {
+    if (state == OtaState::VERIFIED || (state == OtaState::RECEIVING && isBusy())) {
+        upload = 0;
+        return false;
+    }
+    if (state == OtaState::RECEIVING) {
+        LOG_W(WEB, "OTA: Abandoning stalled upload after %u bytes\n", (unsigned)written);
+        target.abort();
+        mbedtls_md_free(&hash);
+    }
+
+    if (++lastUpload == 0) {
+        lastUpload = 1;
+    }
+    this->upload = lastUpload;
+    upload = lastUpload;
+    error = nullptr;
+    written = 0;
+    startedAt = millis();
+    lastChunkAt = startedAt;
+    finishedAt = 0;
+
+    if (!expectedSha256 || !parseHex(expectedSha256, expected, sizeof(expected))) {
+        fail("Missing or malformed SHA-256");
+        return false;
+    }
+
+    if (mbedtls_md_setup(&hash, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 0) != 0 ||
+        mbedtls_md_starts(&hash) != 0) {
+        fail("Hash setup failed");
+        return false;
+    }
+
+    if (!target.begin(0)) {
+        fail("No update partition available");
+        return false;
+    }
+
+    state = OtaState::RECEIVING;
+    LOG_I(WEB, "OTA: Receiving firmware image\n");
+    return true;
+}
+
+bool OtaUpdater::write(uint32_t upload, const uint8_t* data, size_t length) {
+    if (!isOwner(upload) || state != OtaState::RECEIVING) {
+        return false;
+    }
+
+    mbedtls_md_update(&hash, data, length);
+    if (target.write(data, length) != length) {
+        target.abort();
+        fail("Flash write failed");
+        return false;
+    }
+
+    written += length;
+    lastChunkAt = millis();
+    return true;
+}
+
+bool OtaUpdater::finish(uint32_t upload) {
+    if (!isOwner(upload) || state != OtaState::RECEIVING) {
+        return false;
+    }
+
+    uint8_t digest[32];
+    mbedtls_md_finish(&hash, digest);
+    mbedtls_md_free(&hash);
+
+    if (written == 0) {
+        target.abort();
+        fail("Empty firmware image");
+        return false;
+    }
+
+    // Compare before end(): the boot partition only changes for a match
+    if (memcmp(digest, expected, sizeof(digest)) != 0) {
+        target.abort();
+        fail("SHA-256 mismatch");
+        return false;
+    }
+
+    if (!target.end()) {
+        fail("Firmware image rejected");
+        return false;
+    }
+
+    state = OtaState::VERIFIED;
+    finishedAt = millis();
+    unsigned long elapsed = getElapsed();
+    LOG_I(WEB, "OTA: %u bytes verified in %lu ms (%lu KB/s)\n",
+               (unsigned)written, elapsed, elapsed ? (unsigned long)(written / elapsed) : 0UL);
+    return true;
+}
+
+void OtaUpdater::release(uint32_t upload) {
+    if (!isOwner(upload) || state == OtaState::VERIFIED) {
+        return;
+    }
+    if (state == OtaState::RECEIVING) {
+        target.abort();
+        mbedtls_md_free(&hash);
+    }
+    this->upload = 0;
+    state = OtaState::IDLE;
+}
+
+bool OtaUpdater::isBusy() const {
+    if (state == OtaState::VERIFIED) {
+        return true;
+    }
+    return state == OtaState::RECEIVING && millis() - lastChunkAt < OTA_IDLE_TIMEOUT;
+}
+
+unsigned long OtaUpdater::getElapsed() const {
+    if (startedAt == 0) {
+        return 0;
+    }
+    return (finishedAt ? finishedAt : millis()) - startedAt;
+}
+
+const char* OtaUpdater::getStateName(OtaState state) {
+    switch (state) {
+        case OtaState::RECEIVING: return "receiving";
+        case OtaState::VERIFIED: return "verified";
+        case OtaState::FAILED: return "failed";
+        default: return "idle";
+    }
+}
+
+// Private methods
+void OtaUpdater::fail(const char* reason) {
+    mbedtls_md_free(&hash);
+    state = OtaState::FAILED;
+    error = reason;
+    finishedAt = millis();
+    LOG_E(WEB, "OTA: %s after %u bytes\n", reason, (unsigned)written);
+}
+
+bool OtaUpdater::parseHex(const char* hex, uint8_t* out, size_t length) {
+    if (strlen(hex) != length * 2) {
+        return false;
+    }
+    for (size_t i = 0; i < length * 2; i++) {
+        char c = hex[i];
+        uint8_t nibble;
+        if (c >= '0' && c <= '9') {
+            nibble = c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            nibble = c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            nibble = c - 'A' + 10;
+        } else {
+            return false;
+        }
+        out[i / 2] = (i % 2) ? (out[i / 2] | nibble) : (nibble << 4);
+    }
+    return true;
+}
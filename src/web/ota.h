@@ -0,0 +1,77 @@
+#ifndef OTA_H
+#define OTA_H
+
+#include <Arduino.h>
+#include <mbedtls/md.h>
+
+// Firmware update configuration
+#define OTA_PATH            "/api/firmware"
+#define OTA_HASH_HEADER     "X-Firmware-SHA256"
+#define OTA_IDLE_TIMEOUT    30000   // An upload silent this long is abandoned
+#define OTA_RESTART_DELAY   1000    // Lets the response reach the client before rebooting
+
+// Where the image goes. The device writes the inactive app partition via
+// the Update library; anything with the same four calls (e.g. a file on a
+// host) can stand in for it.
+struct OtaTarget {
+    bool (*begin)(size_t size);     // size 0 when unknown
+    size_t (*write)(const uint8_t* data, size_t length);
+    bool (*end)();                  // Finalize and select for the next boot
+    void (*abort)();
+};
+
+extern const OtaTarget OTA_PARTITION_TARGET;
+
+enum class OtaState : uint8_t {
+    IDLE,
+    RECEIVING,
+    VERIFIED,       // Boot partition switched, restart pending
+    FAILED
+};
+
+// Streams an uploaded image into the target chunk by chunk, hashing it on
+// the way, and only finalizes it when the SHA-256 matches the one supplied
+// with the upload. Nothing is buffered beyond what the target itself holds.
+// One upload at a time, identified by an id that is never reused, unlike
+// the address of the request carrying it; used from the AsyncTCP task only.
+class OtaUpdater {
+public:
+    explicit OtaUpdater(const OtaTarget& target);
+
+    // upload receives a fresh id once the updater is claimed, also when the
+    // upload then fails (so its error can be reported), and 0 while another
+    // upload holds it. True if receiving.
+    bool begin(uint32_t& upload, const char* expectedSha256);
+    bool write(uint32_t upload, const uint8_t* data, size_t length);
+    bool finish(uint32_t upload);
+
+    // Result consumed: anything short of a verified image is dropped
+    void release(uint32_t upload);
+
+    bool isOwner(uint32_t upload) const { return upload && this->upload == upload; }
+    bool isBusy() const;
+    OtaState getState() const { return state; }
+    const char* getError() const { return error ? error : "No firmware image received"; }
+    size_t getWritten() const { return written; }
+    unsigned long getElapsed() const;
+
+    static const char* getStateName(OtaState state);
+
+private:
+    const OtaTarget& target;
+    mbedtls_md_context_t hash;
+    uint8_t expected[32];
+    uint32_t upload;                // Id of the current upload, 0 when none
+    uint32_t lastUpload;
+    OtaState state;
+    const char* error;
+    size_t written;
+    unsigned long startedAt;
+    unsigned long lastChunkAt;
+    unsigned long finishedAt;
+
+    void fail(const char* reason);
+    static bool parseHex(const char* hex, uint8_t* out, size_t length);
+};
+
+#endif // OTA_H
@@ -0,0 +1,153 @@
+#include "pagecache.h"
+#include "../utils/log.h"
+
+#define PAGE_ETAG_MAX   24
+
+PageCache::PageCache() {
+    memset(&stats, 0, sizeof(stats));
+    enabled = true;
+}
+
+bool PageCache::send(AsyncWebServerRequest* request, const char* page, uint32_t version, AuthLevel auth) {
+    char etag[PAGE_ETAG_MAX];
+    formatETag(etag, sizeof(etag), version, auth);
+
+    AsyncWebHeader* match = request->getHeader("If-None-Match");
+    if (match && match->value() == etag) {
+        stats.notModified++;
+        AsyncWebServerResponse* response = request->beginResponse(304);
+        addValidators(response, version, auth);
+        request->send(response);
+        return true;
+    }
+
+    std::shared_ptr<Entry> entry;
+    for (size_t i = 0; i < PAGE_CACHE_SLOTS; i++) {
+        const std::shared_ptr<Entry>& candidate = entries[i];
+        if (candidate && candidate->version == version && candidate->auth == auth &&
+            strcmp(candidate->page, page) == 0) {
+            entry = candidate;
+            break;
+        }
+    }
+    if (!entry) {
+        stats.misses++;
+        return false;
+    }
+
+    // The filler holds its own reference, so replacing the slot mid-send is safe
+    stats.hits++;
+    AsyncWebServerResponse* response = request->beginResponse("text/html; charset=utf-8", entry->length,
+        [entry](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+            size_t chunk = min(maxLen, entry->length - index);
+            memcpy(buffer, entry->data + index, chunk);
+            return chunk;
+        });
+    addValidators(response, version, auth);
+    request->send(response);
+    return true;
+}
+
+RenderCapture PageCache::capture(const char* page, uint32_t version, AuthLevel auth) {
+    if (!enabled) {
+        return nullptr;
+    }
+    if (!psramFound()) {
+        LOG_I(WEB, "PageCache: No PSRAM, caching disabled (ETag revalidation only)\n");
+        enabled = false;
+        return nullptr;
+    }
+
+    std::shared_ptr<Entry> entry = std::make_shared<Entry>();
+    entry->page = page;
+    entry->version = version;
+    entry->auth = auth;
+    entry->data = (uint8_t*)ps_malloc(PAGE_CACHE_MAX_BYTES);
+    entry->length = 0;
+    if (!entry->data) {
+        return nullptr;
+    }
+
+    return [this, entry](const uint8_t* data, size_t length) {
+        if (!entry->data) {
+            return; // Already overflowed
+        }
+        if (!data) {
+            // Render complete: trim the buffer and keep it
+            uint8_t* trimmed = (uint8_t*)ps_realloc(entry->data, entry->length);
+            if (trimmed) {
+                entry->data = trimmed;
+            }
+            store(entry);
+            return;
+        }
+        if (entry->length + length > PAGE_CACHE_MAX_BYTES) {
+            free(entry->data);
+            entry->data = nullptr;
+            stats.oversize++;
+            return;
+        }
+        memcpy(entry->data + entry->length, data, length);
+        entry->length += length;
+    };
+}
+
+void PageCache::addValidators(AsyncWebServerResponse* response, uint32_t version, AuthLevel auth) {
+    char etag[PAGE_ETAG_MAX];
+    formatETag(etag, sizeof(etag), version, auth);
+    response->addHeader("ETag", etag);
+    response->addHeader("Cache-Control", PAGE_CACHE_CONTROL);
+}
+
+void PageCache::clear() {
+    for (size_t i = 0; i < PAGE_CACHE_SLOTS; i++) {
+        entries[i].reset();
+    }
+}
+
+uint8_t PageCache::getHitRate() const {
+    uint32_t served = stats.hits + stats.notModified;
+    uint32_t total = served + stats.misses;
+    return total ? (uint8_t)((uint64_t)served * 100 / total) : 0;
+}
+
+size_t PageCache::getBytesUsed() const {
+    size_t bytes = 0;
+    for (size_t i = 0; i < PAGE_CACHE_SLOTS; i++) {
+        if (entries[i]) {
+            bytes += entries[i]->length;
+        }
+    }
+    return bytes;
+}
+
+// Private methods
+void PageCache::store(const std::shared_ptr<Entry>& entry) {
+    // A newer render of the same page replaces the older one, otherwise
+    // take a free slot or the one holding the oldest version
+    int match = -1;
+    int freeSlot = -1;
+    int oldest = -1;
+    for (size_t i = 0; i < PAGE_CACHE_SLOTS; i++) {
+        const std::shared_ptr<Entry>& current = entries[i];
+        if (!current) {
+            if (freeSlot < 0) freeSlot = i;
+        } else if (current->auth == entry->auth && strcmp(current->page, entry->page) == 0) {
+            match = i;
+            break;
+        } else if (oldest < 0 || (int32_t)(entries[oldest]->version - current->version) > 0) {
+            oldest = i;
+        }
+    }
+
+    if (match >= 0 && (int32_t)(entries[match]->version - entry->version) > 0) {
+        return; // A render of a newer version finished first
+    }
+    int slot = match >= 0 ? match : (freeSlot >= 0 ? freeSlot : oldest);
+    entries[slot] = entry;
+    stats.stored++;
+}
+
+void PageCache::formatETag(char* out, size_t size, uint32_t version, AuthLevel auth) {
+    snprintf(out, size, "\"v%08x-%d\"", version, (int)auth);
+}
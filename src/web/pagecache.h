@@ -0,0 +1,64 @@
+#ifndef PAGECACHE_H
+#define PAGECACHE_H
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <memory>
+#include "sessions.h"
+#include "renderer.h"
+
+// Rendered page cache configuration
+#define PAGE_CACHE_SLOTS        4       // Distinct (page, auth level) entries
+#define PAGE_CACHE_MAX_BYTES    24576   // Larger renders are streamed but not kept
+#define PAGE_CACHE_CONTROL      "private, no-cache"     // Always revalidate via ETag
+
+// Cache usage counters
+struct PageCacheStats {
+    uint32_t hits;              // Served from a stored render
+    uint32_t misses;            // Rendered from the templates
+    uint32_t notModified;       // Answered with 304
+    uint32_t stored;
+    uint32_t oversize;          // Render exceeded PAGE_CACHE_MAX_BYTES
+};
+
+// Keeps fully rendered pages in PSRAM, keyed on (page, state version, auth
+// level), and answers conditional GETs with 304 when the browser already
+// holds the current version. Without PSRAM only revalidation is done.
+// Used from the AsyncTCP task only.
+class PageCache {
+public:
+    PageCache();
+
+    // Sends a 304 or a stored copy; returns false when the page must be rendered
+    bool send(AsyncWebServerRequest* request, const char* page, uint32_t version, AuthLevel auth);
+
+    // Capture hook for a fresh render, plus the validators to attach to it
+    RenderCapture capture(const char* page, uint32_t version, AuthLevel auth);
+    void addValidators(AsyncWebServerResponse* response, uint32_t version, AuthLevel auth);
+
+    void clear();
+    bool isEnabled() const { return enabled; }
+    const PageCacheStats& getStats() const { return stats; }
+    uint8_t getHitRate() const;
+    size_t getBytesUsed() const;
+
+private:
+    struct Entry {
+        const char* page;
+        uint32_t version;
+        AuthLevel auth;
+        uint8_t* data;
+        size_t length;
+
+        ~Entry() { free(data); }
+    };
+
+    std::shared_ptr<Entry> entries[PAGE_CACHE_SLOTS];
+    PageCacheStats stats;
+    bool enabled;
+
+    void store(const std::shared_ptr<Entry>& entry);
+    static void formatETag(char* out, size_t size, uint32_t version, AuthLevel auth);
+};
+
+#endif // PAGECACHE_H
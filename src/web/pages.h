@@ -0,0 +1,460 @@
+#ifndef PAGES_H
+#define PAGES_H
+
+#include <Arduino.h>
+#include "assets.h"
+
+// Flash-resident page templates for PageRenderer.
+// {{name}} placeholders are resolved by the page's processor in web.cpp.
+// Styles and scripts live in web/ and are served from LittleFS; the
+// ASSET_* URLs come from assets.h, generated by scripts/build_web_assets.py.
+
+// Landing page shown before login or setup
+static const char PAGE_LANDING[] PROGMEM = R"HTML(<!DOCTYPE html>
+<html>
+<head>
+<title>{{owner_title}}</title>
+<meta charset='utf-8'>
+<meta name='viewport' content='width=device-width, initial-scale=1'>
+<link rel='stylesheet' href=')HTML" ASSET_CSS_LANDING R"HTML('>
+</head>
+<body>
+<div class='landing-container'>
+<div class='logo'>🐷⚡</div>
+<div class='title'>{{owner_title}}</div>
+<div class='subtitle'>Your Personal Bitcoin Piggy Bank</div>
+<div class='description'>
+<strong>Welcome to Hodling Hog!</strong><br><br>
+This is a kid-friendly Bitcoin monitoring device that helps you track your Bitcoin savings.
+Think of it as your digital piggy bank that shows how much Bitcoin you have in two places:<br><br>
+• <strong>Lightning Wallet</strong> - For small amounts and quick payments<br>
+• <strong>Cold Storage</strong> - For larger amounts kept extra safe<br><br>
+Your Hodling Hog keeps an eye on your Bitcoin 24/7 so you can watch your savings grow!
+</div>
+<div class='features'>
+<div class='feature'>
+<div class='feature-icon'>👀</div>
+<strong>Watch Only</strong><br>
+Safely monitor your Bitcoin without any risk
+</div>
+<div class='feature'>
+<div class='feature-icon'>⚡</div>
+<strong>Lightning Ready</strong><br>
+Track Lightning wallet balance and transactions
+</div>
+<div class='feature'>
+<div class='feature-icon'>❄️</div>
+<strong>Cold Storage</strong><br>
+Monitor your cold storage Bitcoin addresses
+</div>
+<div class='feature'>
+<div class='feature-icon'>📱</div>
+<strong>Easy Setup</strong><br>
+Simple web interface for all family members
+</div>
+</div>
+{{landing_action}}
+</div>
+</body>
+</html>
+)HTML";
+
+// Dashboard with balances
+static const char PAGE_MAIN[] PROGMEM = R"HTML(<!DOCTYPE html>
+<html>
+<head>
+<title>{{owner_title}} - Bitcoin Piggy Bank</title>
+<link rel='stylesheet' href=')HTML" ASSET_CSS_MAIN R"HTML('>
+</head>
+<body>
+<div class='container'>
+<div class='header'>
+<div class='logo'>{{owner_title}}</div>
+<div class='subtitle'>Your Bitcoin Piggy Bank is Secure!</div>
+</div>
+<div class='nav'>
+<div class='nav-links'>
+<a href='/'>My Piggy Bank</a>
+<a href='/config'>Settings</a>
+</div>
+<div style='display: flex; align-items: center; gap: 1rem;'>
+<span class='live-status' id='live-status'></span>
+<span class='auth-status'>Logged In!</span>
+<a href='/logout' class='logout-btn'>Logout</a>
+</div>
+</div>
+<div class='status-card' style='margin-bottom: 1rem; background: linear-gradient(135deg, #ff9a9e 0%, #fecfef 50%, #fecfef 100%);'>
+<div class='status-title' style='color: #333; font-weight: bold;'>Total Sats</div>
+<div class='status-value' id='total-sats' style='color: #333; font-size: 1.5rem; font-weight: bold;'>{{total_sats}}</div>
+</div>
+<div class='status-grid'>
+<div class='status-card'>
+<div class='status-title'>Lightning Sats</div>
+<div class='status-value' id='lightning-sats'>{{lightning_sats}}</div>
+</div>
+<div class='status-card'>
+<div class='status-title'>Cold Storage Sats</div>
+<div class='status-value' id='cold-sats'>{{cold_sats}}</div>
+</div>
+</div>
+<div class='welcome-message'>
+<div class='welcome-title'>Welcome to Your Bitcoin Adventure!</div>
+<div class='welcome-text'>
+Great job setting up your Hodling Hog!
+This is your very own Bitcoin piggy bank where you can save and learn about digital money.
+Use the menu above to explore and watch your savings grow!
+{{lightning_address_note}}
+</div>
+</div>
+</div>
+<script src=')HTML" ASSET_JS_MAIN R"HTML('></script>
+</body>
+</html>
+)HTML";
+
+// Settings page
+static const char PAGE_CONFIG[] PROGMEM = R"HTML(<!DOCTYPE html>
+<html><head><title>Settings - Hodling Hog</title>
+<link rel='stylesheet' href=')HTML" ASSET_CSS_CONFIG R"HTML('></head><body>
+<div class='container'>
+<div class='header'><h1>Hodling Hog</h1><p>Settings & Configuration</p></div>
+<div class='nav'>
+<a href='/'>Home</a>
+<a href='/config' class='active'>Settings</a>
+</div>
+<div id='status-msg'></div>
+<div class='section'>
+<div class='section-title'>WiFi Settings</div>
+{{wifi_current}}
+<form method='POST' action='/api/config/wifi'>
+<div class='grid-2'>
+<div class='form-group'>
+<label class='form-label'>Network Name (SSID)</label>
+<input type='text' name='ssid' class='form-input' placeholder='YourWiFiNetwork' value='{{wifi_ssid}}' required>
+</div>
+<div class='form-group'>
+<label class='form-label'>Password</label>
+<input type='password' name='password' class='form-input' placeholder='{{wifi_password_hint}}' value=''>
+</div>
+</div>
+<button type='submit' class='save-btn'>Save WiFi Settings</button>
+</form>
+</div>
+<div class='section'>
+<div class='section-title'>⚡ Lightning Wallet Settings (Wallet of Satoshi)</div>
+<div class='info-box'>
+<strong>📱 How to get Wallet of Satoshi API credentials:</strong><br>
+1. Download the Wallet of Satoshi app<br>
+2. Create an account and verify your email<br>
+3. Go to Settings → Developer → API Keys<br>
+4. Generate new API credentials<br>
+5. Copy the API Token and API Secret below
+</div>
+{{lightning_current}}
+<form method='POST' action='/api/config/lightning'>
+<div class='form-group'>
+<label class='form-label'>WoS API Token *</label>
+<input type='password' name='api_token' class='form-input' placeholder='Your WoS API Token' value='{{ln_api_token}}'>
+<small style='color:#666;'>Get this from Wallet of Satoshi app → Settings → Developer → API Keys</small>
+</div>
+<div class='form-group'>
+<label class='form-label'>WoS API Secret *</label>
+<input type='password' name='api_secret' class='form-input' placeholder='Your WoS API Secret' value='{{ln_api_secret}}'>
+<small style='color:#666;'>Keep this secret safe - it's used for signing transactions</small>
+</div>
+<div class='form-group'>
+<label class='form-label'>Lightning Address</label>
+<input type='email' name='lightning_address' class='form-input' placeholder='yourname@walletofsatoshi.com' value='{{ln_address}}'>
+<small style='color:#666;'>Your Lightning address for receiving payments (optional)</small>
+</div>
+<button type='submit' class='save-btn'>Save Lightning Settings</button>
+</form>
+</div>
+<div class='section'>
+<div class='section-title'>Cold Storage Settings</div>
+{{cold_current}}
+<form method='POST' action='/api/config/coldstorage'>
+<div class='form-group'>
+<label class='form-label'>Bitcoin Address or Wallet</label>
+<input type='text' name='address' class='form-input' placeholder='bc1q..., xpub/zpub... or wpkh(...) descriptor' value='{{cold_address}}' required>
+</div>
+<button type='submit' class='save-btn'>Save Cold Storage Settings</button>
+</form>
+</div>
+<div class='section'>
+<div class='section-title'>System Settings</div>
+<div class='current-value'>Current Display Name: {{display_name}}</div>
+<div class='current-value'>Current Sleep Timeout: {{sleep_minutes}} minutes</div>
+<form method='POST' action='/api/config/system'>
+<div class='form-group'>
+<label class='form-label'>Owner Name:</label>
+<input type='text' name='ownerName' class='form-input' placeholder='Enter your name (e.g., Alice)' value='{{owner_name}}' maxlength='20'>
+<small style='color:#666;'>This will show as "YourName's Hodling Hog" on the device</small>
+</div>
+<div class='form-group'>
+<label class='form-label'>Sleep Timeout (minutes):</label>
+<input type='number' name='sleepTimeout' class='form-input' placeholder='3' value='{{sleep_minutes}}' min='1' max='60' required>
+<small style='color:#666;'>Device will sleep after this many minutes of inactivity</small>
+</div>
+<button type='submit' class='save-btn'>Save System Settings</button>
+</form>
+</div>
+<div class='section danger-zone'>
+<div class='section-title'>⚠️ Danger Zone</div>
+<div class='warning-text'>
+This action cannot be undone! Factory reset will permanently erase:
+<ul>
+<li>🔑 Seed phrase and login credentials</li>
+<li>⚡ Lightning wallet data</li>
+<li>❄️ Cold storage settings</li>
+<li>📶 WiFi configuration</li>
+<li>⚙️ All system settings</li>
+</ul>
+</div>
+<button type='button' class='danger-btn' onclick='confirmFactoryReset()'>🗑️ Factory Reset Device</button>
+</div>
+</div>
+<script src=')HTML" ASSET_JS_CONFIG R"HTML('></script>
+</body></html>
+)HTML";
+
+// Seed phrase login
+static const char PAGE_LOGIN[] PROGMEM = R"HTML(<!DOCTYPE html>
+<html>
+<head>
+    <title>Login to Your Piggy Bank - Hodling Hog</title>
+    <link rel='stylesheet' href=')HTML" ASSET_CSS_LOGIN R"HTML('>
+</head>
+<body>
+    <div class="login-container">
+        <div class="logo">🐷⚡ Hodling Hog</div>
+        <div class="subtitle">Welcome back! Open your piggy bank</div>
+        
+        {{error}}
+        
+        <div class="info">
+            Enter the 4 special words you wrote down to access your Bitcoin piggy bank! 🔐
+        </div>
+        
+        <form method="POST" action="/login">
+            <div class="form-group">
+                <label for="seedphrase">Your 4 Secret Words:</label>
+                <input 
+                    type="text" 
+                    id="seedphrase" 
+                    name="seedphrase" 
+                    class="seed-input"
+                    placeholder="word1 word2 word3 word4"
+                    required
+                    autocomplete="off"
+                    autocapitalize="none"
+                    autocorrect="off"
+                    spellcheck="false"
+                />
+                <div class="word-count" id="wordCount">0 words</div>
+            </div>
+            
+            <button type="submit" class="login-btn">🔓 Open My Piggy Bank!</button>
+        </form>
+    </div>
+    
+    <script src=')HTML" ASSET_JS_LOGIN R"HTML('></script>
+</body>
+</html>)HTML";
+
+// Manual seed phrase setup
+static const char PAGE_SETUP[] PROGMEM = R"HTML(<!DOCTYPE html>
+<html>
+<head>
+    <title>Hodling Hog - First Time Setup</title>
+    <link rel='stylesheet' href=')HTML" ASSET_CSS_SETUP R"HTML('>
+</head>
+<body>
+    <div class="setup-container">
+        <div class="logo">🐷⚡ Hodling Hog</div>
+        <div class="subtitle">First Time Setup</div>
+        
+        {{error}}
+        
+        <div class="warning">
+            <strong>⚠️ Important Security Information</strong><br>
+            This seed phrase will be used to protect access to your Hodling Hog device. 
+            Store it securely and never share it with anyone!
+        </div>
+        
+        <div class="info">
+            <strong>Setup Instructions:</strong><br>
+            1. Generate a new 12-word seed phrase using a trusted wallet app<br>
+            2. Write it down on paper and store it safely<br>
+            3. Enter it below to secure your device<br>
+            4. You'll need this phrase to access the web interface
+        </div>
+        
+        <form method="POST" action="/setup">
+            <div class="form-group">
+                <label for="seedphrase">Enter your 12-word seed phrase:</label>
+                <textarea 
+                    id="seedphrase" 
+                    name="seedphrase" 
+                    class="seed-input"
+                    placeholder="Enter 12 words separated by spaces..."
+                    required
+                    autocomplete="off"
+                    autocapitalize="none"
+                    autocorrect="off"
+                    spellcheck="false"
+                ></textarea>
+                <div class="word-count" id="wordCount">0 words</div>
+                <div class="example">
+                    Example: abandon ability able about above absent absorb abstract absurd abuse access accident
+                </div>
+            </div>
+            
+            <button type="submit" class="setup-btn">🔐 Secure My Device</button>
+        </form>
+    </div>
+    
+    <script src=')HTML" ASSET_JS_SETUP R"HTML('></script>
+</body>
+</html>)HTML";
+
+// Generated seed phrase, step 1 of 2
+static const char PAGE_SEED_DISPLAY[] PROGMEM = R"HTML(<!DOCTYPE html>
+<html>
+<head>
+    <title>Your Secret Words - Hodling Hog</title>
+    <link rel='stylesheet' href=')HTML" ASSET_CSS_SEED_DISPLAY R"HTML('>
+</head>
+<body>
+    <div class="seed-container">
+        <div class="step-indicator">📝 Step 1 of 2: Write Down Your Words</div>
+        <div class="logo">🐷⚡ Hodling Hog</div>
+        <div class="title">Your Secret Words!</div>
+        <div class="subtitle">These 4 special words will protect your Bitcoin piggy bank</div>
+        
+                 <div class="seed-words">{{seed_phrase}}</div>
+        
+        <div class="warning">
+            <strong>⚠️ Very Important!</strong><br>
+            Write these 4 words on a piece of paper RIGHT NOW! 📝<br>
+            Keep the paper safe - you'll need these words to open your piggy bank!
+        </div>
+        
+        <div class="instructions">
+            <strong>📚 What to do:</strong><br>
+            1. Get a piece of paper and a pencil ✏️<br>
+            2. Write down all 4 words exactly as shown<br>
+            3. Keep your paper somewhere safe (like with your other important papers)<br>
+            4. Click continue when you're done writing
+        </div>
+        
+        <a href="/confirm-seed">
+            <button class="continue-btn">✅ I wrote them down!</button>
+        </a>
+    </div>
+</body>
+</html>)HTML";
+
+// Seed phrase confirmation, step 2 of 2
+static const char PAGE_SEED_CONFIRM[] PROGMEM = R"HTML(<!DOCTYPE html>
+<html>
+<head>
+    <title>Confirm Your Words - Hodling Hog</title>
+    <link rel='stylesheet' href=')HTML" ASSET_CSS_SEED_CONFIRM R"HTML('>
+</head>
+<body>
+    <div class="confirm-container">
+        <div class="step-indicator">✅ Step 2 of 2: Confirm Your Words</div>
+        <div class="logo">🐷⚡ Hodling Hog</div>
+        <div class="title">Now Type Your Words</div>
+        <div class="subtitle">Show me you wrote them down correctly!</div>
+        
+        {{error}}
+        
+        <div class="instructions">
+            <strong>🔍 Type the 4 words you wrote down:</strong><br>
+            • Type them exactly as they appeared<br>
+            • Separate each word with a space<br>
+            • Check your spelling carefully!
+        </div>
+        
+        <form method="POST" action="/confirm-seed">
+            <div class="form-group">
+                <label for="seedphrase">Enter your 4 words:</label>
+                <input 
+                    type="text" 
+                    id="seedphrase" 
+                    name="seedphrase" 
+                    class="seed-input"
+                    placeholder="word1 word2 word3 word4"
+                    required
+                    autocomplete="off"
+                    autocapitalize="none"
+                    autocorrect="off"
+                    spellcheck="false"
+                />
+                <div class="word-count" id="wordCount">0 words</div>
+            </div>
+            
+            <button type="submit" class="confirm-btn">🔐 Confirm & Secure My Piggy Bank!</button>
+        </form>
+    </div>
+    
+    <script src=')HTML" ASSET_JS_SEED_CONFIRM R"HTML('></script>
+</body>
+</html>)HTML";
+
+// Factory reset confirmation
+static const char PAGE_FACTORY_RESET[] PROGMEM = R"HTML(<!DOCTYPE html>
+<html><head><title>Factory Reset Complete</title>
+<meta http-equiv='refresh' content='3;url=/generate-seed'>
+<style>
+body{font-family:Arial;text-align:center;padding:2rem;background:#ffecd2;}
+.reset-container{max-width:600px;margin:0 auto;background:white;border-radius:20px;padding:2rem;box-shadow:0 4px 6px rgba(0,0,0,0.1);}
+.reset-title{font-size:2rem;color:#f44336;margin-bottom:1rem;}
+.reset-message{font-size:1.2rem;color:#333;margin-bottom:2rem;}
+.countdown{font-size:1rem;color:#666;}
+</style></head><body>
+<div class='reset-container'>
+<div class='reset-title'>🗑️ Factory Reset Complete</div>
+<div class='reset-message'>
+All data has been permanently erased:<br>
+• Seed phrase and login<br>
+• Lightning wallet data<br>
+• Cold storage settings<br>
+• WiFi configuration<br>
+• System settings
+</div>
+<div class='countdown'>Redirecting to setup in 3 seconds...</div>
+</div></body></html>)HTML";
+
+// Landing page call to action for an already configured device
+static const char FRAG_LANDING_LOGIN[] PROGMEM = R"HTML(<p style='color: #666; margin: 1rem 0;'>This Hodling Hog has already been set up. Enter your secret words to access it.</p>
+<a href='/login' class='action-btn primary'>🔓 Login to My Piggy Bank</a>)HTML";
+
+// Landing page call to action for a new device
+static const char FRAG_LANDING_SETUP[] PROGMEM = R"HTML(<p style='color: #666; margin: 1rem 0;'>Let's get your Hodling Hog set up! We'll create some special words to keep it secure.</p>
+<a href='/generate-seed' class='action-btn primary'>🚀 Set Up My Hodling Hog</a>)HTML";
+
+static const char FRAG_MAIN_LIGHTNING_ADDRESS[] PROGMEM = R"HTML(<br><br><strong>Lightning Address:</strong> {{ln_address}}
+<br>Send Lightning payments to this address to add sats to your wallet!)HTML";
+
+static const char FRAG_CONFIG_WIFI_CURRENT[] PROGMEM = R"HTML(<div class='current-value'>Current WiFi: {{wifi_ssid}}</div>)HTML";
+
+static const char FRAG_CONFIG_LIGHTNING_CONFIGURED[] PROGMEM = R"HTML(<div class='current-value'>✅ API Token: {{ln_token_prefix}}...*** (configured)</div>
+{{lightning_address_current}})HTML";
+
+static const char FRAG_CONFIG_LIGHTNING_ADDRESS[] PROGMEM = R"HTML(<div class='current-value'>📧 Lightning Address: {{ln_address}}</div>)HTML";
+
+static const char FRAG_CONFIG_LIGHTNING_MISSING[] PROGMEM = R"HTML(<div class='warning-text'>⚠️ No Lightning wallet configured. Add your WoS credentials below.</div>)HTML";
+
+static const char FRAG_CONFIG_COLD_CURRENT[] PROGMEM = R"HTML(<div class='current-value'>Current Address: {{cold_address}}</div>)HTML";
+
+// Error banners for form pages
+static const char FRAG_ERROR_LOGIN[] PROGMEM = R"HTML(<div class='error'>Invalid seed phrase or account locked</div>)HTML";
+static const char FRAG_ERROR_BUSY[] PROGMEM = R"HTML(<div class='error'>Too many logins at once. Please try again in a moment.</div>)HTML";
+static const char FRAG_LOGIN_PENDING[] PROGMEM = R"HTML(<div class='info'>Checking your secret words...</div>)HTML";
+static const char FRAG_ERROR_SETUP[] PROGMEM = R"HTML(<div class='error'>Invalid seed phrase format. Please check that you have exactly 12 valid words.</div>)HTML";
+static const char FRAG_ERROR_CONFIRM[] PROGMEM = R"HTML(<div class='error'>❌ The words you entered don't match! Please try again carefully.</div>)HTML";
+
+#endif // PAGES_H
@@ -0,0 +1,107 @@
+#include "ratelimit.h"
+#include "web.h"
+
+#define RATE_LIMIT_COST     1000    // Tokens per request
+#define RATE_LIMIT_CAPACITY (RATE_LIMIT_BURST * RATE_LIMIT_COST)
+
+static uint32_t requestIP(AsyncWebServerRequest* request) {
+    return (uint32_t)request->client()->remoteIP();
+}
+
+RateLimitHandler::RateLimitHandler() {
+    memset(buckets, 0, sizeof(buckets));
+    limited = 0;
+    replaced = 0;
+}
+
+bool RateLimitHandler::allow(uint32_t clientIP) {
+    Bucket* bucket = bucketFor(clientIP);
+
+    // Refill: RATE_LIMIT_PER_SEC requests per second is the same number
+    // of thousandths per millisecond
+    unsigned long now = millis();
+    uint32_t refill = (now - bucket->lastRefill) * RATE_LIMIT_PER_SEC;
+    bucket->tokens = min((uint32_t)RATE_LIMIT_CAPACITY, bucket->tokens + refill);
+    bucket->lastRefill = now;
+
+    if (bucket->tokens < RATE_LIMIT_COST) {
+        limited++;
+        return false;
+    }
+    bucket->tokens -= RATE_LIMIT_COST;
+    return true;
+}
+
+bool RateLimitHandler::canHandle(AsyncWebServerRequest* request) {
+    // Claiming the request means rejecting it
+    return !allow(requestIP(request));
+}
+
+void RateLimitHandler::handleRequest(AsyncWebServerRequest* request) {
+    AsyncWebServerResponse* response = request->beginResponse(429, "text/plain", "Too many requests");
+    response->addHeader("Retry-After", RATE_LIMIT_RETRY_AFTER);
+    request->send(response);
+}
+
+RateLimitHandler::Bucket* RateLimitHandler::bucketFor(uint32_t clientIP) {
+    Bucket* freeBucket = nullptr;
+    Bucket* idlest = nullptr;
+    unsigned long now = millis();
+    for (size_t i = 0; i < RATE_LIMIT_CLIENTS; i++) {
+        Bucket& bucket = buckets[i];
+        if (!bucket.used) {
+            if (!freeBucket) freeBucket = &bucket;
+        } else if (bucket.clientIP == clientIP) {
+            return &bucket;
+        } else if (!idlest || now - bucket.lastRefill > now - idlest->lastRefill) {
+            idlest = &bucket;
+        }
+    }
+
+    // New client takes a free bucket, or the one idle for longest
+    Bucket* bucket = freeBucket;
+    if (!bucket) {
+        bucket = idlest;
+        replaced++;
+    }
+    bucket->clientIP = clientIP;
+    bucket->tokens = RATE_LIMIT_CAPACITY;
+    bucket->lastRefill = now;
+    bucket->used = true;
+    return bucket;
+}
+
+AdmissionHandler::AdmissionHandler(uint8_t maxInFlight) : maxInFlight(maxInFlight) {
+    inFlight = 0;
+    peakInFlight = 0;
+    admitted = 0;
+    shed = 0;
+}
+
+bool AdmissionHandler::canHandle(AsyncWebServerRequest* request) {
+    // Event streams stay open indefinitely; the event source caps them itself
+    if (request->url() == EVENTS_PATH) {
+        return false;
+    }
+
+    if (inFlight >= maxInFlight) {
+        shed++;
+        return true;
+    }
+
+    inFlight++;
+    admitted++;
+    if (inFlight > peakInFlight) {
+        peakInFlight = inFlight;
+    }
+    request->onDisconnect([this]() {
+        inFlight--;
+    });
+    return false;
+}
+
+void AdmissionHandler::handleRequest(AsyncWebServerRequest* request) {
+    AsyncWebServerResponse* response = request->beginResponse(503, "text/plain", "Server busy");
+    response->addHeader("Retry-After", ADMISSION_RETRY_AFTER);
+    request->send(response);
+}
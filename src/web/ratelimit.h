@@ -0,0 +1,74 @@
+#ifndef RATELIMIT_H
+#define RATELIMIT_H
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+
+// Per-client token bucket
+#define RATE_LIMIT_CLIENTS      8       // Distinct client IPs tracked at once
+#define RATE_LIMIT_BURST        20      // Requests a client may send back to back
+#define RATE_LIMIT_PER_SEC      5       // Sustained requests per second per client
+#define RATE_LIMIT_RETRY_AFTER  "1"     // Retry-After seconds sent with 429
+
+// Admission control
+#define ADMISSION_RETRY_AFTER   "2"     // Retry-After seconds sent with 503
+
+// Both gates are registered ahead of every route, so a rejected request is
+// answered before any page rendering or JSON work starts. They run on the
+// AsyncTCP task together with the handlers, so their state needs no lock.
+
+// Rejects clients that have used up their token bucket with 429.
+class RateLimitHandler : public AsyncWebHandler {
+public:
+    RateLimitHandler();
+
+    bool allow(uint32_t clientIP);
+    bool canHandle(AsyncWebServerRequest* request) override;
+    void handleRequest(AsyncWebServerRequest* request) override;
+    bool isRequestHandlerTrivial() override { return true; }
+
+    // Statistics
+    uint32_t getLimited() const { return limited; }
+    uint32_t getReplaced() const { return replaced; }
+
+private:
+    struct Bucket {
+        uint32_t clientIP;
+        uint32_t tokens;            // Thousandths of a request
+        unsigned long lastRefill;
+        bool used;
+    };
+
+    Bucket buckets[RATE_LIMIT_CLIENTS];
+    uint32_t limited;
+    uint32_t replaced;
+
+    Bucket* bucketFor(uint32_t clientIP);
+};
+
+// Caps concurrent in-flight requests and sheds the excess with 503.
+// A slot is held from the end of the request headers until the client
+// connection closes.
+class AdmissionHandler : public AsyncWebHandler {
+public:
+    AdmissionHandler(uint8_t maxInFlight);
+
+    bool canHandle(AsyncWebServerRequest* request) override;
+    void handleRequest(AsyncWebServerRequest* request) override;
+    bool isRequestHandlerTrivial() override { return true; }
+
+    // Statistics
+    uint8_t getInFlight() const { return inFlight; }
+    uint8_t getPeakInFlight() const { return peakInFlight; }
+    uint32_t getAdmitted() const { return admitted; }
+    uint32_t getShed() const { return shed; }
+
+private:
+    uint8_t maxInFlight;
+    uint8_t inFlight;
+    uint8_t peakInFlight;
+    uint32_t admitted;
+    uint32_t shed;
+};
+
+#endif // RATELIMIT_H
@@ -0,0 +1,178 @@
+#include "renderer.h"
+#include "../utils/log.h"
+
+RenderStats PageRenderer::stats[RENDER_STATS_SLOTS];
+size_t PageRenderer::statsCount = 0;
+
+PageRenderer::PageRenderer(const char* name, PGM_P tpl, RenderProcessor processor, RenderCapture capture)
+    : name(name), processor(processor), capture(capture) {
+    frames[0].tpl = tpl;
+    frames[0].pos = 0;
+    depth = 1;
+    value.fragment = nullptr;
+    valuePos = 0;
+
+    startMicros = micros();
+    startFreeHeap = ESP.getFreeHeap();
+    minFreeHeap = startFreeHeap;
+    ttfbUs = 0;
+    bytesSent = 0;
+}
+
+AsyncWebServerResponse* PageRenderer::begin(AsyncWebServerRequest* request, const char* name,
+                                            PGM_P tpl, RenderProcessor processor, int httpCode,
+                                            RenderCapture capture) {
+    // Owned by the filler; released together with the response
+    std::shared_ptr<PageRenderer> renderer = std::make_shared<PageRenderer>(name, tpl, processor, capture);
+
+    AsyncWebServerResponse* response = request->beginChunkedResponse("text/html; charset=utf-8",
+        [renderer](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+            return renderer->fill(buffer, maxLen, index);
+        });
+    response->setCode(httpCode);
+    return response;
+}
+
+size_t PageRenderer::fill(uint8_t* buffer, size_t maxLen, size_t index) {
+    if (index == 0) {
+        ttfbUs = micros() - startMicros;
+    }
+
+    size_t written = 0;
+    while (written < maxLen) {
+        // Drain the current placeholder value first
+        if (valuePos < value.text.length()) {
+            written += copyPending(buffer + written, maxLen - written);
+            continue;
+        }
+
+        if (depth == 0) {
+            break;
+        }
+
+        Frame& frame = frames[depth - 1];
+        PGM_P cursor = frame.tpl + frame.pos;
+        if (*cursor == '\0') {
+            depth--; // Fragment (or page) finished
+            continue;
+        }
+
+        // Copy literal text up to the next placeholder
+        PGM_P marker = strstr(cursor, "{{");
+        size_t literal = marker ? (size_t)(marker - cursor) : strlen(cursor);
+        if (literal > 0) {
+            size_t chunk = min(literal, maxLen - written);
+            memcpy_P(buffer + written, cursor, chunk);
+            written += chunk;
+            frame.pos += chunk;
+            continue;
+        }
+
+        if (!expandPlaceholder(frame)) {
+            // Not a valid placeholder - emit the braces verbatim
+            size_t chunk = min((size_t)2, maxLen - written);
+            memcpy_P(buffer + written, cursor, chunk);
+            written += chunk;
+            frame.pos += chunk;
+        }
+    }
+
+    uint32_t freeHeap = ESP.getFreeHeap();
+    if (freeHeap < minFreeHeap) {
+        minFreeHeap = freeHeap;
+    }
+
+    bytesSent += written;
+    if (capture && written > 0) {
+        capture(buffer, written);
+    }
+    if (written == 0) {
+        finish();
+    }
+    return written;
+}
+
+size_t PageRenderer::copyPending(uint8_t* buffer, size_t maxLen) {
+    size_t remaining = value.text.length() - valuePos;
+    size_t chunk = min(remaining, maxLen);
+    memcpy(buffer, value.text.c_str() + valuePos, chunk);
+    valuePos += chunk;
+
+    if (valuePos >= value.text.length()) {
+        value.text = String(); // Release the value buffer as soon as it is sent
+        valuePos = 0;
+    }
+    return chunk;
+}
+
+bool PageRenderer::expandPlaceholder(Frame& frame) {
+    PGM_P start = frame.tpl + frame.pos + 2;
+    PGM_P end = strstr(start, "}}");
+    if (!end || (size_t)(end - start) > RENDER_MAX_KEY) {
+        return false;
+    }
+
+    char key[RENDER_MAX_KEY + 1];
+    size_t keyLen = end - start;
+    memcpy_P(key, start, keyLen);
+    key[keyLen] = '\0';
+    frame.pos += keyLen + 4;
+
+    value.text = String();
+    value.fragment = nullptr;
+    valuePos = 0;
+    if (processor) {
+        processor(key, value);
+    }
+
+    if (value.fragment) {
+        if (depth < RENDER_MAX_DEPTH) {
+            frames[depth].tpl = value.fragment;
+            frames[depth].pos = 0;
+            depth++;
+        } else {
+            LOG_I(WEB, "Renderer: Fragment nesting too deep at {{%s}}\n", key);
+        }
+        value.fragment = nullptr;
+    }
+    return true;
+}
+
+void PageRenderer::finish() {
+    uint32_t peakHeap = startFreeHeap > minFreeHeap ? startFreeHeap - minFreeHeap : 0;
+
+    RenderStats* slot = nullptr;
+    for (size_t i = 0; i < statsCount; i++) {
+        if (strcmp(stats[i].page, name) == 0) {
+            slot = &stats[i];
+            break;
+        }
+    }
+    if (!slot && statsCount < RENDER_STATS_SLOTS) {
+        slot = &stats[statsCount++];
+        memset(slot, 0, sizeof(RenderStats));
+        slot->page = name;
+    }
+
+    if (slot) {
+        slot->renders++;
+        slot->lastTtfbUs = ttfbUs;
+        slot->maxTtfbUs = max(slot->maxTtfbUs, ttfbUs);
+        slot->lastPeakHeap = peakHeap;
+        slot->maxPeakHeap = max(slot->maxPeakHeap, peakHeap);
+        slot->lastBytes = bytesSent;
+    }
+
+    if (capture) {
+        capture(nullptr, 0);
+        capture = nullptr;
+    }
+
+    LOG_I(WEB, "Renderer: %s sent %u bytes (TTFB %lu us, peak heap %u bytes)\n",
+               name, (unsigned)bytesSent, (unsigned long)ttfbUs, peakHeap);
+}
+
+const RenderStats* PageRenderer::getStats(size_t& count) {
+    count = statsCount;
+    return stats;
+}
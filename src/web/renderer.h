@@ -0,0 +1,85 @@
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <functional>
+#include <memory>
+
+// Streaming renderer configuration
+#define RENDER_MAX_KEY      24      // Longest {{placeholder}} name
+#define RENDER_MAX_DEPTH    3       // Nested fragment levels
+#define RENDER_STATS_SLOTS  12      // Distinct pages tracked for statistics
+
+// Value produced for a {{placeholder}}: either short dynamic text or a
+// flash-resident fragment, which may itself contain placeholders
+struct RenderValue {
+    String text;
+    PGM_P fragment;
+};
+
+typedef std::function<void(const char* key, RenderValue& value)> RenderProcessor;
+
+// Receives a copy of every chunk sent, then (nullptr, 0) once the page is
+// complete. Not called for pages abandoned by the client.
+typedef std::function<void(const uint8_t* data, size_t length)> RenderCapture;
+
+// Per-page render measurements (peak heap and time to first byte)
+struct RenderStats {
+    const char* page;
+    uint32_t renders;
+    uint32_t lastTtfbUs;
+    uint32_t maxTtfbUs;
+    uint32_t lastPeakHeap;
+    uint32_t maxPeakHeap;
+    uint32_t lastBytes;
+};
+
+// Expands a PROGMEM template into a chunked response buffer by buffer.
+// Heap held per request is the renderer itself plus the largest single
+// placeholder value, independent of the page size.
+class PageRenderer {
+public:
+    PageRenderer(const char* name, PGM_P tpl, RenderProcessor processor, RenderCapture capture = nullptr);
+
+    // AwsResponseFiller-compatible fill step
+    size_t fill(uint8_t* buffer, size_t maxLen, size_t index);
+
+    // Start a chunked response for a template
+    static AsyncWebServerResponse* begin(AsyncWebServerRequest* request, const char* name,
+                                         PGM_P tpl, RenderProcessor processor, int httpCode = 200,
+                                         RenderCapture capture = nullptr);
+
+    // Statistics
+    static const RenderStats* getStats(size_t& count);
+
+private:
+    struct Frame {
+        PGM_P tpl;
+        size_t pos;
+    };
+
+    const char* name;
+    RenderProcessor processor;
+    RenderCapture capture;
+    Frame frames[RENDER_MAX_DEPTH];
+    uint8_t depth;
+    RenderValue value;
+    size_t valuePos;
+
+    // Measurement state
+    unsigned long startMicros;
+    uint32_t startFreeHeap;
+    uint32_t minFreeHeap;
+    uint32_t ttfbUs;
+    size_t bytesSent;
+
+    size_t copyPending(uint8_t* buffer, size_t maxLen);
+    bool expandPlaceholder(Frame& frame);
+    void finish();
+
+    static RenderStats stats[RENDER_STATS_SLOTS];
+    static size_t statsCount;
+};
+
+#endif // RENDERER_H
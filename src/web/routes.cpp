@@ -0,0 +1,124 @@
+#include "routes.h"
+#include "ota.h"
+#include "../utils/log.h"
+
+uint32_t routeKey(WebRequestMethodComposite method, const char* path, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ (uint8_t)path[i]) * 16777619u;
+    }
+    return (hash ^ method) * 16777619u;
+}
+
+RouteTable::RouteTable(WebInterface* owner, const Route* routes, size_t count,
+                       const RouteMiddleware* chain, size_t chainLength, RouteLogger logger)
+    : owner(owner), routes(routes), count(count), chain(chain), chainLength(chainLength), logger(logger) {
+    memset(order, 0, sizeof(order));
+    memset(stats, 0, sizeof(stats));
+}
+
+void RouteTable::begin() {
+    // A dropped or shadowed route would only show up as a 404 in the field
+    if (count > ROUTE_TABLE_MAX) {
+        LOG_E(WEB, "RouteTable: %d routes exceed ROUTE_TABLE_MAX (%d)\n", count, ROUTE_TABLE_MAX);
+        logFlush();
+        abort();
+    }
+
+    // Insertion sort by key; the table is small and sorted once at startup
+    for (size_t i = 0; i < count; i++) {
+        uint8_t index = i;
+        size_t j = i;
+        while (j > 0 && routes[order[j - 1]].key > routes[index].key) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = index;
+    }
+
+    for (size_t i = 1; i < count; i++) {
+        if (routes[order[i]].key == routes[order[i - 1]].key) {
+            LOG_E(WEB, "RouteTable: Key collision between %s and %s\n",
+                       routes[order[i - 1]].path, routes[order[i]].path);
+            logFlush();
+            abort();
+        }
+    }
+    LOG_I(WEB, "RouteTable: %d routes indexed\n", count);
+}
+
+const Route* RouteTable::find(WebRequestMethodComposite method, const String& url) const {
+    uint32_t key = routeKey(method, url.c_str(), url.length());
+
+    size_t low = 0;
+    size_t high = count;
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+        const Route& route = routes[order[mid]];
+        if (route.key < key) {
+            low = mid + 1;
+        } else if (route.key > key) {
+            high = mid;
+        } else {
+            // Guard against a hash match on an unknown path
+            return strcmp(route.path, url.c_str()) == 0 ? &route : nullptr;
+        }
+    }
+    return nullptr;
+}
+
+bool RouteTable::canHandle(AsyncWebServerRequest* request) {
+    if (!find(request->method(), request->url())) {
+        return false;
+    }
+    // The server drops every header a handler has not asked for
+    request->addInterestingHeader("Cookie");
+    request->addInterestingHeader("Authorization");
+    request->addInterestingHeader("Content-Type");
+    request->addInterestingHeader("If-None-Match");
+    request->addInterestingHeader("X-Forwarded-For");
+    request->addInterestingHeader("X-Real-IP");
+    request->addInterestingHeader(OTA_HASH_HEADER);
+    return true;
+}
+
+void RouteTable::handleRequest(AsyncWebServerRequest* request) {
+    const Route* route = find(request->method(), request->url());
+    if (!route) {
+        request->send(404);
+        return;
+    }
+    RouteStats& routeStats = stats[route - routes];
+
+    unsigned long start = micros();
+    bool admitted = true;
+    for (size_t i = 0; i < chainLength && admitted; i++) {
+        admitted = (owner->*chain[i])(request, *route);
+    }
+    if (admitted) {
+        (owner->*route->handler)(request);
+    } else {
+        routeStats.rejected++;
+    }
+    uint32_t elapsed = micros() - start;
+
+    routeStats.calls++;
+    routeStats.lastUs = elapsed;
+    routeStats.totalUs += elapsed;
+    if (elapsed > routeStats.maxUs) {
+        routeStats.maxUs = elapsed;
+    }
+
+    if (logger) {
+        (owner->*logger)(request, *route, elapsed);
+    }
+}
+
+void RouteTable::handleUpload(AsyncWebServerRequest* request, const String& filename, size_t index,
+                              uint8_t* data, size_t len, bool final) {
+    // Uploads to routes without an upload handler are discarded
+    const Route* route = find(request->method(), request->url());
+    if (route && route->upload) {
+        (owner->*route->upload)(request, filename, index, data, len, final);
+    }
+}
@@ -0,0 +1,102 @@
+#ifndef ROUTES_H
+#define ROUTES_H
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include "sessions.h"
+
+// Route table configuration
+#define ROUTE_TABLE_MAX     32      // Routes a single table can index
+
+// Route flags
+#define ROUTE_ACTIVITY      0x01    // Counts as user activity (resets the sleep timer)
+#define ROUTE_PAGE          0x02    // HTML page: unauthenticated clients are sent to /login
+#define ROUTE_GUARDED       0x04    // Costs an extra rate-limit token (credential entry, config writes)
+
+// FNV-1a over the path, then the method, so GET and POST on one path get
+// distinct keys. constexpr so route table keys are computed at compile time.
+constexpr uint32_t routeHash(const char* path, uint32_t hash = 2166136261u) {
+    return *path ? routeHash(path + 1, (hash ^ (uint8_t)*path) * 16777619u) : hash;
+}
+
+constexpr uint32_t routeKey(WebRequestMethodComposite method, const char* path) {
+    return (routeHash(path) ^ method) * 16777619u;
+}
+
+// Same key for a request URL, without recursion
+uint32_t routeKey(WebRequestMethodComposite method, const char* path, size_t length);
+
+class WebInterface;
+typedef void (WebInterface::*RouteHandler)(AsyncWebServerRequest* request);
+
+// Per-chunk callback for a multipart file upload. Runs while the body is
+// still arriving, i.e. before the middleware chain and the handler.
+typedef void (WebInterface::*RouteUploadHandler)(AsyncWebServerRequest* request, const String& filename,
+                                                 size_t index, uint8_t* data, size_t len, bool final);
+
+struct Route {
+    uint32_t key;
+    WebRequestMethod method;
+    const char* path;
+    AuthLevel auth;
+    uint8_t flags;
+    RouteHandler handler;
+    RouteUploadHandler upload;
+};
+
+#define ROUTE(method, path, auth, flags, handler) \
+    { routeKey(method, path), method, path, auth, flags, &WebInterface::handler, nullptr }
+
+#define UPLOAD_ROUTE(method, path, auth, flags, handler, upload) \
+    { routeKey(method, path), method, path, auth, flags, &WebInterface::handler, &WebInterface::upload }
+
+// Middleware step run before the handler. Returns false once it has
+// answered the request itself, which ends the chain.
+typedef bool (WebInterface::*RouteMiddleware)(AsyncWebServerRequest* request, const Route& route);
+
+// Post-handler hook for access logging
+typedef void (WebInterface::*RouteLogger)(AsyncWebServerRequest* request, const Route& route, uint32_t elapsedUs);
+
+// Per-route latency: time from dispatch until the handler returns, which
+// covers the middleware chain and the first chunk of a streamed response
+struct RouteStats {
+    uint32_t calls;
+    uint32_t rejected;      // Stopped by middleware
+    uint32_t lastUs;
+    uint32_t maxUs;
+    uint64_t totalUs;
+};
+
+// Dispatches requests through a static route table with one binary search
+// on the hashed method and path, so registration order no longer matters.
+class RouteTable : public AsyncWebHandler {
+public:
+    RouteTable(WebInterface* owner, const Route* routes, size_t count,
+               const RouteMiddleware* chain, size_t chainLength, RouteLogger logger = nullptr);
+
+    void begin();
+    const Route* find(WebRequestMethodComposite method, const String& url) const;
+
+    bool canHandle(AsyncWebServerRequest* request) override;
+    void handleRequest(AsyncWebServerRequest* request) override;
+    void handleUpload(AsyncWebServerRequest* request, const String& filename, size_t index,
+                      uint8_t* data, size_t len, bool final) override;
+    bool isRequestHandlerTrivial() override { return false; }
+
+    // Statistics
+    size_t size() const { return count; }
+    const Route& getRoute(size_t index) const { return routes[index]; }
+    const RouteStats& getStats(size_t index) const { return stats[index]; }
+
+private:
+    WebInterface* owner;
+    const Route* routes;
+    size_t count;
+    const RouteMiddleware* chain;
+    size_t chainLength;
+    RouteLogger logger;
+    uint8_t order[ROUTE_TABLE_MAX];     // Route indices sorted by key
+    RouteStats stats[ROUTE_TABLE_MAX];
+};
+
+#endif // ROUTES_H
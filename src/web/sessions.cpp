@@ -0,0 +1,221 @@
+#include "sessions.h"
+#include <esp_system.h>
+
+static_assert((SESSION_TABLE_SLOTS & (SESSION_TABLE_SLOTS - 1)) == 0, "SESSION_TABLE_SLOTS must be a power of two");
+static_assert(SESSION_TABLE_SLOTS >= SESSION_CAPACITY * 2, "Session table load factor must stay <= 0.5");
+
+SessionTable::SessionTable() {
+    memset(slots, 0, sizeof(slots));
+    memset(occupied, 0, sizeof(occupied));
+    count = 0;
+    evictions = 0;
+    lock = portMUX_INITIALIZER_UNLOCKED;
+}
+
+static const char HEX_DIGITS[] = "0123456789abcdef";
+
+void SessionTable::create(uint32_t clientIP, AuthLevel level, char* tokenHex) {
+    // A repeated 128-bit token is next to impossible, but never shared
+    do {
+        generateToken(tokenHex);
+    } while (!insert(tokenHex, clientIP, level));
+}
+
+void SessionTable::generateToken(char* tokenHex) {
+    uint8_t token[SESSION_TOKEN_BYTES];
+    esp_fill_random(token, SESSION_TOKEN_BYTES);
+    for (size_t i = 0; i < SESSION_TOKEN_BYTES; i++) {
+        tokenHex[i * 2] = HEX_DIGITS[token[i] >> 4];
+        tokenHex[i * 2 + 1] = HEX_DIGITS[token[i] & 0x0f];
+    }
+    tokenHex[SESSION_TOKEN_HEX_LEN] = '\0';
+}
+
+bool SessionTable::insert(const char* tokenHex, uint32_t clientIP, AuthLevel level) {
+    WebContext context;
+    memset(&context, 0, sizeof(context));
+    if (!parseToken(tokenHex, SESSION_TOKEN_HEX_LEN, context.token)) {
+        return false;
+    }
+    memcpy(context.sessionToken, tokenHex, SESSION_TOKEN_HEX_LEN);
+    context.clientIP = clientIP;
+    context.authLevel = level;
+    context.sessionStart = millis();
+    context.lastActivity = context.sessionStart;
+
+    portENTER_CRITICAL(&lock);
+    if (count >= SESSION_CAPACITY) {
+        int victim = oldestSlot();
+        if (victim >= 0) {
+            removeSlot(victim);
+            evictions++;
+        }
+    }
+
+    // A duplicate would leave one of the two sessions unreachable
+    if (findSlot(context.token) >= 0) {
+        portEXIT_CRITICAL(&lock);
+        return false;
+    }
+
+    size_t slot = homeSlot(context.token);
+    while (occupied[slot]) {
+        slot = (slot + 1) & (SESSION_TABLE_SLOTS - 1);
+    }
+    slots[slot] = context;
+    occupied[slot] = true;
+    count++;
+    portEXIT_CRITICAL(&lock);
+    return true;
+}
+
+bool SessionTable::check(const char* tokenHex, size_t length, AuthLevel required) {
+    uint8_t token[SESSION_TOKEN_BYTES];
+    if (!parseToken(tokenHex, length, token)) {
+        return false;
+    }
+
+    portENTER_CRITICAL(&lock);
+    int slot = findSlot(token);
+    bool allowed = slot >= 0 && slots[slot].authLevel >= required;
+    if (allowed) {
+        slots[slot].lastActivity = millis();
+    }
+    portEXIT_CRITICAL(&lock);
+    return allowed;
+}
+
+bool SessionTable::remove(const char* tokenHex, size_t length) {
+    uint8_t token[SESSION_TOKEN_BYTES];
+    if (!parseToken(tokenHex, length, token)) {
+        return false;
+    }
+
+    portENTER_CRITICAL(&lock);
+    int slot = findSlot(token);
+    if (slot >= 0) {
+        removeSlot(slot);
+    }
+    portEXIT_CRITICAL(&lock);
+    return slot >= 0;
+}
+
+size_t SessionTable::expire(unsigned long timeout) {
+    unsigned long now = millis();
+    size_t removed = 0;
+
+    portENTER_CRITICAL(&lock);
+    // Restart the scan after each removal since entries may shift
+    bool again = true;
+    while (again) {
+        again = false;
+        for (size_t i = 0; i < SESSION_TABLE_SLOTS; i++) {
+            if (occupied[i] && now - slots[i].lastActivity > timeout) {
+                removeSlot(i);
+                removed++;
+                again = true;
+                break;
+            }
+        }
+    }
+    portEXIT_CRITICAL(&lock);
+    return removed;
+}
+
+void SessionTable::clear() {
+    portENTER_CRITICAL(&lock);
+    memset(slots, 0, sizeof(slots));
+    memset(occupied, 0, sizeof(occupied));
+    count = 0;
+    portEXIT_CRITICAL(&lock);
+}
+
+// Private methods - caller holds the lock
+int SessionTable::findSlot(const uint8_t* token) const {
+    size_t slot = homeSlot(token);
+    for (size_t probes = 0; probes < SESSION_TABLE_SLOTS && occupied[slot]; probes++) {
+        if (tokensEqual(slots[slot].token, token)) {
+            return slot;
+        }
+        slot = (slot + 1) & (SESSION_TABLE_SLOTS - 1);
+    }
+    return -1;
+}
+
+void SessionTable::removeSlot(size_t slot) {
+    // Backward-shift deletion keeps probe chains intact without tombstones
+    memset(&slots[slot], 0, sizeof(WebContext));
+    occupied[slot] = false;
+    count--;
+
+    size_t hole = slot;
+    size_t next = slot;
+    while (true) {
+        next = (next + 1) & (SESSION_TABLE_SLOTS - 1);
+        if (!occupied[next]) {
+            break;
+        }
+        size_t home = homeSlot(slots[next].token);
+        bool reachable = (hole <= next) ? (hole < home && home <= next)
+                                        : (hole < home || home <= next);
+        if (reachable) {
+            continue; // Entry is still on its probe path
+        }
+        slots[hole] = slots[next];
+        occupied[hole] = true;
+        memset(&slots[next], 0, sizeof(WebContext));
+        occupied[next] = false;
+        hole = next;
+    }
+}
+
+int SessionTable::oldestSlot() const {
+    int oldest = -1;
+    unsigned long now = millis();
+    for (size_t i = 0; i < SESSION_TABLE_SLOTS; i++) {
+        if (occupied[i] && (oldest < 0 || now - slots[i].lastActivity > now - slots[oldest].lastActivity)) {
+            oldest = i;
+        }
+    }
+    return oldest;
+}
+
+size_t SessionTable::homeSlot(const uint8_t* token) {
+    // Tokens are uniformly random, so their leading bytes are a good hash
+    uint32_t hash;
+    memcpy(&hash, token, sizeof(hash));
+    return hash & (SESSION_TABLE_SLOTS - 1);
+}
+
+bool SessionTable::parseToken(const char* tokenHex, size_t length, uint8_t* token) {
+    if (!tokenHex || length != SESSION_TOKEN_HEX_LEN) {
+        return false;
+    }
+    // Decoded once per request; everything after works on the 16 bytes
+    uint8_t invalid = 0;
+    for (size_t i = 0; i < SESSION_TOKEN_BYTES; i++) {
+        uint8_t high = hexValue(tokenHex[i * 2]);
+        uint8_t low = hexValue(tokenHex[i * 2 + 1]);
+        invalid |= (high | low) & 0x10;
+        token[i] = (high << 4) | (low & 0x0f);
+    }
+    return invalid == 0;
+}
+
+uint8_t SessionTable::hexValue(char c) {
+    // Digit value, or 0x10 for anything that is not a hex digit
+    uint8_t digit = (uint8_t)(c - '0');
+    uint8_t letter = (uint8_t)((c | 0x20) - 'a');
+    if (digit < 10) return digit;
+    if (letter < 6) return letter + 10;
+    return 0x10;
+}
+
+bool SessionTable::tokensEqual(const uint8_t* a, const uint8_t* b) {
+    // Constant time, so lookups do not leak how much of a guess matched
+    uint8_t diff = 0;
+    for (size_t i = 0; i < SESSION_TOKEN_BYTES; i++) {
+        diff |= a[i] ^ b[i];
+    }
+    return diff == 0;
+}
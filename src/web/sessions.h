@@ -0,0 +1,75 @@
+#ifndef SESSIONS_H
+#define SESSIONS_H
+
+#include <Arduino.h>
+
+// Session table configuration
+#define MAX_CLIENTS             4                           // Maximum concurrent clients
+#define SESSION_TOKEN_BYTES     16                          // 128-bit random token
+#define SESSION_TOKEN_HEX_LEN   (SESSION_TOKEN_BYTES * 2)   // Cookie representation
+#define SESSION_CAPACITY        (MAX_CLIENTS * 2)           // Live sessions before LRU eviction
+#define SESSION_TABLE_SLOTS     16                          // Power of two, >= 2x capacity
+
+// Authentication levels
+enum class AuthLevel {
+    NONE,
+    BASIC,
+    ADMIN
+};
+
+// Web request context. Fixed size so the session table never allocates.
+struct WebContext {
+    uint8_t token[SESSION_TOKEN_BYTES];
+    char sessionToken[SESSION_TOKEN_HEX_LEN + 1];   // Hex form for the Set-Cookie header
+    uint32_t clientIP;                              // IPv4, network byte order
+    AuthLevel authLevel;
+    unsigned long sessionStart;
+    unsigned long lastActivity;
+};
+
+// Fixed-capacity session store: open addressing with linear probing over
+// random 128-bit tokens, least-recently-used eviction once full. Removal
+// shifts entries and expiry runs on the main loop, so no pointer into the
+// table is handed out; every lookup and update completes under the lock.
+class SessionTable {
+public:
+    SessionTable();
+
+    // Creates a session at the given level and writes its hex token
+    // (SESSION_TOKEN_HEX_LEN + 1 bytes) to tokenHex
+    void create(uint32_t clientIP, AuthLevel level, char* tokenHex);
+
+    // Two-step form for logins verified later: the token goes out in the
+    // cookie first, the session behind it is added once the check passes.
+    // insert() refuses a malformed token or one already in the table.
+    static void generateToken(char* tokenHex);
+    bool insert(const char* tokenHex, uint32_t clientIP, AuthLevel level);
+
+    // True if the session exists with at least the required level; it is
+    // then marked active
+    bool check(const char* tokenHex, size_t length, AuthLevel required);
+    bool remove(const char* tokenHex, size_t length);
+    size_t expire(unsigned long timeout);
+    void clear();
+
+    // Statistics
+    size_t size() const { return count; }
+    uint32_t getEvictions() const { return evictions; }
+
+private:
+    WebContext slots[SESSION_TABLE_SLOTS];
+    bool occupied[SESSION_TABLE_SLOTS];
+    size_t count;
+    uint32_t evictions;
+    portMUX_TYPE lock;
+
+    int findSlot(const uint8_t* token) const;
+    void removeSlot(size_t slot);
+    int oldestSlot() const;
+    static size_t homeSlot(const uint8_t* token);
+    static bool parseToken(const char* tokenHex, size_t length, uint8_t* token);
+    static uint8_t hexValue(char c);
+    static bool tokensEqual(const uint8_t* a, const uint8_t* b);
+};
+
+#endif // SESSIONS_H
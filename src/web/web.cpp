@@ -3,10 +3,19 @@
 #include "../wallet/wallet.h"
 #include "../cold/cold.h"
 #include "../utils/utils.h"
+#include "../utils/jsonpool.h"
+#include "../utils/stateversion.h"
+#include "../utils/log.h"
+#include "../utils/jobs.h"
+#include "../utils/httppool.h"
+#include "../utils/tlsclient.h"
 #include "../display/display.h"
+#include "renderer.h"
+#include "pages.h"
 
 // External function declarations from main.cpp
 extern void updateBalances();
+extern SemaphoreHandle_t balanceLock;
 extern bool wifiConnected;
 extern unsigned long lastInputTime;
 
@@ -19,10 +28,103 @@ void updateWebActivity() {
     lastInputTime = millis();
 }
 
+// Deferred work posted by handlers, run on the job worker task
+static bool jobSaveConfig() {
+    return settings.saveConfig();
+}
+
+static bool jobApplyColdAddress() {
+    // Waits out a running refresh rather than skipping it, so the switch
+    // (key derivation, cache and history files) never overlaps a scan
+    xSemaphoreTake(balanceLock, portMAX_DELAY);
+    coldStorage.setAddress(settings.getConfig()->coldStorage.watchAddress);
+    bool success = coldStorage.updateBalance();
+    bumpStateVersion();
+    webInterface.pushBalances();
+    xSemaphoreGive(balanceLock);
+    return success;
+}
+
+static bool jobRefreshBalances() {
+    updateBalances();
+    return true;
+}
+
+static bool jobVerifyCredentials() {
+    return webInterface.verifyPendingCredentials();
+}
+
+static bool jobSetupWallet() {
+    bool success = lightningWallet.createWalletIfNeeded();
+    updateBalances();
+    return success;
+}
+
+static bool jobFactoryReset() {
+    return settings.factoryReset();
+}
+
+static bool jobRestart() {
+    delay(OTA_RESTART_DELAY);
+    logFlush();
+    ESP.restart();
+    return true;
+}
+
+// Firmware upload a request carries, 0 if none was started
+static uint32_t uploadId(AsyncWebServerRequest* request) {
+    uint32_t upload = 0;
+    if (request->_tempObject) {
+        memcpy(&upload, request->_tempObject, sizeof(upload));
+    }
+    return upload;
+}
+
 // Global instance
 WebInterface webInterface;
 
-WebInterface::WebInterface() : server(WEB_SERVER_PORT) {
+// Route table. Keys are hashed at compile time and dispatch is a single
+// lookup, so entries can be listed in any order.
+const Route WebInterface::routes[] = {
+    // Pages
+    ROUTE(HTTP_GET,  "/",                       AuthLevel::NONE,   ROUTE_ACTIVITY,                 handleRoot),
+    ROUTE(HTTP_GET,  "/login",                  AuthLevel::NONE,   0,                              handleLoginPage),
+    ROUTE(HTTP_POST, "/login",                  AuthLevel::NONE,   ROUTE_ACTIVITY | ROUTE_GUARDED, handleLogin),
+    ROUTE(HTTP_GET,  "/logout",                 AuthLevel::NONE,   0,                              handleLogout),
+    ROUTE(HTTP_GET,  "/setup",                  AuthLevel::NONE,   0,                              handleSetupPage),
+    ROUTE(HTTP_POST, "/setup",                  AuthLevel::NONE,   ROUTE_GUARDED,                  handleSetup),
+    ROUTE(HTTP_GET,  "/generate-seed",          AuthLevel::NONE,   0,                              handleGenerateSeed),
+    ROUTE(HTTP_GET,  "/confirm-seed",           AuthLevel::NONE,   0,                              handleConfirmSeedPage),
+    ROUTE(HTTP_POST, "/confirm-seed",           AuthLevel::NONE,   ROUTE_GUARDED,                  handleConfirmSeed),
+    ROUTE(HTTP_GET,  "/config",                 AuthLevel::ADMIN,  ROUTE_ACTIVITY | ROUTE_PAGE,    handleConfig),
+    
+    // JSON API
+    ROUTE(HTTP_GET,  "/api/status",             AuthLevel::NONE,   0,                              handleSystemInfo),
+    ROUTE(HTTP_GET,  "/api/balances",           AuthLevel::BASIC,  0,                              apiGetBalances),
+    ROUTE(HTTP_GET,  "/api/jobs",               AuthLevel::BASIC,  0,                              apiGetJobs),
+    ROUTE(HTTP_GET,  "/api/transactions",       AuthLevel::BASIC,  0,                              apiGetTransactions),
+    ROUTE(HTTP_GET,  "/api/config",             AuthLevel::ADMIN,  0,                              apiGetConfig),
+    ROUTE(HTTP_POST, "/api/config",             AuthLevel::ADMIN,  ROUTE_GUARDED,                  apiSetConfig),
+    ROUTE(HTTP_POST, "/api/config/wifi",        AuthLevel::BASIC,  ROUTE_ACTIVITY | ROUTE_GUARDED, handleWiFiConfig),
+    ROUTE(HTTP_POST, "/api/config/lightning",   AuthLevel::BASIC,  ROUTE_ACTIVITY | ROUTE_GUARDED, handleLightningConfig),
+    ROUTE(HTTP_POST, "/api/config/coldstorage", AuthLevel::BASIC,  ROUTE_ACTIVITY | ROUTE_GUARDED, handleColdStorageConfig),
+    ROUTE(HTTP_POST, "/api/config/system",      AuthLevel::BASIC,  ROUTE_ACTIVITY | ROUTE_GUARDED, handleSystemConfig),
+    ROUTE(HTTP_GET,  "/api/factory-reset",      AuthLevel::ADMIN,  ROUTE_ACTIVITY | ROUTE_GUARDED, handleFactoryReset),
+    UPLOAD_ROUTE(HTTP_POST, OTA_PATH,           AuthLevel::ADMIN,  ROUTE_ACTIVITY | ROUTE_GUARDED, handleFirmwareUpdate, handleFileUpload),
+};
+
+// Run in order before every routed handler
+const RouteMiddleware WebInterface::middleware[] = {
+    &WebInterface::routeRateLimit,
+    &WebInterface::routeAuth,
+    &WebInterface::routeActivity,
+};
+
+WebInterface::WebInterface() : server(WEB_SERVER_PORT), events(EVENTS_PATH), admission(MAX_CLIENTS),
+    router(this, routes, sizeof(routes) / sizeof(routes[0]),
+           middleware, sizeof(middleware) / sizeof(middleware[0]), &WebInterface::logWebAccess),
+    ota(OTA_PARTITION_TARGET) {
+    static_assert(sizeof(routes) / sizeof(routes[0]) <= ROUTE_TABLE_MAX, "Route table exceeds ROUTE_TABLE_MAX");
     status = WebStatus::STOPPED;
     captivePortalEnabled = false;
     apModeActive = false;
@@ -37,22 +139,26 @@ WebInterface::WebInterface() : server(WEB_SERVER_PORT) {
     authRequired = false;
     adminPassword = "admin123";
     pendingSeedPhrase = "";
+    memset(&pushedBalances, 0, sizeof(pushedBalances));
+    eventId = 0;
 }
 
 void WebInterface::init() {
-    Serial.println("WebInterface: Initializing");
+    LOG_I(WEB, "WebInterface: Initializing\n");
+    setupAdmission();
+    setupEvents();
     setupRoutes();
     status = WebStatus::STOPPED;
 }
 
 void WebInterface::start() {
-    Serial.println("WebInterface: Starting web server");
+    LOG_I(WEB, "WebInterface: Starting web server\n");
     server.begin();
     status = WebStatus::RUNNING;
 }
 
 void WebInterface::stop() {
-    Serial.println("WebInterface: Stopping web server");
+    LOG_I(WEB, "WebInterface: Stopping web server\n");
     server.end();
     status = WebStatus::STOPPED;
 }
@@ -67,11 +173,11 @@ void WebInterface::loop() {
 
 void WebInterface::enableCaptivePortal(bool enable) {
     captivePortalEnabled = enable;
-    Serial.printf("WebInterface: Captive portal %s\n", enable ? "enabled" : "disabled");
+    LOG_I(WEB, "WebInterface: Captive portal %s\n", enable ? "enabled" : "disabled");
 }
 
 void WebInterface::startAPMode() {
-    Serial.println("WebInterface: Starting AP mode");
+    LOG_I(WEB, "WebInterface: Starting AP mode\n");
     
     WiFi.mode(WIFI_AP);
     WiFi.softAPConfig(apIP, apGateway, apSubnet);
@@ -80,12 +186,12 @@ void WebInterface::startAPMode() {
     apModeActive = true;
     status = WebStatus::AP_MODE;
     
-    Serial.printf("WebInterface: AP started - SSID: %s, IP: %s\n", 
-                  apSSID.c_str(), apIP.toString().c_str());
+    LOG_I(WEB, "WebInterface: AP started - SSID: %s, IP: %s\n", 
+               apSSID.c_str(), apIP.toString().c_str());
 }
 
 void WebInterface::stopAPMode() {
-    Serial.println("WebInterface: Stopping AP mode");
+    LOG_I(WEB, "WebInterface: Stopping AP mode\n");
     WiFi.softAPdisconnect(true);
     apModeActive = false;
     status = WebStatus::STOPPED;
@@ -97,32 +203,70 @@ String WebInterface::getAPIP() const {
 
 // Stub implementations for handlers
 void WebInterface::handleConfigRequest(AsyncWebServerRequest* request) {
-    Serial.println("WebInterface: Config request");
-    request->send(200, "text/html; charset=utf-8", generateConfigPage());
+    LOG_I(WEB, "WebInterface: Config request\n");
+    renderConfigPage(request);
 }
 
 void WebInterface::handleApiRequest(AsyncWebServerRequest* request) {
-    Serial.println("WebInterface: API request");
+    LOG_I(WEB, "WebInterface: API request\n");
     request->send(200, "application/json; charset=utf-8", "{\"status\":\"ok\"}");
 }
 
 void WebInterface::handleFileUpload(AsyncWebServerRequest* request, const String& filename, size_t index, uint8_t* data, size_t len, bool final) {
-    Serial.printf("WebInterface: File upload - %s\n", filename.c_str());
+    // Firmware image chunks, written to flash as they arrive
+    updateWebActivity(); // Keep the device awake for the whole upload
+    
+    if (index == 0) {
+        LOG_I(WEB, "WebInterface: Firmware upload - %s\n", filename.c_str());
+        
+        // The route middleware only runs once the body is complete, so check
+        // here before touching flash; the request is rejected properly then
+        if (!authenticateRequest(request, AuthLevel::ADMIN)) {
+            return;
+        }
+        
+        const char* expected = nullptr;
+        if (request->hasParam("sha256")) {
+            expected = request->getParam("sha256")->value().c_str();
+        } else if (request->hasParam("sha256", true)) {
+            expected = request->getParam("sha256", true)->value().c_str();
+        } else if (request->hasHeader(OTA_HASH_HEADER)) {
+            expected = request->getHeader(OTA_HASH_HEADER)->value().c_str();
+        }
+        // The id travels with the request, which frees it with the request
+        uint32_t upload;
+        ota.begin(upload, expected);
+        if (upload && !request->_tempObject) {
+            request->_tempObject = malloc(sizeof(upload));
+        }
+        if (!request->_tempObject) {
+            ota.release(upload);
+            return;
+        }
+        memcpy(request->_tempObject, &upload, sizeof(upload));
+    }
+    
+    uint32_t upload = uploadId(request);
+    if (len > 0) {
+        ota.write(upload, data, len);
+    }
+    if (final) {
+        ota.finish(upload);
+    }
 }
 
 void WebInterface::handleWalletConfig(AsyncWebServerRequest* request) {
-    Serial.println("WebInterface: Wallet config");
+    LOG_I(WEB, "WebInterface: Wallet config\n");
     request->send(200, "text/html; charset=utf-8", "Wallet Config");
 }
 
 void WebInterface::handleLightningTransfer(AsyncWebServerRequest* request) {
-    Serial.println("WebInterface: Lightning transfer");
+    LOG_I(WEB, "WebInterface: Lightning transfer\n");
     request->send(200, "text/html; charset=utf-8", "Lightning Transfer");
 }
 
 void WebInterface::handleWiFiConfig(AsyncWebServerRequest* request) {
-    updateWebActivity(); // Reset sleep timer on web activity
-    Serial.println("WebInterface: Processing WiFi config form");
+    LOG_I(WEB, "WebInterface: Processing WiFi config form\n");
     
     if (request->method() != HTTP_POST) {
         request->send(405, "text/plain", "Method Not Allowed");
@@ -141,9 +285,10 @@ void WebInterface::handleWiFiConfig(AsyncWebServerRequest* request) {
     
     if (ssid.length() > 0) {
         if (settings.setWiFiCredentials(ssid, password)) {
-            if (settings.saveConfig()) {
-                Serial.printf("WiFi config saved - SSID: %s\n", ssid.c_str());
-                request->redirect("/config?saved=wifi");
+            uint32_t job = jobs.post("save-config", jobSaveConfig);
+            if (job) {
+                LOG_I(WEB, "WiFi config updated - SSID: %s\n", ssid.c_str());
+                request->redirect("/config?saved=wifi&job=" + String(job));
                 return;
             }
         }
@@ -153,8 +298,7 @@ void WebInterface::handleWiFiConfig(AsyncWebServerRequest* request) {
 }
 
 void WebInterface::handleLightningConfig(AsyncWebServerRequest* request) {
-    updateWebActivity(); // Reset sleep timer on web activity
-    Serial.println("WebInterface: Processing Lightning config form");
+    LOG_I(WEB, "WebInterface: Processing Lightning config form\n");
     
     if (request->method() != HTTP_POST) {
         request->send(405, "text/plain", "Method Not Allowed");
@@ -179,126 +323,60 @@ void WebInterface::handleLightningConfig(AsyncWebServerRequest* request) {
     if (apiToken.length() > 0 && apiSecret.length() > 0) {
         // Save all Lightning credentials
         if (settings.setLightningCredentials(apiToken, apiSecret, lightningAddress)) {
-            if (settings.saveConfig()) {
+            uint32_t job = jobs.post("save-config", jobSaveConfig);
+            if (job) {
                 // Update the Lightning wallet instance with new credentials
                 lightningWallet.setApiToken(apiToken);
                 lightningWallet.setApiSecret(apiSecret);
                 
-                Serial.printf("Lightning config saved - Token: %s***, Secret: %s***, Address: %s\n", 
+                LOG_I(WEB, "Lightning config updated - Token: %s***, Secret: %s***, Address: %s\n", 
                              apiToken.substring(0, 8).c_str(), 
                              apiSecret.substring(0, 8).c_str(),
                              lightningAddress.c_str());
-                request->redirect("/config?saved=lightning");
+                request->redirect("/config?saved=lightning&job=" + String(job));
                 return;
             }
         }
     } else {
-        Serial.println("WebInterface: Missing required Lightning credentials (token or secret)");
+        LOG_I(WEB, "WebInterface: Missing required Lightning credentials (token or secret)\n");
     }
     
     request->redirect("/config?error=lightning");
 }
 
 void WebInterface::handleColdStorageConfig(AsyncWebServerRequest* request) {
-    updateWebActivity(); // Reset sleep timer on web activity
-    Serial.println("=== HANDLER DEBUG: Cold Storage handler START ===");
-    Serial.printf("Request URL: %s\n", request->url().c_str());
-    Serial.printf("Method: %s\n", request->method() == HTTP_POST ? "POST" : "GET");
-    Serial.printf("Request object address: %p\n", request);
-    
-    // Add safety check for null request
-    if (!request) {
-        Serial.println("ERROR: Null request received");
+    LOG_I(WEB, "WebInterface: Processing cold storage config form\n");
+    
+    if (request->method() != HTTP_POST) {
+        request->send(405, "text/plain", "Method Not Allowed");
         return;
     }
-    Serial.println("HANDLER DEBUG: Request object is valid");
     
-    try {
-        Serial.println("HANDLER DEBUG: Entered try block");
-        
-        if (request->method() != HTTP_POST) {
-            Serial.println("HANDLER DEBUG: Wrong method - sending 405");
-            request->send(405, "text/plain", "Method Not Allowed");
-            Serial.println("HANDLER DEBUG: 405 response sent");
+    String address = "";
+    if (request->hasParam("address", true)) {
+        address = request->getParam("address", true)->value();
+    }
+    LOG_D(WEB, "WebInterface: Received cold storage address: %s (%d chars)\n", address.c_str(), address.length());
+    
+    // A key or descriptor is parsed in full so a bad one is reported, not saved
+    if (address.length() > 0 && coldStorage.isValidAddress(address) &&
+        settings.setColdStorageAddress(address)) {
+        // Persist, switch to the new address and fetch its balance on the
+        // worker, not the TCP task
+        uint32_t saveJob = jobs.post("save-config", jobSaveConfig);
+        uint32_t refreshJob = jobs.post("cold-address", jobApplyColdAddress);
+        if (saveJob && refreshJob) {
+            LOG_I(WEB, "WebInterface: Cold storage address updated: %s\n", address.c_str());
+            request->redirect("/config?saved=coldstorage&job=" + String(refreshJob));
             return;
         }
-        Serial.println("HANDLER DEBUG: Method check passed");
-        
-        String address = "";
-        Serial.println("HANDLER DEBUG: About to check for address parameter");
-        
-        // Check if parameter exists
-        if (request->hasParam("address", true)) {
-            address = request->getParam("address", true)->value();
-            Serial.printf("HANDLER DEBUG: Received address: %s\n", address.c_str());
-        } else {
-            Serial.println("HANDLER DEBUG: No address parameter found");
-        }
-        
-        Serial.printf("HANDLER DEBUG: Address length: %d\n", address.length());
-        
-        if (address.length() > 0) {
-            Serial.println("HANDLER DEBUG: Attempting to save address...");
-            
-            // Check if settings is initialized
-            Serial.println("HANDLER DEBUG: About to check settings availability");
-            if (!settings.getConfig().wifi.ssid.isEmpty() || true) { // Basic check that settings exists
-                Serial.println("HANDLER DEBUG: Settings appears to be available");
-                
-                Serial.println("HANDLER DEBUG: Calling setColdStorageAddress...");
-                if (settings.setColdStorageAddress(address)) {
-                    Serial.println("HANDLER DEBUG: setColdStorageAddress succeeded");
-                    
-                    // IMPORTANT: Update the cold storage instance with the new address!
-                    Serial.println("HANDLER DEBUG: Updating coldStorage instance with new address...");
-                    coldStorage.setAddress(address);
-                    Serial.println("HANDLER DEBUG: Cold storage instance updated");
-                    
-                    // CRITICAL: Update balance immediately with the new address!
-                    Serial.println("HANDLER DEBUG: Triggering balance update...");
-                    coldStorage.updateBalance();
-                    Serial.println("HANDLER DEBUG: Balance update completed");
-                    
-                    Serial.println("HANDLER DEBUG: Calling saveConfig...");
-                    if (settings.saveConfig()) {
-                        Serial.printf("HANDLER DEBUG: Cold storage address saved successfully: %s\n", address.c_str());
-                        Serial.println("HANDLER DEBUG: About to redirect to success page...");
-                        request->redirect("/config?saved=coldstorage");
-                        Serial.println("HANDLER DEBUG: Redirect sent successfully");
-                        return;
-                    } else {
-                        Serial.println("HANDLER DEBUG: saveConfig failed");
-                    }
-                } else {
-                    Serial.println("HANDLER DEBUG: setColdStorageAddress failed");
-                }
-            } else {
-                Serial.println("HANDLER DEBUG: Settings not available");
-            }
-        } else {
-            Serial.println("HANDLER DEBUG: Empty address provided");
-        }
-        
-        Serial.println("HANDLER DEBUG: About to redirect to error page");
-        request->redirect("/config?error=coldstorage");
-        Serial.println("HANDLER DEBUG: Error redirect sent");
-        
-    } catch (const std::exception& e) {
-        Serial.printf("HANDLER DEBUG: Exception caught: %s\n", e.what());
-        request->send(500, "text/plain", "Internal Server Error");
-        Serial.println("HANDLER DEBUG: Exception response sent");
-    } catch (...) {
-        Serial.println("HANDLER DEBUG: Unknown exception caught");
-        request->send(500, "text/plain", "Internal Server Error");
-        Serial.println("HANDLER DEBUG: Unknown exception response sent");
     }
     
-    Serial.println("=== HANDLER DEBUG: Cold Storage handler END ===");
+    request->redirect("/config?error=coldstorage");
 }
 
 void WebInterface::handleSystemConfig(AsyncWebServerRequest* request) {
-    updateWebActivity(); // Reset sleep timer on web activity
-    Serial.println("WebInterface: Processing system config form");
+    LOG_I(WEB, "WebInterface: Processing system config form\n");
     
     if (request->method() != HTTP_POST) {
         request->send(405, "text/plain", "Method Not Allowed");
@@ -318,15 +396,14 @@ void WebInterface::handleSystemConfig(AsyncWebServerRequest* request) {
                 ownerName = "Hodling Hog"; // Reset to default
             }
             
-            // Set device name directly in config
-            settings.getConfig().system.deviceName = ownerName;
+            settings.setDeviceName(ownerName);
             hasChanges = true;
-            Serial.printf("WebInterface: Owner name updated to: %s\n", ownerName.c_str());
+            LOG_I(WEB, "WebInterface: Owner name updated to: %s\n", ownerName.c_str());
             
             // Update display manager immediately so e-ink screen shows new name
             displayMgr.setDeviceName(ownerName);
         } else {
-            Serial.printf("WebInterface: Invalid owner name length: %d\n", ownerName.length());
+            LOG_W(WEB, "WebInterface: Invalid owner name length: %d\n", ownerName.length());
             request->redirect("/config?error=system");
             return;
         }
@@ -343,353 +420,403 @@ void WebInterface::handleSystemConfig(AsyncWebServerRequest* request) {
             
             if (settings.setSleepTimeout(sleepTimeoutMs)) {
                 hasChanges = true;
-                Serial.printf("WebInterface: Sleep timeout updated to %u minutes (%u ms)\n", 
+                LOG_I(WEB, "WebInterface: Sleep timeout updated to %u minutes (%u ms)\n", 
                              sleepTimeoutMinutes, sleepTimeoutMs);
             } else {
-                Serial.println("WebInterface: Failed to save sleep timeout setting");
+                LOG_E(WEB, "WebInterface: Failed to save sleep timeout setting\n");
                 request->redirect("/config?error=system");
                 return;
             }
         } else {
-            Serial.printf("WebInterface: Invalid sleep timeout: %u minutes\n", sleepTimeoutMinutes);
+            LOG_W(WEB, "WebInterface: Invalid sleep timeout: %u minutes\n", sleepTimeoutMinutes);
             request->redirect("/config?error=system");
             return;
         }
     }
     
     if (hasChanges) {
-        if (settings.saveConfig()) {
-            Serial.println("WebInterface: System settings saved successfully");
-            request->redirect("/config?saved=system");
+        uint32_t job = jobs.post("save-config", jobSaveConfig);
+        if (job) {
+            LOG_I(WEB, "WebInterface: System settings updated\n");
+            request->redirect("/config?saved=system&job=" + String(job));
         } else {
-            Serial.println("WebInterface: Failed to save system settings");
+            LOG_E(WEB, "WebInterface: Failed to queue system settings save\n");
             request->redirect("/config?error=system");
         }
     } else {
-        Serial.println("WebInterface: No system settings parameters found");
+        LOG_I(WEB, "WebInterface: No system settings parameters found\n");
         request->redirect("/config?error=system");
     }
 }
 
 void WebInterface::handleTransactionSigning(AsyncWebServerRequest* request) {
-    Serial.println("WebInterface: Transaction signing");
+    LOG_I(WEB, "WebInterface: Transaction signing\n");
     request->send(200, "text/html; charset=utf-8", "Transaction Signing");
 }
 
 void WebInterface::handleSystemInfo(AsyncWebServerRequest* request) {
-    Serial.println("WebInterface: System info");
-    request->send(200, "application/json; charset=utf-8", getSystemStatus());
+    LOG_I(WEB, "WebInterface: System info\n");
+    apiGetStatus(request);
 }
 
 void WebInterface::handleSystemRestart(AsyncWebServerRequest* request) {
-    Serial.println("WebInterface: System restart");
+    LOG_I(WEB, "WebInterface: System restart\n");
     request->send(200, "text/html; charset=utf-8", "Restarting...");
     delay(1000);
+    logFlush();
     ESP.restart();
 }
 
 void WebInterface::handleFactoryReset(AsyncWebServerRequest* request) {
-    Serial.println("WebInterface: ⚠️ FACTORY RESET INITIATED ⚠️");
-    updateWebActivity(); // Reset sleep timer
+    LOG_W(WEB, "WebInterface: ⚠️ FACTORY RESET INITIATED ⚠️\n");
     
     // Clear all active sessions immediately
     clearAllSessions();
-    Serial.println("WebInterface: All sessions cleared");
+    pageCache.clear();
+    LOG_I(WEB, "WebInterface: All sessions cleared\n");
     
-    // Reset all settings to factory defaults
-    if (settings.factoryReset()) {
-        Serial.println("WebInterface: Settings reset to factory defaults");
-    } else {
-        Serial.println("WebInterface: WARNING - Settings reset may have failed");
+    // Erasing flash takes a while; the confirmation page redirects after
+    // 3 seconds, by which time the worker has finished
+    if (!jobs.post("factory-reset", jobFactoryReset)) {
+        sendErrorResponse(request, "Busy, try again", 503);
+        return;
     }
     
     // Send confirmation page with redirect to seed generation
-    String html = "<!DOCTYPE html>";
-    html += "<html><head><title>Factory Reset Complete</title>";
-    html += "<meta http-equiv='refresh' content='3;url=/generate-seed'>";
-    html += "<style>";
-    html += "body{font-family:Arial;text-align:center;padding:2rem;background:#ffecd2;}";
-    html += ".reset-container{max-width:600px;margin:0 auto;background:white;border-radius:20px;padding:2rem;box-shadow:0 4px 6px rgba(0,0,0,0.1);}";
-    html += ".reset-title{font-size:2rem;color:#f44336;margin-bottom:1rem;}";
-    html += ".reset-message{font-size:1.2rem;color:#333;margin-bottom:2rem;}";
-    html += ".countdown{font-size:1rem;color:#666;}";
-    html += "</style></head><body>";
-    html += "<div class='reset-container'>";
-    html += "<div class='reset-title'>🗑️ Factory Reset Complete</div>";
-    html += "<div class='reset-message'>";
-    html += "All data has been permanently erased:<br>";
-    html += "• Seed phrase and login<br>";
-    html += "• Lightning wallet data<br>";
-    html += "• Cold storage settings<br>";
-    html += "• WiFi configuration<br>";
-    html += "• System settings";
-    html += "</div>";
-    html += "<div class='countdown'>Redirecting to setup in 3 seconds...</div>";
-    html += "</div></body></html>";
-    
-    request->send(200, "text/html; charset=utf-8", html);
-    Serial.println("WebInterface: Factory reset complete - redirecting to seed generation");
+    request->send(PageRenderer::begin(request, "factory-reset", PAGE_FACTORY_RESET, nullptr));
+    LOG_I(WEB, "WebInterface: Factory reset queued - redirecting to seed generation\n");
 }
 
 void WebInterface::handleFirmwareUpdate(AsyncWebServerRequest* request) {
-    Serial.println("WebInterface: Firmware update");
-    request->send(200, "text/html; charset=utf-8", "Firmware Update");
+    LOG_I(WEB, "WebInterface: Firmware update\n");
+    
+    // Upload chunks have already been handled by handleFileUpload
+    uint32_t upload = uploadId(request);
+    if (!ota.isOwner(upload)) {
+        if (ota.isBusy()) {
+            sendErrorResponse(request, "Another firmware update is in progress", 409);
+        } else {
+            sendErrorResponse(request, "No firmware image received", 400);
+        }
+        return;
+    }
+    
+    if (ota.getState() != OtaState::VERIFIED) {
+        sendErrorResponse(request, ota.getError(), 422);
+        ota.release(upload);
+        return;
+    }
+    
+    JsonDocument doc(&jsonPool);
+    doc["status"] = "ok";
+    doc["bytes"] = ota.getWritten();
+    doc["elapsed_ms"] = ota.getElapsed();
+    doc["message"] = "Firmware verified, restarting";
+    sendJsonResponse(request, doc);
+    
+    jobs.post("restart", jobRestart);
 }
 
-bool WebInterface::authenticateRequest(AsyncWebServerRequest* request, AuthLevel requiredLevel) {
-    Serial.printf("AUTH DEBUG: Checking auth for %s, required level: %d\n", 
-                  request->url().c_str(), (int)requiredLevel);
-    
+bool WebInterface::authenticateRequest(AsyncWebServerRequest* request, AuthLevel requiredLevel, uint32_t* verifyJob) {
     // Check if authentication is required
     if (!settings.isSeedPhraseSet()) {
-        Serial.println("AUTH DEBUG: No seed phrase set, allowing access");
         return true; // No auth configured yet
     }
     
-    // Check for session token in cookie or header
-    String sessionToken = "";
-    if (request->hasHeader("Cookie")) {
-        String cookie = request->header("Cookie");
-        Serial.printf("AUTH DEBUG: Cookie header: %s\n", cookie.c_str());
-        int sessionStart = cookie.indexOf("session=");
-        if (sessionStart != -1) {
-            sessionStart += 8; // Length of "session="
-            int sessionEnd = cookie.indexOf(";", sessionStart);
-            if (sessionEnd == -1) sessionEnd = cookie.length();
-            sessionToken = cookie.substring(sessionStart, sessionEnd);
-            Serial.printf("AUTH DEBUG: Found session token: %s\n", sessionToken.c_str());
-        } else {
-            Serial.println("AUTH DEBUG: No session cookie found");
-        }
-    } else {
-        Serial.println("AUTH DEBUG: No Cookie header");
-    }
-    
-    // Check authorization header for seed phrase
-    if (sessionToken.isEmpty() && request->hasHeader("Authorization")) {
-        String auth = request->header("Authorization");
-        if (auth.startsWith("Bearer ")) {
-            String seedPhrase = auth.substring(7); // Remove "Bearer "
-            if (settings.validateSeedPhrase(seedPhrase)) {
-                // Create session for this request
-                WebContext* context = createSession(getClientIP(request), 
-                                                   request->hasHeader("User-Agent") ? 
-                                                   request->header("User-Agent") : "Unknown");
-                if (context) {
-                    context->authLevel = AuthLevel::ADMIN;
-                    sessionToken = context->sessionToken;
-                }
-            }
+    // Fast path: session cookie, parsed in place without copying the header
+    AsyncWebHeader* cookie = request->getHeader("Cookie");
+    HeaderView token;
+    if (cookie && findCookie(cookie->value().c_str(), "session", token)) {
+        if (sessions.check(token.data, token.length, requiredLevel)) {
+            return true;
         }
+        LOG_D(AUTH, "WebInterface: No session token with level %d\n", (int)requiredLevel);
     }
     
-    // Validate session token
-    if (!sessionToken.isEmpty() && validateSessionToken(sessionToken)) {
-        WebContext* session = getSession(sessionToken);
-        if (session && session->authLevel >= requiredLevel) {
-            Serial.printf("AUTH DEBUG: Authentication successful, user level: %d\n", (int)session->authLevel);
-            updateSessionActivity(sessionToken);
-            return true;
-        } else if (session) {
-            Serial.printf("AUTH DEBUG: Insufficient privileges - user level: %d, required: %d\n", 
-                         (int)session->authLevel, (int)requiredLevel);
-        } else {
-            Serial.println("AUTH DEBUG: Session not found");
+    // Bearer seed phrase for API clients
+    AsyncWebHeader* authorization = request->getHeader("Authorization");
+    HeaderView credential;
+    if (authorization && findBearer(authorization->value().c_str(), credential)) {
+        AuthLevel level;
+        if (!credentialCache.lookup(credential.data, credential.length, level)) {
+            if (credentialCache.isLocked()) {
+                LOG_D(AUTH, "WebInterface: Bearer verification locked out\n");
+                return false;
+            }
+            
+            // Slow path: the KDF runs on the job worker, which caches the
+            // credential on success; the client retries after that
+            uint32_t job = queueVerification(credential.data, credential.length, nullptr,
+                                             request->client()->remoteIP());
+            if (verifyJob) {
+                *verifyJob = job;
+            }
+            LOG_D(AUTH, "WebInterface: Bearer credential queued for verification\n");
+            return false;
         }
-    } else {
-        Serial.println("AUTH DEBUG: No valid session token");
+        return level >= requiredLevel;
     }
     
-    // Authentication failed
-    Serial.println("AUTH DEBUG: Authentication failed");
+    LOG_D(AUTH, "WebInterface: No valid credentials for %s\n", request->url().c_str());
     return false;
 }
 
-String WebInterface::generateSessionToken() {
-    return "session_" + String(millis());
+bool WebInterface::verifyPendingCredentials() {
+    bool allValid = true;
+    PendingCredentials::Entry entry;
+    int slot;
+    while ((slot = pendingCredentials.next(entry)) >= 0) {
+        String seedPhrase(entry.credential, entry.length);
+        bool login = entry.sessionToken[0] != '\0';
+        bool valid = settings.validateSeedPhrase(seedPhrase, login);
+        if (valid && login) {
+            sessions.insert(entry.sessionToken, entry.clientIP, AuthLevel::ADMIN);
+            LOG_I(WEB, "WebInterface: User logged in successfully\n");
+            
+            // Update balances on successful login to show fresh data
+            if (wifiConnected) {
+                LOG_I(WEB, "Triggering balance update on login\n");
+                jobs.post("balance-refresh", jobRefreshBalances);
+            }
+        } else if (valid) {
+            credentialCache.insert(entry.credential, entry.length, AuthLevel::ADMIN);
+        } else {
+            // Bearer failures feed their own lockout, not the login one
+            if (!login) {
+                credentialCache.recordFailure();
+            }
+            LOG_W(WEB, "WebInterface: %s rejected\n", login ? "Login" : "Bearer credential");
+            allValid = false;
+        }
+        
+        // Freed only after the session or cache entry exists, so a client
+        // waiting on it never sees neither
+        pendingCredentials.finish(slot);
+        memset(&entry, 0, sizeof(entry));
+    }
+    return allValid;
 }
 
 bool WebInterface::validateSessionToken(const String& token) {
-    return activeSessions.find(token) != activeSessions.end();
+    return sessions.check(token.c_str(), token.length(), AuthLevel::NONE);
 }
 
 void WebInterface::invalidateSession(const String& token) {
-    activeSessions.erase(token);
+    sessions.remove(token.c_str(), token.length());
 }
 
 void WebInterface::clearAllSessions() {
-    Serial.printf("WebInterface: Clearing all sessions (%d active)\n", activeSessions.size());
-    activeSessions.clear();
-    Serial.println("WebInterface: All sessions cleared");
-}
-
-String WebInterface::getDeviceInfo() {
-    return "Hodling Hog v1.0";
-}
-
-String WebInterface::getSystemStatus() {
-    return "{\"status\":\"running\",\"uptime\":" + String(millis()) + ",\"free_heap\":" + String(ESP.getFreeHeap()) + "}";
+    LOG_I(WEB, "WebInterface: Clearing all sessions (%d active)\n", sessions.size());
+    sessions.clear();
+    credentialCache.clear();
+    LOG_I(WEB, "WebInterface: All sessions cleared\n");
 }
 
-String WebInterface::getNetworkInfo() {
-    return "{\"wifi_connected\":" + String(WiFi.status() == WL_CONNECTED ? "true" : "false") + "}";
+// Load shedding, checked before any other handler
+void WebInterface::setupAdmission() {
+    server.addHandler(&rateLimiter);
+    server.addHandler(&admission);
 }
 
-// Private methods - stubs
-void WebInterface::setupRoutes() {
-    server.on("/", HTTP_GET, [this](AsyncWebServerRequest* request) {
-        handleRoot(request);
-    });
-    
-    server.on("/login", HTTP_GET, [this](AsyncWebServerRequest* request) {
-        request->send(200, "text/html; charset=utf-8", generateLoginPage());
-    });
-    
-    server.on("/login", HTTP_POST, [this](AsyncWebServerRequest* request) {
-        handleLogin(request);
-    });
-    
-    server.on("/logout", HTTP_GET, [this](AsyncWebServerRequest* request) {
-        handleLogout(request);
-    });
-    
-    server.on("/setup", HTTP_GET, [this](AsyncWebServerRequest* request) {
-        if (settings.isSeedPhraseSet()) {
-            request->redirect("/");
-            return;
+// Live updates
+void WebInterface::setupEvents() {
+    // Same session check as the dashboard itself
+    events.setFilter([this](AsyncWebServerRequest* request) {
+        // Filters run before canHandle, i.e. for every request that gets
+        // this far, so anything but the event stream is passed over first
+        if (request->url() != EVENTS_PATH) {
+            return false;
         }
-        request->send(200, "text/html; charset=utf-8", generateSetupPage());
-    });
-    
-    server.on("/setup", HTTP_POST, [this](AsyncWebServerRequest* request) {
-        handleSetup(request);
-    });
-    
-    server.on("/generate-seed", HTTP_GET, [this](AsyncWebServerRequest* request) {
-        if (settings.isSeedPhraseSet()) {
-            request->redirect("/");
-            return;
+        
+        // Not routed, so Bearer clients are charged here as in routeRateLimit
+        if (request->hasHeader("Authorization") && !checkRateLimit(request->client()->remoteIP())) {
+            return false;
         }
-        handleGenerateSeed(request);
+        return authenticateRequest(request, AuthLevel::BASIC);
     });
     
-    server.on("/confirm-seed", HTTP_GET, [this](AsyncWebServerRequest* request) {
-        if (settings.isSeedPhraseSet() || pendingSeedPhrase.isEmpty()) {
-            request->redirect("/");
+    // New clients get a full snapshot, after that only deltas
+    events.onConnect([this](AsyncEventSourceClient* client) {
+        if (events.count() > maxClients) {
+            LOG_I(WEB, "WebInterface: Too many event clients, closing newest\n");
+            client->close();
             return;
         }
-        request->send(200, "text/html; charset=utf-8", generateSeedConfirmPage());
-    });
-    
-    server.on("/confirm-seed", HTTP_POST, [this](AsyncWebServerRequest* request) {
-        handleConfirmSeed(request);
-    });
-    
-    server.on("/config", HTTP_GET, [this](AsyncWebServerRequest* request) {
-        if (!authenticateRequest(request, AuthLevel::ADMIN)) {
-            request->redirect("/login");
-            return;
+        
+        LightningBalance lnBalance = lightningWallet.getBalance();
+        ColdBalance coldBalance = coldStorage.getBalance();
+        
+        JsonDocument doc(&jsonPool);
+        if (lnBalance.valid) doc["lightning"] = lnBalance.total; else doc["lightning"] = nullptr;
+        if (coldBalance.valid) doc["cold"] = coldBalance.total; else doc["cold"] = nullptr;
+        if (lnBalance.valid || coldBalance.valid) {
+            doc["total"] = (lnBalance.valid ? lnBalance.total : 0) + (coldBalance.valid ? coldBalance.total : 0);
+        } else {
+            doc["total"] = nullptr;
         }
-        handleConfig(request);
+        sendEvent("balances", doc, client);
+        
+        JsonDocument state(&jsonPool);
+        state["state"] = CoreManager::getStateName(core.getCurrentState());
+        sendEvent("state", state, client);
     });
     
+    server.addHandler(&events);
+}
 
+void WebInterface::sendEvent(const char* event, const JsonDocument& doc, AsyncEventSourceClient* client) {
+    if (!client && events.count() == 0) {
+        return;
+    }
     
-
-    
-    server.on("/api/status", HTTP_GET, [this](AsyncWebServerRequest* request) {
-        handleSystemInfo(request);
-    });
-    
-    // IMPORTANT: Specific routes MUST come before general routes to avoid conflicts!
-    // Move specific config endpoints BEFORE the general /api/config routes
-    server.on("/api/config/wifi", HTTP_POST, [this](AsyncWebServerRequest* request) {
-        if (!authenticateRequest(request, AuthLevel::BASIC)) {
-            sendErrorResponse(request, "Authentication required", 401);
-            return;
-        }
-        handleWiFiConfig(request);
-    });
-    
-    server.on("/api/config/lightning", HTTP_POST, [this](AsyncWebServerRequest* request) {
-        if (!authenticateRequest(request, AuthLevel::BASIC)) {
-            sendErrorResponse(request, "Authentication required", 401);
-            return;
-        }
-        handleLightningConfig(request);
-    });
+    char message[EVENTS_MAX_MESSAGE];
+    if (measureJson(doc) >= sizeof(message)) {
+        LOG_I(WEB, "WebInterface: Event '%s' too large, dropped\n", event);
+        return;
+    }
+    serializeJson(doc, message, sizeof(message));
     
-    server.on("/api/config/coldstorage", HTTP_POST, [this](AsyncWebServerRequest* request) {
-        if (!authenticateRequest(request, AuthLevel::BASIC)) {
-            sendErrorResponse(request, "Authentication required", 401);
-            return;
-        }
-        handleColdStorageConfig(request);
-    });
+    if (client) {
+        client->send(message, event, ++eventId, EVENTS_RECONNECT_MS);
+    } else {
+        events.send(message, event, ++eventId, EVENTS_RECONNECT_MS);
+    }
+}
+
+void WebInterface::pushBalances() {
+    LightningBalance lnBalance = lightningWallet.getBalance();
+    ColdBalance coldBalance = coldStorage.getBalance();
+    uint64_t total = (lnBalance.valid ? lnBalance.total : 0) + (coldBalance.valid ? coldBalance.total : 0);
+    bool totalValid = lnBalance.valid || coldBalance.valid;
+    bool first = !pushedBalances.sent;
+    
+    // Only fields that changed since the last push go on the wire
+    JsonDocument doc(&jsonPool);
+    if (first || lnBalance.valid != pushedBalances.lightningValid || lnBalance.total != pushedBalances.lightning) {
+        if (lnBalance.valid) doc["lightning"] = lnBalance.total; else doc["lightning"] = nullptr;
+    }
+    if (first || coldBalance.valid != pushedBalances.coldValid || coldBalance.total != pushedBalances.cold) {
+        if (coldBalance.valid) doc["cold"] = coldBalance.total; else doc["cold"] = nullptr;
+    }
+    bool lastTotalValid = pushedBalances.lightningValid || pushedBalances.coldValid;
+    if (first || totalValid != lastTotalValid || total != pushedBalances.total) {
+        if (totalValid) doc["total"] = total; else doc["total"] = nullptr;
+    }
     
-    server.on("/api/config/system", HTTP_POST, [this](AsyncWebServerRequest* request) {
-        if (!authenticateRequest(request, AuthLevel::BASIC)) {
-            sendErrorResponse(request, "Authentication required", 401);
-            return;
-        }
-        handleSystemConfig(request);
-    });
+    pushedBalances.lightning = lnBalance.total;
+    pushedBalances.cold = coldBalance.total;
+    pushedBalances.total = total;
+    pushedBalances.lightningValid = lnBalance.valid;
+    pushedBalances.coldValid = coldBalance.valid;
+    pushedBalances.sent = true;
     
-    server.on("/api/factory-reset", HTTP_GET, [this](AsyncWebServerRequest* request) {
-        if (!authenticateRequest(request, AuthLevel::ADMIN)) {
-            sendErrorResponse(request, "Authentication required", 401);
-            return;
-        }
-        handleFactoryReset(request);
-    });
+    // An empty object still tells the dashboard the update finished
+    if (doc.isNull()) {
+        doc.to<JsonObject>();
+    }
+    sendEvent("balances", doc);
+}
 
-    // General /api/config routes come AFTER specific ones
-    server.on("/api/config", HTTP_GET, [this](AsyncWebServerRequest* request) {
-        if (!authenticateRequest(request, AuthLevel::ADMIN)) {
-            sendErrorResponse(request, "Authentication required", 401);
-            return;
-        }
-        apiGetConfig(request);
-    });
+void WebInterface::pushState(SystemState state) {
+    JsonDocument doc(&jsonPool);
+    doc["state"] = CoreManager::getStateName(state);
+    sendEvent("state", doc);
+}
+
+void WebInterface::pushWiFiStatus(bool connected) {
+    JsonDocument doc(&jsonPool);
+    doc["connected"] = connected;
+    if (connected) {
+        doc["rssi"] = WiFi.RSSI();
+    }
+    sendEvent("wifi", doc);
+}
+
+String WebInterface::getDeviceInfo() {
+    return "Hodling Hog v1.0";
+}
+
+String WebInterface::getSystemStatus() {
+    String json;
+    serializeJson(createStatusJson(), json);
+    return json;
+}
+
+String WebInterface::getNetworkInfo() {
+    return "{\"wifi_connected\":" + String(WiFi.status() == WL_CONNECTED ? "true" : "false") + "}";
+}
+
+// Private methods - stubs
+void WebInterface::setupRoutes() {
+    router.begin();
+    server.addHandler(&router);
     
-    server.on("/api/config", HTTP_POST, [this](AsyncWebServerRequest* request) {
-        if (!authenticateRequest(request, AuthLevel::ADMIN)) {
-            sendErrorResponse(request, "Authentication required", 401);
-            return;
-        }
-        apiSetConfig(request);
+    // Prefix match, so it stays outside the exact-match table
+    server.on(WEB_STATIC_PATH "/*", HTTP_GET, [this](AsyncWebServerRequest* request) {
+        serveStaticFile(request, request->url());
     });
     
-
-    
     server.onNotFound([this](AsyncWebServerRequest* request) {
         handleNotFound(request);
     });
 }
 
+bool WebInterface::routeRateLimit(AsyncWebServerRequest* request, const Route& route) {
+    // A Bearer credential may cost a KDF run, so it is charged on any route
+    bool charged = (route.flags & ROUTE_GUARDED) || request->hasHeader("Authorization");
+    if (!charged || checkRateLimit(request->client()->remoteIP())) {
+        return true;
+    }
+    sendErrorResponse(request, "Too many requests", 429);
+    return false;
+}
+
+bool WebInterface::routeAuth(AsyncWebServerRequest* request, const Route& route) {
+    uint32_t verifyJob = 0;
+    if (route.auth == AuthLevel::NONE || authenticateRequest(request, route.auth, &verifyJob)) {
+        return true;
+    }
+    if (verifyJob && !(route.flags & ROUTE_PAGE)) {
+        JsonDocument doc(&jsonPool);
+        doc["status"] = "pending";
+        doc["job"] = verifyJob;
+        doc["message"] = "Verifying credential, retry when the job is done";
+        sendJsonResponse(request, doc, 202);
+    } else if (route.flags & ROUTE_PAGE) {
+        request->redirect("/login");
+    } else {
+        sendErrorResponse(request, "Authentication required", 401);
+    }
+    return false;
+}
+
+bool WebInterface::routeActivity(AsyncWebServerRequest* request, const Route& route) {
+    if (route.flags & ROUTE_ACTIVITY) {
+        updateWebActivity(); // Reset sleep timer on web activity
+    }
+    return true;
+}
+
 void WebInterface::handleRoot(AsyncWebServerRequest* request) {
-    updateWebActivity(); // Reset sleep timer on web activity
-    
     // Check if seed phrase is configured
     if (!settings.isSeedPhraseSet()) {
         // Show landing page with setup option
-        request->send(200, "text/html; charset=utf-8", generateLandingPage());
+        renderLandingPage(request);
         return;
     }
     
     // Check authentication
     if (!authenticateRequest(request, AuthLevel::BASIC)) {
         // Show landing page with login option
-        request->send(200, "text/html; charset=utf-8", generateLandingPage());
+        renderLandingPage(request);
         return;
     }
     
-    request->send(200, "text/html; charset=utf-8", generateMainPage());
+    renderMainPage(request);
 }
 
 void WebInterface::handleConfig(AsyncWebServerRequest* request) {
-    updateWebActivity(); // Reset sleep timer on web activity
-    request->send(200, "text/html; charset=utf-8", generateConfigPage());
+    renderConfigPage(request);
 }
 
 void WebInterface::handleAPI(AsyncWebServerRequest* request) {
@@ -704,9 +831,37 @@ void WebInterface::handleCaptivePortal(AsyncWebServerRequest* request) {
     request->redirect("http://" + apIP.toString());
 }
 
-void WebInterface::handleLogin(AsyncWebServerRequest* request) {
-    updateWebActivity(); // Reset sleep timer on web activity
+void WebInterface::handleLoginPage(AsyncWebServerRequest* request) {
+    if (!request->hasParam("verify")) {
+        renderLoginPage(request);
+        return;
+    }
     
+    // Outcome of a POST /login: its session appears once the job worker has
+    // checked the phrase, until then the page reloads itself
+    AsyncWebHeader* cookie = request->getHeader("Cookie");
+    HeaderView token;
+    if (cookie && findCookie(cookie->value().c_str(), "session", token)) {
+        if (sessions.check(token.data, token.length, AuthLevel::ADMIN)) {
+            request->redirect("/");
+            return;
+        }
+        if (pendingCredentials.isPending(token.data, token.length)) {
+            AsyncWebServerResponse* response = PageRenderer::begin(request, "login", PAGE_LOGIN,
+                [](const char* key, RenderValue& value) {
+                    if (strcmp(key, "error") == 0) {
+                        value.fragment = FRAG_LOGIN_PENDING;
+                    }
+                }, 202);
+            response->addHeader("Refresh", "1");
+            request->send(response);
+            return;
+        }
+    }
+    renderLoginPage(request, 401, FRAG_ERROR_LOGIN);
+}
+
+void WebInterface::handleLogin(AsyncWebServerRequest* request) {
     if (request->method() == HTTP_POST) {
         // Get seed phrase from POST body
         String seedPhrase = "";
@@ -714,58 +869,33 @@ void WebInterface::handleLogin(AsyncWebServerRequest* request) {
             seedPhrase = request->getParam("seedphrase", true)->value();
         }
         
-        if (settings.validateSeedPhrase(seedPhrase)) {
-            // Create session
-            WebContext* context = createSession(getClientIP(request), 
-                                               request->hasHeader("User-Agent") ? 
-                                               request->header("User-Agent") : "Unknown");
-            if (context) {
-                context->authLevel = AuthLevel::ADMIN;
-                
-                // Set session cookie
-                AsyncWebServerResponse* response = request->beginResponse(302);
-                response->addHeader("Location", "/");
-                response->addHeader("Set-Cookie", "session=" + context->sessionToken + "; Path=/; HttpOnly; Max-Age=1800");
-                request->send(response);
-                
-                Serial.println("WebInterface: User logged in successfully");
-                
-                // Update balances on successful login to show fresh data
-                if (wifiConnected) {
-                    Serial.println("Triggering balance update on login");
-                    updateBalances();
-                }
-                return;
-            }
+        // The KDF is too slow for the AsyncTCP task. The cookie goes out now
+        // and the session behind it is created by the job worker if the
+        // phrase is right.
+        char sessionToken[SESSION_TOKEN_HEX_LEN + 1];
+        SessionTable::generateToken(sessionToken);
+        if (!queueVerification(seedPhrase.c_str(), seedPhrase.length(), sessionToken,
+                               request->client()->remoteIP())) {
+            renderLoginPage(request, 503, FRAG_ERROR_BUSY);
+            return;
         }
         
-        // Login failed
-        Serial.println("WebInterface: Login failed - invalid seed phrase");
-        String loginPage = generateLoginPage();
-        loginPage.replace("{{error}}", "<div class='error'>Invalid seed phrase or account locked</div>");
-        request->send(401, "text/html; charset=utf-8", loginPage);
+        AsyncWebServerResponse* response = request->beginResponse(302);
+        response->addHeader("Location", "/login?verify=1");
+        response->addHeader("Set-Cookie", String("session=") + sessionToken + "; Path=/; HttpOnly; Max-Age=1800");
+        request->send(response);
     } else {
         // Show login form
-        request->send(200, "text/html; charset=utf-8", generateLoginPage());
+        renderLoginPage(request);
     }
 }
 
 void WebInterface::handleLogout(AsyncWebServerRequest* request) {
     // Get session token and invalidate it
-    String sessionToken = "";
-    if (request->hasHeader("Cookie")) {
-        String cookie = request->header("Cookie");
-        int sessionStart = cookie.indexOf("session=");
-        if (sessionStart != -1) {
-            sessionStart += 8;
-            int sessionEnd = cookie.indexOf(";", sessionStart);
-            if (sessionEnd == -1) sessionEnd = cookie.length();
-            sessionToken = cookie.substring(sessionStart, sessionEnd);
-        }
-    }
-    
-    if (!sessionToken.isEmpty()) {
-        invalidateSession(sessionToken);
+    AsyncWebHeader* cookie = request->getHeader("Cookie");
+    HeaderView token;
+    if (cookie && findCookie(cookie->value().c_str(), "session", token)) {
+        sessions.remove(token.data, token.length);
     }
     
     // Clear cookie and redirect to landing page
@@ -774,7 +904,15 @@ void WebInterface::handleLogout(AsyncWebServerRequest* request) {
     response->addHeader("Set-Cookie", "session=; Path=/; HttpOnly; Max-Age=0");
     request->send(response);
     
-    Serial.println("WebInterface: User logged out");
+    LOG_I(WEB, "WebInterface: User logged out\n");
+}
+
+void WebInterface::handleSetupPage(AsyncWebServerRequest* request) {
+    if (settings.isSeedPhraseSet()) {
+        request->redirect("/");
+        return;
+    }
+    renderSetupPage(request);
 }
 
 void WebInterface::handleSetup(AsyncWebServerRequest* request) {
@@ -791,28 +929,21 @@ void WebInterface::handleSetup(AsyncWebServerRequest* request) {
         
         if (settings.setSeedPhrase(seedPhrase)) {
             // Seed phrase set successfully, auto-login
-            WebContext* context = createSession(getClientIP(request), 
-                                               request->hasHeader("User-Agent") ? 
-                                               request->header("User-Agent") : "Unknown");
-            if (context) {
-                context->authLevel = AuthLevel::ADMIN;
-                
-                AsyncWebServerResponse* response = request->beginResponse(302);
-                response->addHeader("Location", "/");
-                response->addHeader("Set-Cookie", "session=" + context->sessionToken + "; Path=/; HttpOnly; Max-Age=1800");
-                request->send(response);
-                
-                Serial.println("WebInterface: Seed phrase configured and user logged in");
-                return;
-            }
+            char sessionToken[SESSION_TOKEN_HEX_LEN + 1];
+            createSession(request->client()->remoteIP(), AuthLevel::ADMIN, sessionToken);
+            AsyncWebServerResponse* response = request->beginResponse(302);
+            response->addHeader("Location", "/");
+            response->addHeader("Set-Cookie", String("session=") + sessionToken + "; Path=/; HttpOnly; Max-Age=1800");
+            request->send(response);
+            
+            LOG_I(WEB, "WebInterface: Seed phrase configured and user logged in\n");
+            return;
         }
         
         // Setup failed
-        String setupPage = generateSetupPage();
-        setupPage.replace("{{error}}", "<div class='error'>Invalid seed phrase format. Please check that you have exactly 12 valid words.</div>");
-        request->send(400, "text/html; charset=utf-8", setupPage);
+        renderSetupPage(request, 400, FRAG_ERROR_SETUP);
     } else {
-        request->send(200, "text/html; charset=utf-8", generateSetupPage());
+        renderSetupPage(request);
     }
 }
 
@@ -826,9 +957,17 @@ void WebInterface::handleGenerateSeed(AsyncWebServerRequest* request) {
     pendingSeedPhrase = settings.generateKidFriendlySeedPhrase();
     
     // Show the generated seed phrase to the user
-    request->send(200, "text/html; charset=utf-8", generateSeedDisplayPage(pendingSeedPhrase));
+    renderSeedDisplayPage(request, pendingSeedPhrase);
     
-    Serial.println("WebInterface: Generated seed phrase for new user");
+    LOG_I(WEB, "WebInterface: Generated seed phrase for new user\n");
+}
+
+void WebInterface::handleConfirmSeedPage(AsyncWebServerRequest* request) {
+    if (settings.isSeedPhraseSet() || pendingSeedPhrase.isEmpty()) {
+        request->redirect("/");
+        return;
+    }
+    renderSeedConfirmPage(request);
 }
 
 void WebInterface::handleConfirmSeed(AsyncWebServerRequest* request) {
@@ -853,204 +992,61 @@ void WebInterface::handleConfirmSeed(AsyncWebServerRequest* request) {
                 // Clear pending seed and auto-login
                 pendingSeedPhrase = "";
                 
-                WebContext* context = createSession(getClientIP(request), 
-                                                   request->hasHeader("User-Agent") ? 
-                                                   request->header("User-Agent") : "Unknown");
-                if (context) {
-                    context->authLevel = AuthLevel::ADMIN;
-                    
-                    AsyncWebServerResponse* response = request->beginResponse(302);
-                    response->addHeader("Location", "/");
-                    response->addHeader("Set-Cookie", "session=" + context->sessionToken + "; Path=/; HttpOnly; Max-Age=1800");
-                    request->send(response);
-                    
-                    Serial.println("WebInterface: Seed phrase confirmed and user logged in");
-                    
-                    // Load Lightning wallet if configured
-                    if (wifiConnected) {
-                        Serial.println("Loading Lightning wallet configuration on first-time setup");
-                        lightningWallet.createWalletIfNeeded();
-                        
-                        Serial.println("Triggering balance update on first-time setup");
-                        updateBalances();
-                    }
-                    return;
-                }
-            }
-        }
-        
+                char sessionToken[SESSION_TOKEN_HEX_LEN + 1];
+                createSession(request->client()->remoteIP(), AuthLevel::ADMIN, sessionToken);
+                AsyncWebServerResponse* response = request->beginResponse(302);
+                response->addHeader("Location", "/");
+                response->addHeader("Set-Cookie", String("session=") + sessionToken + "; Path=/; HttpOnly; Max-Age=1800");
+                request->send(response);
+                
+                LOG_I(WEB, "WebInterface: Seed phrase confirmed and user logged in\n");
+                
+                // Load Lightning wallet if configured
+                if (wifiConnected) {
+                    LOG_I(WEB, "Loading Lightning wallet and balances on first-time setup\n");
+                    jobs.post("wallet-setup", jobSetupWallet);
+                }
+                return;
+            }
+        }
+        
         // Confirmation failed
-        Serial.println("WebInterface: Seed phrase confirmation failed");
-        String confirmPage = generateSeedConfirmPage();
-        confirmPage.replace("{{error}}", "<div class='error'>❌ The words you entered don't match! Please try again carefully.</div>");
-        request->send(400, "text/html; charset=utf-8", confirmPage);
+        LOG_W(WEB, "WebInterface: Seed phrase confirmation failed\n");
+        renderSeedConfirmPage(request, 400, FRAG_ERROR_CONFIRM);
     } else {
-        request->send(200, "text/html; charset=utf-8", generateSeedConfirmPage());
+        renderSeedConfirmPage(request);
     }
 }
 
-// HTML generators - simplified
-String WebInterface::generateLandingPage() {
-    // Get owner name (device name) from settings
-        String deviceName = settings.getConfig().system.deviceName;
-    String ownerTitle;
+// HTML page renderers - templates live in pages.h
+
+// Owner title as shown on the display, e.g. "Alice's Hodling Hog"
+static String formatOwnerTitle(const String& deviceName) {
     if (deviceName == "Hodling Hog" || deviceName.isEmpty()) {
-        ownerTitle = "My Hodling Hog";
-    } else {
-        ownerTitle = deviceName + "'s Hodling Hog";
+        return "My Hodling Hog";
     }
-    
+    return deviceName + "'s Hodling Hog";
+}
+
+void WebInterface::renderLandingPage(AsyncWebServerRequest* request) {
+    String ownerTitle = formatOwnerTitle(settings.getConfig()->system.deviceName);
     bool isSetup = settings.isSeedPhraseSet();
     
-    String html = "<!DOCTYPE html>";
-    html += "<html>";
-    html += "<head>";
-    html += "<title>" + ownerTitle + "</title>";
-    html += "<meta charset='utf-8'>";
-    html += "<meta name='viewport' content='width=device-width, initial-scale=1'>";
-    html += "<style>";
-    html += "body { ";
-    html += "font-family: 'Comic Sans MS', Arial, sans-serif; ";
-    html += "margin: 0; ";
-    html += "padding: 20px; ";
-    html += "background: linear-gradient(135deg, #ffecd2 0%, #fcb69f 100%);";
-    html += "min-height: 100vh;";
-    html += "display: flex;";
-    html += "align-items: center;";
-    html += "justify-content: center;";
-    html += "}";
-    html += ".landing-container {";
-    html += "max-width: 600px;";
-    html += "margin: 0 auto;";
-    html += "background: white;";
-    html += "border-radius: 20px;";
-    html += "box-shadow: 0 15px 35px rgba(0,0,0,0.1);";
-    html += "padding: 3rem;";
-    html += "text-align: center;";
-    html += "border: 3px solid #ff6b9d;";
-    html += "}";
-    html += ".logo {";
-    html += "font-size: 4rem;";
-    html += "margin-bottom: 1rem;";
-    html += "color: #333;";
-    html += "}";
-    html += ".title {";
-    html += "color: #ff6b9d;";
-    html += "font-size: 2.5rem;";
-    html += "font-weight: bold;";
-    html += "margin-bottom: 1rem;";
-    html += "}";
-    html += ".subtitle {";
-    html += "color: #666;";
-    html += "font-size: 1.3rem;";
-    html += "margin-bottom: 2rem;";
-    html += "line-height: 1.5;";
-    html += "}";
-    html += ".description {";
-    html += "background: #e6f3ff;";
-    html += "color: #0066cc;";
-    html += "padding: 1.5rem;";
-    html += "border-radius: 15px;";
-    html += "margin: 2rem 0;";
-    html += "border-left: 4px solid #0066cc;";
-    html += "font-size: 1.1rem;";
-    html += "line-height: 1.6;";
-    html += "text-align: left;";
-    html += "}";
-    html += ".action-btn {";
-    html += "background: linear-gradient(135deg, #667eea 0%, #764ba2 100%);";
-    html += "color: white;";
-    html += "padding: 1rem 2rem;";
-    html += "border: none;";
-    html += "border-radius: 25px;";
-    html += "font-size: 1.2rem;";
-    html += "cursor: pointer;";
-    html += "transition: all 0.3s;";
-    html += "margin: 0.5rem;";
-    html += "font-family: inherit;";
-    html += "font-weight: bold;";
-    html += "text-decoration: none;";
-    html += "display: inline-block;";
-    html += "}";
-    html += ".action-btn:hover {";
-    html += "transform: translateY(-2px);";
-    html += "box-shadow: 0 5px 15px rgba(0,0,0,0.2);";
-    html += "}";
-    html += ".action-btn.primary {";
-    html += "background: linear-gradient(135deg, #28a745 0%, #20c997 100%);";
-    html += "}";
-    html += ".features {";
-    html += "display: grid;";
-    html += "grid-template-columns: repeat(auto-fit, minmax(150px, 1fr));";
-    html += "gap: 1rem;";
-    html += "margin: 2rem 0;";
-    html += "}";
-    html += ".feature {";
-    html += "background: #f8f9fa;";
-    html += "padding: 1rem;";
-    html += "border-radius: 10px;";
-    html += "font-size: 0.9rem;";
-    html += "}";
-    html += ".feature-icon {";
-    html += "font-size: 2rem;";
-    html += "margin-bottom: 0.5rem;";
-    html += "}";
-    html += "</style>";
-    html += "</head>";
-    html += "<body>";
-    html += "<div class='landing-container'>";
-    html += "<div class='logo'>🐷⚡</div>";
-    html += "<div class='title'>" + ownerTitle + "</div>";
-    html += "<div class='subtitle'>Your Personal Bitcoin Piggy Bank</div>";
-    
-    html += "<div class='description'>";
-    html += "<strong>Welcome to Hodling Hog!</strong><br><br>";
-    html += "This is a kid-friendly Bitcoin monitoring device that helps you track your Bitcoin savings. ";
-    html += "Think of it as your digital piggy bank that shows how much Bitcoin you have in two places:<br><br>";
-    html += "• <strong>Lightning Wallet</strong> - For small amounts and quick payments<br>";
-    html += "• <strong>Cold Storage</strong> - For larger amounts kept extra safe<br><br>";
-    html += "Your Hodling Hog keeps an eye on your Bitcoin 24/7 so you can watch your savings grow!";
-    html += "</div>";
-    
-    html += "<div class='features'>";
-    html += "<div class='feature'>";
-    html += "<div class='feature-icon'>👀</div>";
-    html += "<strong>Watch Only</strong><br>";
-    html += "Safely monitor your Bitcoin without any risk";
-    html += "</div>";
-    html += "<div class='feature'>";
-    html += "<div class='feature-icon'>⚡</div>";
-    html += "<strong>Lightning Ready</strong><br>";
-    html += "Track Lightning wallet balance and transactions";
-    html += "</div>";
-    html += "<div class='feature'>";
-    html += "<div class='feature-icon'>❄️</div>";
-    html += "<strong>Cold Storage</strong><br>";
-    html += "Monitor your cold storage Bitcoin addresses";
-    html += "</div>";
-    html += "<div class='feature'>";
-    html += "<div class='feature-icon'>📱</div>";
-    html += "<strong>Easy Setup</strong><br>";
-    html += "Simple web interface for all family members";
-    html += "</div>";
-    html += "</div>";
-    
-    if (isSetup) {
-        html += "<p style='color: #666; margin: 1rem 0;'>This Hodling Hog has already been set up. Enter your secret words to access it.</p>";
-        html += "<a href='/login' class='action-btn primary'>🔓 Login to My Piggy Bank</a>";
-    } else {
-        html += "<p style='color: #666; margin: 1rem 0;'>Let's get your Hodling Hog set up! We'll create some special words to keep it secure.</p>";
-        html += "<a href='/generate-seed' class='action-btn primary'>🚀 Set Up My Hodling Hog</a>";
-    }
-    
-    html += "</div>";
-    html += "</body>";
-    html += "</html>";
-    return html;
+    request->send(PageRenderer::begin(request, "landing", PAGE_LANDING,
+        [ownerTitle, isSetup](const char* key, RenderValue& value) {
+            if (strcmp(key, "owner_title") == 0) {
+                value.text = ownerTitle;
+            } else if (strcmp(key, "landing_action") == 0) {
+                value.fragment = isSetup ? FRAG_LANDING_LOGIN : FRAG_LANDING_SETUP;
+            }
+        }));
 }
 
-String WebInterface::generateMainPage() {
-    // Access the global wallet instances
+void WebInterface::renderMainPage(AsyncWebServerRequest* request) {
+    uint32_t version = getStateVersion();
+    if (pageCache.send(request, "main", version, AuthLevel::BASIC)) {
+        return;
+    }
     
     // Get current balances
     LightningBalance lnBalance = lightningWallet.getBalance();
@@ -1066,418 +1062,97 @@ String WebInterface::generateMainPage() {
     if (lnBalance.valid) totalSats += lnBalance.total;
     String totalSatsString = (coldBalance.valid || lnBalance.valid) ? utils.formatNumber(totalSats) + " sats" : "-- sats";
     
-    // Get Lightning address for display
-    String lightningAddress = settings.getConfig().lightning.receiveAddress;
-    bool hasLightningWallet = !lightningAddress.isEmpty();
-    
-    // Get device name for title
-    String deviceName = settings.getConfig().system.deviceName;
-    String ownerTitle;
-    if (deviceName == "Hodling Hog" || deviceName.isEmpty()) {
-        ownerTitle = "My Hodling Hog";
-    } else {
-        ownerTitle = deviceName + "'s Hodling Hog";
-    }
-    
-    String html = "<!DOCTYPE html>";
-    html += "<html>";
-    html += "<head>";
-    html += "<title>" + ownerTitle + " - Bitcoin Piggy Bank</title>";
-    html += "<style>";
-    html += "body { ";
-    html += "font-family: 'Comic Sans MS', Arial, sans-serif; ";
-    html += "margin: 0; ";
-    html += "padding: 20px; ";
-    html += "background: linear-gradient(135deg, #ffecd2 0%, #fcb69f 100%);";
-    html += "min-height: 100vh;";
-    html += "}";
-    html += ".container {";
-    html += "max-width: 800px;";
-    html += "margin: 0 auto;";
-    html += "background: white;";
-    html += "border-radius: 20px;";
-    html += "box-shadow: 0 10px 25px rgba(0,0,0,0.1);";
-    html += "padding: 2rem;";
-    html += "border: 3px solid #ff6b9d;";
-    html += "}";
-    html += ".header {";
-    html += "text-align: center;";
-    html += "margin-bottom: 2rem;";
-    html += "border-bottom: 3px solid #f0f0f0;";
-    html += "padding-bottom: 1rem;";
-    html += "}";
-    html += ".logo {";
-    html += "font-size: 3.5rem;";
-    html += "margin-bottom: 0.5rem;";
-    html += "color: #333;";
-    html += "}";
-    html += ".subtitle {";
-    html += "color: #ff6b9d;";
-    html += "font-size: 1.3rem;";
-    html += "font-weight: bold;";
-    html += "}";
-    html += ".nav {";
-    html += "display: flex;";
-    html += "justify-content: space-between;";
-    html += "align-items: center;";
-    html += "background: linear-gradient(135deg, #667eea 0%, #764ba2 100%);";
-    html += "padding: 1rem;";
-    html += "border-radius: 15px;";
-    html += "margin-bottom: 2rem;";
-    html += "color: white;";
-    html += "}";
-    html += ".nav-links {";
-    html += "display: flex;";
-    html += "gap: 1rem;";
-    html += "}";
-    html += ".nav-links a {";
-    html += "color: white;";
-    html += "text-decoration: none;";
-    html += "padding: 0.5rem 1rem;";
-    html += "border-radius: 10px;";
-    html += "transition: background 0.3s;";
-    html += "font-weight: bold;";
-    html += "}";
-    html += ".nav-links a:hover {";
-    html += "background: rgba(255,255,255,0.2);";
-    html += "}";
-    html += ".auth-status {";
-    html += "font-size: 0.9rem;";
-    html += "color: #90ee90;";
-    html += "font-weight: bold;";
-    html += "}";
-    html += ".logout-btn {";
-    html += "background: #ff6b9d;";
-    html += "color: white;";
-    html += "padding: 0.5rem 1rem;";
-    html += "border: none;";
-    html += "border-radius: 10px;";
-    html += "cursor: pointer;";
-    html += "text-decoration: none;";
-    html += "font-size: 0.9rem;";
-    html += "font-weight: bold;";
-    html += "transition: all 0.3s;";
-    html += "}";
-    html += ".logout-btn:hover {";
-    html += "background: #e55a87;";
-    html += "transform: translateY(-2px);";
-    html += "}";
-    html += ".status-grid {";
-    html += "display: grid;";
-    html += "grid-template-columns: repeat(auto-fit, minmax(200px, 1fr));";
-    html += "gap: 1rem;";
-    html += "margin-bottom: 2rem;";
-    html += "}";
-    html += ".status-card {";
-    html += "background: linear-gradient(135deg, #a8edea 0%, #fed6e3 100%);";
-    html += "padding: 1.5rem;";
-    html += "border-radius: 15px;";
-    html += "border-left: 5px solid #667eea;";
-    html += "text-align: center;";
-    html += "transition: transform 0.3s;";
-    html += "}";
-    html += ".status-card:hover {";
-    html += "transform: translateY(-3px);";
-    html += "}";
-    html += ".status-title {";
-    html += "font-weight: bold;";
-    html += "color: #333;";
-    html += "margin-bottom: 0.5rem;";
-    html += "font-size: 1.1rem;";
-    html += "}";
-    html += ".status-value {";
-    html += "font-size: 1.8rem;";
-    html += "color: #667eea;";
-    html += "font-weight: bold;";
-    html += "}";
-    html += ".welcome-message {";
-    html += "background: linear-gradient(135deg, #ffeaa7 0%, #fab1a0 100%);";
-    html += "padding: 1.5rem;";
-    html += "border-radius: 15px;";
-    html += "text-align: center;";
-    html += "border: 3px solid #fdcb6e;";
-    html += "}";
-    html += ".welcome-title {";
-    html += "font-size: 1.5rem;";
-    html += "color: #333;";
-    html += "margin-bottom: 1rem;";
-    html += "font-weight: bold;";
-    html += "}";
-    html += ".welcome-text {";
-    html += "color: #666;";
-    html += "font-size: 1.1rem;";
-    html += "line-height: 1.4;";
-    html += "}";
-    html += ".bitcoin-emoji {";
-    html += "font-size: 2rem;";
-    html += "margin: 0 0.5rem;";
-    html += "}";
-    html += "</style>";
-    html += "</head>";
-    html += "<body>";
-    html += "<div class='container'>";
-    html += "<div class='header'>";
-    html += "<div class='logo'>" + ownerTitle + "</div>";
-    html += "<div class='subtitle'>Your Bitcoin Piggy Bank is Secure!</div>";
-    html += "</div>";
-    html += "<div class='nav'>";
-    html += "<div class='nav-links'>";
-    html += "<a href='/'>My Piggy Bank</a>";
-    html += "<a href='/config'>Settings</a>";
-    html += "</div>";
-    html += "<div style='display: flex; align-items: center; gap: 1rem;'>";
-    html += "<span class='auth-status'>Logged In!</span>";
-    html += "<a href='/logout' class='logout-btn'>Logout</a>";
-    html += "</div>";
-    html += "</div>";
-    // Total Sats display
-    html += "<div class='status-card' style='margin-bottom: 1rem; background: linear-gradient(135deg, #ff9a9e 0%, #fecfef 50%, #fecfef 100%);'>";
-    html += "<div class='status-title' style='color: #333; font-weight: bold;'>Total Sats</div>";
-    html += "<div class='status-value' style='color: #333; font-size: 1.5rem; font-weight: bold;'>" + totalSatsString + "</div>";
-    html += "</div>";
-    
-    html += "<div class='status-grid'>";
-    html += "<div class='status-card'>";
-    html += "<div class='status-title'>Lightning Sats</div>";
-    html += "<div class='status-value'>" + lightningSatsString + "</div>";
-    html += "</div>";
-    html += "<div class='status-card'>";
-    html += "<div class='status-title'>Cold Storage Sats</div>";
-    html += "<div class='status-value'>" + coldSatsString + "</div>";
-    html += "</div>";
-    html += "</div>";
-    html += "<div class='welcome-message'>";
-    html += "<div class='welcome-title'>Welcome to Your Bitcoin Adventure!</div>";
-    html += "<div class='welcome-text'>";
-    html += "Great job setting up your Hodling Hog! ";
-    html += "This is your very own Bitcoin piggy bank where you can save and learn about digital money. ";
-    html += "Use the menu above to explore and watch your savings grow!";
-    if (hasLightningWallet) {
-        html += "<br><br><strong>Lightning Address:</strong> " + lightningAddress;
-        html += "<br>Send Lightning payments to this address to add sats to your wallet!";
-    }
-    html += "</div>";
-    html += "</div>";
-    html += "</div>";
-    html += "</body>";
-    html += "</html>";
-    return html;
+    ConfigSnapshot config = settings.getConfig();
+    String lightningAddress = config->lightning.receiveAddress;
+    String ownerTitle = formatOwnerTitle(config->system.deviceName);
+    
+    AsyncWebServerResponse* response = PageRenderer::begin(request, "main", PAGE_MAIN,
+        [ownerTitle, totalSatsString, lightningSatsString, coldSatsString, lightningAddress]
+        (const char* key, RenderValue& value) {
+            if (strcmp(key, "owner_title") == 0) {
+                value.text = ownerTitle;
+            } else if (strcmp(key, "total_sats") == 0) {
+                value.text = totalSatsString;
+            } else if (strcmp(key, "lightning_sats") == 0) {
+                value.text = lightningSatsString;
+            } else if (strcmp(key, "cold_sats") == 0) {
+                value.text = coldSatsString;
+            } else if (strcmp(key, "lightning_address_note") == 0) {
+                if (!lightningAddress.isEmpty()) {
+                    value.fragment = FRAG_MAIN_LIGHTNING_ADDRESS;
+                }
+            } else if (strcmp(key, "ln_address") == 0) {
+                value.text = lightningAddress;
+            }
+        }, 200, pageCache.capture("main", version, AuthLevel::BASIC));
+    pageCache.addValidators(response, version, AuthLevel::BASIC);
+    request->send(response);
 }
 
-String WebInterface::generateConfigPage() {
-    // Get current settings to populate form fields
-    const HodlingHogConfig& config = settings.getConfig();
-    
-    String html = "<!DOCTYPE html>";
-    html += "<html><head><title>Settings - Hodling Hog</title>";
-    html += "<style>";
-    html += "body{font-family:Arial;margin:0;padding:20px;background:#ffecd2;}";
-    html += ".container{max-width:900px;margin:0 auto;background:white;border-radius:20px;padding:2rem;}";
-    html += ".header{text-align:center;margin-bottom:2rem;border-bottom:3px solid #f0f0f0;padding-bottom:1rem;}";
-    html += ".nav{background:#667eea;padding:1rem;border-radius:15px;margin-bottom:2rem;text-align:center;}";
-    html += ".nav a{color:white;text-decoration:none;padding:0.5rem 1rem;margin:0 0.5rem;border-radius:10px;display:inline-block;font-weight:bold;}";
-    html += ".nav a.active{background:rgba(255,255,255,0.3);}";
-    html += ".section{background:#a8edea;margin-bottom:2rem;border-radius:15px;padding:2rem;}";
-    html += ".section-title{font-size:1.5rem;color:#333;margin-bottom:1rem;font-weight:bold;}";
-    html += ".current-value{background:#e8f5e8;padding:0.5rem;border-radius:5px;margin-bottom:1rem;font-size:0.9rem;color:#2d5f2d;}";
-    html += ".form-group{margin-bottom:1.5rem;}";
-    html += ".form-label{display:block;font-weight:bold;color:#333;margin-bottom:0.5rem;}";
-    html += ".form-input{width:100%;padding:0.75rem;border:2px solid #ddd;border-radius:10px;font-size:1rem;box-sizing:border-box;}";
-    html += ".save-btn{background:#667eea;color:white;padding:0.75rem 2rem;border:none;border-radius:25px;font-size:1.1rem;cursor:pointer;font-weight:bold;margin-top:1rem;}";
-    html += ".danger-zone{background:#ffebee;border:2px solid #f44336;margin-top:2rem;}";
-    html += ".danger-btn{background:#f44336;color:white;padding:0.75rem 2rem;border:none;border-radius:25px;font-size:1.1rem;cursor:pointer;font-weight:bold;margin-top:1rem;}";
-    html += ".danger-btn:hover{background:#d32f2f;}";
-    html += ".warning-text{color:#d32f2f;font-weight:bold;margin-bottom:1rem;}";
-    html += ".warning-text ul{margin:0.5rem 0;padding-left:1.5rem;}";
-    html += ".warning-text li{margin:0.25rem 0;}";
-    html += ".info-box{background:#e3f2fd;border:1px solid #2196f3;padding:1rem;border-radius:8px;margin-bottom:1rem;}";
-    html += ".info-box strong{color:#1976d2;}";
-    html += ".grid-2{display:grid;grid-template-columns:1fr 1fr;gap:1rem;}";
-    html += ".success-msg{background:#d4edda;color:#155724;padding:1rem;border-radius:10px;margin-bottom:2rem;border-left:4px solid #28a745;}";
-    html += ".error-msg{background:#f8d7da;color:#721c24;padding:1rem;border-radius:10px;margin-bottom:2rem;border-left:4px solid #dc3545;}";
-    html += "</style></head><body>";
-    html += "<div class='container'>";
-    html += "<div class='header'><h1>Hodling Hog</h1><p>Settings & Configuration</p></div>";
-    html += "<div class='nav'>";
-    html += "<a href='/'>Home</a>";
-    html += "<a href='/config' class='active'>Settings</a>";
-    html += "</div>";
-    
-    // Add success/error messages based on query parameters
-    html += "<script>";
-    html += "var urlParams = new URLSearchParams(window.location.search);";
-    html += "var saved = urlParams.get('saved');";
-    html += "var error = urlParams.get('error');";
-    html += "if(saved) {";
-    html += "  var msg = '';";
-    html += "  if(saved === 'wifi') msg = 'WiFi settings saved successfully!';";
-    html += "  else if(saved === 'lightning') msg = 'Lightning wallet settings saved successfully!';";
-    html += "  else if(saved === 'coldstorage') msg = 'Cold storage address saved successfully!';";
-    html += "  else if(saved === 'system') msg = 'System settings saved successfully!';";
-    html += "  if(msg) document.write('<div class=\"success-msg\">' + msg + '</div>');";
-    html += "}";
-    html += "if(error) {";
-    html += "  var msg = '';";
-    html += "  if(error === 'wifi') msg = 'Error saving WiFi settings. Please try again.';";
-    html += "  else if(error === 'lightning') msg = 'Error saving Lightning settings. Please check your API token.';";
-    html += "  else if(error === 'coldstorage') msg = 'Error saving cold storage address. Please check the address format.';";
-    html += "  else if(error === 'system') msg = 'Error saving system settings. Please check the sleep timeout value (1-60 minutes).';";
-    html += "  if(msg) document.write('<div class=\"error-msg\">' + msg + '</div>');";
-    html += "}";
-    html += "</script>";
-    
-    html += "<div class='section'>";
-    html += "<div class='section-title'>WiFi Settings</div>";
-    // Show current WiFi settings if available
-    if (!config.wifi.ssid.isEmpty()) {
-        html += "<div class='current-value'>Current WiFi: " + config.wifi.ssid + "</div>";
-    }
-    html += "<form method='POST' action='/api/config/wifi'>";
-    html += "<div class='grid-2'>";
-    html += "<div class='form-group'>";
-    html += "<label class='form-label'>Network Name (SSID)</label>";
-    html += "<input type='text' name='ssid' class='form-input' placeholder='YourWiFiNetwork' value='" + config.wifi.ssid + "' required>";
-    html += "</div>";
-    html += "<div class='form-group'>";
-    html += "<label class='form-label'>Password</label>";
-    // Show asterisks for existing password, but allow field to be populated for editing
-    String passwordDisplay = config.wifi.password.isEmpty() ? "" : String("*").c_str();
-    for (int i = 1; i < config.wifi.password.length(); i++) {
-        passwordDisplay += "*";
-    }
-    html += "<input type='password' name='password' class='form-input' placeholder='" + (config.wifi.password.isEmpty() ? "WiFi Password" : "Current: " + passwordDisplay) + "' value=''>";
-    html += "</div>";
-    html += "</div>";
-    html += "<button type='submit' class='save-btn'>Save WiFi Settings</button>";
-    html += "</form>";
-    html += "</div>";
-    
-    html += "<div class='section'>";
-    html += "<div class='section-title'>⚡ Lightning Wallet Settings (Wallet of Satoshi)</div>";
-    
-    // Instructions for getting WoS credentials
-    html += "<div class='info-box'>";
-    html += "<strong>📱 How to get Wallet of Satoshi API credentials:</strong><br>";
-    html += "1. Download the Wallet of Satoshi app<br>";
-    html += "2. Create an account and verify your email<br>";
-    html += "3. Go to Settings → Developer → API Keys<br>";
-    html += "4. Generate new API credentials<br>";
-    html += "5. Copy the API Token and API Secret below";
-    html += "</div>";
-    
-    // Show current Lightning settings if available
-    if (!config.lightning.apiToken.isEmpty()) {
-        html += "<div class='current-value'>✅ API Token: " + config.lightning.apiToken.substring(0, 8) + "...*** (configured)</div>";
-        if (!config.lightning.receiveAddress.isEmpty()) {
-            html += "<div class='current-value'>📧 Lightning Address: " + config.lightning.receiveAddress + "</div>";
-        }
-    } else {
-        html += "<div class='warning-text'>⚠️ No Lightning wallet configured. Add your WoS credentials below.</div>";
-    }
-    
-    html += "<form method='POST' action='/api/config/lightning'>";
-    html += "<div class='form-group'>";
-    html += "<label class='form-label'>WoS API Token *</label>";
-    html += "<input type='password' name='api_token' class='form-input' placeholder='Your WoS API Token' value='" + config.lightning.apiToken + "'>";
-    html += "<small style='color:#666;'>Get this from Wallet of Satoshi app → Settings → Developer → API Keys</small>";
-    html += "</div>";
-    html += "<div class='form-group'>";
-    html += "<label class='form-label'>WoS API Secret *</label>";
-    html += "<input type='password' name='api_secret' class='form-input' placeholder='Your WoS API Secret' value='" + config.lightning.apiSecret + "'>";
-    html += "<small style='color:#666;'>Keep this secret safe - it's used for signing transactions</small>";
-    html += "</div>";
-    html += "<div class='form-group'>";
-    html += "<label class='form-label'>Lightning Address</label>";
-    html += "<input type='email' name='lightning_address' class='form-input' placeholder='yourname@walletofsatoshi.com' value='" + config.lightning.receiveAddress + "'>";
-    html += "<small style='color:#666;'>Your Lightning address for receiving payments (optional)</small>";
-    html += "</div>";
-    html += "<button type='submit' class='save-btn'>Save Lightning Settings</button>";
-    html += "</form>";
-    html += "</div>";
-    
-    html += "<div class='section'>";
-    html += "<div class='section-title'>Cold Storage Settings</div>";
-    // Show current cold storage address if available
-    if (!config.coldStorage.watchAddress.isEmpty()) {
-        html += "<div class='current-value'>Current Address: " + config.coldStorage.watchAddress + "</div>";
-    }
-    html += "<form method='POST' action='/api/config/coldstorage'>";
-    html += "<div class='form-group'>";
-    html += "<label class='form-label'>Bitcoin Address</label>";
-    html += "<input type='text' name='address' class='form-input' placeholder='bc1q... (your Bitcoin address)' value='" + config.coldStorage.watchAddress + "' required>";
-    html += "</div>";
-    html += "<button type='submit' class='save-btn'>Save Cold Storage Settings</button>";
-    html += "</form>";
-    html += "</div>";
-
-    // System Settings Section
-    html += "<div class='section'>";
-    html += "<div class='section-title'>System Settings</div>";
-    // Show current device name formatted as it appears on screen
-    String currentDeviceName = config.system.deviceName;
-    String currentDisplayName;
-    if (currentDeviceName == "Hodling Hog" || currentDeviceName.isEmpty()) {
-        currentDisplayName = "My Hodling Hog";
-    } else {
-        currentDisplayName = currentDeviceName + "'s Hodling Hog";
-    }
-    html += "<div class='current-value'>Current Display Name: " + currentDisplayName + "</div>";
-    // Show current sleep timeout
-    uint32_t currentSleepTimeoutMinutes = config.power.sleepTimeout / 60000; // Convert ms to minutes
-    html += "<div class='current-value'>Current Sleep Timeout: " + String(currentSleepTimeoutMinutes) + " minutes</div>";
-    html += "<form method='POST' action='/api/config/system'>";
-    html += "<div class='form-group'>";
-    html += "<label class='form-label'>Owner Name:</label>";
-    html += "<input type='text' name='ownerName' class='form-input' placeholder='Enter your name (e.g., Alice)' value='" + (currentDeviceName == "Hodling Hog" ? "" : currentDeviceName) + "' maxlength='20'>";
-    html += "<small style='color:#666;'>This will show as \"YourName's Hodling Hog\" on the device</small>";
-    html += "</div>";
-    html += "<div class='form-group'>";
-    html += "<label class='form-label'>Sleep Timeout (minutes):</label>";
-    html += "<input type='number' name='sleepTimeout' class='form-input' placeholder='3' value='" + String(currentSleepTimeoutMinutes) + "' min='1' max='60' required>";
-    html += "<small style='color:#666;'>Device will sleep after this many minutes of inactivity</small>";
-    html += "</div>";
-    html += "<button type='submit' class='save-btn'>Save System Settings</button>";
-    html += "</form>";
-    html += "</div>";
-
-    // Danger Zone Section
-    html += "<div class='section danger-zone'>";
-    html += "<div class='section-title'>⚠️ Danger Zone</div>";
-    html += "<div class='warning-text'>";
-    html += "This action cannot be undone! Factory reset will permanently erase:";
-    html += "<ul>";
-    html += "<li>🔑 Seed phrase and login credentials</li>";
-    html += "<li>⚡ Lightning wallet data</li>";
-    html += "<li>❄️ Cold storage settings</li>";
-    html += "<li>📶 WiFi configuration</li>";
-    html += "<li>⚙️ All system settings</li>";
-    html += "</ul>";
-    html += "</div>";
-    html += "<button type='button' class='danger-btn' onclick='confirmFactoryReset()'>🗑️ Factory Reset Device</button>";
-    html += "</div>";
-    
-    html += "</div>";
-    
-    // Add JavaScript for factory reset confirmation
-    html += "<script>";
-    html += "function confirmFactoryReset() {";
-    html += "  if(confirm('⚠️ DANGER: This will permanently erase ALL data including your seed phrase!\\n\\nAre you absolutely sure you want to factory reset?')) {";
-    html += "    if(confirm('⚠️ FINAL WARNING: Your Lightning wallet and all settings will be lost forever!\\n\\nContinue with factory reset?')) {";
-    html += "      window.location.href = '/api/factory-reset';";
-    html += "    }";
-    html += "  }";
-    html += "}";
-    html += "</script>";
-    
-    html += "</body></html>";
-    return html;
+void WebInterface::renderConfigPage(AsyncWebServerRequest* request) {
+    uint32_t version = getStateVersion();
+    if (pageCache.send(request, "config", version, AuthLevel::ADMIN)) {
+        return;
+    }
+    
+    // Snapshot current settings to populate form fields; the renderer
+    // shares it rather than copying every string
+    ConfigSnapshot config = settings.getConfig();
+    
+    AsyncWebServerResponse* response = PageRenderer::begin(request, "config", PAGE_CONFIG,
+        [config](const char* key, RenderValue& value) {
+            if (strcmp(key, "wifi_current") == 0) {
+                if (!config->wifi.ssid.isEmpty()) {
+                    value.fragment = FRAG_CONFIG_WIFI_CURRENT;
+                }
+            } else if (strcmp(key, "wifi_ssid") == 0) {
+                value.text = config->wifi.ssid;
+            } else if (strcmp(key, "wifi_password_hint") == 0) {
+                // Show asterisks for existing password, never the password itself
+                if (config->wifi.password.isEmpty()) {
+                    value.text = "WiFi Password";
+                } else {
+                    value.text = "Current: ";
+                    for (size_t i = 0; i < config->wifi.password.length(); i++) {
+                        value.text += "*";
+                    }
+                }
+            } else if (strcmp(key, "lightning_current") == 0) {
+                value.fragment = config->lightning.apiToken.isEmpty() ?
+                                 FRAG_CONFIG_LIGHTNING_MISSING : FRAG_CONFIG_LIGHTNING_CONFIGURED;
+            } else if (strcmp(key, "lightning_address_current") == 0) {
+                if (!config->lightning.receiveAddress.isEmpty()) {
+                    value.fragment = FRAG_CONFIG_LIGHTNING_ADDRESS;
+                }
+            } else if (strcmp(key, "ln_token_prefix") == 0) {
+                value.text = config->lightning.apiToken.substring(0, 8);
+            } else if (strcmp(key, "ln_api_token") == 0) {
+                value.text = config->lightning.apiToken;
+            } else if (strcmp(key, "ln_api_secret") == 0) {
+                value.text = config->lightning.apiSecret;
+            } else if (strcmp(key, "ln_address") == 0) {
+                value.text = config->lightning.receiveAddress;
+            } else if (strcmp(key, "cold_current") == 0) {
+                if (!config->coldStorage.watchAddress.isEmpty()) {
+                    value.fragment = FRAG_CONFIG_COLD_CURRENT;
+                }
+            } else if (strcmp(key, "cold_address") == 0) {
+                value.text = config->coldStorage.watchAddress;
+            } else if (strcmp(key, "display_name") == 0) {
+                value.text = formatOwnerTitle(config->system.deviceName);
+            } else if (strcmp(key, "sleep_minutes") == 0) {
+                value.text = String(config->power.sleepTimeout / 60000); // Convert ms to minutes
+            } else if (strcmp(key, "owner_name") == 0) {
+                value.text = config->system.deviceName == "Hodling Hog" ? "" : config->system.deviceName;
+            }
+        }, 200, pageCache.capture("config", version, AuthLevel::ADMIN));
+    pageCache.addValidators(response, version, AuthLevel::ADMIN);
+    request->send(response);
 }
 
 // Commented out - wallet functionality removed for passive mode
 /*
 String WebInterface::generateWalletPage() {
-    updateWebActivity(); // Reset sleep timer on web activity
-    
     // Get current balances
     LightningBalance lnBalance = lightningWallet.getBalance();
     ColdBalance coldBalance = coldStorage.getBalance();
@@ -1488,11 +1163,11 @@ String WebInterface::generateWalletPage() {
     String lightningString = lnBalance.valid ? String(lnBalance.total) + " sats" : "-- sats";
     
     // Get Lightning address
-    String lightningAddress = settings.getConfig().lightning.receiveAddress;
+    String lightningAddress = settings.getConfig()->lightning.receiveAddress;
     bool hasLightningWallet = !lightningAddress.isEmpty();
     
     // Get cold storage address
-    String coldAddress = settings.getConfig().coldStorage.watchAddress;
+    String coldAddress = settings.getConfig()->coldStorage.watchAddress;
     bool hasColdStorage = !coldAddress.isEmpty();
     
     
@@ -1667,680 +1342,44 @@ String WebInterface::generateSystemPage() {
     return "<!DOCTYPE html><html><head><title>System</title></head><body><h1>System Page Not Available</h1><a href='/'>Home</a> | <a href='/config'>Settings</a></body></html>";
 }
 
-String WebInterface::generateCaptivePortalPage() {
-    return generateMainPage();
+void WebInterface::renderCaptivePortalPage(AsyncWebServerRequest* request) {
+    renderMainPage(request);
 }
 
-String WebInterface::generateLoginPage() {
-    return R"(
-<!DOCTYPE html>
-<html>
-<head>
-    <title>Login to Your Piggy Bank - Hodling Hog</title>
-    <style>
-        body { 
-            font-family: 'Comic Sans MS', Arial, sans-serif; 
-            margin: 0; 
-            padding: 0; 
-            background: linear-gradient(135deg, #667eea 0%, #764ba2 100%);
-            min-height: 100vh;
-            display: flex;
-            align-items: center;
-            justify-content: center;
-        }
-        .login-container {
-            background: white;
-            padding: 2rem;
-            border-radius: 15px;
-            box-shadow: 0 10px 25px rgba(0,0,0,0.2);
-            max-width: 400px;
-            width: 90%;
-            border: 3px solid #667eea;
-        }
-        .logo {
-            text-align: center;
-            font-size: 2.5rem;
-            margin-bottom: 1rem;
-            color: #333;
-        }
-        .subtitle {
-            text-align: center;
-            color: #666;
-            margin-bottom: 2rem;
-            font-size: 1.1rem;
-        }
-        .form-group {
-            margin-bottom: 1rem;
-        }
-        label {
-            display: block;
-            margin-bottom: 0.5rem;
-            font-weight: bold;
-            color: #333;
-            font-size: 1.1rem;
-        }
-        .seed-input {
-            width: 100%;
-            padding: 0.75rem;
-            border: 2px solid #ddd;
-            border-radius: 10px;
-            font-size: 1.1rem;
-            font-family: 'Courier New', monospace;
-            text-align: center;
-            letter-spacing: 1px;
-        }
-        .seed-input:focus {
-            border-color: #667eea;
-            outline: none;
-            box-shadow: 0 0 10px rgba(102, 126, 234, 0.3);
-        }
-        .login-btn {
-            width: 100%;
-            padding: 0.75rem;
-            background: #667eea;
-            color: white;
-            border: none;
-            border-radius: 25px;
-            font-size: 1.1rem;
-            cursor: pointer;
-            transition: all 0.3s;
-            font-family: inherit;
-            font-weight: bold;
-        }
-        .login-btn:hover {
-            background: #5a6fd8;
-            transform: translateY(-2px);
-            box-shadow: 0 5px 15px rgba(0,0,0,0.2);
-        }
-        .error {
-            background: #ffe6e6;
-            color: #d00;
-            padding: 0.75rem;
-            border-radius: 5px;
-            margin-bottom: 1rem;
-            border-left: 4px solid #d00;
-        }
-        .info {
-            background: #e6f3ff;
-            color: #0066cc;
-            padding: 0.75rem;
-            border-radius: 5px;
-            margin-bottom: 1rem;
-            border-left: 4px solid #0066cc;
-            font-size: 0.9rem;
-        }
-        .word-count {
-            font-size: 0.8rem;
-            color: #666;
-            text-align: right;
-            margin-top: 0.25rem;
-        }
-    </style>
-</head>
-<body>
-    <div class="login-container">
-        <div class="logo">🐷⚡ Hodling Hog</div>
-        <div class="subtitle">Welcome back! Open your piggy bank</div>
-        
-        {{error}}
-        
-        <div class="info">
-            Enter the 4 special words you wrote down to access your Bitcoin piggy bank! 🔐
-        </div>
-        
-        <form method="POST" action="/login">
-            <div class="form-group">
-                <label for="seedphrase">Your 4 Secret Words:</label>
-                <input 
-                    type="text" 
-                    id="seedphrase" 
-                    name="seedphrase" 
-                    class="seed-input"
-                    placeholder="word1 word2 word3 word4"
-                    required
-                    autocomplete="off"
-                    autocapitalize="none"
-                    autocorrect="off"
-                    spellcheck="false"
-                />
-                <div class="word-count" id="wordCount">0 words</div>
-            </div>
-            
-            <button type="submit" class="login-btn">🔓 Open My Piggy Bank!</button>
-        </form>
-    </div>
-    
-    <script>
-        document.getElementById('seedphrase').addEventListener('input', function() {
-            const words = this.value.trim().split(/\s+/).filter(word => word.length > 0);
-            document.getElementById('wordCount').textContent = words.length + ' words';
-            
-            if (words.length === 4) {
-                document.getElementById('wordCount').style.color = '#0a8';
-                document.querySelector('.login-btn').style.background = '#667eea';
-            } else {
-                document.getElementById('wordCount').style.color = '#666';
-                document.querySelector('.login-btn').style.background = '#6c757d';
+void WebInterface::renderLoginPage(AsyncWebServerRequest* request, int httpCode, PGM_P error) {
+    request->send(PageRenderer::begin(request, "login", PAGE_LOGIN,
+        [error](const char* key, RenderValue& value) {
+            if (strcmp(key, "error") == 0) {
+                value.fragment = error;
             }
-        });
-        
-        // Clear any error placeholder if no error
-        if (document.querySelector('.error') === null) {
-            document.body.innerHTML = document.body.innerHTML.replace('{{error}}', '');
-        }
-    </script>
-</body>
-</html>
-)";
+        }, httpCode));
 }
 
-String WebInterface::generateSetupPage() {
-    return R"(
-<!DOCTYPE html>
-<html>
-<head>
-    <title>Hodling Hog - First Time Setup</title>
-    <style>
-        body { 
-            font-family: Arial, sans-serif; 
-            margin: 0; 
-            padding: 0; 
-            background: linear-gradient(135deg, #667eea 0%, #764ba2 100%);
-            min-height: 100vh;
-            display: flex;
-            align-items: center;
-            justify-content: center;
-        }
-        .setup-container {
-            background: white;
-            padding: 2rem;
-            border-radius: 10px;
-            box-shadow: 0 10px 25px rgba(0,0,0,0.2);
-            max-width: 500px;
-            width: 90%;
-        }
-        .logo {
-            text-align: center;
-            font-size: 2.5rem;
-            margin-bottom: 1rem;
-            color: #333;
-        }
-        .subtitle {
-            text-align: center;
-            color: #666;
-            margin-bottom: 2rem;
-        }
-        .form-group {
-            margin-bottom: 1rem;
-        }
-        label {
-            display: block;
-            margin-bottom: 0.5rem;
-            font-weight: bold;
-            color: #333;
-        }
-        .seed-input {
-            width: 100%;
-            padding: 0.75rem;
-            border: 2px solid #ddd;
-            border-radius: 5px;
-            font-size: 1rem;
-            min-height: 100px;
-            resize: vertical;
-            font-family: monospace;
-        }
-        .seed-input:focus {
-            border-color: #667eea;
-            outline: none;
-        }
-        .setup-btn {
-            width: 100%;
-            padding: 0.75rem;
-            background: #28a745;
-            color: white;
-            border: none;
-            border-radius: 5px;
-            font-size: 1rem;
-            cursor: pointer;
-            transition: background 0.3s;
-        }
-        .setup-btn:hover {
-            background: #218838;
-        }
-        .error {
-            background: #ffe6e6;
-            color: #d00;
-            padding: 0.75rem;
-            border-radius: 5px;
-            margin-bottom: 1rem;
-            border-left: 4px solid #d00;
-        }
-        .warning {
-            background: #fff3cd;
-            color: #856404;
-            padding: 0.75rem;
-            border-radius: 5px;
-            margin-bottom: 1rem;
-            border-left: 4px solid #ffc107;
-            font-size: 0.9rem;
-        }
-        .info {
-            background: #e6f3ff;
-            color: #0066cc;
-            padding: 0.75rem;
-            border-radius: 5px;
-            margin-bottom: 1rem;
-            border-left: 4px solid #0066cc;
-            font-size: 0.9rem;
-        }
-        .word-count {
-            font-size: 0.8rem;
-            color: #666;
-            text-align: right;
-            margin-top: 0.25rem;
-        }
-        .example {
-            background: #f8f9fa;
-            padding: 0.5rem;
-            border-radius: 3px;
-            font-family: monospace;
-            font-size: 0.8rem;
-            margin-top: 0.5rem;
-            color: #666;
-        }
-    </style>
-</head>
-<body>
-    <div class="setup-container">
-        <div class="logo">🐷⚡ Hodling Hog</div>
-        <div class="subtitle">First Time Setup</div>
-        
-        {{error}}
-        
-        <div class="warning">
-            <strong>⚠️ Important Security Information</strong><br>
-            This seed phrase will be used to protect access to your Hodling Hog device. 
-            Store it securely and never share it with anyone!
-        </div>
-        
-        <div class="info">
-            <strong>Setup Instructions:</strong><br>
-            1. Generate a new 12-word seed phrase using a trusted wallet app<br>
-            2. Write it down on paper and store it safely<br>
-            3. Enter it below to secure your device<br>
-            4. You'll need this phrase to access the web interface
-        </div>
-        
-        <form method="POST" action="/setup">
-            <div class="form-group">
-                <label for="seedphrase">Enter your 12-word seed phrase:</label>
-                <textarea 
-                    id="seedphrase" 
-                    name="seedphrase" 
-                    class="seed-input"
-                    placeholder="Enter 12 words separated by spaces..."
-                    required
-                    autocomplete="off"
-                    autocapitalize="none"
-                    autocorrect="off"
-                    spellcheck="false"
-                ></textarea>
-                <div class="word-count" id="wordCount">0 words</div>
-                <div class="example">
-                    Example: abandon ability able about above absent absorb abstract absurd abuse access accident
-                </div>
-            </div>
-            
-            <button type="submit" class="setup-btn">🔐 Secure My Device</button>
-        </form>
-    </div>
-    
-    <script>
-        document.getElementById('seedphrase').addEventListener('input', function() {
-            const words = this.value.trim().split(/\s+/).filter(word => word.length > 0);
-            document.getElementById('wordCount').textContent = words.length + ' words';
-            
-            if (words.length === 12) {
-                document.getElementById('wordCount').style.color = '#28a745';
-                document.querySelector('.setup-btn').style.background = '#28a745';
-            } else {
-                document.getElementById('wordCount').style.color = '#666';
-                document.querySelector('.setup-btn').style.background = '#6c757d';
+void WebInterface::renderSetupPage(AsyncWebServerRequest* request, int httpCode, PGM_P error) {
+    request->send(PageRenderer::begin(request, "setup", PAGE_SETUP,
+        [error](const char* key, RenderValue& value) {
+            if (strcmp(key, "error") == 0) {
+                value.fragment = error;
             }
-        });
-        
-        // Clear any error placeholder if no error
-        if (document.querySelector('.error') === null) {
-            document.body.innerHTML = document.body.innerHTML.replace('{{error}}', '');
-        }
-    </script>
-</body>
-</html>
-)";
+        }, httpCode));
 }
 
-String WebInterface::generateSeedDisplayPage(const String& seedPhrase) {
-    String page = R"(
-<!DOCTYPE html>
-<html>
-<head>
-    <title>Your Secret Words - Hodling Hog</title>
-    <style>
-        body { 
-            font-family: 'Comic Sans MS', Arial, sans-serif; 
-            margin: 0; 
-            padding: 0; 
-            background: linear-gradient(135deg, #ff9a9e 0%, #fecfef 50%, #fecfef 100%);
-            min-height: 100vh;
-            display: flex;
-            align-items: center;
-            justify-content: center;
-        }
-        .seed-container {
-            background: white;
-            padding: 2rem;
-            border-radius: 20px;
-            box-shadow: 0 15px 35px rgba(0,0,0,0.1);
-            max-width: 500px;
-            width: 90%;
-            text-align: center;
-            border: 3px solid #ff6b9d;
-        }
-        .logo {
-            font-size: 3rem;
-            margin-bottom: 1rem;
-            color: #333;
-        }
-        .title {
-            color: #ff6b9d;
-            font-size: 1.8rem;
-            font-weight: bold;
-            margin-bottom: 1rem;
-        }
-        .subtitle {
-            color: #666;
-            margin-bottom: 2rem;
-            font-size: 1.1rem;
-        }
-        .seed-words {
-            background: #f8f9ff;
-            padding: 2rem;
-            border-radius: 15px;
-            margin: 2rem 0;
-            border: 2px dashed #ff6b9d;
-            font-family: 'Courier New', monospace;
-            font-size: 1.8rem;
-            font-weight: bold;
-            color: #333;
-            letter-spacing: 2px;
-            line-height: 1.6;
-        }
-        .warning {
-            background: #fff3cd;
-            color: #856404;
-            padding: 1rem;
-            border-radius: 10px;
-            margin: 1rem 0;
-            border-left: 4px solid #ffc107;
-            font-size: 0.95rem;
-            text-align: left;
-        }
-        .instructions {
-            background: #e6f3ff;
-            color: #0066cc;
-            padding: 1rem;
-            border-radius: 10px;
-            margin: 1rem 0;
-            border-left: 4px solid #0066cc;
-            font-size: 0.95rem;
-            text-align: left;
-        }
-        .continue-btn {
-            background: #28a745;
-            color: white;
-            padding: 1rem 2rem;
-            border: none;
-            border-radius: 25px;
-            font-size: 1.2rem;
-            cursor: pointer;
-            transition: all 0.3s;
-            margin-top: 1rem;
-            font-family: inherit;
-            font-weight: bold;
-        }
-        .continue-btn:hover {
-            background: #218838;
-            transform: translateY(-2px);
-            box-shadow: 0 5px 15px rgba(0,0,0,0.2);
-        }
-        .step-indicator {
-            background: #ff6b9d;
-            color: white;
-            padding: 0.5rem 1rem;
-            border-radius: 20px;
-            font-size: 0.9rem;
-            margin-bottom: 1rem;
-            display: inline-block;
-        }
-    </style>
-</head>
-<body>
-    <div class="seed-container">
-        <div class="step-indicator">📝 Step 1 of 2: Write Down Your Words</div>
-        <div class="logo">🐷⚡ Hodling Hog</div>
-        <div class="title">Your Secret Words!</div>
-        <div class="subtitle">These 4 special words will protect your Bitcoin piggy bank</div>
-        
-                 <div class="seed-words">)" + seedPhrase + R"(</div>
-        
-        <div class="warning">
-            <strong>⚠️ Very Important!</strong><br>
-            Write these 4 words on a piece of paper RIGHT NOW! 📝<br>
-            Keep the paper safe - you'll need these words to open your piggy bank!
-        </div>
-        
-        <div class="instructions">
-            <strong>📚 What to do:</strong><br>
-            1. Get a piece of paper and a pencil ✏️<br>
-            2. Write down all 4 words exactly as shown<br>
-            3. Keep your paper somewhere safe (like with your other important papers)<br>
-            4. Click continue when you're done writing
-        </div>
-        
-        <a href="/confirm-seed">
-            <button class="continue-btn">✅ I wrote them down!</button>
-        </a>
-    </div>
-</body>
-</html>
-)";
-    return page;
-}
-
-String WebInterface::generateSeedConfirmPage() {
-    return R"(
-<!DOCTYPE html>
-<html>
-<head>
-    <title>Confirm Your Words - Hodling Hog</title>
-    <style>
-        body { 
-            font-family: 'Comic Sans MS', Arial, sans-serif; 
-            margin: 0; 
-            padding: 0; 
-            background: linear-gradient(135deg, #a8edea 0%, #fed6e3 100%);
-            min-height: 100vh;
-            display: flex;
-            align-items: center;
-            justify-content: center;
-        }
-        .confirm-container {
-            background: white;
-            padding: 2rem;
-            border-radius: 20px;
-            box-shadow: 0 15px 35px rgba(0,0,0,0.1);
-            max-width: 500px;
-            width: 90%;
-            text-align: center;
-            border: 3px solid #6fb3d9;
-        }
-        .logo {
-            font-size: 3rem;
-            margin-bottom: 1rem;
-            color: #333;
-        }
-        .title {
-            color: #6fb3d9;
-            font-size: 1.8rem;
-            font-weight: bold;
-            margin-bottom: 1rem;
-        }
-        .subtitle {
-            color: #666;
-            margin-bottom: 2rem;
-            font-size: 1.1rem;
-        }
-        .form-group {
-            margin-bottom: 1.5rem;
-            text-align: left;
-        }
-        label {
-            display: block;
-            margin-bottom: 0.5rem;
-            font-weight: bold;
-            color: #333;
-            font-size: 1.1rem;
-        }
-        .seed-input {
-            width: 100%;
-            padding: 1rem;
-            border: 3px solid #ddd;
-            border-radius: 15px;
-            font-size: 1.2rem;
-            font-family: 'Courier New', monospace;
-            text-align: center;
-            letter-spacing: 2px;
-        }
-        .seed-input:focus {
-            border-color: #6fb3d9;
-            outline: none;
-            box-shadow: 0 0 10px rgba(111, 179, 217, 0.3);
-        }
-        .confirm-btn {
-            background: #28a745;
-            color: white;
-            padding: 1rem 2rem;
-            border: none;
-            border-radius: 25px;
-            font-size: 1.2rem;
-            cursor: pointer;
-            transition: all 0.3s;
-            margin-top: 1rem;
-            font-family: inherit;
-            font-weight: bold;
-            width: 100%;
-        }
-        .confirm-btn:hover {
-            background: #218838;
-            transform: translateY(-2px);
-            box-shadow: 0 5px 15px rgba(0,0,0,0.2);
-        }
-        .error {
-            background: #ffe6e6;
-            color: #d00;
-            padding: 1rem;
-            border-radius: 10px;
-            margin-bottom: 1rem;
-            border-left: 4px solid #d00;
-            text-align: left;
-        }
-        .instructions {
-            background: #e6f3ff;
-            color: #0066cc;
-            padding: 1rem;
-            border-radius: 10px;
-            margin: 1rem 0;
-            border-left: 4px solid #0066cc;
-            font-size: 0.95rem;
-            text-align: left;
-        }
-        .step-indicator {
-            background: #6fb3d9;
-            color: white;
-            padding: 0.5rem 1rem;
-            border-radius: 20px;
-            font-size: 0.9rem;
-            margin-bottom: 1rem;
-            display: inline-block;
-        }
-        .word-count {
-            font-size: 0.9rem;
-            color: #666;
-            text-align: right;
-            margin-top: 0.5rem;
-        }
-    </style>
-</head>
-<body>
-    <div class="confirm-container">
-        <div class="step-indicator">✅ Step 2 of 2: Confirm Your Words</div>
-        <div class="logo">🐷⚡ Hodling Hog</div>
-        <div class="title">Now Type Your Words</div>
-        <div class="subtitle">Show me you wrote them down correctly!</div>
-        
-        {{error}}
-        
-        <div class="instructions">
-            <strong>🔍 Type the 4 words you wrote down:</strong><br>
-            • Type them exactly as they appeared<br>
-            • Separate each word with a space<br>
-            • Check your spelling carefully!
-        </div>
-        
-        <form method="POST" action="/confirm-seed">
-            <div class="form-group">
-                <label for="seedphrase">Enter your 4 words:</label>
-                <input 
-                    type="text" 
-                    id="seedphrase" 
-                    name="seedphrase" 
-                    class="seed-input"
-                    placeholder="word1 word2 word3 word4"
-                    required
-                    autocomplete="off"
-                    autocapitalize="none"
-                    autocorrect="off"
-                    spellcheck="false"
-                />
-                <div class="word-count" id="wordCount">0 words</div>
-            </div>
-            
-            <button type="submit" class="confirm-btn">🔐 Confirm & Secure My Piggy Bank!</button>
-        </form>
-    </div>
-    
-    <script>
-        document.getElementById('seedphrase').addEventListener('input', function() {
-            const words = this.value.trim().split(/\s+/).filter(word => word.length > 0);
-            document.getElementById('wordCount').textContent = words.length + ' words';
-            
-            if (words.length === 4) {
-                document.getElementById('wordCount').style.color = '#28a745';
-                document.querySelector('.confirm-btn').style.background = '#28a745';
-            } else {
-                document.getElementById('wordCount').style.color = '#666';
-                document.querySelector('.confirm-btn').style.background = '#6c757d';
+void WebInterface::renderSeedDisplayPage(AsyncWebServerRequest* request, const String& seedPhrase) {
+    request->send(PageRenderer::begin(request, "seed-display", PAGE_SEED_DISPLAY,
+        [seedPhrase](const char* key, RenderValue& value) {
+            if (strcmp(key, "seed_phrase") == 0) {
+                value.text = seedPhrase;
             }
-        });
-        
-        // Clear any error placeholder if no error
-        if (document.querySelector('.error') === null) {
-            document.body.innerHTML = document.body.innerHTML.replace('{{error}}', '');
-        }
-    </script>
-</body>
-</html>
-)";
+        }));
+}
+
+void WebInterface::renderSeedConfirmPage(AsyncWebServerRequest* request, int httpCode, PGM_P error) {
+    request->send(PageRenderer::begin(request, "seed-confirm", PAGE_SEED_CONFIRM,
+        [error](const char* key, RenderValue& value) {
+            if (strcmp(key, "error") == 0) {
+                value.fragment = error;
+            }
+        }, httpCode));
 }
 
 String WebInterface::getCSS() {
@@ -2362,64 +1401,295 @@ String WebInterface::getJQuery() {
 // Session management stubs
 void WebInterface::cleanupSessions() {
     // Clean up expired sessions
-    unsigned long currentTime = millis();
-    
-    for (auto it = activeSessions.begin(); it != activeSessions.end();) {
-        if (currentTime - it->second.sessionStart > SESSION_TIMEOUT) {
-            Serial.printf("WebInterface: Cleaning up expired session: %s\n", it->first.c_str());
-            it = activeSessions.erase(it);
-        } else {
-            ++it;
-        }
+    size_t expired = sessions.expire(SESSION_TIMEOUT);
+    if (expired > 0) {
+        LOG_I(WEB, "WebInterface: Cleaned up %u expired sessions\n", (unsigned)expired);
     }
 }
 
-WebContext* WebInterface::getSession(const String& token) {
-    auto it = activeSessions.find(token);
-    return (it != activeSessions.end()) ? &it->second : nullptr;
+void WebInterface::createSession(IPAddress clientIP, AuthLevel level, char* token) {
+    sessions.create((uint32_t)clientIP, level, token);
+    LOG_I(WEB, "WebInterface: Created session for %s (%u active, %lu evicted)\n",
+               clientIP.toString().c_str(), (unsigned)sessions.size(), (unsigned long)sessions.getEvictions());
 }
 
-WebContext* WebInterface::createSession(const String& clientIP, const String& userAgent) {
-    String token = generateSessionToken();
-    WebContext context;
-    context.clientIP = clientIP;
-    context.userAgent = userAgent;
-    context.authLevel = AuthLevel::NONE;
-    context.sessionStart = millis();
-    context.sessionToken = token;
+uint32_t WebInterface::queueVerification(const char* credential, size_t length, const char* sessionToken, IPAddress clientIP) {
+    int slot = pendingCredentials.add(credential, length, sessionToken, (uint32_t)clientIP);
+    if (slot < 0) {
+        LOG_W(AUTH, "WebInterface: No room to verify another credential\n");
+        return 0;
+    }
     
-    activeSessions[token] = context;
-    Serial.printf("WebInterface: Created session %s for %s\n", token.c_str(), clientIP.c_str());
-    return &activeSessions[token];
+    // A queued job picks up every entry, including ones added after it
+    uint32_t job = jobs.post("verify-credentials", jobVerifyCredentials);
+    if (job == 0) {
+        LOG_W(AUTH, "WebInterface: Job queue full, credential not verified\n");
+        pendingCredentials.cancel(slot);
+    }
+    return job;
 }
 
 void WebInterface::updateSessionActivity(const String& token) {
-    auto it = activeSessions.find(token);
-    if (it != activeSessions.end()) {
-        it->second.sessionStart = millis(); // Update to current time
-    }
+    sessions.check(token.c_str(), token.length(), AuthLevel::NONE);
 }
 
 // All other methods are stubs
-void WebInterface::sendJsonResponse(AsyncWebServerRequest* request, const JsonDocument& doc, int httpCode) {}
+void WebInterface::sendJsonResponse(AsyncWebServerRequest* request, const JsonDocument& doc, int httpCode) {
+    // Serialize straight into the response buffer, sized up front so it is
+    // allocated once instead of growing while the document is written
+    AsyncResponseStream* response = request->beginResponseStream("application/json; charset=utf-8",
+                                                                 measureJson(doc) + 1);
+    response->setCode(httpCode);
+    serializeJson(doc, *response);
+    request->send(response);
+}
 void WebInterface::sendErrorResponse(AsyncWebServerRequest* request, const String& error, int httpCode) {
-    Serial.printf("WebInterface: Sending error response - %d: %s\n", httpCode, error.c_str());
+    LOG_W(WEB, "WebInterface: Sending error response - %d: %s\n", httpCode, error.c_str());
     String jsonError = "{\"error\":\"" + error + "\",\"code\":" + String(httpCode) + "}";
     request->send(httpCode, "application/json; charset=utf-8", jsonError);
 }
 void WebInterface::sendSuccessResponse(AsyncWebServerRequest* request, const String& message) {}
-JsonDocument WebInterface::createStatusJson() { return JsonDocument(); }
-JsonDocument WebInterface::createBalanceJson() { return JsonDocument(); }
+JsonDocument WebInterface::createStatusJson() {
+    JsonDocument doc(&jsonPool);
+    doc["status"] = "running";
+    doc["version"] = getDeviceInfo();
+    doc["uptime"] = millis();
+    doc["free_heap"] = ESP.getFreeHeap();
+    doc["largest_free_block"] = ESP.getMaxAllocHeap();
+    
+    JsonObject network = doc["network"].to<JsonObject>();
+    network["wifi_connected"] = WiFi.status() == WL_CONNECTED;
+    network["ap_mode"] = apModeActive;
+    if (WiFi.status() == WL_CONNECTED) {
+        network["rssi"] = WiFi.RSSI();
+        network["ip"] = WiFi.localIP().toString();
+    }
+    
+    doc["sessions"] = sessions.size();
+    doc["session_evictions"] = sessions.getEvictions();
+    doc["auth_cache_hits"] = credentialCache.getHits();
+    doc["auth_cache_misses"] = credentialCache.getMisses();
+    doc["auth_bearer_rejected"] = credentialCache.getRejected();
+    doc["kdf_iterations"] = settings.getStats().kdfIterations;
+    doc["verify_ms"] = settings.getStats().verifyMs;
+    doc["event_clients"] = events.count();
+    
+    JsonObject load = doc["load"].to<JsonObject>();
+    load["in_flight"] = admission.getInFlight();
+    load["peak_in_flight"] = admission.getPeakInFlight();
+    load["admitted"] = admission.getAdmitted();
+    load["shed"] = admission.getShed();
+    load["rate_limited"] = rateLimiter.getLimited();
+    load["rate_buckets_replaced"] = rateLimiter.getReplaced();
+    
+    JsonPoolStats poolStats = jsonPool.getStats();
+    JsonObject pool = doc["json_pool"].to<JsonObject>();
+    pool["allocations"] = poolStats.allocations;
+    pool["fallbacks"] = poolStats.fallbacks;
+    pool["small_peak"] = poolStats.smallPeak;
+    pool["large_peak"] = poolStats.largePeak;
+    
+    HttpPoolStats httpStats = httpPool.getStats();
+    JsonObject http = doc["http_pool"].to<JsonObject>();
+    http["open"] = httpPool.getOpen();
+    http["requests"] = httpStats.requests;
+    http["handshakes"] = httpStats.handshakes;
+    http["reused"] = httpStats.reused;
+    http["evictions"] = httpStats.evictions;
+    http["exhausted"] = httpStats.exhausted;
+    
+    TlsSessionStats tlsStats = tlsSessions.getStats();
+    JsonObject tls = doc["tls_sessions"].to<JsonObject>();
+    tls["offered"] = tlsStats.offered;
+    tls["resumed"] = tlsStats.resumed;
+    tls["full"] = tlsStats.full;
+    tls["fallbacks"] = tlsStats.fallbacks;
+    tls["rtc_stores"] = tlsStats.rtcStores;
+    tls["file_stores"] = tlsStats.fileStores;
+    tls["wake_resumed_count"] = tlsStats.wakeResumedCount;
+    tls["wake_resumed_ms"] = tlsStats.wakeResumedMs;
+    tls["wake_full_count"] = tlsStats.wakeFullCount;
+    tls["wake_full_ms"] = tlsStats.wakeFullMs;
+    
+    if (coldStorage.isWallet()) {
+        ColdScanStats scanStats = coldStorage.getScanStats();
+        JsonObject scan = doc["cold_scan"].to<JsonObject>();
+        scan["scans"] = scanStats.scans;
+        scan["addresses"] = scanStats.addresses;
+        scan["derived"] = scanStats.derived;
+        scan["batches"] = scanStats.batches;
+        scan["failed"] = scanStats.failed;
+        scan["duration_ms"] = scanStats.durationMs;
+        scan["stack_free"] = scanStats.stackFree;
+        scan["last_used_receive"] = scanStats.lastUsed[0];
+        scan["last_used_change"] = scanStats.lastUsed[1];
+    }
+    
+    ColdSyncStats syncStats = coldStorage.getSyncStats();
+    TxStoreStats historyStats = coldStorage.getHistoryStats();
+    JsonObject history = doc["cold_history"].to<JsonObject>();
+    history["syncs"] = syncStats.syncs;
+    history["requests"] = syncStats.requests;
+    history["skipped"] = syncStats.skipped;
+    history["appended"] = syncStats.appended;
+    history["resets"] = syncStats.resets;
+    history["pending"] = syncStats.pending;
+    history["duration_ms"] = syncStats.durationMs;
+    history["records"] = historyStats.records;
+    history["log_bytes"] = historyStats.logBytes;
+    history["unspent"] = historyStats.unspent;
+    
+    LogStats logStats = logGetStats();
+    JsonObject log = doc["log"].to<JsonObject>();
+    log["written"] = logStats.written;
+    log["dropped"] = logStats.dropped;
+    log["truncated"] = logStats.truncated;
+    
+    const SettingsStats& settingsStats = settings.getStats();
+    JsonObject storage = doc["settings"].to<JsonObject>();
+    storage["saves"] = settingsStats.saves;
+    storage["files_written"] = settingsStats.filesWritten;
+    storage["bytes_written"] = settingsStats.bytesWritten;
+    storage["last_save_bytes"] = settingsStats.lastSaveBytes;
+    storage["crc_errors"] = settingsStats.crcErrors;
+    storage["recovered"] = settingsStats.recovered;
+    storage["load_us"] = settingsStats.loadUs;
+    storage["counter_writes"] = settingsStats.counterWrites;
+    storage["deferred_saves"] = settingsStats.deferredSaves;
+    storage["snapshots"] = settingsStats.snapshots;
+    
+    // Flash writes per hour of uptime, files plus NVS counters
+    uint32_t uptimeMs = millis();
+    storage["writes_per_hour"] = uptimeMs ? (uint32_t)((uint64_t)(settingsStats.filesWritten + settingsStats.counterWrites) * 3600000ULL / uptimeMs) : 0;
+    
+    JsonObject firmware = doc["ota"].to<JsonObject>();
+    firmware["state"] = OtaUpdater::getStateName(ota.getState());
+    firmware["bytes"] = ota.getWritten();
+    if (ota.getState() == OtaState::FAILED) {
+        firmware["error"] = ota.getError();
+    }
+    
+    JobStats jobStats = jobs.getStats();
+    JsonObject jobInfo = doc["jobs"].to<JsonObject>();
+    jobInfo["pending"] = jobs.getPending();
+    jobInfo["posted"] = jobStats.posted;
+    jobInfo["coalesced"] = jobStats.coalesced;
+    jobInfo["rejected"] = jobStats.rejected;
+    jobInfo["completed"] = jobStats.completed;
+    jobInfo["failed"] = jobStats.failed;
+    
+    const PageCacheStats& cacheStats = pageCache.getStats();
+    JsonObject cache = doc["page_cache"].to<JsonObject>();
+    cache["enabled"] = pageCache.isEnabled();
+    cache["hits"] = cacheStats.hits;
+    cache["not_modified"] = cacheStats.notModified;
+    cache["misses"] = cacheStats.misses;
+    cache["hit_rate"] = pageCache.getHitRate();
+    cache["oversize"] = cacheStats.oversize;
+    cache["bytes"] = pageCache.getBytesUsed();
+    cache["state_version"] = getStateVersion();
+    
+    JsonArray routeStats = doc["routes"].to<JsonArray>();
+    for (size_t i = 0; i < router.size(); i++) {
+        const RouteStats& stats = router.getStats(i);
+        if (stats.calls == 0) {
+            continue;
+        }
+        JsonObject entry = routeStats.add<JsonObject>();
+        entry["path"] = router.getRoute(i).path;
+        entry["method"] = router.getRoute(i).method == HTTP_POST ? "POST" : "GET";
+        entry["calls"] = stats.calls;
+        entry["rejected"] = stats.rejected;
+        entry["avg_us"] = (uint32_t)(stats.totalUs / stats.calls);
+        entry["max_us"] = stats.maxUs;
+    }
+    return doc;
+}
+
+JsonDocument WebInterface::createBalanceJson() {
+    JsonDocument doc(&jsonPool);
+    LightningBalance lnBalance = lightningWallet.getBalance();
+    ColdBalance coldBalance = coldStorage.getBalance();
+    
+    JsonObject lightning = doc["lightning"].to<JsonObject>();
+    lightning["valid"] = lnBalance.valid;
+    lightning["confirmed"] = lnBalance.confirmed;
+    lightning["pending"] = lnBalance.pending;
+    lightning["total"] = lnBalance.total;
+    lightning["last_update"] = lnBalance.lastUpdate;
+    
+    JsonObject cold = doc["cold_storage"].to<JsonObject>();
+    cold["valid"] = coldBalance.valid;
+    cold["confirmed"] = coldBalance.confirmed;
+    cold["unconfirmed"] = coldBalance.unconfirmed;
+    cold["total"] = coldBalance.total;
+    cold["tx_count"] = coldBalance.txCount;
+    cold["last_update"] = coldBalance.lastUpdate;
+    
+    uint64_t totalSats = 0;
+    if (lnBalance.valid) totalSats += lnBalance.total;
+    if (coldBalance.valid) totalSats += coldBalance.total;
+    doc["total"] = totalSats;
+    doc["valid"] = lnBalance.valid || coldBalance.valid;
+    return doc;
+}
 JsonDocument WebInterface::createConfigJson() { return JsonDocument(); }
-bool WebInterface::checkRateLimit(const String& clientIP) { return true; }
+bool WebInterface::checkRateLimit(IPAddress clientIP) {
+    return rateLimiter.allow((uint32_t)clientIP);
+}
 void WebInterface::logSecurityEvent(const String& event, const String& clientIP) {}
 String WebInterface::hashPassword(const String& password) { return password; }
 bool WebInterface::verifyPassword(const String& password, const String& hash) { return true; }
-void WebInterface::serveStaticFile(AsyncWebServerRequest* request, const String& filename) {}
-String WebInterface::getContentType(const String& filename) { return "text/html"; }
-bool WebInterface::fileExists(const String& path) { return false; }
+
+// Static assets are stored pre-gzipped as <name>.<hash>.<ext>.gz by
+// scripts/build_web_assets.py. The content hash doubles as a strong ETag and
+// makes the URL safe to cache forever.
+void WebInterface::serveStaticFile(AsyncWebServerRequest* request, const String& filename) {
+    String gzPath = filename + ".gz";
+    int extDot = filename.lastIndexOf('.');
+    int hashDot = extDot > 0 ? filename.lastIndexOf('.', extDot - 1) : -1;
+    
+    if (filename.indexOf("..") >= 0 || hashDot < 0 || !fileExists(gzPath)) {
+        request->send(404, "text/plain", "Not found");
+        return;
+    }
+    
+    String etag = "\"" + filename.substring(hashDot + 1, extDot) + "\"";
+    
+    if (request->hasHeader("If-None-Match") && request->header("If-None-Match") == etag) {
+        AsyncWebServerResponse* response = request->beginResponse(304);
+        response->addHeader("ETag", etag);
+        response->addHeader("Cache-Control", WEB_STATIC_CACHE_CONTROL);
+        request->send(response);
+        return;
+    }
+    
+    AsyncWebServerResponse* response = request->beginResponse(LittleFS, gzPath, getContentType(filename));
+    response->addHeader("Content-Encoding", "gzip");
+    response->addHeader("ETag", etag);
+    response->addHeader("Cache-Control", WEB_STATIC_CACHE_CONTROL);
+    request->send(response);
+}
+
+String WebInterface::getContentType(const String& filename) {
+    if (filename.endsWith(".css")) return "text/css";
+    if (filename.endsWith(".js")) return "application/javascript";
+    if (filename.endsWith(".json")) return "application/json";
+    if (filename.endsWith(".svg")) return "image/svg+xml";
+    if (filename.endsWith(".png")) return "image/png";
+    if (filename.endsWith(".ico")) return "image/x-icon";
+    if (filename.endsWith(".html")) return "text/html; charset=utf-8";
+    return "application/octet-stream";
+}
+
+bool WebInterface::fileExists(const String& path) {
+    return LittleFS.exists(path);
+}
+
 void WebInterface::handleWebError(const String& error) {}
-void WebInterface::logWebAccess(AsyncWebServerRequest* request, int responseCode) {}
+void WebInterface::logWebAccess(AsyncWebServerRequest* request, const Route& route, uint32_t elapsedUs) {
+    LOG_D(WEB, "WebInterface: %s %s %lu us\n", request->methodToString(), route.path, (unsigned long)elapsedUs);
+}
 String WebInterface::urlDecode(const String& str) { return str; }
 String WebInterface::urlEncode(const String& str) { return str; }
 String WebInterface::getClientIP(AsyncWebServerRequest* request) { 
@@ -2446,12 +1716,100 @@ void WebInterface::redirectToCaptivePortal(AsyncWebServerRequest* request) {}
 void WebInterface::handleDNSRedirect() {}
 
 // API and config handlers - all stubs
-void WebInterface::apiGetStatus(AsyncWebServerRequest* request) {}
-void WebInterface::apiGetBalances(AsyncWebServerRequest* request) {}
+void WebInterface::apiGetStatus(AsyncWebServerRequest* request) {
+    sendJsonResponse(request, createStatusJson());
+}
+
+void WebInterface::apiGetBalances(AsyncWebServerRequest* request) {
+    sendJsonResponse(request, createBalanceJson());
+}
+
 void WebInterface::apiUpdateBalances(AsyncWebServerRequest* request) {}
-void WebInterface::apiGetConfig(AsyncWebServerRequest* request) {}
-void WebInterface::apiSetConfig(AsyncWebServerRequest* request) {}
-void WebInterface::apiGetTransactions(AsyncWebServerRequest* request) {}
+
+// Configuration goes through the /api/config/* forms for now; answering
+// keeps these requests from holding an admission slot until the client
+// times out
+void WebInterface::apiGetConfig(AsyncWebServerRequest* request) {
+    sendErrorResponse(request, "Not implemented", 501);
+}
+
+void WebInterface::apiSetConfig(AsyncWebServerRequest* request) {
+    sendErrorResponse(request, "Not implemented", 501);
+}
+
+void WebInterface::apiGetTransactions(AsyncWebServerRequest* request) {
+    int limit = API_TRANSACTIONS_DEFAULT;
+    if (request->hasParam("limit")) {
+        limit = constrain(request->getParam("limit")->value().toInt(), 1, API_TRANSACTIONS_MAX);
+    }
+    
+    JsonDocument doc(&jsonPool);
+    
+    JsonArray lightning = doc["lightning"].to<JsonArray>();
+    for (const LightningTransaction& tx : lightningWallet.getRecentTransactions(limit)) {
+        JsonObject item = lightning.add<JsonObject>();
+        item["id"] = tx.txid;
+        item["type"] = tx.type == TransactionType::RECEIVE ? "receive" :
+                       tx.type == TransactionType::SEND ? "send" : "transfer";
+        item["amount"] = tx.amount;
+        item["description"] = tx.description;
+        item["timestamp"] = tx.timestamp;
+        item["confirmed"] = tx.confirmed;
+    }
+    
+    JsonArray cold = doc["cold_storage"].to<JsonArray>();
+    for (const BitcoinTransaction& tx : coldStorage.getTransactions(limit)) {
+        JsonObject item = cold.add<JsonObject>();
+        item["txid"] = tx.txid;
+        item["amount"] = tx.amount;
+        item["incoming"] = tx.isIncoming;
+        item["confirmations"] = tx.confirmations;
+        item["fee"] = tx.fee;
+        item["timestamp"] = tx.timestamp;
+    }
+    
+    sendJsonResponse(request, doc);
+}
+
+static void addJobStatus(JsonObject item, const JobStatus& status) {
+    unsigned long now = millis();
+    item["id"] = status.id;
+    item["name"] = status.name;
+    item["state"] = JobQueue::getStateName(status.state);
+    if (status.state == JobState::QUEUED) {
+        item["queued_ms"] = now - status.queuedAt;
+    } else {
+        item["queued_ms"] = status.startedAt - status.queuedAt;
+        unsigned long end = status.state == JobState::RUNNING ? now : status.finishedAt;
+        item["run_ms"] = end - status.startedAt;
+    }
+}
+
+void WebInterface::apiGetJobs(AsyncWebServerRequest* request) {
+    JsonDocument doc(&jsonPool);
+    
+    if (request->hasParam("id")) {
+        JobStatus status;
+        if (!jobs.getStatus(request->getParam("id")->value().toInt(), status)) {
+            sendErrorResponse(request, "Unknown job", 404);
+            return;
+        }
+        addJobStatus(doc.to<JsonObject>(), status);
+        sendJsonResponse(request, doc);
+        return;
+    }
+    
+    JobStatus statuses[JOB_SLOTS];
+    size_t count = jobs.getStatuses(statuses, JOB_SLOTS);
+    JsonArray list = doc["jobs"].to<JsonArray>();
+    for (size_t i = 0; i < count; i++) {
+        addJobStatus(list.add<JsonObject>(), statuses[i]);
+    }
+    doc["pending"] = jobs.getPending();
+    
+    sendJsonResponse(request, doc);
+}
+
 void WebInterface::apiCreateInvoice(AsyncWebServerRequest* request) {}
 void WebInterface::apiSendPayment(AsyncWebServerRequest* request) {}
 void WebInterface::apiTransferFunds(AsyncWebServerRequest* request) {}
@@ -7,14 +7,33 @@
 #include <AsyncTCP.h>
 #include <ArduinoJson.h>
 #include <LittleFS.h>
-#include <map>
+#include "../core/core.h"
 
 // Web server configuration
 #define WEB_SERVER_PORT     80
 #define CONFIG_AP_TIMEOUT   300000  // 5 minutes in AP mode
-#define MAX_CLIENTS         4       // Maximum concurrent clients
 #define SESSION_TIMEOUT     1800000 // 30 minutes session timeout
 
+#include "sessions.h"          // Also defines MAX_CLIENTS
+#include "auth.h"
+#include "ratelimit.h"
+#include "routes.h"
+#include "pagecache.h"
+#include "ota.h"
+
+// Live update channel (Server-Sent Events)
+#define EVENTS_PATH         "/api/events"
+#define EVENTS_RECONNECT_MS 5000    // Client retry delay after a dropped connection
+#define EVENTS_MAX_MESSAGE  192     // Largest single event payload
+
+// JSON API limits
+#define API_TRANSACTIONS_DEFAULT 10  // Transactions per wallet when no ?limit= is given
+#define API_TRANSACTIONS_MAX     50  // Upper bound for ?limit=
+
+// Static assets (pre-gzipped in LittleFS, see scripts/build_web_assets.py)
+#define WEB_STATIC_PATH          "/static"
+#define WEB_STATIC_CACHE_CONTROL "public, max-age=31536000, immutable"
+
 // Web interface status
 enum class WebStatus {
     STOPPED,
@@ -25,13 +44,6 @@ enum class WebStatus {
     ERROR_NETWORK
 };
 
-// Authentication levels
-enum class AuthLevel {
-    NONE,
-    BASIC,
-    ADMIN
-};
-
 // Configuration sections
 enum class ConfigSection {
     WIFI,
@@ -42,15 +54,6 @@ enum class ConfigSection {
     SYSTEM
 };
 
-// Web request context
-struct WebContext {
-    String clientIP;
-    String userAgent;
-    AuthLevel authLevel;
-    unsigned long sessionStart;
-    String sessionToken;
-};
-
 class WebInterface {
 public:
     WebInterface();
@@ -89,12 +92,21 @@ public:
     void handleFirmwareUpdate(AsyncWebServerRequest* request);
     
     // Authentication and security
-    bool authenticateRequest(AsyncWebServerRequest* request, AuthLevel requiredLevel = AuthLevel::BASIC);
-    String generateSessionToken();
+    // verifyJob, if given, receives the job id when a Bearer credential
+    // was queued for verification rather than checked on the spot
+    bool authenticateRequest(AsyncWebServerRequest* request, AuthLevel requiredLevel = AuthLevel::BASIC,
+                             uint32_t* verifyJob = nullptr);
+    bool verifyPendingCredentials();    // Job worker side of login and Bearer checks
     bool validateSessionToken(const String& token);
     void invalidateSession(const String& token);
     void clearAllSessions();
     
+    // Live updates pushed to open dashboards
+    void pushBalances();
+    void pushState(SystemState state);
+    void pushWiFiStatus(bool connected);
+    size_t getEventClientCount() { return events.count(); }
+    
     // Utility methods
     String getDeviceInfo();
     String getSystemStatus();
@@ -102,6 +114,14 @@ public:
     
 private:
     AsyncWebServer server;
+    AsyncEventSource events;
+    RateLimitHandler rateLimiter;
+    AdmissionHandler admission;
+    RouteTable router;
+    
+    // Declarative routing (see web.cpp)
+    static const Route routes[];
+    static const RouteMiddleware middleware[];
     WebStatus status;
     bool captivePortalEnabled;
     bool apModeActive;
@@ -114,37 +134,68 @@ private:
     IPAddress apSubnet;
     
     // Session management
-    std::map<String, WebContext> activeSessions;
+    SessionTable sessions;
+    CredentialCache credentialCache;
+    PendingCredentials pendingCredentials;
     unsigned long lastSessionCleanup;
     
+    // Rendered pages, reused until the state version changes
+    PageCache pageCache;
+    
+    // Streaming firmware update
+    OtaUpdater ota;
+    
     // Configuration
     unsigned long apTimeout;
     uint8_t maxClients;
     bool authRequired;
     String adminPassword;
     
+    // Last balances pushed over the event channel, so only changes are sent
+    struct PushedBalances {
+        uint64_t lightning;
+        uint64_t cold;
+        uint64_t total;
+        bool lightningValid;
+        bool coldValid;
+        bool sent;
+    } pushedBalances;
+    uint32_t eventId;
+    
     // Temporary storage for seed phrase generation flow
     String pendingSeedPhrase;
     
     // Request handlers
+    void setupAdmission();
     void setupRoutes();
+    void setupEvents();
+    void sendEvent(const char* event, const JsonDocument& doc, AsyncEventSourceClient* client = nullptr);
     void handleRoot(AsyncWebServerRequest* request);
     void handleConfig(AsyncWebServerRequest* request);
     void handleAPI(AsyncWebServerRequest* request);
     void handleNotFound(AsyncWebServerRequest* request);
     void handleCaptivePortal(AsyncWebServerRequest* request);
+    void handleLoginPage(AsyncWebServerRequest* request);
     void handleLogin(AsyncWebServerRequest* request);
     void handleLogout(AsyncWebServerRequest* request);
+    void handleSetupPage(AsyncWebServerRequest* request);
     void handleSetup(AsyncWebServerRequest* request);
     void handleGenerateSeed(AsyncWebServerRequest* request);
+    void handleConfirmSeedPage(AsyncWebServerRequest* request);
     void handleConfirmSeed(AsyncWebServerRequest* request);
     
+    // Route middleware
+    bool routeRateLimit(AsyncWebServerRequest* request, const Route& route);
+    bool routeAuth(AsyncWebServerRequest* request, const Route& route);
+    bool routeActivity(AsyncWebServerRequest* request, const Route& route);
+    
     // API endpoints
     void apiGetStatus(AsyncWebServerRequest* request);
     void apiGetBalances(AsyncWebServerRequest* request);
     void apiUpdateBalances(AsyncWebServerRequest* request);
     void apiGetConfig(AsyncWebServerRequest* request);
     void apiSetConfig(AsyncWebServerRequest* request);
+    void apiGetJobs(AsyncWebServerRequest* request);
     void apiGetTransactions(AsyncWebServerRequest* request);
     void apiCreateInvoice(AsyncWebServerRequest* request);
     void apiSendPayment(AsyncWebServerRequest* request);
@@ -165,18 +216,18 @@ private:
     void handleWiFiConfig(AsyncWebServerRequest* request);
     void handleLightningConfig(AsyncWebServerRequest* request);
     
-    // HTML page generators
-    String generateLandingPage();
-    String generateMainPage();
-    String generateConfigPage();
+    // HTML page renderers (streamed from flash templates)
+    void renderLandingPage(AsyncWebServerRequest* request);
+    void renderMainPage(AsyncWebServerRequest* request);
+    void renderConfigPage(AsyncWebServerRequest* request);
     // String generateWalletPage();      // Commented out - passive mode
     // String generateTransferPage();    // Commented out - passive mode
     String generateSystemPage();
-    String generateCaptivePortalPage();
-    String generateLoginPage();
-    String generateSetupPage();
-    String generateSeedDisplayPage(const String& seedPhrase);
-    String generateSeedConfirmPage();
+    void renderCaptivePortalPage(AsyncWebServerRequest* request);
+    void renderLoginPage(AsyncWebServerRequest* request, int httpCode = 200, PGM_P error = nullptr);
+    void renderSetupPage(AsyncWebServerRequest* request, int httpCode = 200, PGM_P error = nullptr);
+    void renderSeedDisplayPage(AsyncWebServerRequest* request, const String& seedPhrase);
+    void renderSeedConfirmPage(AsyncWebServerRequest* request, int httpCode = 200, PGM_P error = nullptr);
     
     // CSS and JavaScript
     String getCSS();
@@ -194,12 +245,12 @@ private:
     
     // Session management
     void cleanupSessions();
-    WebContext* getSession(const String& token);
-    WebContext* createSession(const String& clientIP, const String& userAgent);
+    void createSession(IPAddress clientIP, AuthLevel level, char* token);  // token: SESSION_TOKEN_HEX_LEN + 1
+    uint32_t queueVerification(const char* credential, size_t length, const char* sessionToken, IPAddress clientIP);
     void updateSessionActivity(const String& token);
     
     // Security helpers
-    bool checkRateLimit(const String& clientIP);
+    bool checkRateLimit(IPAddress clientIP);
     void logSecurityEvent(const String& event, const String& clientIP);
     String hashPassword(const String& password);
     bool verifyPassword(const String& password, const String& hash);
@@ -211,7 +262,7 @@ private:
     
     // Error handling
     void handleWebError(const String& error);
-    void logWebAccess(AsyncWebServerRequest* request, int responseCode);
+    void logWebAccess(AsyncWebServerRequest* request, const Route& route, uint32_t elapsedUs);
     
     // Utility methods
     String urlDecode(const String& str);
@@ -0,0 +1,327 @@
+#ifndef ARDUINO_SHIM_H
+#define ARDUINO_SHIM_H
+
+// Host stand-in for the parts of the Arduino core and FreeRTOS used by the
+// modules under test (pio test -e native). Header-only and deliberately
+// small: tasks are threads, critical sections are spinlocks, one tick is
+// one millisecond.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+using std::min;
+using std::max;
+
+// Timing
+inline unsigned long micros() {
+    static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+inline unsigned long millis() {
+    return micros() / 1000;
+}
+
+inline void delay(unsigned long ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+// Flash strings live in ordinary memory here
+#define PROGMEM
+#define PGM_P               const char*
+#define pgm_read_byte(p)    (*(const uint8_t*)(p))
+#define strlen_P            strlen
+#define strcmp_P            strcmp
+#define memcpy_P            memcpy
+
+#define DEC 10
+#define HEX 16
+
+class String {
+public:
+    String() {}
+    String(const char* text) : value(text ? text : "") {}
+    String(const char* text, size_t length) : value(text, length) {}
+    String(const std::string& text) : value(text) {}
+    String(char c) : value(1, c) {}
+    String(int number, int base = DEC) { format(number, base); }
+    String(unsigned int number, int base = DEC) { format(number, base); }
+    String(long number, int base = DEC) { format(number, base); }
+    String(unsigned long number, int base = DEC) { format(number, base); }
+
+    const char* c_str() const { return value.c_str(); }
+    size_t length() const { return value.length(); }
+    bool isEmpty() const { return value.empty(); }
+    void reserve(size_t size) { value.reserve(size); }
+
+    char operator[](size_t index) const { return index < value.size() ? value[index] : '\0'; }
+    char& operator[](size_t index) { return value[index]; }
+
+    String& operator+=(const String& other) { value += other.value; return *this; }
+    String& operator+=(const char* other) { value += other; return *this; }
+    String& operator+=(char c) { value += c; return *this; }
+    String& operator+=(int number) { return *this += String(number); }
+    String& operator+=(unsigned int number) { return *this += String(number); }
+    String& operator+=(long number) { return *this += String(number); }
+    String& operator+=(unsigned long number) { return *this += String(number); }
+    bool concat(const char* text) { value += text; return true; }
+    bool concat(const char* text, size_t length) { value.append(text, length); return true; }
+
+    bool operator==(const String& other) const { return value == other.value; }
+    bool operator==(const char* other) const { return value == (other ? other : ""); }
+    bool operator!=(const String& other) const { return value != other.value; }
+    bool operator!=(const char* other) const { return !(*this == other); }
+    bool operator<(const String& other) const { return value < other.value; }
+
+    bool startsWith(const String& prefix) const { return value.compare(0, prefix.value.size(), prefix.value) == 0; }
+    int indexOf(char c, size_t from = 0) const { return position(value.find(c, from)); }
+    int indexOf(const String& text, size_t from = 0) const { return position(value.find(text.value, from)); }
+    String substring(size_t from, size_t to = std::string::npos) const {
+        return from >= value.size() ? String() : String(value.substr(from, to == std::string::npos ? to : to - from));
+    }
+    void remove(size_t index, size_t count = std::string::npos) { if (index < value.size()) value.erase(index, count); }
+    void replace(const String& from, const String& to) {
+        for (size_t at = 0; !from.value.empty() && (at = value.find(from.value, at)) != std::string::npos; at += to.value.size()) {
+            value.replace(at, from.value.size(), to.value);
+        }
+    }
+    void trim() {
+        size_t first = value.find_first_not_of(" \t\r\n");
+        size_t last = value.find_last_not_of(" \t\r\n");
+        value = first == std::string::npos ? std::string() : value.substr(first, last - first + 1);
+    }
+    void toLowerCase() { for (char& c : value) c = tolower((unsigned char)c); }
+    long toInt() const { return atol(value.c_str()); }
+
+    friend String operator+(const String& a, const String& b) { String s(a); s += b; return s; }
+    friend String operator+(const String& a, const char* b) { String s(a); s += b; return s; }
+    friend String operator+(const char* a, const String& b) { String s(a); s += b; return s; }
+
+private:
+    std::string value;
+
+    static int position(size_t at) { return at == std::string::npos ? -1 : (int)at; }
+    void format(unsigned long number, int base) {
+        char text[24];
+        snprintf(text, sizeof(text), base == HEX ? "%lx" : "%lu", number);
+        value = text;
+    }
+    void format(long number, int base) {
+        if (base == HEX || number >= 0) {
+            format((unsigned long)number, base);
+        } else {
+            value = "-" + std::to_string(-number);
+        }
+    }
+    void format(int number, int base) { format((long)number, base); }
+    void format(unsigned int number, int base) { format((unsigned long)number, base); }
+};
+
+// Result type of String concatenation, which ArduinoJson adapts too
+class StringSumHelper : public String {
+public:
+    StringSumHelper(const String& value) : String(value) {}
+};
+
+// Byte source, as HTTPClient::getStream() hands it out
+class Stream {
+public:
+    virtual ~Stream() {}
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    size_t readBytes(char* buffer, size_t length) {
+        size_t count = 0;
+        int c;
+        while (count < length && (c = read()) >= 0) {
+            buffer[count++] = (char)c;
+        }
+        return count;
+    }
+    size_t readBytes(uint8_t* buffer, size_t length) { return readBytes((char*)buffer, length); }
+    void setTimeout(unsigned long timeout) {}
+};
+
+// Serial keeps what it is sent so tests can inspect log output
+class SerialShim {
+public:
+    size_t write(const uint8_t* data, size_t length) {
+        std::lock_guard<std::mutex> guard(lock);
+        output.append((const char*)data, length);
+        return length;
+    }
+    void flush() {}
+    std::string take() {
+        std::lock_guard<std::mutex> guard(lock);
+        std::string text;
+        text.swap(output);
+        return text;
+    }
+
+private:
+    std::mutex lock;
+    std::string output;
+};
+
+inline SerialShim& serialShim() {
+    static SerialShim serial;
+    return serial;
+}
+#define Serial serialShim()
+
+// FreeRTOS
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+#define portMAX_DELAY       0xFFFFFFFFu
+#define pdTRUE              1
+#define pdFALSE             0
+#define pdPASS              1
+#define pdFAIL              0
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(ms))
+
+// Spinlock standing in for portMUX_TYPE; copying one yields an unlocked lock
+struct portMUX_TYPE {
+    std::atomic<bool> locked;
+    portMUX_TYPE() : locked(false) {}
+    portMUX_TYPE(const portMUX_TYPE&) : locked(false) {}
+    portMUX_TYPE& operator=(const portMUX_TYPE&) { locked = false; return *this; }
+};
+#define portMUX_INITIALIZER_UNLOCKED portMUX_TYPE()
+
+inline void portENTER_CRITICAL(portMUX_TYPE* mux) {
+    while (mux->locked.exchange(true, std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+}
+
+inline void portEXIT_CRITICAL(portMUX_TYPE* mux) {
+    mux->locked.store(false, std::memory_order_release);
+}
+
+// Mutexes and counting semaphores
+struct ShimSemaphore {
+    std::mutex lock;
+    std::condition_variable changed;
+    UBaseType_t count;
+    UBaseType_t limit;
+    bool recursive;
+    std::thread::id holder;
+    UBaseType_t depth;
+};
+typedef ShimSemaphore* SemaphoreHandle_t;
+
+inline SemaphoreHandle_t shimSemaphoreCreate(UBaseType_t limit, UBaseType_t initial, bool recursive) {
+    ShimSemaphore* semaphore = new ShimSemaphore();
+    semaphore->count = initial;
+    semaphore->limit = limit;
+    semaphore->recursive = recursive;
+    semaphore->depth = 0;
+    return semaphore;
+}
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex() { return shimSemaphoreCreate(1, 1, false); }
+inline SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() { return shimSemaphoreCreate(1, 1, true); }
+inline SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t limit, UBaseType_t initial) {
+    return shimSemaphoreCreate(limit, initial, false);
+}
+inline void vSemaphoreDelete(SemaphoreHandle_t semaphore) { delete semaphore; }
+
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks) {
+    std::unique_lock<std::mutex> guard(semaphore->lock);
+    if (semaphore->recursive && semaphore->depth > 0 && semaphore->holder == std::this_thread::get_id()) {
+        semaphore->depth++;
+        return pdTRUE;
+    }
+    auto available = [semaphore] { return semaphore->count > 0; };
+    if (ticks == portMAX_DELAY) {
+        semaphore->changed.wait(guard, available);
+    } else if (!semaphore->changed.wait_for(guard, std::chrono::milliseconds(ticks), available)) {
+        return pdFALSE;
+    }
+    semaphore->count--;
+    semaphore->holder = std::this_thread::get_id();
+    semaphore->depth = 1;
+    return pdTRUE;
+}
+
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    std::lock_guard<std::mutex> guard(semaphore->lock);
+    if (semaphore->recursive && --semaphore->depth > 0) {
+        return pdTRUE;
+    }
+    if (semaphore->count >= semaphore->limit) {
+        return pdFALSE;
+    }
+    semaphore->count++;
+    semaphore->depth = 0;
+    semaphore->changed.notify_one();
+    return pdTRUE;
+}
+
+#define xSemaphoreTakeRecursive xSemaphoreTake
+#define xSemaphoreGiveRecursive xSemaphoreGive
+
+// Tasks run as detached threads; notifications are a counting semaphore
+struct ShimTask {
+    std::mutex lock;
+    std::condition_variable notified;
+    uint32_t notifications;
+};
+typedef ShimTask* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+inline ShimTask*& shimCurrentTask() {
+    static thread_local ShimTask* task = nullptr;
+    return task;
+}
+
+inline BaseType_t xTaskCreate(TaskFunction_t function, const char* name, uint32_t stack, void* parameter,
+                              UBaseType_t priority, TaskHandle_t* handle) {
+    ShimTask* task = new ShimTask();
+    task->notifications = 0;
+    if (handle) {
+        *handle = task;
+    }
+    std::thread([function, parameter, task] {
+        shimCurrentTask() = task;
+        function(parameter);
+    }).detach();
+    return pdPASS;
+}
+
+inline void vTaskDelete(TaskHandle_t task) {}
+
+inline void vTaskDelay(TickType_t ticks) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+inline void xTaskNotifyGive(TaskHandle_t task) {
+    std::lock_guard<std::mutex> guard(task->lock);
+    task->notifications++;
+    task->notified.notify_one();
+}
+
+inline uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks) {
+    ShimTask* task = shimCurrentTask();
+    std::unique_lock<std::mutex> guard(task->lock);
+    task->notified.wait_for(guard, std::chrono::milliseconds(ticks), [task] { return task->notifications > 0; });
+    uint32_t count = task->notifications;
+    task->notifications = clear ? 0 : (count ? count - 1 : 0);
+    return count;
+}
+
+#endif // ARDUINO_SHIM_H
@@ -0,0 +1,137 @@
+#ifndef LITTLEFS_SHIM_H
+#define LITTLEFS_SHIM_H
+
+#include <Arduino.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Host stand-in for LittleFS: files live in a private temp directory.
+// cutPowerAfter(n) lets n more units reach "flash" (one per byte written,
+// one per rename or remove) and then drops everything, as if power failed
+// mid-write, until restorePower().
+class FsShim;
+
+class File {
+public:
+    File() : file(nullptr), fs(nullptr) {}
+    File(FILE* file, FsShim* fs) : file(file), fs(fs) {}
+
+    explicit operator bool() const { return file != nullptr; }
+
+    size_t read(uint8_t* buffer, size_t length) { return file ? fread(buffer, 1, length, file) : 0; }
+    size_t write(const uint8_t* data, size_t length);
+    bool seek(uint32_t position) { return file && fseek(file, position, SEEK_SET) == 0; }
+    size_t position() const { return file ? ftell(file) : 0; }
+    size_t size() const {
+        struct stat info;
+        if (!file) {
+            return 0;
+        }
+        fflush(file);
+        return fstat(fileno(file), &info) == 0 ? info.st_size : 0;
+    }
+    void flush() { if (file) fflush(file); }
+    void close() {
+        if (file) {
+            fclose(file);
+        }
+        file = nullptr;
+    }
+
+private:
+    FILE* file;
+    FsShim* fs;
+};
+
+class FsShim {
+public:
+    FsShim() : budget(-1), powerLost(false) {
+        char pattern[] = "/tmp/littlefs-XXXXXX";
+        root = mkdtemp(pattern) ? pattern : "/tmp";
+    }
+
+    bool begin(bool formatOnFail = false) { return true; }
+
+    bool format() {
+        DIR* dir = opendir(root.c_str());
+        if (!dir) {
+            return false;
+        }
+        while (struct dirent* entry = readdir(dir)) {
+            if (entry->d_name[0] != '.') {
+                ::remove((root + "/" + entry->d_name).c_str());
+            }
+        }
+        closedir(dir);
+        return true;
+    }
+
+    bool exists(const String& path) {
+        struct stat info;
+        return stat(hostPath(path).c_str(), &info) == 0;
+    }
+
+    File open(const String& path, const char* mode = "r") {
+        bool writing = mode[0] != 'r' || strchr(mode, '+');
+        if (writing && powerLost) {
+            return File();
+        }
+        std::string hostMode = std::string(mode) + "b";
+        return File(fopen(hostPath(path).c_str(), hostMode.c_str()), this);
+    }
+
+    bool remove(const String& path) {
+        return consume(1) == 1 && ::remove(hostPath(path).c_str()) == 0;
+    }
+
+    bool rename(const String& from, const String& to) {
+        return consume(1) == 1 && ::rename(hostPath(from).c_str(), hostPath(to).c_str()) == 0;
+    }
+
+    // Fault injection
+    void cutPowerAfter(long units) { budget = units; powerLost = units <= 0; }
+    void restorePower() { budget = -1; powerLost = false; }
+    bool isPowerLost() const { return powerLost; }
+
+    // Units of a request that still reach flash
+    size_t consume(size_t units) {
+        if (powerLost) {
+            return 0;
+        }
+        if (budget < 0) {
+            return units;
+        }
+        if ((long)units >= budget) {
+            units = budget;
+            powerLost = true;
+        }
+        budget -= units;
+        return units;
+    }
+
+private:
+    std::string root;
+    long budget;
+    bool powerLost;
+
+    std::string hostPath(const String& path) const { return root + path.c_str(); }
+};
+
+inline size_t File::write(const uint8_t* data, size_t length) {
+    if (!file) {
+        return 0;
+    }
+    size_t allowed = fs->consume(length);
+    size_t written = fwrite(data, 1, allowed, file);
+    fflush(file);
+    return written;
+}
+
+inline FsShim& littleFsShim() {
+    static FsShim fs;
+    return fs;
+}
+#define LittleFS littleFsShim()
+
+#endif // LITTLEFS_SHIM_H
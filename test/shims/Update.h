@@ -0,0 +1,68 @@
+#ifndef UPDATE_SHIM_H
+#define UPDATE_SHIM_H
+
+#include <Arduino.h>
+#include <vector>
+
+// Host stand-in for the Arduino Update library: the inactive app slot is a
+// byte vector of the partitions.csv size, and "selecting it for the next
+// boot" copies it to bootImage
+#define UPDATE_SIZE_UNKNOWN     0xFFFFFFFF
+#define U_FLASH                 0
+#define UPDATE_SHIM_SLOT_SIZE   0x1C0000
+
+class UpdateShim {
+public:
+    std::vector<uint8_t> slot;
+    std::vector<uint8_t> bootImage;
+    bool running = false;
+    uint32_t aborts = 0;
+
+    bool begin(size_t size, int command) {
+        if (running || (size != UPDATE_SIZE_UNKNOWN && size > UPDATE_SHIM_SLOT_SIZE)) {
+            return false;
+        }
+        slot.clear();
+        running = true;
+        return true;
+    }
+
+    size_t write(uint8_t* data, size_t length) {
+        if (!running) {
+            return 0;
+        }
+        size_t room = UPDATE_SHIM_SLOT_SIZE - slot.size();
+        size_t count = min(length, room);
+        slot.insert(slot.end(), data, data + count);
+        return count;
+    }
+
+    bool end(bool evenIfRemaining) {
+        if (!running || slot.empty()) {
+            return false;
+        }
+        running = false;
+        bootImage = slot;
+        return true;
+    }
+
+    void abort() {
+        running = false;
+        aborts++;
+    }
+
+    void reset() {
+        slot.clear();
+        bootImage.clear();
+        running = false;
+        aborts = 0;
+    }
+};
+
+inline UpdateShim& updateShim() {
+    static UpdateShim update;
+    return update;
+}
+#define Update updateShim()
+
+#endif // UPDATE_SHIM_H
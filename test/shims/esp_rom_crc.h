@@ -0,0 +1,20 @@
+#ifndef ESP_ROM_CRC_SHIM_H
+#define ESP_ROM_CRC_SHIM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Host stand-in for the ROM CRC-32 (IEEE 802.3, reflected), same
+// pre- and post-inversion as the ROM routine
+inline uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t* buf, uint32_t len) {
+    crc = ~crc;
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= buf[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+#endif // ESP_ROM_CRC_SHIM_H
@@ -0,0 +1,24 @@
+#ifndef ESP_SYSTEM_SHIM_H
+#define ESP_SYSTEM_SHIM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <random>
+
+// Host stand-in for the hardware RNG
+inline uint32_t esp_random() {
+    static std::random_device device;
+    return device();
+}
+
+// Four bytes per draw, as the ESP-IDF version reads the RNG register
+inline void esp_fill_random(void* buffer, size_t length) {
+    uint8_t* out = (uint8_t*)buffer;
+    for (size_t i = 0; i < length; i += 4) {
+        uint32_t word = esp_random();
+        memcpy(out + i, &word, length - i < 4 ? length - i : 4);
+    }
+}
+
+#endif // ESP_SYSTEM_SHIM_H
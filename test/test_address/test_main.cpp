@@ -0,0 +1,158 @@
+// Watch-only address derivation: BIP32 public derivation and the BIP84,
+// BIP49 and BIP32 reference addresses
+#include <unity.h>
+#include "cold/bip32.h"
+
+#define BENCH_ADDRESSES 20
+
+// BIP84 reference account (mnemonic "abandon ... about", m/84'/0'/0')
+static const char* BIP84_ZPUB =
+    "zpub6rFR7y4Q2AijBEqTUquhVz398htDFrtymD9xYYfG1m4wAcvPhXNfE3EfH1r1ADqtfSdVCToUG868RvUUkgDKf31mGDtKsAYz2oz2AGutZYs";
+
+// BIP32 test vector 2: m and m/0
+static const char* BIP32_MASTER =
+    "xpub661MyMwAqRbcFW31YEwpkMuc5THy2PSt5bDMsktWQcFF8syAmRUapSCGu8ED9W6oDMSgv6Zz8idoc4a6mr8BDzTJY47LJhkJ8UB7WEGuduB";
+static const char* BIP32_CHILD =
+    "xpub69H7F5d8KSRgmmdJg2KhpAK8SR3DjMwAdkxj3ZuxV27CprR9LgpeyGmXUbC6wb7ERfvrnKZjXoUmmDznezpbZb7ap6r1D3tgFxHmwMkQTPH";
+
+static void parseHex(const char* hex, uint8_t* out) {
+    for (size_t i = 0; hex[i * 2]; i++) {
+        sscanf(hex + i * 2, "%2hhx", &out[i]);
+    }
+}
+
+static String addressOf(const ExtendedPubKey& key) {
+    uint8_t hash[HASH160_SIZE];
+    char address[ADDRESS_MAX_LENGTH];
+    scriptHash(key.key, key.script, hash);
+    encodeAddress(hash, key.script, key.testnet, address);
+    return String(address);
+}
+
+static bool parse(const char* text, ExtendedPubKey& out) {
+    return parseExtendedPubKey(text, strlen(text), out);
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+static void test_encodes_reference_addresses() {
+    uint8_t key[BIP32_KEY_SIZE];
+    uint8_t hash[HASH160_SIZE];
+    char address[ADDRESS_MAX_LENGTH];
+
+    // BIP84 m/84'/0'/0'/0/0
+    parseHex("0330d54fd0dd420a6e5f8d3624f5f3482cae350f79d5f0753bf5beef9c2d91af3c", key);
+    scriptHash(key, ScriptType::P2WPKH, hash);
+    TEST_ASSERT_TRUE(encodeAddress(hash, ScriptType::P2WPKH, false, address));
+    TEST_ASSERT_EQUAL_STRING("bc1qcr8te4kr609gcawutmrza0j4xv80jy8z306fyu", address);
+
+    // BIP49 testnet m/49'/1'/0'/0/0
+    parseHex("03a1af804ac108a8a51782198c2d034b28bf90c8803f5a53f76276fa69a4eae77f", key);
+    scriptHash(key, ScriptType::P2SH_P2WPKH, hash);
+    TEST_ASSERT_TRUE(encodeAddress(hash, ScriptType::P2SH_P2WPKH, true, address));
+    TEST_ASSERT_EQUAL_STRING("2Mww8dCYPUpKHofjgcXcBCEGmniw9CoaiD2", address);
+
+    // BIP32 test vector 1 master key
+    parseHex("0339a36013301597daef41fbe593a02cc513d0b55527ec2df1050e2e8ff49c85c2", key);
+    scriptHash(key, ScriptType::P2PKH, hash);
+    TEST_ASSERT_TRUE(encodeAddress(hash, ScriptType::P2PKH, false, address));
+    TEST_ASSERT_EQUAL_STRING("15mKKb2eos1hWa6tisdPwwDC1a5J1y9nma", address);
+}
+
+static void test_base58check() {
+    uint8_t decoded[BIP32_SERIALIZED_SIZE + 4];
+    TEST_ASSERT_EQUAL_UINT32(BIP32_SERIALIZED_SIZE,
+                             base58CheckDecode(BIP84_ZPUB, strlen(BIP84_ZPUB), decoded, sizeof(decoded)));
+
+    char encoded[128];
+    TEST_ASSERT_TRUE(base58CheckEncode(decoded, BIP32_SERIALIZED_SIZE, encoded, sizeof(encoded)));
+    TEST_ASSERT_EQUAL_STRING(BIP84_ZPUB, encoded);
+
+    // One changed character breaks the checksum
+    String damaged(BIP84_ZPUB);
+    damaged[20] = damaged[20] == 'a' ? 'b' : 'a';
+    TEST_ASSERT_EQUAL_UINT32(0, base58CheckDecode(damaged.c_str(), damaged.length(), decoded, sizeof(decoded)));
+    TEST_ASSERT_EQUAL_UINT32(0, base58CheckDecode("0OIl", 4, decoded, sizeof(decoded)));
+}
+
+static void test_parses_extended_keys() {
+    ExtendedPubKey key;
+    TEST_ASSERT_TRUE(parse(BIP84_ZPUB, key));
+    TEST_ASSERT_EQUAL(ScriptType::P2WPKH, key.script);
+    TEST_ASSERT_FALSE(key.testnet);
+
+    TEST_ASSERT_TRUE(parse(BIP32_MASTER, key));
+    TEST_ASSERT_EQUAL(ScriptType::P2PKH, key.script);
+
+    // Private keys are refused
+    TEST_ASSERT_FALSE(parse("xprv9s21ZrQH143K31xYSDQpPDxsXRTUcvj2iNHm5NUtrGiGG5e2DtALGdso3pGz6ssrdK4PFmM8NSpSBHNqPqm55Qn3LqFtT2emdEXVYsCzC2U", key));
+}
+
+static void test_bip32_public_derivation() {
+    ExtendedPubKey master;
+    ExtendedPubKey expected;
+    ExtendedPubKey child;
+    TEST_ASSERT_TRUE(parse(BIP32_MASTER, master));
+    TEST_ASSERT_TRUE(parse(BIP32_CHILD, expected));
+
+    Bip32Deriver deriver;
+    TEST_ASSERT_TRUE(deriver.begin(master));
+    TEST_ASSERT_TRUE(deriver.derive(0, child));
+    TEST_ASSERT_EQUAL_MEMORY(expected.key, child.key, BIP32_KEY_SIZE);
+    TEST_ASSERT_EQUAL_MEMORY(expected.chainCode, child.chainCode, BIP32_CHAIN_CODE_SIZE);
+
+    // Hardened children need the private key
+    TEST_ASSERT_FALSE(deriver.derive(BIP32_HARDENED, child));
+}
+
+static void test_bip84_addresses() {
+    ExtendedPubKey account;
+    TEST_ASSERT_TRUE(parse(BIP84_ZPUB, account));
+
+    Bip32Deriver accountDeriver;
+    Bip32Deriver chainDeriver;
+    ExtendedPubKey chain;
+    ExtendedPubKey address;
+    TEST_ASSERT_TRUE(accountDeriver.begin(account));
+
+    TEST_ASSERT_TRUE(accountDeriver.derive(0, chain));
+    TEST_ASSERT_TRUE(chainDeriver.begin(chain));
+    TEST_ASSERT_TRUE(chainDeriver.derive(0, address));
+    TEST_ASSERT_EQUAL_STRING("bc1qcr8te4kr609gcawutmrza0j4xv80jy8z306fyu", addressOf(address).c_str());
+    TEST_ASSERT_TRUE(chainDeriver.derive(1, address));
+    TEST_ASSERT_EQUAL_STRING("bc1qnjg0jd8228aq7egyzacy8cys3knf9xvrerkf9g", addressOf(address).c_str());
+
+    TEST_ASSERT_TRUE(accountDeriver.derive(1, chain));
+    TEST_ASSERT_TRUE(chainDeriver.begin(chain));
+    TEST_ASSERT_TRUE(chainDeriver.derive(0, address));
+    TEST_ASSERT_EQUAL_STRING("bc1q8c6fshw2dlwun7ekn9qwf37cu2rn755upcp6el", addressOf(address).c_str());
+
+    // A gap-limit run from one receive chain
+    TEST_ASSERT_TRUE(accountDeriver.derive(0, chain));
+    TEST_ASSERT_TRUE(chainDeriver.begin(chain));
+    unsigned long start = micros();
+    for (uint32_t i = 0; i < BENCH_ADDRESSES; i++) {
+        TEST_ASSERT_TRUE(chainDeriver.derive(i, address));
+        addressOf(address);
+    }
+    unsigned long elapsed = micros() - start;
+
+    char message[96];
+    snprintf(message, sizeof(message), "%u receive addresses derived and encoded in %lu us",
+             (unsigned)BENCH_ADDRESSES, elapsed);
+    TEST_MESSAGE(message);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_encodes_reference_addresses);
+    RUN_TEST(test_base58check);
+    RUN_TEST(test_parses_extended_keys);
+    RUN_TEST(test_bip32_public_derivation);
+    RUN_TEST(test_bip84_addresses);
+    return UNITY_END();
+}
@@ -0,0 +1,199 @@
+// Esplora /address responses: the filtered stream parse against the old
+// buffer-the-body-then-parse-everything path it replaced
+#include <unity.h>
+#include <ArduinoJson.h>
+#include "cold/esplora.h"
+#include "utils/jsonpool.h"
+
+#define BENCH_PARSES    5000
+
+static const char* RESPONSE =
+    "{\"address\":\"bc1qcr8te4kr609gcawutmrza0j4xv80jy8z306fyu\","
+    "\"chain_stats\":{\"funded_txo_count\":5,\"funded_txo_sum\":21000000000000,"
+    "\"spent_txo_count\":2,\"spent_txo_sum\":400000,\"tx_count\":6},"
+    "\"mempool_stats\":{\"funded_txo_count\":1,\"funded_txo_sum\":250000,"
+    "\"spent_txo_count\":1,\"spent_txo_sum\":100000,\"tx_count\":2}}";
+
+// Body as the HTTP client delivers it, at most chunk bytes per read()
+// burst
+class BodyStream : public Stream {
+public:
+    BodyStream(const char* text, size_t chunk = 0) : text(text), length(strlen(text)), position(0), chunk(chunk) {}
+
+    int available() override {
+        size_t left = length - position;
+        return chunk && left > chunk ? chunk : left;
+    }
+    int read() override { return position < length ? (uint8_t)text[position++] : -1; }
+    int peek() override { return position < length ? (uint8_t)text[position] : -1; }
+
+private:
+    const char* text;
+    size_t length;
+    size_t position;
+    size_t chunk;
+};
+
+// Heap accounting for the old path, which parsed with the default allocator
+class CountingAllocator : public ArduinoJson::Allocator {
+public:
+    size_t current = 0;
+    size_t peak = 0;
+
+    void* allocate(size_t size) override {
+        size_t* block = (size_t*)malloc(size + sizeof(size_t));
+        *block = size;
+        account(size);
+        return block + 1;
+    }
+    void deallocate(void* ptr) override {
+        if (ptr) {
+            size_t* block = (size_t*)ptr - 1;
+            current -= *block;
+            free(block);
+        }
+    }
+    void* reallocate(void* ptr, size_t newSize) override {
+        size_t* block = (size_t*)ptr - 1;
+        current -= *block;
+        block = (size_t*)realloc(block, newSize + sizeof(size_t));
+        *block = newSize;
+        account(newSize);
+        return block + 1;
+    }
+
+private:
+    void account(size_t size) {
+        current += size;
+        peak = max(peak, current);
+    }
+};
+
+// The replaced fetchAddressBalance(): whole body into a String, then a
+// full parse
+static bool parseBuffered(Stream& stream, CountingAllocator& allocator, AddressStats& stats) {
+    String body;
+    int c;
+    while ((c = stream.read()) >= 0) {
+        body += (char)c;
+    }
+    JsonDocument doc(&allocator);
+    if (deserializeJson(doc, body)) {
+        return false;
+    }
+    stats.funded = doc["chain_stats"]["funded_txo_sum"];
+    stats.spent = doc["chain_stats"]["spent_txo_sum"];
+    stats.txCount = doc["chain_stats"]["tx_count"];
+    stats.mempoolFunded = doc["mempool_stats"]["funded_txo_sum"];
+    stats.mempoolSpent = doc["mempool_stats"]["spent_txo_sum"];
+    stats.mempoolTxCount = doc["mempool_stats"]["tx_count"];
+    return true;
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+static void test_parses_stats() {
+    BodyStream body(RESPONSE, 7);
+    AddressStats stats;
+    TEST_ASSERT_TRUE(esploraParseAddressStats(body, stats));
+    TEST_ASSERT_TRUE(stats.funded == 21000000000000ULL);
+    TEST_ASSERT_TRUE(stats.spent == 400000);
+    TEST_ASSERT_EQUAL_UINT32(6, stats.txCount);
+    TEST_ASSERT_TRUE(stats.mempoolFunded == 250000);
+    TEST_ASSERT_TRUE(stats.mempoolSpent == 100000);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.mempoolTxCount);
+}
+
+static void test_rejects_bad_bodies() {
+    AddressStats stats;
+    const char* bodies[] = {
+        "",
+        "Too many requests",
+        "{\"chain_stats\":{\"tx_count\":1}}",
+        "{\"chain_stats\":{\"tx_count\":1},\"mempool_stats\":[]}",
+        "{\"chain_stats\":{\"tx_count\":1},\"mempool_stats\":{\"tx_count\":"
+    };
+    for (size_t i = 0; i < sizeof(bodies) / sizeof(bodies[0]); i++) {
+        BodyStream body(bodies[i]);
+        TEST_ASSERT_FALSE_MESSAGE(esploraParseAddressStats(body, stats), bodies[i]);
+    }
+
+    // Cut anywhere short of the end
+    size_t length = strlen(RESPONSE);
+    for (size_t cut = 0; cut + 1 < length; cut++) {
+        String prefix(RESPONSE, cut);
+        BodyStream body(prefix.c_str());
+        TEST_ASSERT_FALSE(esploraParseAddressStats(body, stats));
+    }
+}
+
+static void test_pool_blocks_returned() {
+    JsonPoolStats before = jsonPool.getStats();
+    BodyStream body(RESPONSE);
+    AddressStats stats;
+    TEST_ASSERT_TRUE(esploraParseAddressStats(body, stats));
+    JsonPoolStats after = jsonPool.getStats();
+    TEST_ASSERT_EQUAL_UINT32(before.fallbacks, after.fallbacks);
+    TEST_ASSERT_EQUAL_UINT32(0, after.smallInUse);
+    TEST_ASSERT_EQUAL_UINT32(0, after.largeInUse);
+}
+
+static void test_trimmed_string_moves_to_small_block() {
+    // A string that grew past a small block while parsing returns its
+    // large block once shrunk to fit
+    void* text = jsonPool.allocate(40);
+    text = jsonPool.reallocate(text, 133);
+    TEST_ASSERT_EQUAL_UINT32(1, jsonPool.getStats().largeInUse);
+    memset(text, 'a', 133);
+    text = jsonPool.reallocate(text, 73);
+    TEST_ASSERT_EQUAL_UINT32(0, jsonPool.getStats().largeInUse);
+    TEST_ASSERT_EQUAL_UINT32(1, jsonPool.getStats().smallInUse);
+    TEST_ASSERT_EQUAL('a', ((char*)text)[72]);
+    jsonPool.deallocate(text);
+    TEST_ASSERT_EQUAL_UINT32(0, jsonPool.getStats().smallInUse);
+}
+
+static void test_benchmark_against_buffered() {
+    CountingAllocator allocator;
+    AddressStats stats;
+
+    unsigned long start = micros();
+    for (uint32_t i = 0; i < BENCH_PARSES; i++) {
+        BodyStream body(RESPONSE, 64);
+        TEST_ASSERT_TRUE(parseBuffered(body, allocator, stats));
+    }
+    unsigned long bufferedUs = micros() - start;
+    TEST_ASSERT_EQUAL_UINT32(0, allocator.current);
+
+    JsonPoolStats before = jsonPool.getStats();
+    start = micros();
+    for (uint32_t i = 0; i < BENCH_PARSES; i++) {
+        BodyStream body(RESPONSE, 64);
+        TEST_ASSERT_TRUE(esploraParseAddressStats(body, stats));
+    }
+    unsigned long streamedUs = micros() - start;
+    JsonPoolStats after = jsonPool.getStats();
+    TEST_ASSERT_EQUAL_UINT32(before.fallbacks, after.fallbacks);
+
+    char message[192];
+    snprintf(message, sizeof(message),
+             "%u parses of a %u-byte body: buffered %lu us, peak %u B heap plus the body; "
+             "streamed %lu us, peak %u small + %u large pool blocks, no heap",
+             (unsigned)BENCH_PARSES, (unsigned)strlen(RESPONSE), bufferedUs, (unsigned)allocator.peak,
+             streamedUs, (unsigned)after.smallPeak, (unsigned)after.largePeak);
+    TEST_MESSAGE(message);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_parses_stats);
+    RUN_TEST(test_rejects_bad_bodies);
+    RUN_TEST(test_pool_blocks_returned);
+    RUN_TEST(test_trimmed_string_moves_to_small_block);
+    RUN_TEST(test_benchmark_against_buffered);
+    return UNITY_END();
+}
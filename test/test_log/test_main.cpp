@@ -0,0 +1,100 @@
+// Log ring: lines from concurrent producers reach Serial whole and in
+// per-producer order, and every line is either written or counted dropped
+#include <unity.h>
+#include <thread>
+#include <vector>
+#include "utils/log.h"
+
+#define PRODUCERS           4
+#define LINES_PER_PRODUCER  20000
+
+void setUp() {
+    logFlush();
+    Serial.take();
+}
+
+void tearDown() {
+}
+
+static void test_writes_directly_before_init() {
+    logWrite("boot %d\n", 1);
+    TEST_ASSERT_EQUAL_STRING("boot 1\n", Serial.take().c_str());
+}
+
+static void test_truncates_long_lines() {
+    logInit();
+    LogStats before = logGetStats();
+
+    char text[LOG_LINE_MAX * 2];
+    memset(text, 'x', sizeof(text) - 1);
+    text[sizeof(text) - 1] = '\0';
+    logWrite("%s\n", text);
+    logFlush();
+
+    std::string output = Serial.take();
+    TEST_ASSERT_EQUAL_UINT32(LOG_LINE_MAX - 1, output.size());
+    TEST_ASSERT_EQUAL('\n', output[output.size() - 1]);
+    TEST_ASSERT_EQUAL_UINT32(before.truncated + 1, logGetStats().truncated);
+}
+
+static void test_concurrent_producers() {
+    logInit();
+    LogStats before = logGetStats();
+
+    // Producers pause now and then so the drain task keeps up part of the
+    // time and the ring overflows the rest
+    std::vector<std::thread> producers;
+    unsigned long start = micros();
+    for (int t = 0; t < PRODUCERS; t++) {
+        producers.push_back(std::thread([t] {
+            for (int i = 0; i < LINES_PER_PRODUCER; i++) {
+                if (i % 50 == 0) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+                }
+                logWrite("P%d %d\n", t, i);
+            }
+        }));
+    }
+    for (std::thread& producer : producers) {
+        producer.join();
+    }
+    unsigned long elapsed = micros() - start;
+    logFlush();
+
+    std::string output = Serial.take();
+    int last[PRODUCERS] = {-1, -1, -1, -1};
+    uint32_t lines = 0;
+    size_t pos = 0;
+    while (pos < output.size()) {
+        size_t end = output.find('\n', pos);
+        TEST_ASSERT_TRUE(end != std::string::npos);
+        int producer, index;
+        char tail;
+        TEST_ASSERT_EQUAL(3, sscanf(output.c_str() + pos, "P%d %d%c", &producer, &index, &tail));
+        TEST_ASSERT_EQUAL('\n', tail);
+        TEST_ASSERT_TRUE(producer >= 0 && producer < PRODUCERS);
+        TEST_ASSERT_TRUE(index > last[producer]);
+        last[producer] = index;
+        lines++;
+        pos = end + 1;
+    }
+
+    LogStats after = logGetStats();
+    uint32_t written = after.written - before.written;
+    uint32_t dropped = after.dropped - before.dropped;
+    TEST_ASSERT_EQUAL_UINT32(written, lines);
+    TEST_ASSERT_EQUAL_UINT32(PRODUCERS * LINES_PER_PRODUCER, written + dropped);
+
+    char message[128];
+    snprintf(message, sizeof(message), "%u lines in %lu us: %u written, %u dropped",
+             (unsigned)(PRODUCERS * LINES_PER_PRODUCER), elapsed, (unsigned)written, (unsigned)dropped);
+    TEST_MESSAGE(message);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_writes_directly_before_init);
+    RUN_TEST(test_truncates_long_lines);
+    RUN_TEST(test_concurrent_producers);
+    return UNITY_END();
+}
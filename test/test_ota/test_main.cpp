@@ -0,0 +1,148 @@
+// Firmware updates into a fake app slot (test/shims/Update.h): the image
+// only becomes the boot image when it arrives whole and matches its hash
+#include <unity.h>
+#include <vector>
+#include <Update.h>
+#include "web/ota.h"
+
+#define IMAGE_SIZE      100000
+#define CHUNK_SIZE      1460    // One TCP segment per write, as AsyncTCP delivers
+
+static std::vector<uint8_t> image;
+static char imageHash[65];
+
+static void hashImage(const std::vector<uint8_t>& data, char* hex) {
+    uint8_t digest[32];
+    mbedtls_md(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), data.data(), data.size(), digest);
+    for (size_t i = 0; i < sizeof(digest); i++) {
+        snprintf(hex + i * 2, 3, "%02x", digest[i]);
+    }
+}
+
+static bool upload(OtaUpdater& updater, uint32_t owner, const std::vector<uint8_t>& data) {
+    for (size_t offset = 0; offset < data.size(); offset += CHUNK_SIZE) {
+        size_t length = min((size_t)CHUNK_SIZE, data.size() - offset);
+        if (!updater.write(owner, data.data() + offset, length)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void setUp() {
+    Update.reset();
+    if (image.empty()) {
+        image.resize(IMAGE_SIZE);
+        for (size_t i = 0; i < image.size(); i++) {
+            image[i] = (uint8_t)(i * 7 + (i >> 8));
+        }
+        hashImage(image, imageHash);
+    }
+}
+
+void tearDown() {
+}
+
+static void test_streams_verified_image() {
+    OtaUpdater updater(OTA_PARTITION_TARGET);
+    uint32_t owner;
+    TEST_ASSERT_TRUE(updater.begin(owner, imageHash));
+    TEST_ASSERT_TRUE(upload(updater, owner, image));
+    TEST_ASSERT_EQUAL_UINT32(IMAGE_SIZE, updater.getWritten());
+    TEST_ASSERT_TRUE(Update.bootImage.empty());
+
+    TEST_ASSERT_TRUE(updater.finish(owner));
+    TEST_ASSERT_EQUAL(OtaState::VERIFIED, updater.getState());
+    TEST_ASSERT_TRUE(Update.bootImage == image);
+
+    // Verified means a restart is pending; nothing else gets in
+    uint32_t other;
+    TEST_ASSERT_TRUE(updater.isBusy());
+    TEST_ASSERT_FALSE(updater.begin(other, imageHash));
+    TEST_ASSERT_EQUAL_UINT32(0, other);
+    updater.release(owner);
+    TEST_ASSERT_EQUAL(OtaState::VERIFIED, updater.getState());
+}
+
+static void test_hash_mismatch_keeps_boot_image() {
+    OtaUpdater updater(OTA_PARTITION_TARGET);
+    std::vector<uint8_t> corrupt = image;
+    corrupt[IMAGE_SIZE / 2] ^= 0x01;
+
+    uint32_t owner;
+    TEST_ASSERT_TRUE(updater.begin(owner, imageHash));
+    TEST_ASSERT_TRUE(upload(updater, owner, corrupt));
+    TEST_ASSERT_FALSE(updater.finish(owner));
+    TEST_ASSERT_EQUAL(OtaState::FAILED, updater.getState());
+    TEST_ASSERT_EQUAL_STRING("SHA-256 mismatch", updater.getError());
+    TEST_ASSERT_TRUE(Update.bootImage.empty());
+    TEST_ASSERT_EQUAL_UINT32(1, Update.aborts);
+
+    updater.release(owner);
+    TEST_ASSERT_EQUAL(OtaState::IDLE, updater.getState());
+}
+
+static void test_rejects_malformed_hash() {
+    OtaUpdater updater(OTA_PARTITION_TARGET);
+    uint32_t owner;
+    TEST_ASSERT_FALSE(updater.begin(owner, nullptr));
+    TEST_ASSERT_FALSE(updater.begin(owner, "abc"));
+    char bad[65];
+    memcpy(bad, imageHash, sizeof(bad));
+    bad[10] = 'g';
+    TEST_ASSERT_FALSE(updater.begin(owner, bad));
+    TEST_ASSERT_EQUAL(OtaState::FAILED, updater.getState());
+    TEST_ASSERT_FALSE(Update.running);
+}
+
+static void test_one_upload_at_a_time() {
+    OtaUpdater updater(OTA_PARTITION_TARGET);
+    uint32_t first, second;
+    TEST_ASSERT_TRUE(updater.begin(first, imageHash));
+    TEST_ASSERT_TRUE(updater.write(first, image.data(), CHUNK_SIZE));
+
+    TEST_ASSERT_FALSE(updater.begin(second, imageHash));
+    TEST_ASSERT_FALSE(updater.write(second, image.data(), CHUNK_SIZE));
+    TEST_ASSERT_FALSE(updater.finish(second));
+    updater.release(second);
+    TEST_ASSERT_EQUAL(OtaState::RECEIVING, updater.getState());
+
+    // Dropped connection: the slot is freed and the next upload starts clean
+    updater.release(first);
+    TEST_ASSERT_FALSE(Update.running);
+    TEST_ASSERT_TRUE(updater.begin(second, imageHash));
+    TEST_ASSERT_NOT_EQUAL(first, second);
+
+    // Chunks still arriving under the old id, e.g. from a request that
+    // reused the old one's memory, are refused
+    TEST_ASSERT_FALSE(updater.write(first, image.data(), CHUNK_SIZE));
+    TEST_ASSERT_EQUAL_UINT32(0, updater.getWritten());
+    TEST_ASSERT_TRUE(upload(updater, second, image));
+    TEST_ASSERT_TRUE(updater.finish(second));
+    TEST_ASSERT_TRUE(Update.bootImage == image);
+}
+
+static void test_image_larger_than_slot_fails() {
+    std::vector<uint8_t> large(UPDATE_SHIM_SLOT_SIZE + CHUNK_SIZE, 0x5a);
+    char largeHash[65];
+    hashImage(large, largeHash);
+
+    OtaUpdater updater(OTA_PARTITION_TARGET);
+    uint32_t owner;
+    TEST_ASSERT_TRUE(updater.begin(owner, largeHash));
+    TEST_ASSERT_FALSE(upload(updater, owner, large));
+    TEST_ASSERT_EQUAL(OtaState::FAILED, updater.getState());
+    TEST_ASSERT_EQUAL_STRING("Flash write failed", updater.getError());
+    TEST_ASSERT_FALSE(updater.finish(owner));
+    TEST_ASSERT_TRUE(Update.bootImage.empty());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_streams_verified_image);
+    RUN_TEST(test_hash_mismatch_keeps_boot_image);
+    RUN_TEST(test_rejects_malformed_hash);
+    RUN_TEST(test_one_upload_at_a_time);
+    RUN_TEST(test_image_larger_than_slot_fails);
+    return UNITY_END();
+}
@@ -0,0 +1,184 @@
+// Settings records under power loss: a write cut at any byte leaves the
+// old record or the new one, and damage on flash is caught, never loaded
+#include <unity.h>
+#include <LittleFS.h>
+#include <vector>
+#include "settings/records.h"
+
+#define RECORD_PATH     "/wallet.bin"
+
+static std::vector<uint8_t> payload(size_t length, uint8_t seed) {
+    std::vector<uint8_t> data(length);
+    for (size_t i = 0; i < length; i++) {
+        data[i] = (uint8_t)(seed + i * 31);
+    }
+    return data;
+}
+
+static bool writeFile(const std::vector<uint8_t>& data) {
+    size_t written;
+    return recordWrite(RECORD_PATH, data.data(), data.size(), written);
+}
+
+// Payload read back, empty when there is none; corrupt is reported
+static std::vector<uint8_t> readFile(bool& corrupt) {
+    size_t length = 0;
+    uint8_t* data = recordRead(RECORD_PATH, length, false, corrupt);
+    std::vector<uint8_t> out;
+    if (data) {
+        out.assign(data, data + length);
+        free(data);
+    }
+    return out;
+}
+
+static std::vector<uint8_t> rawFile() {
+    File file = LittleFS.open(RECORD_PATH, "r");
+    std::vector<uint8_t> data(file.size());
+    file.read(data.data(), data.size());
+    file.close();
+    return data;
+}
+
+static void writeRaw(const std::vector<uint8_t>& data) {
+    File file = LittleFS.open(RECORD_PATH, "w");
+    file.write(data.data(), data.size());
+    file.close();
+}
+
+void setUp() {
+    LittleFS.restorePower();
+    LittleFS.format();
+}
+
+void tearDown() {
+}
+
+static void test_round_trip() {
+    std::vector<uint8_t> data = payload(300, 1);
+    size_t written;
+    TEST_ASSERT_TRUE(recordWrite(RECORD_PATH, data.data(), data.size(), written));
+    TEST_ASSERT_EQUAL_UINT32(sizeof(SettingsRecordHeader) + data.size(), written);
+    TEST_ASSERT_FALSE(LittleFS.exists(RECORD_PATH SETTINGS_TEMP_SUFFIX));
+
+    bool corrupt;
+    TEST_ASSERT_TRUE(readFile(corrupt) == data);
+    TEST_ASSERT_FALSE(corrupt);
+
+    // Missing is not corrupt
+    LittleFS.remove(RECORD_PATH);
+    TEST_ASSERT_TRUE(readFile(corrupt).empty());
+    TEST_ASSERT_FALSE(corrupt);
+}
+
+static void test_cut_at_every_byte() {
+    std::vector<uint8_t> before = payload(300, 1);
+    std::vector<uint8_t> after = payload(420, 2);
+
+    // Header and payload bytes, then the rename
+    long total = sizeof(SettingsRecordHeader) + after.size() + 1;
+    uint32_t oldSeen = 0;
+    uint32_t newSeen = 0;
+    for (long cut = 0; cut <= total; cut++) {
+        LittleFS.restorePower();
+        LittleFS.format();
+        TEST_ASSERT_TRUE(writeFile(before));
+
+        LittleFS.cutPowerAfter(cut);
+        bool success = writeFile(after);
+        TEST_ASSERT_EQUAL(cut == total, success);
+
+        // Reboot
+        LittleFS.restorePower();
+        bool corrupt;
+        std::vector<uint8_t> loaded = readFile(corrupt);
+        TEST_ASSERT_FALSE(corrupt);
+        if (loaded == after) {
+            newSeen++;
+        } else {
+            TEST_ASSERT_TRUE(loaded == before);
+            oldSeen++;
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(total, oldSeen);
+    TEST_ASSERT_EQUAL_UINT32(1, newSeen);
+
+    char message[96];
+    snprintf(message, sizeof(message), "%ld cut points: %u kept the old record, %u the new one",
+             total + 1, (unsigned)oldSeen, (unsigned)newSeen);
+    TEST_MESSAGE(message);
+}
+
+static void test_cut_first_write_leaves_nothing() {
+    std::vector<uint8_t> data = payload(64, 3);
+    LittleFS.cutPowerAfter(sizeof(SettingsRecordHeader) + 10);
+    TEST_ASSERT_FALSE(writeFile(data));
+    LittleFS.restorePower();
+
+    bool corrupt;
+    TEST_ASSERT_TRUE(readFile(corrupt).empty());
+    TEST_ASSERT_FALSE(corrupt);
+}
+
+static void test_detects_flipped_bits() {
+    std::vector<uint8_t> data = payload(200, 4);
+    TEST_ASSERT_TRUE(writeFile(data));
+    std::vector<uint8_t> good = rawFile();
+
+    for (size_t offset = 0; offset < good.size(); offset++) {
+        std::vector<uint8_t> damaged = good;
+        damaged[offset] ^= 1 << (offset % 8);
+        writeRaw(damaged);
+
+        bool corrupt;
+        TEST_ASSERT_TRUE(readFile(corrupt).empty());
+        TEST_ASSERT_TRUE(corrupt);
+    }
+}
+
+static void test_detects_truncation() {
+    std::vector<uint8_t> data = payload(200, 5);
+    TEST_ASSERT_TRUE(writeFile(data));
+    std::vector<uint8_t> good = rawFile();
+
+    for (size_t length = 0; length < good.size(); length++) {
+        writeRaw(std::vector<uint8_t>(good.begin(), good.begin() + length));
+
+        bool corrupt;
+        TEST_ASSERT_TRUE(readFile(corrupt).empty());
+        TEST_ASSERT_TRUE(corrupt);
+    }
+}
+
+static void test_unframed_only_when_allowed() {
+    const char* json = "{\"wifi\":{}}";
+    writeRaw(std::vector<uint8_t>(json, json + strlen(json)));
+
+    size_t length = 0;
+    bool corrupt;
+    uint8_t* data = recordRead(RECORD_PATH, length, true, corrupt);
+    TEST_ASSERT_NOT_NULL(data);
+    TEST_ASSERT_FALSE(corrupt);
+    TEST_ASSERT_EQUAL_UINT32(strlen(json), length);
+    TEST_ASSERT_EQUAL_MEMORY(json, data, length);
+    free(data);
+
+    TEST_ASSERT_NULL(recordRead(RECORD_PATH, length, false, corrupt));
+    TEST_ASSERT_TRUE(corrupt);
+}
+
+static void test_crc_matches_ieee() {
+    TEST_ASSERT_EQUAL_UINT32(0xCBF43926, recordCrc((const uint8_t*)"123456789", 9));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_cut_at_every_byte);
+    RUN_TEST(test_cut_first_write_leaves_nothing);
+    RUN_TEST(test_detects_flipped_bits);
+    RUN_TEST(test_detects_truncation);
+    RUN_TEST(test_unframed_only_when_allowed);
+    RUN_TEST(test_crc_matches_ieee);
+    return UNITY_END();
+}
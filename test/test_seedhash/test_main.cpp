@@ -0,0 +1,121 @@
+// Seed phrase verifiers: fixed PBKDF2-HMAC-SHA256 vectors, round trips,
+// legacy hex records and tampered verifiers
+#include <unity.h>
+#include "settings/seedhash.h"
+
+#define TEST_PHRASE     "apple banana cat dog"
+#define TEST_ITERATIONS 20000
+
+// Keys computed independently with Python's hashlib.pbkdf2_hmac
+static const char* VECTOR_LONG =
+    "pbkdf2$10000$000102030405060708090a0b0c0d0e0f$"
+    "ff4fff678067442f39d2e8bff627c2a54f8531ee0d2795dd85fa945cb80c2a9e";
+static const char* VECTOR_LONG_PHRASE =
+    "abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon about";
+static const char* VECTOR_SINGLE =
+    "pbkdf2$1$686f646c696e6720686f672073616c74$"    // "hodling hog salt"
+    "cc1ed429296b553e2b80c6a41d96d6f4efef09bfd723563c7ef8a0c29eb904b0";
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+static void test_matches_reference_vectors() {
+    TEST_ASSERT_TRUE(seedKdfVerify(VECTOR_LONG_PHRASE, VECTOR_LONG));
+    TEST_ASSERT_TRUE(seedKdfVerify(TEST_PHRASE, VECTOR_SINGLE));
+    TEST_ASSERT_FALSE(seedKdfVerify(TEST_PHRASE, VECTOR_LONG));
+    TEST_ASSERT_EQUAL_UINT32(10000, seedKdfIterations(VECTOR_LONG));
+    TEST_ASSERT_EQUAL_UINT32(1, seedKdfIterations(VECTOR_SINGLE));
+}
+
+static void test_hash_round_trip() {
+    String first;
+    String second;
+    TEST_ASSERT_TRUE(seedKdfHash(TEST_PHRASE, TEST_ITERATIONS, first));
+    TEST_ASSERT_TRUE(seedKdfHash(TEST_PHRASE, TEST_ITERATIONS, second));
+    TEST_ASSERT_TRUE(first.startsWith(SEED_KDF_PREFIX));
+    TEST_ASSERT_TRUE(first != second);  // Fresh salt each time
+
+    TEST_ASSERT_TRUE(seedKdfVerify(TEST_PHRASE, first));
+    TEST_ASSERT_TRUE(seedKdfVerify(TEST_PHRASE, second));
+    TEST_ASSERT_FALSE(seedKdfVerify("apple banana cat dot", first));
+    TEST_ASSERT_EQUAL_UINT32(TEST_ITERATIONS, seedKdfIterations(first));
+}
+
+static void test_legacy_records() {
+    String legacy;
+    const char* phrase = "apple banana";
+    for (size_t i = 0; i < strlen(phrase); i++) {
+        legacy += String((int)phrase[i], HEX);
+    }
+    TEST_ASSERT_TRUE(seedKdfVerify(phrase, legacy));
+    TEST_ASSERT_FALSE(seedKdfVerify("apple banane", legacy));
+    TEST_ASSERT_FALSE(seedKdfVerify("apple banana ", legacy));
+    TEST_ASSERT_EQUAL_UINT32(0, seedKdfIterations(legacy));
+}
+
+static void test_rejects_tampered_verifiers() {
+    String stored(VECTOR_SINGLE);
+
+    // Every character of the key, salt and count matters
+    for (size_t i = strlen(SEED_KDF_PREFIX); i < stored.length(); i++) {
+        if (stored[i] == '$') {
+            continue;
+        }
+        String tampered = stored;
+        tampered[i] = tampered[i] == '0' ? '1' : '0';
+        TEST_ASSERT_FALSE(seedKdfVerify(TEST_PHRASE, tampered));
+    }
+
+    // Malformed ones never fall through to the legacy check
+    TEST_ASSERT_FALSE(seedKdfVerify(TEST_PHRASE, stored + "0"));
+    TEST_ASSERT_FALSE(seedKdfVerify(TEST_PHRASE, stored.substring(0, stored.length() - 1)));
+    TEST_ASSERT_FALSE(seedKdfVerify(TEST_PHRASE, "pbkdf2$0$00$00"));
+    TEST_ASSERT_FALSE(seedKdfVerify(TEST_PHRASE, "pbkdf2$99999999$000102030405060708090a0b0c0d0e0f$"
+                                                 "ff4fff678067442f39d2e8bff627c2a54f8531ee0d2795dd85fa945cb80c2a9e"));
+    TEST_ASSERT_EQUAL_UINT32(0, seedKdfIterations("pbkdf2$x$00$00"));
+}
+
+static void test_constant_time_compare() {
+    uint8_t a[32];
+    uint8_t b[32];
+    memset(a, 0x5a, sizeof(a));
+    memcpy(b, a, sizeof(b));
+    TEST_ASSERT_TRUE(seedKdfEqual(a, b, sizeof(a)));
+    for (size_t i = 0; i < sizeof(b); i++) {
+        b[i] ^= 0x80;
+        TEST_ASSERT_FALSE(seedKdfEqual(a, b, sizeof(a)));
+        b[i] ^= 0x80;
+    }
+}
+
+static void test_calibration() {
+    unsigned long start = micros();
+    uint32_t iterations = seedKdfCalibrate(SEED_KDF_TARGET_MS);
+    unsigned long calibrateUs = micros() - start;
+    TEST_ASSERT_TRUE(iterations >= SEED_KDF_MIN_ITERATIONS && iterations <= SEED_KDF_MAX_ITERATIONS);
+
+    String stored;
+    TEST_ASSERT_TRUE(seedKdfHash(TEST_PHRASE, iterations, stored));
+    start = millis();
+    TEST_ASSERT_TRUE(seedKdfVerify(TEST_PHRASE, stored));
+    unsigned long verifyMs = millis() - start;
+
+    char message[112];
+    snprintf(message, sizeof(message), "calibrated to %u iterations in %lu us; verify took %lu ms (target %d)",
+             (unsigned)iterations, calibrateUs, verifyMs, SEED_KDF_TARGET_MS);
+    TEST_MESSAGE(message);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_matches_reference_vectors);
+    RUN_TEST(test_hash_round_trip);
+    RUN_TEST(test_legacy_records);
+    RUN_TEST(test_rejects_tampered_verifiers);
+    RUN_TEST(test_constant_time_compare);
+    RUN_TEST(test_calibration);
+    return UNITY_END();
+}
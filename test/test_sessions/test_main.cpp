@@ -0,0 +1,194 @@
+// Session table: behaviour, plus a microbenchmark against the
+// std::map<String, WebContext> it replaced
+#include <unity.h>
+#include <map>
+#include "web/sessions.h"
+
+#define BENCH_LOOKUPS   200000
+
+// Session record and key scheme of the old map
+struct LegacyContext {
+    String clientIP;
+    String userAgent;
+    AuthLevel authLevel;
+    unsigned long sessionStart;
+    String sessionToken;
+};
+
+static SessionTable* table;
+
+void setUp() {
+    table = new SessionTable();
+}
+
+void tearDown() {
+    delete table;
+}
+
+static void test_create_and_check() {
+    char token[SESSION_TOKEN_HEX_LEN + 1];
+    table->create(0x0100007f, AuthLevel::BASIC, token);
+    TEST_ASSERT_EQUAL_UINT32(SESSION_TOKEN_HEX_LEN, strlen(token));
+    TEST_ASSERT_EQUAL_UINT32(1, table->size());
+
+    TEST_ASSERT_TRUE(table->check(token, SESSION_TOKEN_HEX_LEN, AuthLevel::NONE));
+    TEST_ASSERT_TRUE(table->check(token, SESSION_TOKEN_HEX_LEN, AuthLevel::BASIC));
+    TEST_ASSERT_FALSE(table->check(token, SESSION_TOKEN_HEX_LEN, AuthLevel::ADMIN));
+
+    // Wrong length, wrong digits, unknown token
+    TEST_ASSERT_FALSE(table->check(token, SESSION_TOKEN_HEX_LEN - 1, AuthLevel::NONE));
+    char other[SESSION_TOKEN_HEX_LEN + 1];
+    memcpy(other, token, sizeof(other));
+    other[0] = other[0] == 'f' ? '0' : 'f';
+    TEST_ASSERT_FALSE(table->check(other, SESSION_TOKEN_HEX_LEN, AuthLevel::NONE));
+    other[0] = 'x';
+    TEST_ASSERT_FALSE(table->check(other, SESSION_TOKEN_HEX_LEN, AuthLevel::NONE));
+
+    TEST_ASSERT_TRUE(table->remove(token, SESSION_TOKEN_HEX_LEN));
+    TEST_ASSERT_FALSE(table->remove(token, SESSION_TOKEN_HEX_LEN));
+    TEST_ASSERT_FALSE(table->check(token, SESSION_TOKEN_HEX_LEN, AuthLevel::NONE));
+    TEST_ASSERT_EQUAL_UINT32(0, table->size());
+}
+
+static void test_insert_generated_token() {
+    // Login flow: the token goes out before the session exists
+    char token[SESSION_TOKEN_HEX_LEN + 1];
+    SessionTable::generateToken(token);
+    TEST_ASSERT_FALSE(table->check(token, SESSION_TOKEN_HEX_LEN, AuthLevel::NONE));
+    TEST_ASSERT_TRUE(table->insert(token, 0x0100007f, AuthLevel::ADMIN));
+    TEST_ASSERT_TRUE(table->check(token, SESSION_TOKEN_HEX_LEN, AuthLevel::ADMIN));
+
+    // A second session under the same token would be unreachable
+    TEST_ASSERT_FALSE(table->insert(token, 0x0200007f, AuthLevel::BASIC));
+    TEST_ASSERT_TRUE(table->check(token, SESSION_TOKEN_HEX_LEN, AuthLevel::ADMIN));
+
+    TEST_ASSERT_FALSE(table->insert("not a token", 0x0100007f, AuthLevel::ADMIN));
+    TEST_ASSERT_EQUAL_UINT32(1, table->size());
+}
+
+static void test_evicts_least_recently_used() {
+    char tokens[SESSION_CAPACITY + 1][SESSION_TOKEN_HEX_LEN + 1];
+    for (size_t i = 0; i < SESSION_CAPACITY; i++) {
+        table->create(i, AuthLevel::BASIC, tokens[i]);
+        delay(2);
+    }
+
+    // Touching the oldest makes the second oldest the victim
+    TEST_ASSERT_TRUE(table->check(tokens[0], SESSION_TOKEN_HEX_LEN, AuthLevel::NONE));
+    delay(2);
+    table->create(SESSION_CAPACITY, AuthLevel::BASIC, tokens[SESSION_CAPACITY]);
+
+    TEST_ASSERT_EQUAL_UINT32(SESSION_CAPACITY, table->size());
+    TEST_ASSERT_EQUAL_UINT32(1, table->getEvictions());
+    TEST_ASSERT_TRUE(table->check(tokens[0], SESSION_TOKEN_HEX_LEN, AuthLevel::NONE));
+    TEST_ASSERT_FALSE(table->check(tokens[1], SESSION_TOKEN_HEX_LEN, AuthLevel::NONE));
+    for (size_t i = 2; i <= SESSION_CAPACITY; i++) {
+        TEST_ASSERT_TRUE(table->check(tokens[i], SESSION_TOKEN_HEX_LEN, AuthLevel::NONE));
+    }
+}
+
+static void test_expire_keeps_probe_chains() {
+    char tokens[SESSION_CAPACITY][SESSION_TOKEN_HEX_LEN + 1];
+    for (size_t i = 0; i < SESSION_CAPACITY; i++) {
+        table->create(i, AuthLevel::BASIC, tokens[i]);
+    }
+    delay(20);
+
+    // Keep every other session alive; removal shifts entries back, so the
+    // survivors must stay reachable
+    for (size_t i = 0; i < SESSION_CAPACITY; i += 2) {
+        TEST_ASSERT_TRUE(table->check(tokens[i], SESSION_TOKEN_HEX_LEN, AuthLevel::NONE));
+    }
+    TEST_ASSERT_EQUAL_UINT32(SESSION_CAPACITY / 2, table->expire(10));
+    for (size_t i = 0; i < SESSION_CAPACITY; i++) {
+        TEST_ASSERT_EQUAL(i % 2 == 0, table->check(tokens[i], SESSION_TOKEN_HEX_LEN, AuthLevel::NONE));
+    }
+
+    table->clear();
+    TEST_ASSERT_EQUAL_UINT32(0, table->size());
+}
+
+static void test_benchmark_against_map() {
+    char tokens[SESSION_CAPACITY][SESSION_TOKEN_HEX_LEN + 1];
+    std::map<String, LegacyContext> legacy;
+    String cookies[SESSION_CAPACITY];
+
+    // The old createSession: token from millis(), two map lookups
+    unsigned long start = micros();
+    for (size_t i = 0; i < SESSION_CAPACITY; i++) {
+        String token = String("session_") + String(millis()) + String((unsigned long)i);
+        LegacyContext context;
+        context.clientIP = "192.168.1.10";
+        context.userAgent = "Mozilla/5.0";
+        context.authLevel = AuthLevel::ADMIN;
+        context.sessionStart = millis();
+        context.sessionToken = token;
+        legacy[token] = context;
+        legacy[token].authLevel = AuthLevel::ADMIN;
+        cookies[i] = String("theme=dark; session=") + token;
+    }
+    unsigned long mapCreateUs = micros() - start;
+
+    // The table also draws 128 bits from the RNG per token, which the old
+    // millis() token never paid for
+    start = micros();
+    for (size_t i = 0; i < SESSION_CAPACITY; i++) {
+        table->create(0x0a01a8c0, AuthLevel::ADMIN, tokens[i]);
+    }
+    unsigned long tableCreateUs = micros() - start;
+
+    // The old authenticateRequest: copy the token out of the cookie, then
+    // validateSessionToken, getSession and updateSessionActivity each
+    // looked it up again
+    size_t found = 0;
+    start = micros();
+    for (size_t i = 0; i < BENCH_LOOKUPS; i++) {
+        const String& cookie = cookies[i % SESSION_CAPACITY];
+        int tokenStart = cookie.indexOf("session=") + 8;
+        int tokenEnd = cookie.indexOf(";", tokenStart);
+        String token = cookie.substring(tokenStart, tokenEnd < 0 ? cookie.length() : tokenEnd);
+        if (legacy.find(token) == legacy.end()) {
+            continue;
+        }
+        std::map<String, LegacyContext>::iterator it = legacy.find(token);
+        if (it != legacy.end() && it->second.authLevel >= AuthLevel::BASIC) {
+            it = legacy.find(token);
+            it->second.sessionStart = millis();
+            found++;
+        }
+    }
+    unsigned long mapLookupUs = micros() - start;
+    TEST_ASSERT_EQUAL_UINT32(BENCH_LOOKUPS, found);
+
+    // The current path: cookie parsed in place, one check()
+    for (size_t i = 0; i < SESSION_CAPACITY; i++) {
+        cookies[i] = String("theme=dark; session=") + tokens[i];
+    }
+    found = 0;
+    start = micros();
+    for (size_t i = 0; i < BENCH_LOOKUPS; i++) {
+        const char* cookie = cookies[i % SESSION_CAPACITY].c_str();
+        const char* token = strstr(cookie, "session=") + 8;
+        if (table->check(token, strcspn(token, ";"), AuthLevel::BASIC)) {
+            found++;
+        }
+    }
+    unsigned long tableLookupUs = micros() - start;
+    TEST_ASSERT_EQUAL_UINT32(BENCH_LOOKUPS, found);
+
+    char message[160];
+    snprintf(message, sizeof(message), "create x%u: map %lu us, table %lu us; lookup x%u: map %lu us, table %lu us",
+             (unsigned)SESSION_CAPACITY, mapCreateUs, tableCreateUs,
+             (unsigned)BENCH_LOOKUPS, mapLookupUs, tableLookupUs);
+    TEST_MESSAGE(message);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_create_and_check);
+    RUN_TEST(test_insert_generated_token);
+    RUN_TEST(test_evicts_least_recently_used);
+    RUN_TEST(test_expire_keeps_probe_chains);
+    RUN_TEST(test_benchmark_against_map);
+    return UNITY_END();
+}
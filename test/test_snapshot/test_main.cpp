@@ -0,0 +1,140 @@
+// Snapshot cell under load: readers on several threads never see a torn
+// value while a writer publishes, and every copy is freed exactly once
+#include <unity.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "utils/snapshot.h"
+
+#define READERS         4
+#define PUBLISHES       20000
+#define FIELD_COUNT     16
+
+static std::atomic<uint32_t> constructed(0);
+static std::atomic<uint32_t> destroyed(0);
+
+// Every field carries the version, so a mix of two versions shows up
+struct Config {
+    uint32_t version;
+    uint32_t fields[FIELD_COUNT];
+    String name;
+
+    explicit Config(uint32_t version) : version(version), name(String("config-") + String((unsigned long)version)) {
+        for (size_t i = 0; i < FIELD_COUNT; i++) {
+            fields[i] = version;
+        }
+        constructed++;
+    }
+    Config(const Config& other) : version(other.version), name(other.name) {
+        memcpy(fields, other.fields, sizeof(fields));
+        constructed++;
+    }
+    ~Config() {
+        destroyed++;
+    }
+
+    bool isConsistent() const {
+        for (size_t i = 0; i < FIELD_COUNT; i++) {
+            if (fields[i] != version) {
+                return false;
+            }
+        }
+        return name == String("config-") + String((unsigned long)version);
+    }
+};
+
+void setUp() {
+    constructed = 0;
+    destroyed = 0;
+}
+
+void tearDown() {
+}
+
+static void test_empty_until_published() {
+    SnapshotCell<Config> cell;
+    TEST_ASSERT_TRUE(cell.get() == nullptr);
+    cell.publish(Config(1));
+    TEST_ASSERT_EQUAL_UINT32(1, cell.get()->version);
+}
+
+static void test_holder_keeps_old_snapshot() {
+    {
+        SnapshotCell<Config> cell;
+        cell.publish(Config(1));
+        SnapshotCell<Config>::Pointer held = cell.get();
+        cell.publish(Config(2));
+        TEST_ASSERT_EQUAL_UINT32(1, held->version);
+        TEST_ASSERT_EQUAL_UINT32(2, cell.get()->version);
+
+        // Two temporaries, two published copies; the first copy lives on
+        // in held
+        TEST_ASSERT_EQUAL_UINT32(4, constructed.load());
+        TEST_ASSERT_EQUAL_UINT32(2, destroyed.load());
+    }
+    TEST_ASSERT_EQUAL_UINT32(constructed.load(), destroyed.load());
+}
+
+static void test_concurrent_readers() {
+    SnapshotCell<Config>* cell = new SnapshotCell<Config>();
+    cell->publish(Config(0));
+
+    std::atomic<bool> done(false);
+    std::atomic<uint32_t> reads(0);
+    std::atomic<uint32_t> torn(0);
+    std::atomic<uint32_t> backwards(0);
+    std::vector<std::thread> readers;
+    for (int r = 0; r < READERS; r++) {
+        readers.push_back(std::thread([&] {
+            uint32_t last = 0;
+            uint32_t count = 0;
+            while (!done.load()) {
+                SnapshotCell<Config>::Pointer snapshot = cell->get();
+                if (!snapshot->isConsistent()) {
+                    torn++;
+                }
+                if (snapshot->version < last) {
+                    backwards++;
+                }
+                last = snapshot->version;
+                count++;
+            }
+            reads += count;
+        }));
+    }
+
+    unsigned long start = micros();
+    for (uint32_t version = 1; version <= PUBLISHES; version++) {
+        Config draft(version);
+        cell->publish(draft);
+    }
+    unsigned long elapsed = micros() - start;
+    done = true;
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(0, torn.load());
+    TEST_ASSERT_EQUAL_UINT32(0, backwards.load());
+    TEST_ASSERT_EQUAL_UINT32(PUBLISHES, cell->get()->version);
+
+    // One draft and one published copy per version, plus the first; only
+    // the current snapshot is still alive
+    TEST_ASSERT_EQUAL_UINT32(2 * (PUBLISHES + 1), constructed.load());
+    TEST_ASSERT_EQUAL_UINT32(constructed.load() - 1, destroyed.load());
+    delete cell;
+    TEST_ASSERT_EQUAL_UINT32(constructed.load(), destroyed.load());
+
+    char message[128];
+    snprintf(message, sizeof(message), "%u publishes in %lu us alongside %u reads on %d threads",
+             (unsigned)PUBLISHES, elapsed, (unsigned)reads.load(), READERS);
+    TEST_MESSAGE(message);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_until_published);
+    RUN_TEST(test_holder_keeps_old_snapshot);
+    RUN_TEST(test_concurrent_readers);
+    return UNITY_END();
+}
@@ -0,0 +1,225 @@
+// Transaction history store: replay of the committed log, sync positions
+// copied in and out, per-address restarts, and power cuts at every byte of
+// an append and commit
+#include <unity.h>
+#include <LittleFS.h>
+#include "cold/txstore.h"
+
+#define STORE_ID    1
+#define ACCOUNT     7
+
+static TxLogRecord makeRecord(TxRecordType type, uint8_t id, uint32_t index, int64_t value, uint32_t height) {
+    TxLogRecord record;
+    memset(&record, 0, sizeof(record));
+    record.type = type;
+    record.account = ACCOUNT;
+    record.txid[0] = id;
+    record.index = index;
+    record.value = value;
+    record.height = height;
+    return record;
+}
+
+// Newest first, as a backfill delivers it: tx 2 spends output 0 of tx 1
+static std::vector<TxLogRecord> firstPage() {
+    std::vector<TxLogRecord> records;
+    records.push_back(makeRecord(TxRecordType::TRANSACTION, 2, 0, -100, 20));
+    records.push_back(makeRecord(TxRecordType::SPEND, 1, 0, 100, 20));
+    return records;
+}
+
+// Then tx 1 itself, and a newer tx 3 paying the address
+static std::vector<TxLogRecord> secondPage() {
+    std::vector<TxLogRecord> records;
+    records.push_back(makeRecord(TxRecordType::TRANSACTION, 1, 0, 100, 10));
+    records.push_back(makeRecord(TxRecordType::OUTPUT, 1, 0, 100, 10));
+    records.push_back(makeRecord(TxRecordType::TRANSACTION, 3, 0, 50, 30));
+    records.push_back(makeRecord(TxRecordType::OUTPUT, 3, 1, 50, 30));
+    return records;
+}
+
+// Stores a page and its sync position the way the sync does
+static bool storePage(TxStore& store, const std::vector<TxLogRecord>& records, uint32_t txCount) {
+    TxAccount account;
+    if (!store.getAccount(ACCOUNT, account) || !store.append(records)) {
+        return false;
+    }
+    account.txCount = txCount;
+    store.setAccount(account);
+    return store.commit();
+}
+
+static uint32_t storedTxCount(TxStore& store) {
+    TxAccount account;
+    store.getAccount(ACCOUNT, account);
+    return account.txCount;
+}
+
+void setUp() {
+    LittleFS.restorePower();
+    LittleFS.format();
+}
+
+void tearDown() {
+}
+
+static void test_record_layout() {
+    TEST_ASSERT_EQUAL_UINT32(64, sizeof(TxLogRecord));
+}
+
+static void test_replays_committed_log() {
+    TxStore store;
+    store.load(STORE_ID);
+    TEST_ASSERT_TRUE(storePage(store, firstPage(), 1));
+    TEST_ASSERT_TRUE(storePage(store, secondPage(), 3));
+
+    // The spend replayed before its output cancels it
+    TEST_ASSERT_EQUAL_UINT32(1, store.getUnspent().size());
+    TEST_ASSERT_EQUAL_UINT8(3, store.getUnspent()[0].txid[0]);
+    TEST_ASSERT_EQUAL_UINT32(3, store.getRecent().size());
+    TEST_ASSERT_EQUAL_UINT32(30, store.getRecent()[0].height);
+
+    TxStore reloaded;
+    reloaded.load(STORE_ID);
+    TEST_ASSERT_EQUAL_UINT32(6, reloaded.getStats().records);
+    TEST_ASSERT_EQUAL_UINT32(1, reloaded.getUnspent().size());
+    TEST_ASSERT_EQUAL_UINT32(3, reloaded.getRecent().size());
+    TEST_ASSERT_EQUAL_UINT32(3, storedTxCount(reloaded));
+
+    // Another wallet's id does not pick the files up
+    reloaded.load(STORE_ID + 1);
+    TEST_ASSERT_EQUAL_UINT32(0, reloaded.getStats().records);
+}
+
+static void test_uncommitted_append_is_overwritten() {
+    TxStore store;
+    store.load(STORE_ID);
+    TEST_ASSERT_TRUE(storePage(store, firstPage(), 1));
+    TEST_ASSERT_TRUE(store.append(secondPage()));
+
+    TxStore reloaded;
+    reloaded.load(STORE_ID);
+    TEST_ASSERT_EQUAL_UINT32(2, reloaded.getStats().records);
+    TEST_ASSERT_EQUAL_UINT32(1, storedTxCount(reloaded));
+
+    // The next append starts at the committed end
+    std::vector<TxLogRecord> newer(1, makeRecord(TxRecordType::TRANSACTION, 8, 0, 1, 41));
+    TEST_ASSERT_TRUE(storePage(reloaded, newer, 2));
+    reloaded.load(STORE_ID);
+    TEST_ASSERT_EQUAL_UINT32(3, reloaded.getStats().records);
+    TEST_ASSERT_EQUAL_UINT8(8, reloaded.getRecent()[0].txid[0]);
+}
+
+static void test_accounts_are_copies() {
+    TxStore store;
+    store.load(STORE_ID);
+    TxAccount account;
+    TEST_ASSERT_TRUE(store.getAccount(ACCOUNT, account));
+    TEST_ASSERT_EQUAL_UINT32(ACCOUNT, account.account);
+    TEST_ASSERT_EQUAL_UINT32(0, account.txCount);
+
+    // Changing the copy changes nothing until it is set
+    account.txCount = 5;
+    TEST_ASSERT_EQUAL_UINT32(0, storedTxCount(store));
+    store.setAccount(account);
+    TEST_ASSERT_EQUAL_UINT32(5, storedTxCount(store));
+
+    // A full table refuses new addresses but keeps serving known ones
+    for (uint32_t i = 1; store.getStats().accounts < TX_STORE_ACCOUNTS_MAX; i++) {
+        TEST_ASSERT_TRUE(store.getAccount(ACCOUNT + i, account));
+    }
+    TEST_ASSERT_FALSE(store.getAccount(0, account));
+    TEST_ASSERT_TRUE(store.getAccount(ACCOUNT, account));
+    TEST_ASSERT_TRUE(store.commit());
+
+    TxStore reloaded;
+    reloaded.load(STORE_ID);
+    TEST_ASSERT_EQUAL_UINT32(TX_STORE_ACCOUNTS_MAX, reloaded.getStats().accounts);
+    TEST_ASSERT_EQUAL_UINT32(5, storedTxCount(reloaded));
+}
+
+static void test_reset_account_keeps_others() {
+    TxStore store;
+    store.load(STORE_ID);
+    TEST_ASSERT_TRUE(storePage(store, secondPage(), 2));
+
+    // A second address paid by tx 4
+    std::vector<TxLogRecord> other;
+    other.push_back(makeRecord(TxRecordType::TRANSACTION, 4, 0, 70, 40));
+    other.push_back(makeRecord(TxRecordType::OUTPUT, 4, 0, 70, 40));
+    other[0].account = ACCOUNT + 1;
+    other[1].account = ACCOUNT + 1;
+    TxAccount account;
+    TEST_ASSERT_TRUE(store.getAccount(ACCOUNT + 1, account));
+    TEST_ASSERT_TRUE(store.append(other));
+    account.txCount = 1;
+    store.setAccount(account);
+    TEST_ASSERT_TRUE(store.commit());
+    TEST_ASSERT_EQUAL_UINT32(3, store.getUnspent().size());
+
+    // Only the first address loses its history, in RAM and after a reload
+    TEST_ASSERT_TRUE(store.resetAccount(ACCOUNT));
+    TEST_ASSERT_EQUAL_UINT32(0, storedTxCount(store));
+    TEST_ASSERT_EQUAL_UINT32(1, store.getUnspent().size());
+    TEST_ASSERT_EQUAL_UINT8(4, store.getUnspent()[0].txid[0]);
+    TEST_ASSERT_EQUAL_UINT32(1, store.getRecent().size());
+
+    // Its next sync appends a fresh history after the skipped records
+    TEST_ASSERT_TRUE(storePage(store, secondPage(), 2));
+    TxStore reloaded;
+    reloaded.load(STORE_ID);
+    TEST_ASSERT_EQUAL_UINT32(10, reloaded.getStats().records);
+    TEST_ASSERT_EQUAL_UINT32(3, reloaded.getUnspent().size());
+    TEST_ASSERT_EQUAL_UINT32(3, reloaded.getRecent().size());
+    TEST_ASSERT_EQUAL_UINT32(2, storedTxCount(reloaded));
+}
+
+static void test_cut_at_every_byte() {
+    // Log bytes, state header and positions, then the rename
+    long total = secondPage().size() * sizeof(TxLogRecord) + 5 * sizeof(uint32_t) + sizeof(TxAccount) + 1;
+    uint32_t oldSeen = 0;
+    uint32_t newSeen = 0;
+    for (long cut = 0; cut <= total; cut++) {
+        LittleFS.restorePower();
+        LittleFS.format();
+        TxStore store;
+        store.load(STORE_ID);
+        TEST_ASSERT_TRUE(storePage(store, firstPage(), 1));
+
+        LittleFS.cutPowerAfter(cut);
+        bool stored = storePage(store, secondPage(), 3);
+        TEST_ASSERT_EQUAL(cut == total, stored);
+
+        // Reboot: the log and the positions always agree
+        LittleFS.restorePower();
+        TxStore reloaded;
+        reloaded.load(STORE_ID);
+        if (reloaded.getStats().records == 6) {
+            TEST_ASSERT_EQUAL_UINT32(3, storedTxCount(reloaded));
+            TEST_ASSERT_EQUAL_UINT32(1, reloaded.getUnspent().size());
+            newSeen++;
+        } else {
+            TEST_ASSERT_EQUAL_UINT32(2, reloaded.getStats().records);
+            TEST_ASSERT_EQUAL_UINT32(1, storedTxCount(reloaded));
+            oldSeen++;
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(total, oldSeen);
+    TEST_ASSERT_EQUAL_UINT32(1, newSeen);
+
+    char message[96];
+    snprintf(message, sizeof(message), "%ld cut points: %u kept the old history, %u the new one",
+             total + 1, (unsigned)oldSeen, (unsigned)newSeen);
+    TEST_MESSAGE(message);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_record_layout);
+    RUN_TEST(test_replays_committed_log);
+    RUN_TEST(test_uncommitted_append_is_overwritten);
+    RUN_TEST(test_accounts_are_copies);
+    RUN_TEST(test_reset_account_keeps_others);
+    RUN_TEST(test_cut_at_every_byte);
+    return UNITY_END();
+}
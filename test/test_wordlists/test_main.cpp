@@ -0,0 +1,144 @@
+// Seed phrase tables: BIP39 vectors, lookups over the whole table, the kid
+// word picker, and how long a phrase check takes
+#include <unity.h>
+#include "settings/wordlists.h"
+
+#define BENCH_PHRASES   20000
+
+// From the BIP39 reference vectors (trezor/python-mnemonic), one per length
+static const char* VALID_PHRASES[] = {
+    "abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon about",
+    "legal winner thank year wave sausage worth useful legal winner thank yellow",
+    "zoo zoo zoo zoo zoo zoo zoo zoo zoo zoo zoo zoo zoo zoo zoo zoo zoo zoo zoo zoo zoo zoo zoo vote",
+    "gravity machine north sort system female filter attitude volume fold club stay feature office ecology stable narrow fog",
+    "void come effort suffer camp survey warrior heavy shoot primary clutch crush open amazing screen patrol "
+    "group space point ten exist slush involve unfold"
+};
+
+static const char* INVALID_PHRASES[] = {
+    "abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon",  // Checksum
+    "zoo zoo zoo zoo zoo zoo zoo zoo zoo zoo zoo zoo",                                                  // Checksum
+    "abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon about",            // 11 words
+    "abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon abouts",   // Unknown word
+    "",
+    "cat dog fish bird"
+};
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+static void test_accepts_reference_phrases() {
+    for (size_t i = 0; i < sizeof(VALID_PHRASES) / sizeof(VALID_PHRASES[0]); i++) {
+        TEST_ASSERT_TRUE_MESSAGE(bip39IsValid(VALID_PHRASES[i]), VALID_PHRASES[i]);
+    }
+
+    // Case and spacing do not matter
+    TEST_ASSERT_TRUE(bip39IsValid("  Legal winner THANK year wave sausage worth useful legal winner thank yellow "));
+}
+
+static void test_rejects_invalid_phrases() {
+    for (size_t i = 0; i < sizeof(INVALID_PHRASES) / sizeof(INVALID_PHRASES[0]); i++) {
+        TEST_ASSERT_FALSE_MESSAGE(bip39IsValid(INVALID_PHRASES[i]), INVALID_PHRASES[i]);
+    }
+}
+
+static void test_table_lookups() {
+    TEST_ASSERT_EQUAL_INT(0, bip39Index("abandon", 7));
+    TEST_ASSERT_EQUAL_INT(3, bip39Index("about", 5));
+    TEST_ASSERT_EQUAL_INT(BIP39_WORD_COUNT - 1, bip39Index("zoo", 3));
+    TEST_ASSERT_EQUAL_INT(-1, bip39Index("aban", 4));
+    TEST_ASSERT_EQUAL_INT(-1, bip39Index("abandons", 8));
+
+    // Every word finds itself, and the table is sorted for the search
+    for (uint16_t i = 0; i < BIP39_WORD_COUNT; i++) {
+        const char* word = bip39Word(i);
+        TEST_ASSERT_TRUE(strlen(word) <= WORD_MAX_LENGTH);
+        TEST_ASSERT_EQUAL_INT(i, bip39Index(word, strlen(word)));
+        if (i > 0) {
+            TEST_ASSERT_TRUE(strcmp(bip39Word(i - 1), word) < 0);
+        }
+    }
+    for (uint8_t i = 0; i < KID_WORD_COUNT; i++) {
+        const char* word = kidWord(i);
+        TEST_ASSERT_EQUAL_INT(i, kidWordIndex(word, strlen(word)));
+    }
+}
+
+static void test_next_word() {
+    const char* cursor = "  Apple\tbanana   strawberries ";
+    char word[WORD_MAX_LENGTH + 1];
+    TEST_ASSERT_EQUAL_UINT32(5, nextWord(cursor, word));
+    TEST_ASSERT_EQUAL_STRING("apple", word);
+    TEST_ASSERT_EQUAL_UINT32(6, nextWord(cursor, word));
+    TEST_ASSERT_EQUAL_STRING("banana", word);
+    TEST_ASSERT_EQUAL_UINT32(WORD_MAX_LENGTH + 1, nextWord(cursor, word));
+    TEST_ASSERT_EQUAL_UINT32(0, nextWord(cursor, word));
+}
+
+static void test_kid_phrases() {
+    char out[64];
+    size_t length = kidPhraseGenerate(out, sizeof(out), 4);
+    TEST_ASSERT_EQUAL_UINT32(strlen(out), length);
+
+    const char* cursor = out;
+    char word[WORD_MAX_LENGTH + 1];
+    size_t words = 0;
+    while ((length = nextWord(cursor, word))) {
+        TEST_ASSERT_TRUE(kidWordIndex(word, length) >= 0);
+        words++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(4, words);
+    TEST_ASSERT_EQUAL_UINT32(0, kidPhraseGenerate(out, 8, 4));
+
+    // 1000 picks per word expected; a biased pick would stand out
+    uint32_t counts[KID_WORD_COUNT] = {0};
+    for (uint32_t i = 0; i < KID_WORD_COUNT * 1000; i++) {
+        counts[kidWordPick()]++;
+    }
+    for (uint8_t i = 0; i < KID_WORD_COUNT; i++) {
+        TEST_ASSERT_TRUE(counts[i] > 800 && counts[i] < 1200);
+    }
+}
+
+static void test_benchmark_validation() {
+    const char* phrase = VALID_PHRASES[4];
+    unsigned long start = micros();
+    uint32_t valid = 0;
+    for (uint32_t i = 0; i < BENCH_PHRASES; i++) {
+        valid += bip39IsValid(phrase);
+    }
+    unsigned long validateUs = micros() - start;
+    TEST_ASSERT_EQUAL_UINT32(BENCH_PHRASES, valid);
+
+    start = micros();
+    uint32_t found = 0;
+    for (uint32_t i = 0; i < BENCH_PHRASES; i++) {
+        const char* cursor = phrase;
+        char word[WORD_MAX_LENGTH + 1];
+        size_t length;
+        while ((length = nextWord(cursor, word))) {
+            found += bip39Index(word, length) >= 0;
+        }
+    }
+    unsigned long lookupUs = micros() - start;
+    TEST_ASSERT_EQUAL_UINT32(BENCH_PHRASES * 24, found);
+
+    char message[128];
+    snprintf(message, sizeof(message), "24-word phrase: %.2f us to validate, %.2f us of it word lookups",
+             (double)validateUs / BENCH_PHRASES, (double)lookupUs / BENCH_PHRASES);
+    TEST_MESSAGE(message);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_accepts_reference_phrases);
+    RUN_TEST(test_rejects_invalid_phrases);
+    RUN_TEST(test_table_lookups);
+    RUN_TEST(test_next_word);
+    RUN_TEST(test_kid_phrases);
+    RUN_TEST(test_benchmark_validation);
+    return UNITY_END();
+}
@@ -0,0 +1,50 @@
+// Show the result of the last settings form submission
+var urlParams = new URLSearchParams(window.location.search);
+var saved = urlParams.get('saved');
+var error = urlParams.get('error');
+var statusMsg = document.getElementById('status-msg');
+if(saved) {
+    var msg = '';
+    if(saved === 'wifi') msg = 'WiFi settings saved successfully!';
+    else if(saved === 'lightning') msg = 'Lightning wallet settings saved successfully!';
+    else if(saved === 'coldstorage') msg = 'Cold storage address saved successfully!';
+    else if(saved === 'system') msg = 'System settings saved successfully!';
+    if(msg) statusMsg.innerHTML = '<div class="success-msg">' + msg + '</div>';
+}
+// Saves run in the background; follow the job until it finishes
+var job = urlParams.get('job');
+if(saved && job) {
+    var savedHtml = statusMsg.innerHTML;
+    statusMsg.innerHTML = '<div class="success-msg">Saving...</div>';
+    var pollJob = function() {
+        fetch('/api/jobs?id=' + encodeURIComponent(job))
+            .then(function(r) { return r.ok ? r.json() : { state: 'done' }; })
+            .then(function(status) {
+                if(status.state === 'failed') {
+                    statusMsg.innerHTML = '<div class="error-msg">Saving failed. Please try again.</div>';
+                } else if(status.state === 'done') {
+                    statusMsg.innerHTML = savedHtml;
+                } else {
+                    setTimeout(pollJob, 1000);
+                }
+            })
+            .catch(function() { setTimeout(pollJob, 1000); });
+    };
+    pollJob();
+}
+if(error) {
+    var msg = '';
+    if(error === 'wifi') msg = 'Error saving WiFi settings. Please try again.';
+    else if(error === 'lightning') msg = 'Error saving Lightning settings. Please check your API token.';
+    else if(error === 'coldstorage') msg = 'Error saving cold storage address. Please check the address format.';
+    else if(error === 'system') msg = 'Error saving system settings. Please check the sleep timeout value (1-60 minutes).';
+    if(msg) statusMsg.innerHTML = '<div class="error-msg">' + msg + '</div>';
+}
+
+function confirmFactoryReset() {
+    if(confirm('⚠️ DANGER: This will permanently erase ALL data including your seed phrase!\n\nAre you absolutely sure you want to factory reset?')) {
+        if(confirm('⚠️ FINAL WARNING: Your Lightning wallet and all settings will be lost forever!\n\nContinue with factory reset?')) {
+            window.location.href = '/api/factory-reset';
+        }
+    }
+}
@@ -0,0 +1,12 @@
+document.getElementById('seedphrase').addEventListener('input', function() {
+    const words = this.value.trim().split(/\s+/).filter(word => word.length > 0);
+    document.getElementById('wordCount').textContent = words.length + ' words';
+
+    if (words.length === 4) {
+        document.getElementById('wordCount').style.color = '#0a8';
+        document.querySelector('.login-btn').style.background = '#667eea';
+    } else {
+        document.getElementById('wordCount').style.color = '#666';
+        document.querySelector('.login-btn').style.background = '#6c757d';
+    }
+});
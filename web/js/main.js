@@ -0,0 +1,49 @@
+// Live balance and status updates pushed by the device over /api/events
+function formatSats(value) {
+    if (value === null || value === undefined) return '-- sats';
+    return value.toLocaleString('en-US') + ' sats';
+}
+
+function setBalance(id, value) {
+    var el = document.getElementById(id);
+    if (el) el.textContent = formatSats(value);
+}
+
+function setUpdating(updating) {
+    var values = document.querySelectorAll('.status-value');
+    for (var i = 0; i < values.length; i++) {
+        values[i].classList.toggle('updating', updating);
+    }
+}
+
+if (window.EventSource) {
+    var liveStatus = document.getElementById('live-status');
+    var source = new EventSource('/api/events');
+
+    // Only the fields that changed are sent
+    source.addEventListener('balances', function(e) {
+        var data = JSON.parse(e.data);
+        if ('lightning' in data) setBalance('lightning-sats', data.lightning);
+        if ('cold' in data) setBalance('cold-sats', data.cold);
+        if ('total' in data) setBalance('total-sats', data.total);
+        setUpdating(false);
+    });
+
+    source.addEventListener('state', function(e) {
+        var data = JSON.parse(e.data);
+        setUpdating(data.state === 'updating_balances');
+        liveStatus.textContent = data.state === 'updating_balances' ? '🔄 Updating...' : '';
+    });
+
+    source.addEventListener('wifi', function(e) {
+        var data = JSON.parse(e.data);
+        liveStatus.textContent = data.connected ? '' : '📶 Offline';
+    });
+
+    source.onerror = function() {
+        liveStatus.textContent = '⏸️ Reconnecting...';
+    };
+    source.onopen = function() {
+        liveStatus.textContent = '';
+    };
+}
@@ -0,0 +1,12 @@
+document.getElementById('seedphrase').addEventListener('input', function() {
+    const words = this.value.trim().split(/\s+/).filter(word => word.length > 0);
+    document.getElementById('wordCount').textContent = words.length + ' words';
+
+    if (words.length === 12) {
+        document.getElementById('wordCount').style.color = '#28a745';
+        document.querySelector('.setup-btn').style.background = '#28a745';
+    } else {
+        document.getElementById('wordCount').style.color = '#666';
+        document.querySelector('.setup-btn').style.background = '#6c757d';
+    }
+});